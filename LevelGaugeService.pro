@@ -6,43 +6,76 @@ CONFIG += c++20 console
 CONFIG -= app_bundle
 
 SOURCES += \
+    applicanttopologycache.cpp \
+    checksum.cpp \
+    circuitbreaker.cpp \
+    compression.cpp \
     core.cpp \
+    flushpolicy.cpp \
+    httpclientpool.cpp \
     intake.cpp \
+    jsonwriter.cpp \
+    logbuffer.cpp \
     main.cpp \
+    packageindex.cpp \
+    packagesizecontroller.cpp \
+    packagetracker.cpp \
     service.cpp \
+    statusspool.cpp \
+    statuswriter.cpp \
     suncsync.cpp \
     sync.cpp \
     syncdbintake.cpp \
     syncdbstatus.cpp \
+    synchttpflowmeter.cpp \
     synchttpintake.cpp \
     synchttpstatus.cpp \
     tank.cpp \
     tankconfig.cpp \
     tankid.cpp \
     tanks.cpp \
+    tankscalculatequery.cpp \
     tanksconfig.cpp \
     tankstatus.cpp \
     tankstatuses.cpp \
     tconfig.cpp \
+    timerwheel.cpp \
 
 HEADERS += \
+    applicanttopologycache.h \
+    checksum.h \
+    circuitbreaker.h \
+    compression.h \
     core.h \
+    dbwritemode.h \
+    flushpolicy.h \
+    httpclientpool.h \
     intake.h \
+    jsonwriter.h \
+    logbuffer.h \
+    packageindex.h \
+    packagesizecontroller.h \
+    packagetracker.h \
     service.h \
+    statusspool.h \
+    statuswriter.h \
     suncsync.h \
     sync.h \
     syncdbintake.h \
     syncdbstatus.h \
+    synchttpflowmeter.h \
     synchttpintake.h \
     synchttpstatus.h \
     tank.h \
     tankconfig.h \
     tankid.h \
     tanks.h \
+    tankscalculatequery.h \
     tanksconfig.h \
     tankstatus.h \
     tankstatuses.h \
-    tconfig.h
+    tconfig.h \
+    timerwheel.h
 
 RC_ICONS = $$PWD/res/LevelGaugeService.ico
 
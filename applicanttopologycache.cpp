@@ -0,0 +1,351 @@
+//STL
+#include <algorithm>
+
+//My
+#include "applicanttopologycache.h"
+
+using namespace LevelGaugeService;
+using namespace Common;
+
+static const QString CACHE_NAME = "ApplicantTopologyCache";
+
+ApplicantTopologyCache::ApplicantTopologyCache(TanksConfig* tanksConfig, HTTPClientPool* httpClientPool,
+                                               const QHash<qint64, QString>& applicantBINs, qint64 refreshInterval, QObject* parent /* = nullptr */)
+    : QObject{parent}
+    , _tanksConfig(tanksConfig)
+    , _httpClientPool(httpClientPool)
+    , _applicantBINs(applicantBINs)
+    , _refreshInterval(refreshInterval)
+{
+    Q_CHECK_PTR(_tanksConfig);
+    Q_CHECK_PTR(_httpClientPool);
+    Q_ASSERT(_refreshInterval > 0);
+
+    QObject::connect(&_refreshTimer, SIGNAL(timeout()), SLOT(refresh()));
+}
+
+ApplicantTopologyCache::~ApplicantTopologyCache()
+{
+    stop();
+}
+
+void ApplicantTopologyCache::start()
+{
+    Q_ASSERT(!_isStarted);
+
+    for (const auto& tankId: _tanksConfig->getTanksID())
+    {
+        addApplicant(tankId);
+    }
+
+    for (auto applicantBINs_it = _applicantBINs.begin(); applicantBINs_it != _applicantBINs.end(); ++applicantBINs_it)
+    {
+        if (!_applicants.contains(applicantBINs_it.key()))
+        {
+            emit sendLogMsg(CACHE_NAME, TDBLoger::MSG_CODE::WARNING_CODE,
+                            QString("BIN is set for an applicant without tanks. Applicant ID: %1. Skip").arg(applicantBINs_it.key()));
+        }
+    }
+
+    _isStarted = true;
+
+    if (_applicants.empty())
+    {
+        return;
+    }
+
+    refresh();
+
+    _refreshTimer.start(_refreshInterval);
+}
+
+void ApplicantTopologyCache::stop()
+{
+    if (!_isStarted)
+    {
+        return;
+    }
+
+    _refreshTimer.stop();
+
+    _applicants.clear();
+
+    _isStarted = false;
+}
+
+void ApplicantTopologyCache::removeTanks(const TankIDList& tanksId)
+{
+    if (!_isStarted)
+    {
+        return;
+    }
+
+    //клиенты организаций сохраняются - резервуары с тем же ИД обычно сразу добавляются с новой конфигурацией
+    for (const auto& tankId: tanksId)
+    {
+        _invalidTanks.remove(tankId);
+    }
+}
+
+void ApplicantTopologyCache::addTanks(const TankIDList& tanksId)
+{
+    if (!_isStarted)
+    {
+        return;
+    }
+
+    QSet<qint64> applicantsId;
+    for (const auto& tankId: tanksId)
+    {
+        const auto tankConfig = _tanksConfig->findTankConfig(tankId);
+        if (tankConfig == nullptr)
+        {
+            continue;
+        }
+
+        const auto newApplicantId = addApplicant(tankId);
+        if (newApplicantId != 0)
+        {
+            auto& applicant = _applicants.at(newApplicantId);
+            if (applicant.suncSync->isAvailable())
+            {
+                applicant.requestId = applicant.suncSync->sendGetApplicantData(applicant.BIN);
+            }
+
+            continue;
+        }
+
+        applicantsId.insert(tankConfig->remoteApplicantId());
+    }
+
+    //данные организации уже получены - новые резервуары проверяем не дожидаясь обновления
+    for (const auto applicantId: applicantsId)
+    {
+        if (_topologies.contains(applicantId))
+        {
+            checkTanks(applicantId);
+        }
+    }
+
+    if (!_applicants.empty() && !_refreshTimer.isActive())
+    {
+        _refreshTimer.start(_refreshInterval);
+    }
+}
+
+bool ApplicantTopologyCache::isTankValid(const TankID& tankId) const
+{
+    return !_invalidTanks.contains(tankId);
+}
+
+bool ApplicantTopologyCache::isLoaded(qint64 applicantId) const
+{
+    return _topologies.contains(applicantId);
+}
+
+QList<qint64> ApplicantTopologyCache::devices(qint64 applicantId) const
+{
+    const auto topologies_it = _topologies.find(applicantId);
+    if (topologies_it == _topologies.end())
+    {
+        return {};
+    }
+
+    return topologies_it->devices.values();
+}
+
+void ApplicantTopologyCache::refresh()
+{
+    Q_ASSERT(_isStarted);
+
+    for (auto& [applicantId, applicant]: _applicants)
+    {
+        //предыдущий запрос еще не завершен или сервер временно недоступен - ждем следующего обновления
+        if (applicant.requestId != 0 || !applicant.suncSync->isAvailable())
+        {
+            continue;
+        }
+
+        applicant.requestId = applicant.suncSync->sendGetApplicantData(applicant.BIN);
+    }
+}
+
+void ApplicantTopologyCache::getApplicantData(const SUNCSync::ApplicantDataInfo& applicantData, quint64 id)
+{
+    const auto applicants_it = std::find_if(_applicants.begin(), _applicants.end(),
+        [id](const auto& applicant)
+        {
+            return applicant.second.requestId == id;
+        });
+
+    if (applicants_it == _applicants.end())
+    {
+        return;
+    }
+
+    const auto applicantId = applicants_it->first;
+    applicants_it->second.requestId = 0;
+
+    if (!applicantData.success)
+    {
+        emit sendLogMsg(CACHE_NAME, TDBLoger::MSG_CODE::WARNING_CODE,
+                        QString("Server did not return applicant data. Applicant ID: %1. Error: %2")
+                            .arg(applicantId)
+                            .arg(applicantData.error));
+
+        return;
+    }
+
+    if (applicantData.applicantData.applicantId != applicantId)
+    {
+        emit sendLogMsg(CACHE_NAME, TDBLoger::MSG_CODE::WARNING_CODE,
+                        QString("Server returned data of another applicant. Check [SYNC_HTTP]/ApplicantBINs. Applicant ID: %1. Received applicant ID: %2")
+                            .arg(applicantId)
+                            .arg(applicantData.applicantData.applicantId));
+
+        return;
+    }
+
+    Topology topology;
+    for (const auto& object: applicantData.applicantData.objects)
+    {
+        topology.objects.insert(object.objectId);
+
+        for (const auto& tank: object.tanks)
+        {
+            topology.tanks.insert(tank.tankId);
+        }
+
+        for (const auto& device: object.devices)
+        {
+            topology.devices.insert(device.deviceId);
+        }
+    }
+    topology.updateDateTime = QDateTime::currentDateTime();
+
+    emit sendLogMsg(CACHE_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE,
+                    QString("Applicant data loaded. Applicant ID: %1. Objects: %2. Tanks: %3. Devices: %4")
+                        .arg(applicantId)
+                        .arg(topology.objects.size())
+                        .arg(topology.tanks.size())
+                        .arg(topology.devices.size()));
+
+    _topologies.insert(applicantId, std::move(topology));
+
+    checkTanks(applicantId);
+}
+
+qint64 ApplicantTopologyCache::addApplicant(const TankID& tankId)
+{
+    const auto tankConfig = _tanksConfig->getTankConfig(tankId);
+    const auto applicantId = tankConfig->remoteApplicantId();
+
+    const auto applicantBINs_it = _applicantBINs.find(applicantId);
+    if (applicantBINs_it == _applicantBINs.end() || _applicants.contains(applicantId))
+    {
+        return 0;
+    }
+
+    Applicant applicant;
+    applicant.BIN = applicantBINs_it.value();
+    applicant.suncSync = std::make_unique<SUNCSync>(_httpClientPool, tankConfig->remoteBaseUrl(), tankConfig->remoteBearerToken());
+
+    QObject::connect(applicant.suncSync.get(), SIGNAL(errorRequest(const QString&, LevelGaugeService::SUNCSync::PackageProcessingStatus, quint64)),
+                                 SLOT(errorRequest(const QString&, LevelGaugeService::SUNCSync::PackageProcessingStatus, quint64)));
+    QObject::connect(applicant.suncSync.get(), SIGNAL(sendLogMsg(Common::TDBLoger::MSG_CODE, const QString&, quint64)),
+                                 SLOT(sendLogMsgHTTP(Common::TDBLoger::MSG_CODE, const QString&, quint64)));
+    QObject::connect(applicant.suncSync.get(), SIGNAL(getApplicantData(const LevelGaugeService::SUNCSync::ApplicantDataInfo&, quint64)),
+                                 SLOT(getApplicantData(const LevelGaugeService::SUNCSync::ApplicantDataInfo&, quint64)));
+
+    _applicants.emplace(applicantId, std::move(applicant));
+
+    return applicantId;
+}
+
+void ApplicantTopologyCache::checkTanks(qint64 applicantId)
+{
+    const auto& topology = _topologies[applicantId];
+
+    TankIDList validTanksId;
+    for (const auto& tankId: _tanksConfig->getTanksID())
+    {
+        const auto tankConfig = _tanksConfig->getTankConfig(tankId);
+        if (tankConfig->remoteApplicantId() != applicantId)
+        {
+            continue;
+        }
+
+        const auto isValid = topology.objects.contains(tankConfig->remoteObjectId()) && topology.tanks.contains(tankConfig->remoteTankId());
+        if (isValid)
+        {
+            if (_invalidTanks.remove(tankId))
+            {
+                emit sendLogMsg(CACHE_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE,
+                                QString("Tank found on server. Data sending resumed. AZSCode: %1. Tank number: %2. Remote object ID: %3. Remote tank ID: %4")
+                                    .arg(tankId.levelGaugeCode())
+                                    .arg(tankId.tankNumber())
+                                    .arg(tankConfig->remoteObjectId())
+                                    .arg(tankConfig->remoteTankId()));
+
+                validTanksId.push_back(tankId);
+            }
+
+            continue;
+        }
+
+        if (!_invalidTanks.contains(tankId))
+        {
+            _invalidTanks.insert(tankId);
+
+            emit sendLogMsg(CACHE_NAME, TDBLoger::MSG_CODE::WARNING_CODE,
+                            QString("Tank not found on server. Data will not be sent until the tank configuration is fixed. AZSCode: %1. Tank number: %2. Remote object ID: %3. Remote tank ID: %4")
+                                .arg(tankId.levelGaugeCode())
+                                .arg(tankId.tankNumber())
+                                .arg(tankConfig->remoteObjectId())
+                                .arg(tankConfig->remoteTankId()));
+        }
+    }
+
+    if (!validTanksId.isEmpty())
+    {
+        emit tanksValid(validTanksId);
+    }
+}
+
+void ApplicantTopologyCache::errorRequest(const QString& msg, SUNCSync::PackageProcessingStatus status, quint64 id)
+{
+    const auto applicants_it = std::find_if(_applicants.begin(), _applicants.end(),
+        [id](const auto& applicant)
+        {
+            return applicant.second.requestId == id;
+        });
+
+    if (applicants_it == _applicants.end())
+    {
+        return;
+    }
+
+    applicants_it->second.requestId = 0;
+
+    emit sendLogMsg(CACHE_NAME, TDBLoger::MSG_CODE::WARNING_CODE,
+                    QString("Error getting applicant data. Previous data is used. Applicant ID: %1. Status: %2. Error: %3")
+                        .arg(applicants_it->first)
+                        .arg(SUNCSync::packageProcessingStatusToString(status))
+                        .arg(msg));
+}
+
+void ApplicantTopologyCache::sendLogMsgHTTP(TDBLoger::MSG_CODE category, const QString& msg, quint64 id)
+{
+    const auto applicants_it = std::find_if(_applicants.begin(), _applicants.end(),
+        [id](const auto& applicant)
+        {
+            return applicant.second.requestId == id;
+        });
+
+    if (applicants_it == _applicants.end())
+    {
+        return;
+    }
+
+    emit sendLogMsg(CACHE_NAME, category, QString("Applicant ID: %1. %2").arg(applicants_it->first).arg(msg));
+}
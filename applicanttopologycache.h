@@ -0,0 +1,164 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Кеш структуры организаций (объекты, резервуары, устройства) на сервере СУНП
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//STL
+#include <memory>
+#include <unordered_map>
+
+//Qt
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QDateTime>
+
+//My
+#include "Common/tdbloger.h"
+#include "tanksconfig.h"
+#include "suncsync.h"
+#include "httpclientpool.h"
+
+namespace LevelGaugeService
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// При запуске и далее с интервалом refreshInterval запрашивает у сервера
+///     данные организаций, для которых задан БИН, и проверяет по ним ИД
+///     объектов и резервуаров из конфигурации резервуаров. Синхронизаторы
+///     исключают из пакетов данные резервуаров и устройств, отсутствующих на
+///     сервере, поэтому один неверно настроенный резервуар не приводит к
+///     отклонению сервером всего пакета. Пока данные организации не получены
+///     (БИН не задан или сервер недоступен) все резервуары считаются корректными
+///
+class ApplicantTopologyCache final
+    : public QObject
+{
+    Q_OBJECT
+
+public:
+    /*!
+        Конструктор
+        @param tanksConfig - конфигурация резервуаров
+        @param httpClientPool - общий пул HTTP клиентов
+        @param applicantBINs - БИН организаций. Ключ - ИД организации
+        @param refreshInterval - интервал обновления данных, мсек
+        @param parent - указатель на родительский класс
+    */
+    ApplicantTopologyCache(LevelGaugeService::TanksConfig* tanksConfig, LevelGaugeService::HTTPClientPool* httpClientPool,
+                           const QHash<qint64, QString>& applicantBINs, qint64 refreshInterval, QObject* parent = nullptr);
+
+    /*!
+        Деструктор
+    */
+    ~ApplicantTopologyCache();
+
+    void start();
+    void stop();
+
+    /*!
+        Резервуары удаляются из конфигурации. Вызывается пока конфигурации резервуаров еще существуют
+        @param tanksId - список ИД удаляемых резервуаров
+    */
+    void removeTanks(const LevelGaugeService::TankIDList& tanksId);
+
+    /*!
+        Резервуары добавлены в конфигурацию. Для новых организаций запрашиваются данные с сервера,
+            резервуары организаций с уже полученными данными проверяются сразу
+        @param tanksId - список ИД добавленных резервуаров
+    */
+    void addTanks(const LevelGaugeService::TankIDList& tanksId);
+
+    /*!
+        Проверяет наличие резервуара у организации на сервере
+        @param tankId - ИД резервуара
+        @return false если данные организации получены и резервуар (или его объект) на сервере отсутствует
+    */
+    bool isTankValid(const LevelGaugeService::TankID& tankId) const;
+
+    /*!
+        Возвращает true если данные организации получены с сервера
+    */
+    bool isLoaded(qint64 applicantId) const;
+
+    /*!
+        Возвращает ИД устройств организации на сервере
+        @param applicantId - ИД организации
+        @return список ИД устройств. Пустой если данные организации не получены
+    */
+    QList<qint64> devices(qint64 applicantId) const;
+
+signals:
+    /*!
+        Сигнал испускатся при необходимости сохранить сообщения в лог
+        @param name - символьное название кеша
+        @param category - тип сохраняемого сообщения (DBG, INFO, WAR....)
+        @param msg - текст сообщения
+    */
+    void sendLogMsg(const QString& name, Common::TDBLoger::MSG_CODE category, const QString& msg);
+
+    /*!
+        Сигнал испускается когда резервуары, ранее отсутствовавшие на сервере, найдены в полученных данных организации
+        @param tanksId - список ИД резервуаров
+    */
+    void tanksValid(const LevelGaugeService::TankIDList& tanksId);
+
+private slots:
+    void refresh();
+
+    void getApplicantData(const LevelGaugeService::SUNCSync::ApplicantDataInfo& applicantData, quint64 id);
+    void errorRequest(const QString& msg, LevelGaugeService::SUNCSync::PackageProcessingStatus status, quint64 id);
+    void sendLogMsgHTTP(Common::TDBLoger::MSG_CODE category, const QString& msg, quint64 id);
+
+private:
+    struct Topology
+    {
+        QSet<qint64> objects;   ///< ИД объектов
+        QSet<qint64> tanks;     ///< ИД резервуаров
+        QSet<qint64> devices;   ///< ИД устройств
+        QDateTime updateDateTime;
+    };
+
+    struct Applicant
+    {
+        std::unique_ptr<LevelGaugeService::SUNCSync> suncSync;
+        QString BIN;
+        quint64 requestId = 0;  ///< ИД выполняемого запроса. 0 - запрос не выполняется
+    };
+
+private:
+    ApplicantTopologyCache() = delete;
+    Q_DISABLE_COPY_MOVE(ApplicantTopologyCache)
+
+    /*!
+        Создает клиент сервера организации резервуара, если для организации задан БИН и клиент еще не создан
+        @param tankId - ИД резервуара
+        @return ИД организации если клиент создан, иначе 0
+    */
+    qint64 addApplicant(const LevelGaugeService::TankID& tankId);
+
+    /*!
+        Проверяет резервуары организации по полученным данным и сохраняет в лог список некорректных резервуаров
+    */
+    void checkTanks(qint64 applicantId);
+
+private:
+    LevelGaugeService::TanksConfig* _tanksConfig = nullptr;
+    LevelGaugeService::HTTPClientPool* _httpClientPool = nullptr;
+    const QHash<qint64, QString> _applicantBINs;
+    const qint64 _refreshInterval = 0;
+
+    std::unordered_map<qint64, Applicant> _applicants;  ///< Ключ - ИД организации
+    QHash<qint64, Topology> _topologies;                ///< Полученные данные организаций. Ключ - ИД организации
+    QSet<LevelGaugeService::TankID> _invalidTanks;      ///< Резервуары, отсутствующие на сервере
+
+    QTimer _refreshTimer;
+
+    bool _isStarted = false;
+
+}; //class ApplicantTopologyCache
+
+} //namespace LevelGaugeService
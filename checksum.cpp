@@ -0,0 +1,43 @@
+//STL
+#include <array>
+
+//My
+#include "checksum.h"
+
+using namespace LevelGaugeService;
+
+static constexpr std::array<quint32, 256> makeCRC32Table()
+{
+    std::array<quint32, 256> table{};
+    for (quint32 i = 0; i < 256; ++i)
+    {
+        quint32 value = i;
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            value = (value & 1) ? (0xEDB88320u ^ (value >> 1)) : (value >> 1);
+        }
+        table[i] = value;
+    }
+
+    return table;
+}
+
+static constexpr std::array<quint32, 256> CRC32_TABLE = makeCRC32Table();
+
+quint32 LevelGaugeService::crc32(const char* data, qsizetype size, quint32 crc /* = 0 */)
+{
+    Q_ASSERT(data != nullptr || size == 0);
+
+    crc = ~crc;
+    for (qsizetype i = 0; i < size; ++i)
+    {
+        crc = CRC32_TABLE[(crc ^ static_cast<quint8>(data[i])) & 0xFFu] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+quint32 LevelGaugeService::crc32(const QByteArray& data, quint32 crc /* = 0 */)
+{
+    return crc32(data.constData(), data.size(), crc);
+}
@@ -0,0 +1,24 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Вспомогательные функции расчета контрольных сумм
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//QT
+#include <QByteArray>
+
+namespace LevelGaugeService
+{
+
+/*!
+    Рассчитывает CRC-32 (IEEE 802.3, полином 0xEDB88320) блока данных
+    @param data - данные
+    @param size - размер данных в байтах
+    @param crc - значение CRC предыдущего блока (для расчета по частям)
+    @return - значение CRC-32
+*/
+quint32 crc32(const char* data, qsizetype size, quint32 crc = 0);
+quint32 crc32(const QByteArray& data, quint32 crc = 0);
+
+} //namespace LevelGaugeService
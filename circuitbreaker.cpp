@@ -0,0 +1,141 @@
+//STL
+#include <algorithm>
+
+//QT
+#include <QRandomGenerator>
+
+//My
+#include "circuitbreaker.h"
+
+using namespace LevelGaugeService;
+
+QString CircuitBreaker::stateToString(State state)
+{
+    switch (state)
+    {
+    case State::CLOSED: return "CLOSED";
+    case State::OPEN: return "OPEN";
+    case State::HALF_OPEN: return "HALF_OPEN";
+    default:
+        Q_ASSERT(false);
+    }
+
+    return "UNDEFINED";
+}
+
+CircuitBreaker::CircuitBreaker(const Settings& settings)
+    : _settings(settings)
+{
+    Q_ASSERT(_settings.failureThreshold > 0);
+    Q_ASSERT(_settings.minBackoff > 0 && _settings.minBackoff <= _settings.maxBackoff);
+}
+
+CircuitBreaker::~CircuitBreaker()
+{
+}
+
+bool CircuitBreaker::allowRequest()
+{
+    if (!isAvailable())
+    {
+        return false;
+    }
+
+    if (_state == State::OPEN)
+    {
+        _state = State::HALF_OPEN;
+        _isProbeSended = false;
+    }
+
+    if (_state == State::HALF_OPEN)
+    {
+        _isProbeSended = true;
+    }
+
+    return true;
+}
+
+bool CircuitBreaker::isAvailable() const
+{
+    switch (_state)
+    {
+    case State::CLOSED: return true;
+    case State::OPEN: return _openTimer.elapsed() >= _backoff;
+    case State::HALF_OPEN: return !_isProbeSended;
+    default:
+        Q_ASSERT(false);
+    }
+
+    return false;
+}
+
+bool CircuitBreaker::success()
+{
+    const auto isChanged = _state != State::CLOSED;
+
+    _state = State::CLOSED;
+    _failureCount = 0;
+    _openCount = 0;
+    _isProbeSended = false;
+    _backoff = 0;
+    _openTimer.invalidate();
+
+    return isChanged;
+}
+
+bool CircuitBreaker::failure()
+{
+    ++_failureCount;
+
+    switch (_state)
+    {
+    case State::CLOSED:
+        if (_failureCount >= _settings.failureThreshold)
+        {
+            open();
+
+            return true;
+        }
+
+        return false;
+    case State::HALF_OPEN:
+        open();
+
+        return true;
+    case State::OPEN:
+        //ответ на запрос, отправленный до открытия выключателя
+        return false;
+    default:
+        Q_ASSERT(false);
+    }
+
+    return false;
+}
+
+qint64 CircuitBreaker::retryAfter() const
+{
+    switch (_state)
+    {
+    case State::CLOSED: return 0;
+    case State::OPEN: return std::max<qint64>(_backoff - _openTimer.elapsed(), 0);
+    case State::HALF_OPEN: return _isProbeSended ? _settings.minBackoff : 0;
+    default:
+        Q_ASSERT(false);
+    }
+
+    return 0;
+}
+
+void CircuitBreaker::open()
+{
+    //экспоненциальная задержка: половина фиксированная, половина случайная
+    const auto shift = std::min<quint32>(_openCount, 20);
+    const auto backoff = std::min(_settings.minBackoff << shift, _settings.maxBackoff);
+    _backoff = backoff / 2 + QRandomGenerator::global()->bounded(static_cast<int>(backoff / 2 + 1));
+
+    ++_openCount;
+
+    _state = State::OPEN;
+    _isProbeSended = false;
+    _openTimer.start();
+}
@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Автоматический выключатель (circuit breaker) запросов к удаленному серверу
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//QT
+#include <QString>
+#include <QElapsedTimer>
+
+namespace LevelGaugeService
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// В состоянии CLOSED запросы выполняются как обычно. После failureThreshold
+///     ошибок подряд выключатель переходит в состояние OPEN и запросы не
+///     выполняются в течение времени задержки. Задержка удваивается после
+///     каждого неудачного открытия (от minBackoff до maxBackoff) и содержит
+///     случайную составляющую, чтобы организации не повторяли запросы
+///     одновременно. По истечении задержки выключатель переходит в состояние
+///     HALF_OPEN и пропускает один пробный запрос: успех закрывает выключатель,
+///     ошибка снова открывает его
+///
+class CircuitBreaker final
+{
+public:
+    enum class State: quint8
+    {
+        CLOSED = 0,     ///< Запросы разрешены
+        OPEN = 1,       ///< Запросы запрещены до истечения задержки
+        HALF_OPEN = 2   ///< Разрешен один пробный запрос
+    };
+
+    struct Settings
+    {
+        quint32 failureThreshold = 3;   ///< Количество ошибок подряд для открытия выключателя
+        qint64 minBackoff = 2000;       ///< Начальная задержка, мсек
+        qint64 maxBackoff = 300000;     ///< Максимальная задержка, мсек
+    };
+
+public:
+    static QString stateToString(State state);
+
+public:
+    /*!
+        Конструктор
+        @param settings - параметры выключателя
+    */
+    explicit CircuitBreaker(const Settings& settings);
+
+    /*!
+        Деструктор
+    */
+    ~CircuitBreaker();
+
+    /*!
+        Проверяет возможность выполнения запроса. В состоянии HALF_OPEN запрос считается пробным
+        @return true если запрос может быть выполнен
+    */
+    bool allowRequest();
+
+    /*!
+        Возвращает true если запрос может быть выполнен. Состояние выключателя не изменяется
+    */
+    bool isAvailable() const;
+
+    /*!
+        Учитывает успешный запрос
+        @return true если состояние выключателя изменилось
+    */
+    bool success();
+
+    /*!
+        Учитывает неудачный запрос
+        @return true если состояние выключателя изменилось
+    */
+    bool failure();
+
+    /*!
+        Время до разрешения следующего запроса, мсек. 0 - запрос может быть выполнен сейчас
+    */
+    qint64 retryAfter() const;
+
+    State state() const { return _state; }
+    quint32 failureCount() const { return _failureCount; }
+
+private:
+    CircuitBreaker() = delete;
+    Q_DISABLE_COPY_MOVE(CircuitBreaker)
+
+    void open();
+
+private:
+    const Settings _settings;
+
+    State _state = State::CLOSED;
+    quint32 _failureCount = 0;      ///< Количество ошибок подряд
+    quint32 _openCount = 0;         ///< Количество открытий подряд без успешного запроса
+    bool _isProbeSended = false;    ///< В состоянии HALF_OPEN пробный запрос уже отправлен
+    qint64 _backoff = 0;            ///< Текущая задержка, мсек
+    QElapsedTimer _openTimer;       ///< Время с момента открытия выключателя
+
+}; //class CircuitBreaker
+
+} //namespace LevelGaugeService
@@ -0,0 +1,49 @@
+//QT
+#include <QtEndian>
+
+//My
+#include "checksum.h"
+
+#include "compression.h"
+
+using namespace LevelGaugeService;
+
+static const qsizetype QCOMPRESS_SIZE_PREFIX = 4;  ///< qCompress дописывает в начало исходный размер данных
+static const qsizetype ZLIB_HEADER_SIZE = 2;
+static const qsizetype ZLIB_TRAILER_SIZE = 4;      ///< Adler-32
+
+//ID1, ID2, CM = deflate, FLG, MTIME(4), XFL, OS = unknown
+static const char GZIP_HEADER[] = {'\x1f', '\x8b', '\x08', '\x00', '\x00', '\x00', '\x00', '\x00', '\x00', '\xff'};
+
+int CompressionLevels::level(qint64 applicantId) const
+{
+    return applicantLevels.value(applicantId, defaultLevel);
+}
+
+QByteArray LevelGaugeService::gzipCompress(const QByteArray& data, int level)
+{
+    Q_ASSERT(level >= 1 && level <= 9);
+
+    //qCompress формирует поток zlib (RFC 1950). Тело потока - это deflate (RFC 1951), которое без изменений
+    //  переносим в контейнер gzip, заменив заголовок zlib и Adler-32 на заголовок gzip, CRC-32 и размер
+    const auto zlibData = qCompress(data, level);
+    if (zlibData.size() < QCOMPRESS_SIZE_PREFIX + ZLIB_HEADER_SIZE + ZLIB_TRAILER_SIZE)
+    {
+        return {};
+    }
+
+    const auto deflateData = QByteArrayView(zlibData).sliced(QCOMPRESS_SIZE_PREFIX + ZLIB_HEADER_SIZE,
+                                                             zlibData.size() - QCOMPRESS_SIZE_PREFIX - ZLIB_HEADER_SIZE - ZLIB_TRAILER_SIZE);
+
+    const auto crc = qToLittleEndian<quint32>(crc32(data));
+    const auto size = qToLittleEndian<quint32>(static_cast<quint32>(data.size()));
+
+    QByteArray result;
+    result.reserve(sizeof(GZIP_HEADER) + deflateData.size() + sizeof(crc) + sizeof(size));
+    result.append(GZIP_HEADER, sizeof(GZIP_HEADER));
+    result.append(deflateData);
+    result.append(reinterpret_cast<const char*>(&crc), sizeof(crc));
+    result.append(reinterpret_cast<const char*>(&size), sizeof(size));
+
+    return result;
+}
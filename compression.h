@@ -0,0 +1,35 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Сжатие тела HTTP запросов
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//QT
+#include <QByteArray>
+#include <QHash>
+
+namespace LevelGaugeService
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// Уровни сжатия запросов к серверу СУНП. 0 - сжатие отключено, 1-9 - уровень
+///     сжатия gzip. Уровень может быть переопределен для отдельной организации
+///
+struct CompressionLevels
+{
+    int defaultLevel = 0;               ///< Уровень сжатия по умолчанию
+    QHash<qint64, int> applicantLevels; ///< Уровни сжатия для отдельных организаций. Ключ - ИД организации
+
+    int level(qint64 applicantId) const;
+};
+
+/*!
+    Сжимает данные в формат gzip (RFC 1952)
+    @param data - исходные данные
+    @param level - уровень сжатия 1-9
+    @return - сжатые данные или пустой массив в случае ошибки
+*/
+QByteArray gzipCompress(const QByteArray& data, int level);
+
+} //namespace LevelGaugeService
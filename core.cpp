@@ -1,4 +1,5 @@
 //QT
+#include <QCoreApplication>
 #include <QSqlQuery>
 #include <QSqlDatabase>
 #include <QSqlError>
@@ -23,19 +24,56 @@ Core::Core(QObject *parent)
 
 Core::~Core()
 {
+    stopLogBuffer();
 }
 
-bool Core::startTankConfig()
+void Core::startLogBuffer()
 {
     Q_CHECK_PTR(_loger);
+    Q_ASSERT(_logBuffer == nullptr);
+
+    _logThread = std::make_unique<QThread>();
+    _logBuffer = std::make_unique<LogBuffer>(_cnf->log_FlushInterval(), _cnf->log_MaxMessagesPerFlush(), _cnf->log_TankHistorySize());
+    _logBuffer->moveToThread(_logThread.get());
+
+    QObject::connect(_logThread.get(), SIGNAL(started()), _logBuffer.get(), SLOT(start()), Qt::QueuedConnection);
+    QObject::connect(_logBuffer.get(), SIGNAL(writeLogMsg(Common::TDBLoger::MSG_CODE, const QString&)),
+                     _loger, SLOT(sendLogMsg(Common::TDBLoger::MSG_CODE, const QString&)), Qt::QueuedConnection);
+
+    _logThread->start();
+}
+
+void Core::stopLogBuffer()
+{
+    if (!_logBuffer)
+    {
+        return;
+    }
+
+    //вызов ставится в очередь после всех ранее отправленных сообщений
+    QMetaObject::invokeMethod(_logBuffer.get(), "stop", Qt::BlockingQueuedConnection);
+
+    //передаем логеру сообщения, которые еще находятся в очереди
+    QCoreApplication::sendPostedEvents(_loger);
+
+    _logThread->quit();
+    _logThread->wait();
+
+    _logBuffer.reset(nullptr);
+    _logThread.reset(nullptr);
+}
+
+bool Core::startTankConfig()
+{
+    Q_CHECK_PTR(_logBuffer);
     Q_ASSERT(_tanksConfig == nullptr);
 
-    _tanksConfig = std::make_unique<TanksConfig>(_cnf->dbConnectionInfo());
+    _tanksConfig = std::make_unique<TanksConfig>(_cnf->dbConnectionInfo(), _cnf->sys_TanksConfigRefreshInterval());
 
     QObject::connect(_tanksConfig.get(), SIGNAL(errorOccurred(Common::EXIT_CODE, const QString&)),
                      SLOT(errorOccurredTankConfig(Common::EXIT_CODE, const QString&)));
     QObject::connect(_tanksConfig.get(), SIGNAL(sendLogMsg(Common::TDBLoger::MSG_CODE, const QString&)),
-                     _loger, SLOT(sendLogMsg(Common::TDBLoger::MSG_CODE, const QString&)));
+                     _logBuffer.get(), SLOT(sendLogMsg(Common::TDBLoger::MSG_CODE, const QString&)), Qt::QueuedConnection);
 
     return _tanksConfig->loadFromDB();
 }
@@ -49,7 +87,14 @@ bool Core::startSync()
     QObject::connect(_sync.get(), SIGNAL(errorOccurred(Common::EXIT_CODE, const QString&)),
                      SLOT(errorOccurredSync(Common::EXIT_CODE, const QString&)));
     QObject::connect(_sync.get(), SIGNAL(sendLogMsg(Common::TDBLoger::MSG_CODE, const QString&)),
-                     _loger, SLOT(sendLogMsg(Common::TDBLoger::MSG_CODE, const QString&)));
+                     _logBuffer.get(), SLOT(sendLogMsg(Common::TDBLoger::MSG_CODE, const QString&)), Qt::QueuedConnection);
+
+    //при изменении конфигурации резервуаров синхронизаторы обновляют данные только измененных резервуаров. Соединение прямое -
+    //к моменту удаления конфигураций синхронизаторы должны освободить ссылки на них
+    QObject::connect(_tanksConfig.get(), SIGNAL(tanksRemoving(const LevelGaugeService::TankIDList&)),
+                     _sync.get(), SLOT(removeTanks(const LevelGaugeService::TankIDList&)), Qt::DirectConnection);
+    QObject::connect(_tanksConfig.get(), SIGNAL(tanksAdded(const LevelGaugeService::TankIDList&)),
+                     _sync.get(), SLOT(addTanks(const LevelGaugeService::TankIDList&)), Qt::DirectConnection);
 
     _sync->start();
 
@@ -61,18 +106,28 @@ bool Core::startTanks()
     Q_CHECK_PTR(_tanksConfig);
     Q_CHECK_PTR(_sync);
 
-    _tanks = std::make_unique<Tanks>(_cnf->dbConnectionInfo(), _tanksConfig.get());
+    _tanks = std::make_unique<Tanks>(_cnf->dbConnectionInfo(), _tanksConfig.get(), _cnf->sys_CheckMeasumentsInterval());
 
     QObject::connect(_tanks.get(), SIGNAL(errorOccurred(Common::EXIT_CODE, const QString&)),
                      SLOT(errorOccurredTanks(Common::EXIT_CODE, const QString&)), Qt::QueuedConnection);
     QObject::connect(_tanks.get(), SIGNAL(sendLogMsg(Common::TDBLoger::MSG_CODE, const QString&)),
-                     _loger, SLOT(sendLogMsg(Common::TDBLoger::MSG_CODE, const QString&)), Qt::QueuedConnection);
+                     _logBuffer.get(), SLOT(sendLogMsg(Common::TDBLoger::MSG_CODE, const QString&)), Qt::QueuedConnection);
+    QObject::connect(_tanks.get(), SIGNAL(sendTankLogMsg(const LevelGaugeService::TankID&, Common::TDBLoger::MSG_CODE, const QString&)),
+                     _logBuffer.get(), SLOT(sendTankLogMsg(const LevelGaugeService::TankID&, Common::TDBLoger::MSG_CODE, const QString&)), Qt::QueuedConnection);
+    //последние сообщения резервуара сохраняются в лог до остановки сервиса из-за его ошибки
+    QObject::connect(_tanks.get(), SIGNAL(tankErrorOccurred(const LevelGaugeService::TankID&)),
+                     _logBuffer.get(), SLOT(writeTankHistory(const LevelGaugeService::TankID&)), Qt::QueuedConnection);
 
     QObject::connect(_tanks.get(), SIGNAL(calculateStatuses(const LevelGaugeService::TankID&, const TankStatusesList&)),
                      _sync.get(), SLOT(calculateStatuses(const LevelGaugeService::TankID&, const TankStatusesList&)), Qt::QueuedConnection);
     QObject::connect(_tanks.get(), SIGNAL(calculateIntakes(const LevelGaugeService::TankID&, const IntakesList&)),
                      _sync.get(), SLOT(calculateIntakes(const LevelGaugeService::TankID&, const IntakesList&)), Qt::QueuedConnection);
 
+    QObject::connect(_tanksConfig.get(), SIGNAL(tanksRemoving(const LevelGaugeService::TankIDList&)),
+                     _tanks.get(), SLOT(removeTanks(const LevelGaugeService::TankIDList&)), Qt::DirectConnection);
+    QObject::connect(_tanksConfig.get(), SIGNAL(tanksAdded(const LevelGaugeService::TankIDList&)),
+                     _tanks.get(), SLOT(addTanks(const LevelGaugeService::TankIDList&)), Qt::DirectConnection);
+
     _tanks->start();
 
     return true;
@@ -80,6 +135,8 @@ bool Core::startTanks()
 
 void Core::start()
 {
+    startLogBuffer();
+
     //загружаем конфигурацию
     if (!startTankConfig())
     {
@@ -117,6 +174,9 @@ void Core::stop()
 
     //TanksConfig
     _tanksConfig.reset(nullptr);
+
+    //сообщения модулей передаются в лог после их остановки
+    stopLogBuffer();
 }
 
 void Core::errorOccurredTankConfig(Common::EXIT_CODE errorCode, const QString &errorString)
@@ -18,6 +18,7 @@
 //My
 #include "Common/tdbloger.h"
 #include "tconfig.h"
+#include "logbuffer.h"
 #include "tanks.h"
 #include "sync.h"
 
@@ -54,6 +55,9 @@ private slots:
 private:
     Q_DISABLE_COPY_MOVE(Core)
 
+    void startLogBuffer();
+    void stopLogBuffer();
+
     bool startTankConfig();
     bool startSync();
     bool startTanks();
@@ -62,6 +66,9 @@ private:
     TConfig* _cnf = nullptr;            ///< Глобальная конфигурация
     Common::TDBLoger* _loger = nullptr; ///< Глобальны логер
 
+    std::unique_ptr<LogBuffer> _logBuffer;  ///< Буфер сообщений модулей перед передачей в глобальный логер
+    std::unique_ptr<QThread> _logThread;    ///< Поток буфера сообщений
+
     std::unique_ptr<TanksConfig> _tanksConfig;  ///< конфигурация резервуаров
     std::unique_ptr<Tanks> _tanks; ///< Список резервуаров
     std::unique_ptr<Sync> _sync;
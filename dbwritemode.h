@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Режим записи вычисленных данных в БД
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//QT
+#include <QString>
+
+namespace LevelGaugeService
+{
+
+enum class DBWriteMode: quint8
+{
+    INSERT = 0,  ///< Простая вставка. Повторная запись после частичной ошибки приводит к дублированию записей
+    MERGE = 1,   ///< Идемпотентная вставка (MERGE ... WHEN NOT MATCHED). Уже существующие записи пропускаются
+    UNDEFINE = 255
+};
+
+inline DBWriteMode stringToDBWriteMode(const QString& mode)
+{
+    const auto modeStr = mode.trimmed().toUpper();
+    if (modeStr == "INSERT")
+    {
+        return DBWriteMode::INSERT;
+    }
+    if (modeStr == "MERGE")
+    {
+        return DBWriteMode::MERGE;
+    }
+
+    return DBWriteMode::UNDEFINE;
+}
+
+inline QString dbWriteModeToString(DBWriteMode mode)
+{
+    switch (mode)
+    {
+    case DBWriteMode::INSERT: return "INSERT";
+    case DBWriteMode::MERGE: return "MERGE";
+    case DBWriteMode::UNDEFINE:
+    default:
+        break;
+    }
+
+    return "UNDEFINE";
+}
+
+} //namespace LevelGaugeService
@@ -0,0 +1,83 @@
+//STL
+#include <algorithm>
+
+//My
+#include "flushpolicy.h"
+
+using namespace LevelGaugeService;
+
+static const qint64 MAX_CHECK_INTERVAL = 1000; ///< мсек
+
+FlushPolicy::FlushPolicy(const Limits& limits)
+    : _limits(limits)
+{
+    Q_ASSERT(_limits.maxRows > 0);
+    Q_ASSERT(_limits.maxBytes > 0);
+    Q_ASSERT(_limits.maxAge > 0);
+}
+
+FlushPolicy::~FlushPolicy()
+{
+}
+
+void FlushPolicy::append(qsizetype rows, qsizetype bytes)
+{
+    if (rows <= 0)
+    {
+        return;
+    }
+
+    if (_rows == 0)
+    {
+        _oldestTimer.start();
+    }
+
+    _rows += rows;
+    _bytes += bytes;
+}
+
+void FlushPolicy::reset()
+{
+    _rows = 0;
+    _bytes = 0;
+    _oldestTimer.invalidate();
+}
+
+bool FlushPolicy::needFlush() const
+{
+    if (_rows == 0)
+    {
+        return false;
+    }
+
+    return isFull() || _oldestTimer.elapsed() >= _limits.maxAge;
+}
+
+bool FlushPolicy::isFull() const
+{
+    return _rows >= _limits.maxRows || _bytes >= _limits.maxBytes;
+}
+
+QString FlushPolicy::reason() const
+{
+    if (_rows >= _limits.maxRows)
+    {
+        return QString("row limit %1 reached").arg(_limits.maxRows);
+    }
+    if (_bytes >= _limits.maxBytes)
+    {
+        return QString("size limit %1 bytes reached").arg(_limits.maxBytes);
+    }
+    if (_rows != 0 && _oldestTimer.elapsed() >= _limits.maxAge)
+    {
+        return QString("age limit %1 ms reached").arg(_limits.maxAge);
+    }
+
+    return "forced";
+}
+
+qint64 FlushPolicy::checkInterval() const
+{
+    //проверяем возраст с точностью не хуже четверти допустимого возраста
+    return std::clamp<qint64>(_limits.maxAge / 4, 1, MAX_CHECK_INTERVAL);
+}
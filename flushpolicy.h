@@ -0,0 +1,93 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Политика сброса буфера записей в БД
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//QT
+#include <QString>
+#include <QElapsedTimer>
+
+namespace LevelGaugeService
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// Определяет момент сохранения накопленных записей в БД. Сохранение требуется
+///     при достижении любого из порогов: количества записей, объема данных
+///     или возраста самой старой записи в буфере. Пустой буфер никогда не
+///     требует сохранения
+///
+class FlushPolicy final
+{
+public:
+    struct Limits
+    {
+        qsizetype maxRows = 0;  ///< Максимальное количество записей в буфере
+        qsizetype maxBytes = 0; ///< Максимальный объем данных в буфере, байт
+        qint64 maxAge = 0;      ///< Максимальный возраст самой старой записи в буфере, мсек
+    };
+
+public:
+    /*!
+        Конструктор
+        @param limits - пороги сохранения буфера
+    */
+    explicit FlushPolicy(const Limits& limits);
+
+    /*!
+        Деструктор
+    */
+    ~FlushPolicy();
+
+    /*!
+        Учитывает добавленные в буфер записи
+        @param rows - количество записей
+        @param bytes - объем данных записей, байт
+    */
+    void append(qsizetype rows, qsizetype bytes);
+
+    /*!
+        Сбрасывает счетчики после сохранения буфера
+    */
+    void reset();
+
+    /*!
+        Возвращает true если буфер необходимо сохранить
+    */
+    bool needFlush() const;
+
+    /*!
+        Возвращает true если достигнут порог по количеству записей или объему данных.
+            Используется для немедленного сохранения при всплеске данных
+    */
+    bool isFull() const;
+
+    /*!
+        Описание причины сохранения для журнала
+    */
+    QString reason() const;
+
+    /*!
+        Интервал проверки возраста буфера, мсек
+    */
+    qint64 checkInterval() const;
+
+    const Limits& limits() const { return _limits; }
+    qsizetype rows() const { return _rows; }
+    qsizetype bytes() const { return _bytes; }
+
+private:
+    FlushPolicy() = delete;
+    Q_DISABLE_COPY_MOVE(FlushPolicy)
+
+private:
+    const Limits _limits;
+
+    qsizetype _rows = 0;        ///< Текущее количество записей в буфере
+    qsizetype _bytes = 0;       ///< Текущий объем данных в буфере
+    QElapsedTimer _oldestTimer; ///< Время с момента добавления самой старой записи
+
+}; //class FlushPolicy
+
+} //namespace LevelGaugeService
@@ -0,0 +1,339 @@
+//STL
+#include <algorithm>
+
+//My
+#include "httpclientpool.h"
+
+using namespace LevelGaugeService;
+using namespace Common;
+
+static const QString POOL_NAME = "HTTPClientPool";
+
+static const int STATS_INTERVAL = 60 * 10 * 1000;          ///< Интервал сохранения статистики в лог, мсек
+static const qsizetype MAX_LATENCY_SAMPLES = 10000;        ///< Максимальное количество хранимых времен выполнения запросов
+static const qint64 DEADLINES_TICK_INTERVAL = 1000;         ///< Шаг проверки сроков выполнения запросов, мсек
+static const quint32 DEADLINES_SLOTS_COUNT = 512;           ///< Количество ячеек колеса сроков выполнения запросов
+static const qint64 CANCELLED_KEEP_TIME = 60 * 10 * 1000;   ///< Время хранения ИД отмененного запроса в ожидании позднего ответа, мсек
+
+static qint64 percentile(const std::vector<qint64>& sortedValues, int percent)
+{
+    Q_ASSERT(!sortedValues.empty());
+    Q_ASSERT(percent >= 0 && percent <= 100);
+
+    return sortedValues[(sortedValues.size() - 1) * percent / 100];
+}
+
+QString HTTPClientPool::Stats::toString() const
+{
+    return QString("Requests: %1. Errors: %2. Clients: %3. Users: %4. Saved clients: %5. Latency (ms) p50: %6 p90: %7 p99: %8 max: %9. "
+                   "Timeouts: %10. In flight: %11. In flight max age (ms): %12")
+        .arg(requestsCount)
+        .arg(errorsCount)
+        .arg(clientsCount)
+        .arg(usersCount)
+        .arg(savedClients)
+        .arg(latencyP50)
+        .arg(latencyP90)
+        .arg(latencyP99)
+        .arg(latencyMax)
+        .arg(timeoutsCount)
+        .arg(inFlightCount)
+        .arg(inFlightMaxAge);
+}
+
+qint64 HTTPClientPool::RequestTimeouts::timeout(const QString& path) const
+{
+    return pathTimeouts.value(path, defaultTimeout);
+}
+
+HTTPClientPool::HTTPClientPool(const RequestTimeouts& requestTimeouts, QObject *parent /* = nullptr */)
+    : QObject{parent}
+    , _requestTimeouts(requestTimeouts)
+    , _deadlines(DEADLINES_TICK_INTERVAL, DEADLINES_SLOTS_COUNT)
+{
+    Q_ASSERT(_requestTimeouts.defaultTimeout > 0);
+
+    _latencies.reserve(MAX_LATENCY_SAMPLES);
+
+    QObject::connect(&_statsTimer, SIGNAL(timeout()), SLOT(saveStats()));
+    QObject::connect(&_deadlinesTimer, SIGNAL(timeout()), SLOT(checkDeadlines()));
+
+    _statsTimer.start(STATS_INTERVAL);
+    _deadlinesTimer.start(DEADLINES_TICK_INTERVAL);
+}
+
+HTTPClientPool::~HTTPClientPool()
+{
+    _deadlinesTimer.stop();
+    _statsTimer.stop();
+
+    _retiredClients.clear();
+}
+
+QString HTTPClientPool::clientKey(const QUrl& url)
+{
+    Q_ASSERT(url.isValid());
+
+    return QString("%1://%2:%3").arg(url.scheme(), url.host().toLower()).arg(url.port(url.scheme() == "http" ? 80 : 443));
+}
+
+HTTPClientPool::Client& HTTPClientPool::client(const QUrl& url)
+{
+    auto& client = _clients[clientKey(url)];
+    if (!client.query)
+    {
+        client.query = std::make_unique<HTTPSSLQuery>(HTTPSSLQuery::ProxyList());
+
+        QObject::connect(client.query.get(), SIGNAL(getAnswer(const QByteArray&, quint64)), SLOT(getAnswerHTTP(const QByteArray&, quint64)));
+        QObject::connect(client.query.get(), SIGNAL(errorOccurred(QNetworkReply::NetworkError, quint64, const QString&, quint64)),
+                                             SLOT(errorOccurredHTTP(QNetworkReply::NetworkError, quint64, const QString&, quint64)));
+        QObject::connect(client.query.get(), SIGNAL(sendLogMsg(Common::TDBLoger::MSG_CODE, const QString&, quint64)),
+                                             SLOT(sendLogMsgHTTP(Common::TDBLoger::MSG_CODE, const QString&, quint64)));
+
+        emit sendLogMsg(POOL_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("HTTP client created. Server: %1").arg(clientKey(url)));
+    }
+
+    return client;
+}
+
+void HTTPClientPool::attach(const QUrl& baseUrl)
+{
+    auto& client = this->client(baseUrl);
+
+    ++client.usersCount;
+    ++client.totalUsersCount;
+}
+
+void HTTPClientPool::detach(const QUrl& baseUrl)
+{
+    const auto clients_it = _clients.find(clientKey(baseUrl));
+
+    Q_ASSERT(clients_it != _clients.end());
+    Q_ASSERT(clients_it->second.usersCount > 0);
+
+    --clients_it->second.usersCount;
+}
+
+quint64 HTTPClientPool::send(const QUrl& url, HTTPSSLQuery::RequestType type, const QByteArray& data, const HTTPSSLQuery::Headers& headers)
+{
+    auto& client = this->client(url);
+
+    const auto id = client.query->send(url, type, data, headers);
+
+    client.requests.insert(id);
+
+    auto& request = _requests[id];
+    request.sendTimer.start();
+    request.path = url.path();
+    request.clientKey = clientKey(url);
+    request.query = client.query.get();
+
+    _deadlines.add(id, _requestTimeouts.timeout(request.path));
+
+    return id;
+}
+
+bool HTTPClientPool::requestFinished(quint64 id, bool success)
+{
+    if (_cancelledRequests.remove(id))
+    {
+        _deadlines.remove(id);
+
+        return false;
+    }
+
+    const auto requests_it = _requests.constFind(id);
+    if (requests_it == _requests.end())
+    {
+        return true;
+    }
+
+    const auto latency = requests_it.value().sendTimer.elapsed();
+    releaseRequest(requests_it.value(), id);
+    _requests.erase(requests_it);
+    _deadlines.remove(id);
+
+    //при переполнении буфера перезаписываем самые старые значения
+    if (static_cast<qsizetype>(_latencies.size()) < MAX_LATENCY_SAMPLES)
+    {
+        _latencies.push_back(latency);
+    }
+    else
+    {
+        _latencies[_nextLatency] = latency;
+        _nextLatency = (_nextLatency + 1) % MAX_LATENCY_SAMPLES;
+    }
+
+    ++_requestsCount;
+    if (!success)
+    {
+        ++_errorsCount;
+    }
+
+    return true;
+}
+
+void HTTPClientPool::releaseRequest(const Request& request, quint64 id)
+{
+    const auto clients_it = _clients.find(request.clientKey);
+    if (clients_it != _clients.end() && clients_it->second.query.get() == request.query)
+    {
+        clients_it->second.requests.remove(id);
+
+        return;
+    }
+
+    for (auto retiredClients_it = _retiredClients.begin(); retiredClients_it != _retiredClients.end(); ++retiredClients_it)
+    {
+        if (retiredClients_it->query.get() != request.query)
+        {
+            continue;
+        }
+
+        retiredClients_it->requests.remove(id);
+
+        //удаление клиента прерывает его зависшие запросы и закрывает их соединения.
+        //Клиент может быть источником текущего сигнала, поэтому удаляется отложенно
+        if (retiredClients_it->requests.isEmpty())
+        {
+            retiredClients_it->query.release()->deleteLater();
+            _retiredClients.erase(retiredClients_it);
+        }
+
+        return;
+    }
+}
+
+void HTTPClientPool::abortRequest(const Request& request)
+{
+    const auto clients_it = _clients.find(request.clientKey);
+    if (clients_it == _clients.end() || clients_it->second.query.get() != request.query)
+    {
+        //клиент уже выведен из работы из-за другого зависшего запроса
+        return;
+    }
+
+    //новые запросы к серверу пойдут через новый клиент, а текущий будет удален вместе с зависшим запросом
+    //после завершения остальных его запросов
+    auto& client = clients_it->second;
+
+    Client retiredClient;
+    retiredClient.query = std::move(client.query);
+    retiredClient.requests = std::move(client.requests);
+    client.requests.clear();
+
+    _retiredClients.push_back(std::move(retiredClient));
+
+    emit sendLogMsg(POOL_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("HTTP client retired after request timeout. Server: %1. Requests in flight: %2")
+                        .arg(request.clientKey)
+                        .arg(_retiredClients.back().requests.size() - 1));
+}
+
+HTTPClientPool::Stats HTTPClientPool::takeStats()
+{
+    Stats stats;
+    stats.requestsCount = _requestsCount;
+    stats.errorsCount = _errorsCount;
+    stats.clientsCount = _clients.size();
+    stats.timeoutsCount = _timeoutsCount;
+    stats.inFlightCount = _requests.size();
+
+    for (const auto& request: _requests)
+    {
+        stats.inFlightMaxAge = std::max(stats.inFlightMaxAge, request.sendTimer.elapsed());
+    }
+
+    for (const auto& [key, client]: _clients)
+    {
+        stats.usersCount += client.usersCount;
+
+        //каждый пользователь кроме первого без пула создал бы свой клиент и свои соединения
+        stats.savedClients += client.totalUsersCount > 0 ? client.totalUsersCount - 1 : 0;
+    }
+
+    if (!_latencies.empty())
+    {
+        std::sort(_latencies.begin(), _latencies.end());
+
+        stats.latencyP50 = percentile(_latencies, 50);
+        stats.latencyP90 = percentile(_latencies, 90);
+        stats.latencyP99 = percentile(_latencies, 99);
+        stats.latencyMax = _latencies.back();
+    }
+
+    _latencies.clear();
+    _nextLatency = 0;
+    _requestsCount = 0;
+    _errorsCount = 0;
+    _timeoutsCount = 0;
+
+    return stats;
+}
+
+void HTTPClientPool::saveStats()
+{
+    if (_requestsCount == 0 && _requests.isEmpty())
+    {
+        return;
+    }
+
+    emit sendLogMsg(POOL_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("HTTP client pool statistic. %1").arg(takeStats().toString()));
+}
+
+void HTTPClientPool::checkDeadlines()
+{
+    for (const auto id: _deadlines.advance())
+    {
+        //срок хранения ИД отмененного запроса истек - поздний ответ уже не ожидается
+        if (_cancelledRequests.remove(id))
+        {
+            continue;
+        }
+
+        const auto requests_it = _requests.constFind(id);
+        if (requests_it == _requests.end())
+        {
+            continue;
+        }
+
+        const auto age = requests_it.value().sendTimer.elapsed();
+        const auto path = requests_it.value().path;
+
+        abortRequest(requests_it.value());
+        requestFinished(id, false);
+        ++_timeoutsCount;
+
+        //поздний ответ на отмененный запрос, если клиент еще не удален, будет отброшен
+        _cancelledRequests.insert(id);
+        _deadlines.add(id, CANCELLED_KEEP_TIME);
+
+        emit errorOccurred(QNetworkReply::TimeoutError, 0, QString("Request timeout expired after %1 ms. Request cancelled. Path: %2").arg(age).arg(path), id);
+    }
+}
+
+void HTTPClientPool::getAnswerHTTP(const QByteArray &answer, quint64 id)
+{
+    if (!requestFinished(id, true))
+    {
+        emit sendLogMsg(POOL_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("Answer received after request timeout expired. Answer skipped. Request ID: %1").arg(id));
+
+        return;
+    }
+
+    emit getAnswer(answer, id);
+}
+
+void HTTPClientPool::errorOccurredHTTP(QNetworkReply::NetworkError code, quint64 serverCode, const QString& msg, quint64 id)
+{
+    if (!requestFinished(id, false))
+    {
+        return;
+    }
+
+    emit errorOccurred(code, serverCode, msg, id);
+}
+
+void HTTPClientPool::sendLogMsgHTTP(Common::TDBLoger::MSG_CODE category, const QString &msg, quint64 id)
+{
+    emit sendLogMsgRequest(category, msg, id);
+}
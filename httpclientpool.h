@@ -0,0 +1,215 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Общий пул HTTP клиентов для обмена с серверами организаций
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//STL
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+//Qt
+#include <QObject>
+#include <QUrl>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QElapsedTimer>
+
+//My
+#include "Common/httpsslquery.h"
+#include "Common/tdbloger.h"
+
+#include "timerwheel.h"
+
+namespace LevelGaugeService
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// Для каждого сервера (схема + хост + порт) создается один HTTP клиент,
+///     который используют все организации обоих синхронизаторов. Поэтому
+///     соединения с сервером (и TLS сессии) переиспользуются между
+///     организациями, а запросы разных организаций мультиплексируются в
+///     одних и тех же соединениях. Ответы рассылаются всем подписчикам,
+///     каждый из которых обрабатывает только свои запросы по ИД.
+///     Пул периодически сохраняет в лог статистику: количество запросов,
+///     количество сэкономленных клиентов (и их установок соединений) и
+///     перцентили времени выполнения запросов.
+///     Для каждого запроса задается срок выполнения, зависящий от метода API.
+///     Запрос, не завершенный в срок, завершается ошибкой TimeoutError, а
+///     поздний ответ на него отбрасывается, поэтому зависшее соединение не
+///     блокирует окна запросов синхронизаторов. Клиент с зависшим запросом
+///     выводится из работы: новые запросы сервера идут через новый клиент, а
+///     старый удаляется после завершения остальных его запросов, что прерывает
+///     зависший запрос и закрывает его соединение
+///
+class HTTPClientPool final
+    : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stats
+    {
+        quint64 requestsCount = 0;   ///< Количество завершенных запросов
+        quint64 errorsCount = 0;     ///< Количество запросов завершенных ошибкой
+        quint64 clientsCount = 0;    ///< Количество HTTP клиентов (серверов)
+        quint64 usersCount = 0;      ///< Количество пользователей клиентов
+        quint64 savedClients = 0;    ///< Количество клиентов (и установок соединений), которые не пришлось создавать
+        qint64 latencyP50 = 0;       ///< Медиана времени выполнения запроса, мсек
+        qint64 latencyP90 = 0;       ///< 90-й перцентиль времени выполнения запроса, мсек
+        qint64 latencyP99 = 0;       ///< 99-й перцентиль времени выполнения запроса, мсек
+        qint64 latencyMax = 0;       ///< Максимальное время выполнения запроса, мсек
+        quint64 timeoutsCount = 0;   ///< Количество запросов, отмененных по истечении срока
+        quint64 inFlightCount = 0;   ///< Количество выполняемых запросов
+        qint64 inFlightMaxAge = 0;   ///< Время выполнения самого старого выполняемого запроса, мсек
+
+        QString toString() const;
+    };
+
+    struct RequestTimeouts
+    {
+        qint64 defaultTimeout = 120000;       ///< Срок выполнения запроса, мсек
+        QHash<QString, qint64> pathTimeouts;  ///< Сроки выполнения запросов к отдельным методам API. Ключ - путь метода
+
+        qint64 timeout(const QString& path) const;
+    };
+
+public:
+    /*!
+        Конструктор
+        @param requestTimeouts - сроки выполнения запросов
+        @param parent - указатель на родительский класс
+    */
+    explicit HTTPClientPool(const RequestTimeouts& requestTimeouts, QObject* parent = nullptr);
+
+    /*!
+        Деструктор
+    */
+    ~HTTPClientPool();
+
+    /*!
+        Регистрирует пользователя сервера. Клиент для сервера создается при первом обращении
+        @param baseUrl - адрес сервера
+    */
+    void attach(const QUrl& baseUrl);
+
+    /*!
+        Отменяет регистрацию пользователя сервера. Клиент сохраняется для повторного использования соединений
+        @param baseUrl - адрес сервера
+    */
+    void detach(const QUrl& baseUrl);
+
+    /*!
+        Отправляет запрос через клиент сервера. Результат возвращается сигналами getAnswer(...) или errorOccurred(...).
+            Если результат не получен в срок - испускается errorOccurred(...) с кодом QNetworkReply::TimeoutError
+        @param url - адрес запроса
+        @param type - тип запроса
+        @param data - тело запроса
+        @param headers - заголовки запроса
+        @return - ИД запроса
+    */
+    quint64 send(const QUrl& url, Common::HTTPSSLQuery::RequestType type, const QByteArray& data,
+                 const Common::HTTPSSLQuery::Headers& headers);
+
+    /*!
+        Возвращает статистику с момента предыдущего вызова и сбрасывает накопленные времена выполнения запросов
+    */
+    Stats takeStats();
+
+signals:
+    void getAnswer(const QByteArray& answer, quint64 id);
+    void errorOccurred(QNetworkReply::NetworkError code, quint64 serverCode, const QString& msg, quint64 id);
+    void sendLogMsgRequest(Common::TDBLoger::MSG_CODE category, const QString& msg, quint64 id);
+
+    /*!
+        Сигнал испускатся при необходимости сохранить сообщения пула в лог
+        @param name - символьное название пула
+        @param category - тип сохраняемого сообщения (DBG, INFO, WAR....)
+        @param msg - текст сообщения
+    */
+    void sendLogMsg(const QString& name, Common::TDBLoger::MSG_CODE category, const QString& msg);
+
+private slots:
+    void getAnswerHTTP(const QByteArray& answer, quint64 id);
+    void errorOccurredHTTP(QNetworkReply::NetworkError code, quint64 serverCode, const QString& msg, quint64 id);
+    void sendLogMsgHTTP(Common::TDBLoger::MSG_CODE category, const QString& msg, quint64 id);
+
+    void saveStats();
+    void checkDeadlines();
+
+private:
+    struct Client
+    {
+        std::unique_ptr<Common::HTTPSSLQuery> query;
+        quint64 usersCount = 0;     ///< Количество зарегистрированных пользователей
+        quint64 totalUsersCount = 0; ///< Количество пользователей за все время работы
+        QSet<quint64> requests;     ///< Выполняемые запросы клиента
+    };
+
+    struct Request
+    {
+        QElapsedTimer sendTimer;    ///< Время с момента отправки запроса
+        QString path;               ///< Путь метода API
+        QString clientKey;          ///< Ключ клиента сервера
+        Common::HTTPSSLQuery* query = nullptr; ///< Клиент, выполняющий запрос
+    };
+
+private:
+    Q_DISABLE_COPY_MOVE(HTTPClientPool)
+
+    /*!
+        Ключ клиента: схема, хост и порт сервера
+    */
+    static QString clientKey(const QUrl& url);
+
+    /*!
+        Возвращает клиент сервера. Если клиента нет - он создается
+    */
+    Client& client(const QUrl& url);
+
+    /*!
+        Учитывает завершение запроса в статистике
+        @param id - ИД запроса
+        @param success - true если получен ответ
+        @return false если запрос ранее был отменен по истечении срока и результат необходимо отбросить
+    */
+    bool requestFinished(quint64 id, bool success);
+
+    /*!
+        Исключает запрос из выполняемых запросов его клиента. Выведенный из работы клиент удаляется после завершения всех его запросов
+        @param request - запрос
+        @param id - ИД запроса
+    */
+    void releaseRequest(const Request& request, quint64 id);
+
+    /*!
+        Выводит из работы клиент зависшего запроса
+        @param request - запрос
+    */
+    void abortRequest(const Request& request);
+
+private:
+    std::unordered_map<QString, Client> _clients;
+    std::vector<Client> _retiredClients; ///< Клиенты с зависшими запросами, ожидающие завершения остальных запросов
+
+    const RequestTimeouts _requestTimeouts;
+
+    QHash<quint64, Request> _requests;   ///< Запросы, на которые еще не получен ответ
+    QSet<quint64> _cancelledRequests;    ///< Запросы, отмененные по истечении срока, поздний ответ на которые еще не получен
+    LevelGaugeService::TimerWheel _deadlines; ///< Сроки выполнения запросов и сроки хранения ИД отмененных запросов
+    QTimer _deadlinesTimer;
+
+    std::vector<qint64> _latencies;   ///< Время выполнения завершенных запросов с момента предыдущей статистики, мсек
+    qsizetype _nextLatency = 0;       ///< Позиция для записи при заполненном буфере _latencies
+    quint64 _requestsCount = 0;
+    quint64 _errorsCount = 0;
+    quint64 _timeoutsCount = 0;
+
+    QTimer _statsTimer;
+
+}; //class HTTPClientPool
+
+} //namespace LevelGaugeService
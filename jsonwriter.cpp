@@ -0,0 +1,214 @@
+//STL
+#include <charconv>
+#include <cmath>
+
+//My
+#include "jsonwriter.h"
+
+using namespace LevelGaugeService;
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+static char* writeDigits(char* pos, int value, int width)
+{
+    for (int i = width - 1; i >= 0; --i)
+    {
+        pos[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+
+    return pos + width;
+}
+
+JSONWriter::JSONWriter(qsizetype reserveSize /* = 0 */)
+{
+    _buffer.reserve(reserveSize);
+    _isFirst.reserve(8);
+}
+
+JSONWriter::~JSONWriter()
+{
+}
+
+void JSONWriter::beginObject(QByteArrayView key /* = {} */)
+{
+    writeKey(key);
+    _buffer.append('{');
+    _isFirst.push_back(true);
+}
+
+void JSONWriter::endObject()
+{
+    Q_ASSERT(!_isFirst.empty());
+
+    _isFirst.pop_back();
+    _buffer.append('}');
+}
+
+void JSONWriter::beginArray(QByteArrayView key /* = {} */)
+{
+    writeKey(key);
+    _buffer.append('[');
+    _isFirst.push_back(true);
+}
+
+void JSONWriter::endArray()
+{
+    Q_ASSERT(!_isFirst.empty());
+
+    _isFirst.pop_back();
+    _buffer.append(']');
+}
+
+void JSONWriter::writeString(QByteArrayView key, QByteArrayView value)
+{
+    writeKey(key);
+    _buffer.append('"');
+    writeEscaped(value);
+    _buffer.append('"');
+}
+
+void JSONWriter::writeNumber(QByteArrayView key, qint64 value)
+{
+    writeKey(key);
+
+    char buf[24];
+    const auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    Q_ASSERT(result.ec == std::errc());
+
+    _buffer.append(buf, result.ptr - buf);
+}
+
+void JSONWriter::writeNumber(QByteArrayView key, float value)
+{
+    writeKey(key);
+
+    //как и QJsonDocument, нечисловые значения записываем как null
+    if (!std::isfinite(value))
+    {
+        _buffer.append("null");
+
+        return;
+    }
+
+    //кратчайшее представление, однозначно восстанавливающее значение float
+    char buf[32];
+    const auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    Q_ASSERT(result.ec == std::errc());
+
+    _buffer.append(buf, result.ptr - buf);
+}
+
+void JSONWriter::writeDateTime(QByteArrayView key, const QDateTime& value)
+{
+    writeKey(key);
+
+    int year = 0;
+    int month = 0;
+    int day = 0;
+    value.date().getDate(&year, &month, &day);
+    const auto time = value.time();
+
+    //"yyyy-MM-ddThh:mm:ss.zzzZ"
+    char buf[26];
+    char* pos = buf;
+    *pos++ = '"';
+    pos = writeDigits(pos, year, 4);
+    *pos++ = '-';
+    pos = writeDigits(pos, month, 2);
+    *pos++ = '-';
+    pos = writeDigits(pos, day, 2);
+    *pos++ = 'T';
+    pos = writeDigits(pos, time.hour(), 2);
+    *pos++ = ':';
+    pos = writeDigits(pos, time.minute(), 2);
+    *pos++ = ':';
+    pos = writeDigits(pos, time.second(), 2);
+    *pos++ = '.';
+    pos = writeDigits(pos, time.msec(), 3);
+    *pos++ = 'Z';
+    *pos++ = '"';
+
+    _buffer.append(buf, pos - buf);
+}
+
+void JSONWriter::writeUuid(QByteArrayView key, const QUuid& value)
+{
+    writeKey(key);
+    _buffer.append('"');
+    _buffer.append(value.toByteArray(QUuid::WithoutBraces));
+    _buffer.append('"');
+}
+
+QByteArray JSONWriter::take()
+{
+    Q_ASSERT(_isFirst.empty());
+
+    return std::move(_buffer);
+}
+
+const QByteArray& JSONWriter::data() const
+{
+    return _buffer;
+}
+
+void JSONWriter::writeKey(QByteArrayView key)
+{
+    if (_isFirst.empty())
+    {
+        Q_ASSERT(key.isEmpty());
+
+        return;
+    }
+
+    if (!_isFirst.back())
+    {
+        _buffer.append(',');
+    }
+    _isFirst.back() = false;
+
+    if (!key.isEmpty())
+    {
+        _buffer.append('"');
+        _buffer.append(key);
+        _buffer.append("\":", 2);
+    }
+}
+
+void JSONWriter::writeEscaped(QByteArrayView value)
+{
+    const char* data = value.data();
+    const auto size = value.size();
+
+    //участки без спецсимволов копируем целиком
+    qsizetype start = 0;
+    for (qsizetype i = 0; i < size; ++i)
+    {
+        const auto ch = static_cast<quint8>(data[i]);
+        if (ch >= 0x20 && ch != '"' && ch != '\\')
+        {
+            continue;
+        }
+
+        _buffer.append(data + start, i - start);
+        start = i + 1;
+
+        switch (ch)
+        {
+        case '"': _buffer.append("\\\"", 2); break;
+        case '\\': _buffer.append("\\\\", 2); break;
+        case '\b': _buffer.append("\\b", 2); break;
+        case '\f': _buffer.append("\\f", 2); break;
+        case '\n': _buffer.append("\\n", 2); break;
+        case '\r': _buffer.append("\\r", 2); break;
+        case '\t': _buffer.append("\\t", 2); break;
+        default:
+        {
+            const char escaped[] = {'\\', 'u', '0', '0', HEX_DIGITS[ch >> 4], HEX_DIGITS[ch & 0x0F]};
+            _buffer.append(escaped, sizeof(escaped));
+        }
+        }
+    }
+
+    _buffer.append(data + start, size - start);
+}
@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Потоковая запись JSON документа в буфер
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//STL
+#include <vector>
+
+//QT
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QDateTime>
+#include <QUuid>
+
+namespace LevelGaugeService
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// Формирует компактный JSON документ дописыванием в заранее зарезервированный
+///     буфер, без построения промежуточного дерева QJsonObject/QJsonArray.
+///     Имена ключей должны состоять из ASCII символов и не требовать экранирования.
+///     Ключ передается только для элементов объекта, для элементов массива - пустой
+///
+class JSONWriter final
+{
+public:
+    /*!
+        Конструктор
+        @param reserveSize - ожидаемый размер документа в байтах
+    */
+    explicit JSONWriter(qsizetype reserveSize = 0);
+
+    /*!
+        Деструктор
+    */
+    ~JSONWriter();
+
+    void beginObject(QByteArrayView key = {});
+    void endObject();
+    void beginArray(QByteArrayView key = {});
+    void endArray();
+
+    /*!
+        Записывает строковое значение
+        @param key - имя ключа
+        @param value - значение в кодировке UTF-8. Экранируется при записи
+    */
+    void writeString(QByteArrayView key, QByteArrayView value);
+    void writeNumber(QByteArrayView key, qint64 value);
+    void writeNumber(QByteArrayView key, float value);
+
+    /*!
+        Записывает дату и время в формате yyyy-MM-ddThh:mm:ss.zzzZ
+    */
+    void writeDateTime(QByteArrayView key, const QDateTime& value);
+    void writeUuid(QByteArrayView key, const QUuid& value);
+
+    /*!
+        Возвращает сформированный документ. После вызова писатель пуст
+    */
+    QByteArray take();
+
+    const QByteArray& data() const;
+
+private:
+    Q_DISABLE_COPY_MOVE(JSONWriter)
+
+    void writeKey(QByteArrayView key);
+    void writeEscaped(QByteArrayView value);
+
+private:
+    QByteArray _buffer;
+    std::vector<bool> _isFirst;  ///< Стек вложенности. true - в текущем объекте/массиве еще нет элементов
+
+}; //class JSONWriter
+
+} //namespace LevelGaugeService
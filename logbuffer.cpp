@@ -0,0 +1,193 @@
+//Qt
+#include <QMutexLocker>
+
+//My
+#include "Common/common.h"
+#include "logbuffer.h"
+
+using namespace LevelGaugeService;
+using namespace Common;
+
+LogBuffer::LogBuffer(qint64 flushInterval, quint32 maxMessagesPerFlush, quint32 tankHistorySize, QObject* parent /* = nullptr */)
+    : QObject{parent}
+    , _flushInterval(flushInterval)
+    , _maxMessagesPerFlush(maxMessagesPerFlush)
+    , _tankHistorySize(tankHistorySize)
+{
+    Q_ASSERT(_flushInterval > 0);
+    Q_ASSERT(_maxMessagesPerFlush > 0);
+
+    _entries.reserve(_maxMessagesPerFlush);
+    _entriesIndex.reserve(_maxMessagesPerFlush);
+}
+
+LogBuffer::~LogBuffer()
+{
+    Q_ASSERT(_flushTimer == nullptr);
+}
+
+void LogBuffer::start()
+{
+    Q_ASSERT(_flushTimer == nullptr);
+
+    _flushTimer = new QTimer();
+
+    QObject::connect(_flushTimer, SIGNAL(timeout()), SLOT(flush()));
+
+    _flushTimer->start(_flushInterval);
+}
+
+void LogBuffer::stop()
+{
+    if (_flushTimer == nullptr)
+    {
+        return;
+    }
+
+    delete _flushTimer;
+    _flushTimer = nullptr;
+
+    flush();
+}
+
+void LogBuffer::sendLogMsg(TDBLoger::MSG_CODE category, const QString& msg)
+{
+    addEntry(TankID{}, category, msg);
+}
+
+void LogBuffer::sendTankLogMsg(const TankID& id, TDBLoger::MSG_CODE category, const QString& msg)
+{
+    addTankHistory(id, category, msg);
+    addEntry(id, category, msg);
+}
+
+void LogBuffer::writeTankHistory(const TankID& id)
+{
+    const auto history = tankHistory(id);
+    if (history.isEmpty())
+    {
+        return;
+    }
+
+    QStringList lines;
+    lines.reserve(history.size());
+    for (const auto& message: history)
+    {
+        lines.push_back(QString("%1 %2").arg(message.dateTime.toString(DATETIME_FORMAT)).arg(message.msg));
+    }
+
+    //история передается сразу после накопленных сообщений, чтобы в логе она шла после них
+    flush();
+
+    emit writeLogMsg(TDBLoger::MSG_CODE::WARNING_CODE, tankMsg(id, QString("Last messages: %1\n%2").arg(history.size()).arg(lines.join('\n'))));
+}
+
+LogBuffer::MessagesList LogBuffer::tankHistory(const TankID& id) const
+{
+    QMutexLocker<QMutex> locker(&_tankHistoryMutex);
+
+    const auto tankHistory_it = _tankHistory.constFind(id);
+    if (tankHistory_it == _tankHistory.end())
+    {
+        return {};
+    }
+
+    const auto& history = tankHistory_it.value();
+
+    MessagesList result;
+    result.reserve(static_cast<qsizetype>(history.messages.size()));
+
+    //в заполненном буфере самое старое сообщение находится в позиции следующего
+    if (history.isFull)
+    {
+        result.append(history.messages.begin() + history.next, history.messages.end());
+    }
+    result.append(history.messages.begin(), history.messages.begin() + history.next);
+
+    return result;
+}
+
+void LogBuffer::flush()
+{
+    for (const auto& entry: _entries)
+    {
+        const auto& key = entry.key;
+        auto msg = key.tankId.levelGaugeCode().isEmpty() ? key.msg : tankMsg(key.tankId, key.msg);
+        if (entry.count > 1)
+        {
+            msg += QString(" (repeated %1 times)").arg(entry.count);
+        }
+
+        emit writeLogMsg(key.category, msg);
+    }
+
+    if (_skippedCount > 0)
+    {
+        emit writeLogMsg(TDBLoger::MSG_CODE::WARNING_CODE,
+                         QString("Too many log messages. Messages skipped: %1. Increase [LOG]/MaxMessagesPerFlush to save all messages").arg(_skippedCount));
+    }
+
+    _entries.clear();
+    _entriesIndex.clear();
+    _skippedCount = 0;
+}
+
+void LogBuffer::addEntry(const TankID& id, TDBLoger::MSG_CODE category, const QString& msg)
+{
+    EntryKey key{id, category, msg};
+
+    const auto entriesIndex_it = _entriesIndex.constFind(key);
+    if (entriesIndex_it != _entriesIndex.end())
+    {
+        ++_entries[entriesIndex_it.value()].count;
+
+        return;
+    }
+
+    //при перегрузке сохраняем только критические сообщения
+    if (_entries.size() >= _maxMessagesPerFlush && category != TDBLoger::MSG_CODE::CRITICAL_CODE)
+    {
+        ++_skippedCount;
+
+        return;
+    }
+
+    _entriesIndex.insert(key, _entries.size());
+    _entries.push_back(Entry{std::move(key), 1});
+}
+
+void LogBuffer::addTankHistory(const TankID& id, TDBLoger::MSG_CODE category, const QString& msg)
+{
+    if (_tankHistorySize == 0)
+    {
+        return;
+    }
+
+    QMutexLocker<QMutex> locker(&_tankHistoryMutex);
+
+    auto& history = _tankHistory[id];
+
+    Message message{QDateTime::currentDateTime(), category, msg};
+    if (history.isFull)
+    {
+        history.messages[history.next] = std::move(message);
+    }
+    else
+    {
+        history.messages.push_back(std::move(message));
+    }
+
+    history.next = (history.next + 1) % _tankHistorySize;
+    if (history.next == 0)
+    {
+        history.isFull = true;
+    }
+}
+
+QString LogBuffer::tankMsg(const TankID& id, const QString& msg)
+{
+    return QString("Tank: AZSCode: %1. TankNumber: %2. Message: %3")
+        .arg(id.levelGaugeCode())
+        .arg(id.tankNumber())
+        .arg(msg);
+}
@@ -0,0 +1,174 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Буфер сообщений лога. Накапливает сообщения модулей и пакетами передает
+///     их в глобальный логер
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//STL
+#include <vector>
+
+//Qt
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QDateTime>
+#include <QMutex>
+#include <QTimer>
+
+//My
+#include "Common/tdbloger.h"
+#include "tankid.h"
+
+namespace LevelGaugeService
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// Объект перемещается в собственный поток, поэтому модули не ждут записи
+///     сообщений в БД. Сообщения накапливаются и передаются в логер раз в
+///     flushInterval. Одинаковые сообщения за интервал передаются один раз с
+///     количеством повторов. Если за интервал накоплено больше
+///     maxMessagesPerFlush разных сообщений - остальные сообщения, кроме
+///     CRITICAL_CODE, пропускаются, а в лог передается количество пропущенных.
+///     Текст сообщений резервуаров формируется только при передаче в логер.
+///     Последние tankHistorySize сообщений каждого резервуара (включая
+///     пропущенные) хранятся в памяти и сохраняются в лог при ошибке резервуара
+///
+class LogBuffer final
+    : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Message
+    {
+        QDateTime dateTime;
+        Common::TDBLoger::MSG_CODE category = Common::TDBLoger::MSG_CODE::INFORMATION_CODE;
+        QString msg;
+    };
+
+    using MessagesList = QList<Message>;
+
+public:
+    /*!
+        Конструктор
+        @param flushInterval - интервал передачи накопленных сообщений в логер, мсек
+        @param maxMessagesPerFlush - максимальное количество разных сообщений за один интервал
+        @param tankHistorySize - количество последних сообщений резервуара, хранимых в памяти. 0 - не хранить
+        @param parent - указатель на родительский класс
+    */
+    LogBuffer(qint64 flushInterval, quint32 maxMessagesPerFlush, quint32 tankHistorySize, QObject* parent = nullptr);
+
+    /*!
+        Деструктор
+    */
+    ~LogBuffer();
+
+    /*!
+        Возвращает последние сообщения резервуара. Может вызываться из любого потока
+        @param id - ИД резервуара
+        @return список сообщений от старых к новым
+    */
+    MessagesList tankHistory(const LevelGaugeService::TankID& id) const;
+
+public slots:
+    /*!
+        Запускает таймер передачи сообщений. Должен вызываться в потоке буфера
+    */
+    void start();
+
+    /*!
+        Передает в логер все накопленные сообщения и останавливает таймер. Должен вызываться в потоке буфера
+    */
+    void stop();
+
+    /*!
+        Добавляет сообщение в буфер
+        @param category - тип сообщения
+        @param msg - текст сообщения
+    */
+    void sendLogMsg(Common::TDBLoger::MSG_CODE category, const QString& msg);
+
+    /*!
+        Добавляет сообщение резервуара в буфер
+        @param id - ИД резервуара
+        @param category - тип сообщения
+        @param msg - текст сообщения
+    */
+    void sendTankLogMsg(const LevelGaugeService::TankID& id, Common::TDBLoger::MSG_CODE category, const QString& msg);
+
+    /*!
+        Передает в логер последние сообщения резервуара одним сообщением
+        @param id - ИД резервуара
+    */
+    void writeTankHistory(const LevelGaugeService::TankID& id);
+
+signals:
+    /*!
+        Сигнал испускается при передаче сообщения в логер
+        @param category - тип сообщения
+        @param msg - текст сообщения
+    */
+    void writeLogMsg(Common::TDBLoger::MSG_CODE category, const QString& msg);
+
+private slots:
+    void flush();
+
+private:
+    struct EntryKey
+    {
+        TankID tankId;          ///< ИД резервуара. Пустой если сообщение не относится к резервуару
+        Common::TDBLoger::MSG_CODE category = Common::TDBLoger::MSG_CODE::INFORMATION_CODE;
+        QString msg;
+
+        bool operator==(const EntryKey& other) const
+        {
+            return category == other.category && msg == other.msg && tankId == other.tankId;
+        }
+    };
+
+    friend size_t qHash(const EntryKey& key, size_t seed) noexcept
+    {
+        return qHashMulti(seed, key.tankId, static_cast<int>(key.category), key.msg);
+    }
+
+    struct Entry
+    {
+        EntryKey key;
+        quint32 count = 1;      ///< Количество одинаковых сообщений за интервал
+    };
+
+    struct TankHistory
+    {
+        std::vector<Message> messages;  ///< Кольцевой буфер сообщений
+        size_t next = 0;                ///< Позиция следующего сообщения
+        bool isFull = false;            ///< Буфер заполнен, следующее сообщение заменит самое старое
+    };
+
+private:
+    LogBuffer() = delete;
+    Q_DISABLE_COPY_MOVE(LogBuffer)
+
+    void addEntry(const LevelGaugeService::TankID& id, Common::TDBLoger::MSG_CODE category, const QString& msg);
+    void addTankHistory(const LevelGaugeService::TankID& id, Common::TDBLoger::MSG_CODE category, const QString& msg);
+
+    static QString tankMsg(const LevelGaugeService::TankID& id, const QString& msg);
+
+private:
+    const qint64 _flushInterval = 1000;
+    const quint32 _maxMessagesPerFlush = 1000;
+    const quint32 _tankHistorySize = 100;
+
+    QTimer* _flushTimer = nullptr;
+
+    std::vector<Entry> _entries;            ///< Сообщения текущего интервала в порядке поступления
+    QHash<EntryKey, size_t> _entriesIndex;  ///< Индексы сообщений в _entries
+    quint64 _skippedCount = 0;              ///< Количество пропущенных сообщений за интервал
+
+    mutable QMutex _tankHistoryMutex;
+    QHash<LevelGaugeService::TankID, TankHistory> _tankHistory;
+
+}; //class LogBuffer
+
+} //namespace LevelGaugeService
@@ -0,0 +1,208 @@
+//My
+#include "packageindex.h"
+
+using namespace LevelGaugeService;
+
+bool PackageIndex::isOutstanding(SUNCSync::PackageProcessingStatus status)
+{
+    switch (status)
+    {
+    case SUNCSync::PackageProcessingStatus::SEND_TO_SERVER:
+    case SUNCSync::PackageProcessingStatus::PENDING:
+    case SUNCSync::PackageProcessingStatus::HTTP_ERROR:
+        return true;
+    default:
+        break;
+    }
+
+    return false;
+}
+
+PackageIndex::PackageIndex()
+{
+}
+
+PackageIndex::~PackageIndex()
+{
+}
+
+void PackageIndex::clear()
+{
+    _packages.clear();
+    _schedule = decltype(_schedule){};
+}
+
+void PackageIndex::addPackage(const QUuid& packageId, const TankID& tankId, qint64 applicantId,
+                              SUNCSync::PackageProcessingStatus status, const QDateTime& nextCheck)
+{
+    addPackage(packageId, applicantId, status, nextCheck);
+
+    const auto packages_it = _packages.find(packageId);
+    if (packages_it != _packages.end())
+    {
+        packages_it->tanks.insert(tankId);
+    }
+}
+
+void PackageIndex::addPackage(const QUuid& packageId, qint64 applicantId, SUNCSync::PackageProcessingStatus status, const QDateTime& nextCheck)
+{
+    Q_ASSERT(!packageId.isNull());
+
+    if (!isOutstanding(status))
+    {
+        return;
+    }
+
+    auto packages_it = _packages.find(packageId);
+    if (packages_it == _packages.end())
+    {
+        PackageInfo packageInfo;
+        packageInfo.applicantId = applicantId;
+        packageInfo.status = status;
+
+        packages_it = _packages.insert(packageId, std::move(packageInfo));
+    }
+
+    Q_ASSERT(packages_it->applicantId == applicantId);
+
+    //если пакет уже был в индексе - проверяем его по наиболее раннему времени
+    if (!packages_it->nextCheck.isValid() || nextCheck < packages_it->nextCheck)
+    {
+        schedule(packageId, nextCheck);
+    }
+}
+
+void PackageIndex::updateStatus(const QUuid& packageId, SUNCSync::PackageProcessingStatus status, const QDateTime& nextCheck)
+{
+    if (!isOutstanding(status))
+    {
+        remove(packageId);
+
+        return;
+    }
+
+    auto packages_it = _packages.find(packageId);
+    if (packages_it == _packages.end())
+    {
+        return;
+    }
+
+    packages_it->status = status;
+
+    schedule(packageId, nextCheck);
+}
+
+void PackageIndex::reschedule(const QUuid& packageId, const QDateTime& nextCheck)
+{
+    if (!_packages.contains(packageId))
+    {
+        return;
+    }
+
+    schedule(packageId, nextCheck);
+}
+
+void PackageIndex::remove(const QUuid& packageId)
+{
+    _packages.remove(packageId);
+}
+
+void PackageIndex::removeTanks(const QSet<TankID>& tanksId)
+{
+    _packages.removeIf(
+        [&tanksId](QHash<QUuid, PackageInfo>::iterator it)
+        {
+            if (!it->tanks.intersects(tanksId))
+            {
+                return false;
+            }
+
+            it->tanks.subtract(tanksId);
+
+            return it->tanks.isEmpty();
+        });
+}
+
+void PackageIndex::removeApplicant(qint64 applicantId)
+{
+    _packages.removeIf([applicantId](QHash<QUuid, PackageInfo>::iterator it){ return it->applicantId == applicantId; });
+}
+
+PackageIndex::PackagesList PackageIndex::takeDue(const QDateTime& now, const QDateTime& leaseUntil)
+{
+    PackagesList result;
+
+    dropStale();
+
+    while (!_schedule.empty() && _schedule.top().nextCheck <= now)
+    {
+        const auto packageId = _schedule.top().packageId;
+        _schedule.pop();
+
+        result.push_back(packageId);
+
+        schedule(packageId, leaseUntil);
+
+        dropStale();
+    }
+
+    return result;
+}
+
+const PackageIndex::PackageInfo* PackageIndex::package(const QUuid& packageId) const
+{
+    const auto packages_it = _packages.find(packageId);
+    if (packages_it == _packages.end())
+    {
+        return nullptr;
+    }
+
+    return &packages_it.value();
+}
+
+QDateTime PackageIndex::nextCheckTime()
+{
+    dropStale();
+
+    if (_schedule.empty())
+    {
+        return {};
+    }
+
+    return _schedule.top().nextCheck;
+}
+
+qsizetype PackageIndex::size() const
+{
+    return _packages.size();
+}
+
+bool PackageIndex::isEmpty() const
+{
+    return _packages.isEmpty();
+}
+
+void PackageIndex::schedule(const QUuid& packageId, const QDateTime& nextCheck)
+{
+    auto packages_it = _packages.find(packageId);
+    Q_ASSERT(packages_it != _packages.end());
+
+    packages_it->nextCheck = nextCheck;
+
+    _schedule.push({nextCheck, packageId});
+}
+
+void PackageIndex::dropStale()
+{
+    while (!_schedule.empty())
+    {
+        const auto& top = _schedule.top();
+        const auto packages_it = _packages.find(top.packageId);
+        if (packages_it != _packages.end() && packages_it->nextCheck == top.nextCheck)
+        {
+            break;
+        }
+
+        _schedule.pop();
+    }
+}
@@ -0,0 +1,150 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Индекс отправленных на сервер пакетов, ожидающих подтверждения обработки
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//STL
+#include <queue>
+#include <vector>
+
+//Qt
+#include <QHash>
+#include <QSet>
+#include <QUuid>
+#include <QDateTime>
+
+//My
+#include "tankid.h"
+#include "suncsync.h"
+
+namespace LevelGaugeService
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// Хранит в памяти все незавершенные пакеты (ИД пакета -> резервуары, статус,
+///     организация, время следующей проверки) и очередь пакетов, упорядоченную
+///     по времени следующей проверки. Индекс заполняется из БД один раз при
+///     запуске и далее поддерживается при изменении статуса пакетов, поэтому
+///     для выбора пакетов на проверку обращение к БД не требуется
+///
+class PackageIndex final
+{
+public:
+    struct PackageInfo
+    {
+        QSet<LevelGaugeService::TankID> tanks;  ///< Резервуары, данные которых содержит пакет
+        SUNCSync::PackageProcessingStatus status = SUNCSync::PackageProcessingStatus::UNDEFINED;
+        qint64 applicantId = 0;                 ///< ИД организации, которой был отправлен пакет
+        QDateTime nextCheck;                    ///< Время следующей проверки статуса пакета
+    };
+
+    using PackagesList = QList<QUuid>;
+
+public:
+    /*!
+        Возвращает true если пакет с таким статусом ожидает подтверждения обработки сервером
+    */
+    static bool isOutstanding(SUNCSync::PackageProcessingStatus status);
+
+public:
+    PackageIndex();
+    ~PackageIndex();
+
+    void clear();
+
+    /*!
+        Добавляет пакет в индекс. Если пакет уже существует - добавляет к нему резервуар
+        @param packageId - ИД пакета
+        @param tankId - ИД резервуара, данные которого содержит пакет
+        @param applicantId - ИД организации
+        @param status - статус пакета. Пакеты с завершенным статусом не добавляются
+        @param nextCheck - время следующей проверки
+    */
+    void addPackage(const QUuid& packageId, const LevelGaugeService::TankID& tankId, qint64 applicantId,
+                    SUNCSync::PackageProcessingStatus status, const QDateTime& nextCheck);
+
+    /*!
+        Добавляет пакет, не содержащий данных резервуаров (например показания расходомеров)
+    */
+    void addPackage(const QUuid& packageId, qint64 applicantId, SUNCSync::PackageProcessingStatus status, const QDateTime& nextCheck);
+
+    /*!
+        Обновляет статус пакета. Пакет с завершенным статусом удаляется из индекса
+        @param packageId - ИД пакета
+        @param status - новый статус
+        @param nextCheck - время следующей проверки
+    */
+    void updateStatus(const QUuid& packageId, SUNCSync::PackageProcessingStatus status, const QDateTime& nextCheck);
+
+    /*!
+        Переносит время следующей проверки пакета
+    */
+    void reschedule(const QUuid& packageId, const QDateTime& nextCheck);
+
+    void remove(const QUuid& packageId);
+
+    /*!
+        Исключает резервуары из пакетов. Пакет, в котором не осталось резервуаров, удаляется из индекса.
+            Пакеты, не содержащие данных резервуаров, не изменяются
+        @param tanksId - ИД резервуаров
+    */
+    void removeTanks(const QSet<LevelGaugeService::TankID>& tanksId);
+
+    /*!
+        Удаляет из индекса все пакеты организации
+        @param applicantId - ИД организации
+    */
+    void removeApplicant(qint64 applicantId);
+
+    /*!
+        Извлекает из очереди пакеты, время проверки которых наступило. Время следующей проверки
+            извлеченных пакетов переносится на leaseUntil, чтобы пакет не был выбран повторно до получения ответа
+        @param now - текущее время
+        @param leaseUntil - время до которого пакет считается находящимся на проверке
+        @return список ИД пакетов
+    */
+    PackagesList takeDue(const QDateTime& now, const QDateTime& leaseUntil);
+
+    /*!
+        Возвращает информацию о пакете или nullptr если пакета нет в индексе
+    */
+    const PackageInfo* package(const QUuid& packageId) const;
+
+    /*!
+        Время ближайшей проверки. Невалидно если индекс пуст
+    */
+    QDateTime nextCheckTime();
+
+    qsizetype size() const;
+    bool isEmpty() const;
+
+private:
+    Q_DISABLE_COPY_MOVE(PackageIndex)
+
+    void schedule(const QUuid& packageId, const QDateTime& nextCheck);
+
+    /*!
+        Удаляет из вершины очереди устаревшие записи (пакет удален или время проверки изменено)
+    */
+    void dropStale();
+
+private:
+    struct ScheduleItem
+    {
+        QDateTime nextCheck;
+        QUuid packageId;
+
+        bool operator>(const ScheduleItem& other) const { return nextCheck > other.nextCheck; }
+    };
+
+private:
+    QHash<QUuid, PackageInfo> _packages;
+
+    //при изменении времени проверки старая запись не удаляется, а пропускается при извлечении
+    std::priority_queue<ScheduleItem, std::vector<ScheduleItem>, std::greater<ScheduleItem>> _schedule;
+
+}; //class PackageIndex
+
+} //namespace LevelGaugeService
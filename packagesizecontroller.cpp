@@ -0,0 +1,73 @@
+//STL
+#include <algorithm>
+
+//My
+#include "packagesizecontroller.h"
+
+using namespace LevelGaugeService;
+
+PackageSizeController::PackageSizeController(const Limits& limits, quint32 initSize)
+    : _limits(limits)
+    , _packageSize(std::clamp(initSize, limits.minSize, limits.maxSize))
+    , _sendInterval(limits.maxInterval)
+{
+    Q_ASSERT(_limits.minSize > 0 && _limits.minSize <= _limits.maxSize);
+    Q_ASSERT(_limits.minInterval > 0 && _limits.minInterval <= _limits.maxInterval);
+    Q_ASSERT(_limits.fastAnswerTime > 0);
+}
+
+PackageSizeController::~PackageSizeController()
+{
+}
+
+bool PackageSizeController::success(qint64 answerTime, quint32 recordsCount)
+{
+    ++_metrics.successCount;
+    _metrics.sentRecords += recordsCount;
+    _metrics.lastAnswerTime = answerTime;
+    _metrics.maxAnswerTime = std::max(_metrics.maxAnswerTime, answerTime);
+
+    const auto oldSize = _packageSize;
+    const auto oldInterval = _sendInterval;
+
+    if (recordsCount < _packageSize)
+    {
+        //данных меньше чем помещается в пакет - отправляем реже, чтобы пакеты были крупнее
+        _sendInterval = std::min(_sendInterval + _limits.intervalStep, _limits.maxInterval);
+    }
+    else if (answerTime <= _limits.fastAnswerTime)
+    {
+        //пакет полный и сервер справляется - увеличиваем размер и частоту отправки
+        _packageSize = std::min(_packageSize + _limits.sizeStep, _limits.maxSize);
+        _sendInterval = std::max(_sendInterval / 2, _limits.minInterval);
+    }
+
+    //полный пакет с медленным ответом - оставляем параметры без изменений
+
+    return oldSize != _packageSize || oldInterval != _sendInterval;
+}
+
+bool PackageSizeController::failure()
+{
+    ++_metrics.failureCount;
+
+    const auto oldSize = _packageSize;
+    const auto oldInterval = _sendInterval;
+
+    _packageSize = std::max(_packageSize / 2, _limits.minSize);
+    _sendInterval = std::min(_sendInterval * 2, _limits.maxInterval);
+
+    return oldSize != _packageSize || oldInterval != _sendInterval;
+}
+
+QString PackageSizeController::toString() const
+{
+    return QString("Package size: %1 records. Send interval: %2 ms. Success: %3. Failure: %4. Sent records: %5. Last answer time: %6 ms. Max answer time: %7 ms")
+        .arg(_packageSize)
+        .arg(_sendInterval)
+        .arg(_metrics.successCount)
+        .arg(_metrics.failureCount)
+        .arg(_metrics.sentRecords)
+        .arg(_metrics.lastAnswerTime)
+        .arg(_metrics.maxAnswerTime);
+}
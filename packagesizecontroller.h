@@ -0,0 +1,96 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Адаптивный выбор размера пакета и частоты отправки данных на сервер
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//QT
+#include <QString>
+
+namespace LevelGaugeService
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// Регулятор по схеме AIMD (аддитивное увеличение, мультипликативное уменьшение).
+///     Пока сервер быстро и успешно принимает полные пакеты - размер пакета
+///     увеличивается на шаг, а интервал отправки сокращается вдвое (догоняем
+///     накопленные данные). Если данных меньше размера пакета - интервал
+///     отправки увеличивается на шаг, чтобы не отправлять мелкие пакеты.
+///     При ошибке размер пакета уменьшается вдвое, а интервал удваивается.
+///     Один экземпляр используется для одной организации
+///
+class PackageSizeController final
+{
+public:
+    struct Limits
+    {
+        quint32 minSize = 0;        ///< Минимальный размер пакета, записей
+        quint32 maxSize = 0;        ///< Максимальный размер пакета, записей
+        quint32 sizeStep = 0;       ///< Шаг увеличения размера пакета, записей
+        qint64 minInterval = 0;     ///< Минимальный интервал отправки пакетов, мсек
+        qint64 maxInterval = 0;     ///< Максимальный интервал отправки пакетов, мсек
+        qint64 intervalStep = 0;    ///< Шаг увеличения интервала отправки, мсек
+        qint64 fastAnswerTime = 0;  ///< Ответ сервера за это время считается быстрым, мсек
+    };
+
+    struct Metrics
+    {
+        quint64 successCount = 0;   ///< Количество успешно принятых сервером пакетов
+        quint64 failureCount = 0;   ///< Количество неудачных отправок
+        quint64 sentRecords = 0;    ///< Количество записей в успешно принятых пакетах
+        qint64 lastAnswerTime = 0;  ///< Время ответа сервера на последний пакет, мсек
+        qint64 maxAnswerTime = 0;   ///< Максимальное время ответа сервера, мсек
+    };
+
+public:
+    /*!
+        Конструктор
+        @param limits - ограничения размера пакета и интервала отправки
+        @param initSize - начальный размер пакета
+    */
+    PackageSizeController(const Limits& limits, quint32 initSize);
+
+    /*!
+        Деструктор
+    */
+    ~PackageSizeController();
+
+    /*!
+        Учитывает успешную отправку пакета
+        @param answerTime - время ответа сервера, мсек
+        @param recordsCount - количество записей в пакете
+        @return true если размер пакета или интервал отправки изменились
+    */
+    bool success(qint64 answerTime, quint32 recordsCount);
+
+    /*!
+        Учитывает неудачную отправку пакета (ошибка сервера или сети)
+        @return true если размер пакета или интервал отправки изменились
+    */
+    bool failure();
+
+    quint32 packageSize() const { return _packageSize; }
+    qint64 sendInterval() const { return _sendInterval; }
+    const Metrics& metrics() const { return _metrics; }
+
+    /*!
+        Текущее состояние регулятора для журнала
+    */
+    QString toString() const;
+
+private:
+    PackageSizeController() = delete;
+    Q_DISABLE_COPY_MOVE(PackageSizeController)
+
+private:
+    const Limits _limits;
+
+    quint32 _packageSize = 0;   ///< Текущий размер пакета, записей
+    qint64 _sendInterval = 0;   ///< Текущий интервал отправки, мсек
+
+    Metrics _metrics;
+
+}; //class PackageSizeController
+
+} //namespace LevelGaugeService
@@ -0,0 +1,248 @@
+//STL
+#include <algorithm>
+
+//My
+#include "packagetracker.h"
+
+using namespace LevelGaugeService;
+using namespace Common;
+
+static const qint64 CHECK_PACKAGE_INTERVAL = 60 * 10;   ///< Интервал проверки статуса пакета, сек
+static const qint64 CHECK_PACKAGE_RETRY_INTERVAL = 60;  ///< Интервал повторной проверки после неудачного запроса, сек
+static const qint64 SEND_RETRY_INTERVAL = 5000;         ///< Минимальная задержка повторной проверки пакета после ошибки отправки, мсек
+
+PackageTracker::PackageTracker(const QString& syncName, const QString& packageName, PackageIndex* packageIndex,
+                               quint32 checkPackageWindow, QObject* parent /* = nullptr */)
+    : QObject{parent}
+    , _syncName(syncName)
+    , _packageName(packageName)
+    , _packageIndex(packageIndex)
+    , _checkPackageWindow(checkPackageWindow)
+{
+    Q_CHECK_PTR(_packageIndex);
+    Q_ASSERT(_checkPackageWindow > 0);
+}
+
+PackageTracker::~PackageTracker()
+{
+    stop();
+}
+
+void PackageTracker::start()
+{
+    Q_ASSERT(_checkTimer == nullptr);
+
+    _checkTimer = new QTimer();
+
+    QObject::connect(_checkTimer, SIGNAL(timeout()), SLOT(checkPackage()));
+
+    _checkTimer->start(1000);
+}
+
+void PackageTracker::stop()
+{
+    delete _checkTimer;
+    _checkTimer = nullptr;
+
+    //соединения с клиентами разрываются при их удалении синхронизатором, а ответы на неизвестные запросы пропускаются
+    _applicants.clear();
+    _checkRequests.clear();
+}
+
+void PackageTracker::addApplicant(qint64 applicantId, SUNCSync* suncSync)
+{
+    Q_CHECK_PTR(suncSync);
+    Q_ASSERT(!_applicants.contains(applicantId));
+
+    QObject::connect(suncSync, SIGNAL(errorRequest(const QString&, LevelGaugeService::SUNCSync::PackageProcessingStatus, quint64)),
+                     SLOT(errorRequest(const QString&, LevelGaugeService::SUNCSync::PackageProcessingStatus, quint64)));
+    QObject::connect(suncSync, SIGNAL(getPackageStatus(const LevelGaugeService::SUNCSync::PackageStatusInfo&, quint64)),
+                     SLOT(getPackageStatus(const LevelGaugeService::SUNCSync::PackageStatusInfo&, quint64)));
+
+    ApplicantData applicant;
+    applicant.suncSync = suncSync;
+
+    _applicants.emplace(applicantId, std::move(applicant));
+}
+
+void PackageTracker::removeApplicant(qint64 applicantId)
+{
+    const auto applicants_it = _applicants.find(applicantId);
+    if (applicants_it == _applicants.end())
+    {
+        return;
+    }
+
+    QObject::disconnect(applicants_it->second.suncSync, nullptr, this, nullptr);
+
+    _applicants.erase(applicants_it);
+
+    _checkRequests.removeIf([applicantId](QHash<quint64, CheckRequest>::iterator it){ return it->applicantId == applicantId; });
+}
+
+void PackageTracker::sendFailed(const QUuid& packageId, qint64 applicantId)
+{
+    //пакет проверяем сразу после восстановления связи с сервером, а не через CHECK_PACKAGE_INTERVAL
+    _packageIndex->reschedule(packageId, QDateTime::currentDateTime().addMSecs(retryDelay(applicantId, SEND_RETRY_INTERVAL)));
+}
+
+void PackageTracker::checkPackage()
+{
+    Q_CHECK_PTR(_checkTimer);
+
+    const auto currentDateTime = QDateTime::currentDateTime();
+
+    //пакеты, время проверки которых наступило, ставим в очередь организации. До получения ответа пакет повторно не выбирается
+    for (const auto& packageId: _packageIndex->takeDue(currentDateTime, currentDateTime.addSecs(CHECK_PACKAGE_INTERVAL)))
+    {
+        const auto packageInfo = _packageIndex->package(packageId);
+        Q_CHECK_PTR(packageInfo);
+
+        const auto applicants_it = _applicants.find(packageInfo->applicantId);
+        if (applicants_it == _applicants.end())
+        {
+            _packageIndex->remove(packageId);
+
+            continue;
+        }
+
+        applicants_it->second.checkQueue.enqueue(packageId);
+    }
+
+    //для каждой организации держим до _checkPackageWindow одновременных запросов
+    bool isChecking = false;
+    for (auto& [applicantId, applicant]: _applicants)
+    {
+        while (applicant.suncSync->isAvailable() && applicant.checkInFlight < _checkPackageWindow && !applicant.checkQueue.isEmpty())
+        {
+            sendCheckPackage(applicantId, applicant, applicant.checkQueue.dequeue());
+        }
+
+        isChecking = isChecking || applicant.checkInFlight != 0 || !applicant.checkQueue.isEmpty();
+    }
+
+    //если проверять нечего - ждем наступления времени проверки ближайшего пакета
+    qint64 interval = 60000;
+    if (isChecking)
+    {
+        interval = 1000;
+    }
+    else
+    {
+        const auto nextCheck = _packageIndex->nextCheckTime();
+        if (nextCheck.isValid())
+        {
+            interval = std::clamp<qint64>(currentDateTime.msecsTo(nextCheck), 1000, 60000);
+        }
+    }
+
+    _checkTimer->setInterval(interval);
+
+    //далее ждем сигналов getPackageStatus(...)
+}
+
+void PackageTracker::sendCheckPackage(qint64 applicantId, ApplicantData& applicant, const QUuid& packageId)
+{
+    const auto sendId = applicant.suncSync->sendGetPackageStatus(packageId);
+
+    CheckRequest request;
+    request.packageId = packageId;
+    request.applicantId = applicantId;
+
+    _checkRequests.emplace(sendId, std::move(request));
+
+    ++applicant.checkInFlight;
+
+    emit sendLogMsg(_syncName, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Check %1 package on the server. Package ID: %2")
+                    .arg(_packageName)
+                    .arg(packageId.toString()));
+}
+
+void PackageTracker::finishCheckPackage(const CheckRequest& request)
+{
+    const auto applicants_it = _applicants.find(request.applicantId);
+    if (applicants_it != _applicants.end() && applicants_it->second.checkInFlight != 0)
+    {
+        --applicants_it->second.checkInFlight;
+    }
+}
+
+qint64 PackageTracker::retryDelay(qint64 applicantId, qint64 minDelay) const
+{
+    const auto applicants_it = _applicants.find(applicantId);
+    if (applicants_it == _applicants.end())
+    {
+        return minDelay;
+    }
+
+    return std::max(applicants_it->second.suncSync->retryAfter(), minDelay);
+}
+
+void PackageTracker::errorRequest(const QString& msg, SUNCSync::PackageProcessingStatus status, quint64 id)
+{
+    //ошибки запросов отправки данных обрабатывает синхронизатор
+    const auto checkRequests_it = _checkRequests.find(id);
+    if (checkRequests_it == _checkRequests.end())
+    {
+        return;
+    }
+
+    const auto request = checkRequests_it.value();
+    _checkRequests.erase(checkRequests_it);
+
+    emit sendLogMsg(_syncName, TDBLoger::MSG_CODE::WARNING_CODE, QString("An unsuccessful check %1 package status to the server. Package ID: %2. Status: %3. Message: %4")
+                         .arg(_packageName)
+                         .arg(request.packageId.toString())
+                         .arg(SUNCSync::packageProcessingStatusToString(status))
+                         .arg(msg));
+
+    _packageIndex->reschedule(request.packageId, QDateTime::currentDateTime().addMSecs(retryDelay(request.applicantId, CHECK_PACKAGE_RETRY_INTERVAL * 1000)));
+
+    finishCheckPackage(request);
+}
+
+void PackageTracker::getPackageStatus(const SUNCSync::PackageStatusInfo& status, quint64 id)
+{
+    const auto checkRequests_it = _checkRequests.find(id);
+    if (checkRequests_it == _checkRequests.end())
+    {
+        return;
+    }
+
+    const auto request = checkRequests_it.value();
+    _checkRequests.erase(checkRequests_it);
+
+    if (status.success)
+    {
+        emit packageStatusReceived(request.packageId, status.packageProcessingStatus, "");
+
+        emit sendLogMsg(_syncName, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("The %1 package status has been successfully received from the server. Package ID: %2. Status: %3")
+                        .arg(_packageName)
+                        .arg(request.packageId.toString())
+                        .arg(SUNCSync::packageProcessingStatusToString(status.packageProcessingStatus)));
+    }
+    else
+    {
+        //полное сообщение выглядит как "PackageId %1 wasn`t found.", но символ ` заменяеться ' на в QString и сравнение не срабатывает
+        //поэтому сравниваем только половину фразы
+        if (status.error.contains(QString("PackageId %1 wasn").arg(request.packageId.toString(QUuid::WithoutBraces)), Qt::CaseInsensitive))
+        {
+            emit packageNotFound(request.packageId);
+
+            emit sendLogMsg(_syncName, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("The %1 package not found on server. Clear PackageID and will retry send. Package ID: %2")
+                        .arg(_packageName)
+                        .arg(request.packageId.toString()));
+        }
+        else
+        {
+            emit packageStatusReceived(request.packageId, SUNCSync::PackageProcessingStatus::SERVER_ERROR, status.error);
+
+            emit sendLogMsg(_syncName, TDBLoger::MSG_CODE::WARNING_CODE, QString("Failed to get the %1 package status from the server and chenged status to SERVER_ERROR. Package ID: %2. Error: %3")
+                        .arg(_packageName)
+                        .arg(request.packageId.toString())
+                        .arg(status.error));
+        }
+    }
+
+    finishCheckPackage(request);
+}
@@ -0,0 +1,162 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Отслеживание статуса обработки отправленных на сервер пакетов
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//STL
+#include <unordered_map>
+
+//Qt
+#include <QObject>
+#include <QHash>
+#include <QQueue>
+#include <QUuid>
+#include <QTimer>
+
+//My
+#include "Common/tdbloger.h"
+#include "suncsync.h"
+#include "packageindex.h"
+
+namespace LevelGaugeService
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// Общая часть HTTP синхронизаторов. Пакеты, время проверки которых
+///     наступило, выбираются из индекса пакетов и ставятся в очередь
+///     организации. Для каждой организации одновременно выполняется не более
+///     checkPackageWindow запросов статуса. Запись полученного статуса в БД
+///     выполняет синхронизатор по сигналам packageStatusReceived(...) и
+///     packageNotFound(...). Запросы отправки данных трекер не обрабатывает
+///
+class PackageTracker final
+    : public QObject
+{
+    Q_OBJECT
+
+public:
+    /*!
+        Конструктор
+        @param syncName - символьное название синхронизатора для сообщений лога
+        @param packageName - название типа пакета для сообщений лога (status, intake, flowmeter)
+        @param packageIndex - индекс незавершенных пакетов синхронизатора
+        @param checkPackageWindow - максимальное количество одновременных запросов проверки статуса пакета для одной организации
+        @param parent - указатель на родительский класс
+    */
+    PackageTracker(const QString& syncName, const QString& packageName, LevelGaugeService::PackageIndex* packageIndex,
+                   quint32 checkPackageWindow, QObject* parent = nullptr);
+
+    /*!
+        Деструктор
+    */
+    ~PackageTracker();
+
+    /*!
+        Запускает проверку пакетов. Индекс пакетов должен быть заполнен
+    */
+    void start();
+
+    /*!
+        Останавливает проверку пакетов. Ответы на уже отправленные запросы игнорируются
+    */
+    void stop();
+
+    /*!
+        Добавляет организацию. Трекер подключается к сигналам ответов на запрос статуса пакета
+        @param applicantId - ИД организации
+        @param suncSync - клиент сервера организации. Должен существовать до вызова removeApplicant(...) или stop()
+    */
+    void addApplicant(qint64 applicantId, LevelGaugeService::SUNCSync* suncSync);
+
+    /*!
+        Удаляет организацию вместе с очередью проверки. Ответы на уже отправленные запросы игнорируются
+        @param applicantId - ИД организации
+    */
+    void removeApplicant(qint64 applicantId);
+
+    /*!
+        Переносит проверку пакета, отправка которого завершилась ошибкой, на время восстановления связи с сервером
+        @param packageId - ИД пакета
+        @param applicantId - ИД организации
+    */
+    void sendFailed(const QUuid& packageId, qint64 applicantId);
+
+signals:
+    /*!
+        Сигнал испускатся при необходимости сохранить сообщения в лог
+        @param syncName - символьное название сихронизатора
+        @param category - тип сохраняемого сообщения (DBG, INFO, WAR....)
+        @param msg - текст сообщения
+    */
+    void sendLogMsg(const QString& syncName, Common::TDBLoger::MSG_CODE category, const QString& msg);
+
+    /*!
+        Сигнал испускается при получении нового статуса пакета
+        @param packageId - ИД пакета
+        @param status - статус пакета
+        @param errorMessage - текст ошибки сервера
+    */
+    void packageStatusReceived(const QUuid& packageId, LevelGaugeService::SUNCSync::PackageProcessingStatus status, const QString& errorMessage);
+
+    /*!
+        Сигнал испускается если пакет не найден на сервере. Данные пакета должны быть отправлены повторно
+        @param packageId - ИД пакета
+    */
+    void packageNotFound(const QUuid& packageId);
+
+private slots:
+    void checkPackage();
+
+    void errorRequest(const QString& msg, LevelGaugeService::SUNCSync::PackageProcessingStatus status, quint64 id);
+    void getPackageStatus(const LevelGaugeService::SUNCSync::PackageStatusInfo& status, quint64 id);
+
+private:
+    struct CheckRequest
+    {
+        QUuid packageId;
+        qint64 applicantId = 0;
+    };
+
+    struct ApplicantData
+    {
+        LevelGaugeService::SUNCSync* suncSync = nullptr;
+        QQueue<QUuid> checkQueue;       ///< Пакеты ожидающие проверки статуса
+        quint32 checkInFlight = 0;      ///< Количество отправленных запросов проверки статуса, на которые еще не получен ответ
+    };
+
+private:
+    PackageTracker() = delete;
+    Q_DISABLE_COPY_MOVE(PackageTracker)
+
+    void sendCheckPackage(qint64 applicantId, ApplicantData& applicant, const QUuid& packageId);
+
+    /*!
+        Завершает проверку пакета и освобождает место в окне запросов организации
+        @param request - запрос проверки
+    */
+    void finishCheckPackage(const CheckRequest& request);
+
+    /*!
+        Задержка повторного обращения к серверу организации после ошибки с учетом состояния доступности сервера
+        @param applicantId - ИД организации
+        @param minDelay - минимальная задержка, мсек
+        @return задержка, мсек
+    */
+    qint64 retryDelay(qint64 applicantId, qint64 minDelay) const;
+
+private:
+    const QString _syncName;
+    const QString _packageName;
+    LevelGaugeService::PackageIndex* _packageIndex = nullptr;
+    const quint32 _checkPackageWindow = 1;  ///< Максимальное количество одновременных запросов проверки статуса для одной организации
+
+    std::unordered_map<qint64, ApplicantData> _applicants; ///< Ключ - ИД организации
+    QHash<quint64, CheckRequest> _checkRequests; ///< Отправленные запросы проверки статуса. Ключ - ИД запроса из SUNCSync
+
+    QTimer* _checkTimer = nullptr;
+
+}; //class PackageTracker
+
+} //namespace LevelGaugeService
@@ -0,0 +1,285 @@
+//QT
+#include <QFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QtEndian>
+#include <QDateTime>
+
+//OS
+#ifdef Q_OS_WIN
+#include <io.h>
+#include <qt_windows.h>
+#else
+#include <unistd.h>
+#endif
+
+//My
+#include "checksum.h"
+
+#include "statusspool.h"
+
+using namespace LevelGaugeService;
+
+static const quint32 MAX_RECORD_SIZE = 64 * 1024; ///< Записи больше этого размера считаются поврежденными
+static const qsizetype RECORD_HEADER_SIZE = 2 * sizeof(quint32);
+
+//QFile::flush() передает данные только в кеш ОС. Чтобы записанные статусы пережили сбой питания,
+//данные сбрасываются на диск средствами ОС
+static bool syncFile(const QFile& file)
+{
+    const auto handle = file.handle();
+    if (handle < 0)
+    {
+        return false;
+    }
+
+#ifdef Q_OS_WIN
+    const auto osHandle = reinterpret_cast<HANDLE>(_get_osfhandle(handle));
+
+    return osHandle != INVALID_HANDLE_VALUE && FlushFileBuffers(osHandle) != 0;
+#else
+    return ::fsync(handle) == 0;
+#endif
+}
+
+static QByteArray statusToRecord(const TankID& id, const TankStatus& tankStatus)
+{
+    QByteArray payload;
+
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    const auto& data = tankStatus.getTankStatusData();
+    stream << id.levelGaugeCode() << id.tankNumber()
+           << data.dateTime << data.volume << data.mass << data.density << data.height << data.temp
+           << static_cast<quint8>(data.status) << data.additionFlag;
+
+    QByteArray record;
+    record.reserve(RECORD_HEADER_SIZE + payload.size());
+
+    const auto size = qToBigEndian<quint32>(static_cast<quint32>(payload.size()));
+    const auto crc = qToBigEndian<quint32>(crc32(payload));
+    record.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    record.append(reinterpret_cast<const char*>(&crc), sizeof(crc));
+    record.append(payload);
+
+    return record;
+}
+
+static bool recordToStatus(const QByteArray& payload, TankID* id, TankStatus* tankStatus)
+{
+    Q_CHECK_PTR(id);
+    Q_CHECK_PTR(tankStatus);
+
+    QDataStream stream(payload);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    QString levelGaugeCode;
+    quint8 tankNumber = 0;
+    quint8 status = 0;
+    TankStatus::TankStatusData data;
+
+    stream >> levelGaugeCode >> tankNumber
+           >> data.dateTime >> data.volume >> data.mass >> data.density >> data.height >> data.temp
+           >> status >> data.additionFlag;
+
+    if (stream.status() != QDataStream::Ok || levelGaugeCode.isEmpty() || tankNumber == 0)
+    {
+        return false;
+    }
+
+    data.status = TankConfig::intToStatus(status);
+    if (!data.check())
+    {
+        return false;
+    }
+
+    *id = TankID(levelGaugeCode, tankNumber);
+    *tankStatus = TankStatus(std::move(data));
+
+    return true;
+}
+
+StatusSpool::StatusSpool(const QString& fileName)
+    : _fileName(fileName)
+{
+    Q_ASSERT(!_fileName.isEmpty());
+}
+
+StatusSpool::~StatusSpool()
+{
+}
+
+QString StatusSpool::replayFileName() const
+{
+    return QString("%1.replay").arg(_fileName);
+}
+
+qint64 StatusSpool::append(const StatusesData& data)
+{
+    QByteArray buffer;
+    qint64 count = 0;
+    for (auto data_it = data.begin(); data_it != data.end(); ++data_it)
+    {
+        for (const auto& tankStatus: data_it.value())
+        {
+            buffer.append(statusToRecord(data_it.key(), tankStatus));
+            ++count;
+        }
+    }
+
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    QFile file(_fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        _errorString = QString("Cannot open spool file %1. Error: %2").arg(_fileName).arg(file.errorString());
+
+        return -1;
+    }
+
+    if (file.write(buffer) != buffer.size() || !file.flush())
+    {
+        _errorString = QString("Cannot write to spool file %1. Error: %2").arg(_fileName).arg(file.errorString());
+
+        return -1;
+    }
+
+    if (!syncFile(file))
+    {
+        _errorString = QString("Cannot sync spool file %1 to disk").arg(_fileName);
+
+        return -1;
+    }
+
+    file.close();
+
+    return count;
+}
+
+bool StatusSpool::hasData() const
+{
+    return QFileInfo(replayFileName()).size() > 0 || QFileInfo(_fileName).size() > 0;
+}
+
+qint64 StatusSpool::beginReplay(StatusesData* data)
+{
+    Q_CHECK_PTR(data);
+
+    _lastCorruptedCount = 0;
+
+    //если предыдущее воспроизведение не было завершено - то повторяем его, иначе берем текущий спул
+    if (!QFile::exists(replayFileName()))
+    {
+        if (!QFile::exists(_fileName))
+        {
+            return 0;
+        }
+
+        if (!QFile::rename(_fileName, replayFileName()))
+        {
+            _errorString = QString("Cannot rename spool file %1 to %2").arg(_fileName).arg(replayFileName());
+
+            return -1;
+        }
+    }
+
+    QFile file(replayFileName());
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        _errorString = QString("Cannot open spool replay file %1. Error: %2").arg(replayFileName()).arg(file.errorString());
+
+        return -1;
+    }
+
+    const auto buffer = file.readAll();
+    file.close();
+
+    qint64 count = 0;
+    qsizetype pos = 0;
+    while (pos < buffer.size())
+    {
+        if (buffer.size() - pos < RECORD_HEADER_SIZE)
+        {
+            ++_lastCorruptedCount;
+
+            break;
+        }
+
+        const auto size = qFromBigEndian<quint32>(buffer.constData() + pos);
+        const auto crc = qFromBigEndian<quint32>(buffer.constData() + pos + sizeof(quint32));
+        pos += RECORD_HEADER_SIZE;
+
+        //длина записи повреждена - дальнейшее чтение невозможно
+        if (size > MAX_RECORD_SIZE || buffer.size() - pos < static_cast<qsizetype>(size))
+        {
+            ++_lastCorruptedCount;
+
+            break;
+        }
+
+        const auto payload = buffer.mid(pos, size);
+        pos += size;
+
+        TankID id;
+        TankStatus tankStatus;
+        if (crc32(payload) != crc || !recordToStatus(payload, &id, &tankStatus))
+        {
+            ++_lastCorruptedCount;
+
+            continue;
+        }
+
+        (*data)[id].emplace_back(std::move(tankStatus));
+        ++count;
+    }
+
+    return count;
+}
+
+bool StatusSpool::commitReplay()
+{
+    if (QFile::exists(replayFileName()) && !QFile::remove(replayFileName()))
+    {
+        _errorString = QString("Cannot remove spool replay file %1").arg(replayFileName());
+
+        return false;
+    }
+
+    return true;
+}
+
+QString StatusSpool::rejectReplay()
+{
+    const auto rejectedFileName = QString("%1.rejected.%2").arg(_fileName).arg(QDateTime::currentDateTime().toString("yyyyMMddhhmmss"));
+
+    if (!QFile::rename(replayFileName(), rejectedFileName))
+    {
+        _errorString = QString("Cannot rename spool replay file %1 to %2").arg(replayFileName()).arg(rejectedFileName);
+
+        return QString();
+    }
+
+    return rejectedFileName;
+}
+
+quint64 StatusSpool::lastCorruptedCount() const
+{
+    return _lastCorruptedCount;
+}
+
+const QString& StatusSpool::fileName() const
+{
+    return _fileName;
+}
+
+QString StatusSpool::errorString()
+{
+    auto res = _errorString;
+    _errorString.clear();
+
+    return res;
+}
@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Локальный буфер (спул) вычисленных статусов резервуаров на время
+///     недоступности БД
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//QT
+#include <QString>
+#include <QHash>
+
+//My
+#include "tankid.h"
+#include "tankstatuses.h"
+
+namespace LevelGaugeService
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// Файл спула только дописывается. Каждая запись имеет вид:
+///     [quint32 - длина данных][quint32 - CRC-32 данных][данные]
+/// Данные - один статус резервуара, сериализованный через QDataStream.
+/// При воспроизведении файл спула переименовывается в файл воспроизведения,
+///     который удаляется только после успешного сохранения данных в БД.
+///     Поэтому новые ошибки БД во время воспроизведения не приводят к потере
+///     данных. При аварийном завершении между сохранением в БД и удалением
+///     файла воспроизведения файл будет воспроизведен повторно, поэтому
+///     сохранение в БД должно быть идемпотентным (SyncDBStatus воспроизводит
+///     спул через MERGE). Файл воспроизведения, данные которого БД отклоняет,
+///     откладывается (rejectReplay()), чтобы не блокировать спул
+///
+class StatusSpool final
+{
+public:
+    using StatusesData = QHash<LevelGaugeService::TankID, LevelGaugeService::TankStatusesList>;
+
+public:
+    /*!
+        Конструктор
+        @param fileName - имя файла спула
+    */
+    explicit StatusSpool(const QString& fileName);
+
+    /*!
+        Деструктор
+    */
+    ~StatusSpool();
+
+    /*!
+        Дописывает статусы в конец файла спула. Перед возвратом данные сбрасываются на диск (fsync/FlushFileBuffers),
+            поэтому записанные статусы сохраняются при сбое питания
+        @param data - статусы для сохранения
+        @return количество записанных статусов или -1 в случае ошибки ввода/вывода
+    */
+    qint64 append(const StatusesData& data);
+
+    /*!
+        Возвращает true если в спуле есть данные ожидающие сохранения в БД
+    */
+    bool hasData() const;
+
+    /*!
+        Начинает воспроизведение спула. Если незавершенного воспроизведения нет, то текущий файл спула
+            становиться файлом воспроизведения
+        @param data - [out] прочитанные статусы
+        @return количество прочитанных статусов или -1 в случае ошибки ввода/вывода.
+            Поврежденный хвост файла (например после аварийного завершения) пропускается
+    */
+    qint64 beginReplay(StatusesData* data);
+
+    /*!
+        Завершает воспроизведение после успешного сохранения данных в БД - удаляет файл воспроизведения
+    */
+    bool commitReplay();
+
+    /*!
+        Откладывает файл воспроизведения, данные которого не могут быть сохранены в БД, для разбора вручную
+        @return имя отложенного файла или пустая строка в случае ошибки ввода/вывода
+    */
+    QString rejectReplay();
+
+    /*!
+        Количество поврежденных записей, обнаруженных при последнем воспроизведении
+    */
+    quint64 lastCorruptedCount() const;
+
+    const QString& fileName() const;
+
+    QString errorString();
+    bool isError() const { return !_errorString.isEmpty(); }
+
+private:
+    StatusSpool() = delete;
+    Q_DISABLE_COPY_MOVE(StatusSpool)
+
+    QString replayFileName() const;
+
+private:
+    const QString _fileName;    ///< Имя файла спула
+
+    quint64 _lastCorruptedCount = 0;
+
+    QString _errorString;
+
+}; //class StatusSpool
+
+} //namespace LevelGaugeService
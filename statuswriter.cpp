@@ -0,0 +1,123 @@
+//Qt
+#include <QSqlQuery>
+#include <QElapsedTimer>
+
+//My
+#include "statuswriter.h"
+
+using namespace LevelGaugeService;
+using namespace Common;
+
+StatusWriter::StatusWriter(const Common::DBConnectionInfo& dbConnectionInfo, const QString& connectionName, QObject* parent /* = nullptr */)
+    : QObject{parent}
+    , _dbConnectionInfo(dbConnectionInfo)
+    , _connectionName(connectionName)
+{
+    Q_ASSERT(!_connectionName.isEmpty());
+}
+
+StatusWriter::~StatusWriter()
+{
+    Q_ASSERT(!_db.isOpen());
+}
+
+void StatusWriter::writeBatch(quint64 batchId, const QStringList& queries)
+{
+    QString errorString;
+    if (!checkDBConnection(&errorString))
+    {
+        emit batchFailed(batchId, errorString, true);
+
+        return;
+    }
+
+    QElapsedTimer writeTimer;
+    writeTimer.start();
+
+    SavedStatusesIDs savedIDs;
+    try
+    {
+        transactionDB(_db);
+
+        QSqlQuery query(_db);
+        query.setForwardOnly(true);
+        for (const auto& queryText: queries)
+        {
+            if (!query.exec(queryText))
+            {
+                throw SQLException(executeDBErrorString(_db, query));
+            }
+
+            //запрос с OUTPUT возвращает добавленные записи
+            while (query.isSelect() && query.next())
+            {
+                const TankID id(query.value("AZSCode").toString(), static_cast<quint8>(query.value("TankNumber").toUInt()));
+                savedIDs[id].insert(query.value("DateTime").toDateTime(), query.value("ID").toULongLong());
+            }
+        }
+
+        commitDB(_db);
+    }
+    catch (const SQLException& err)
+    {
+        _db.rollback();
+
+        _isDBError = !isConnectionAlive(_db);
+
+        emit batchFailed(batchId, err.what(), _isDBError);
+
+        return;
+    }
+
+    emit batchWrited(batchId, queries.size(), writeTimer.elapsed(), savedIDs);
+}
+
+bool StatusWriter::isConnectionAlive(QSqlDatabase& db)
+{
+    if (!db.isOpen())
+    {
+        return false;
+    }
+
+    QSqlQuery query(db);
+
+    return query.exec("SELECT 1");
+}
+
+void StatusWriter::stop()
+{
+    if (_db.isOpen())
+    {
+        closeDB(_db);
+    }
+}
+
+bool StatusWriter::checkDBConnection(QString* errorString)
+{
+    Q_CHECK_PTR(errorString);
+
+    if (_db.isOpen() && !_isDBError)
+    {
+        return true;
+    }
+
+    try
+    {
+        if (_db.isOpen())
+        {
+            closeDB(_db);
+        }
+
+        connectToDB(_db, _dbConnectionInfo, _connectionName);
+    }
+    catch (const SQLException& err)
+    {
+        *errorString = err.what();
+
+        return false;
+    }
+
+    _isDBError = false;
+
+    return true;
+}
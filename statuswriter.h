@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Класс выполняет запись пакетов запросов в БД в отдельном потоке
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//Qt
+#include <QObject>
+#include <QStringList>
+#include <QSqlDatabase>
+
+//My
+#include "Common/common.h"
+#include "tankstatuses.h"
+
+namespace LevelGaugeService
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// Писатель одной секции (шарда) данных. Объект перемещается в собственный
+///     поток и использует собственное подключение к БД. Каждый пакет запросов
+///     выполняется отдельной транзакцией. Подключение к БД выполняется при
+///     записи первого пакета и восстанавливается после потери подключения.
+///     Ошибка записи сообщает, потеряно ли подключение, т.к. ошибку данных
+///     повторная запись не исправит. Если запросы
+///     содержат OUTPUT INSERTED.[ID], INSERTED.[AZSCode], INSERTED.[TankNumber],
+///     INSERTED.[DateTime], то ИД добавленных записей возвращаются вместе с
+///     результатом записи
+///
+class StatusWriter final
+    : public QObject
+{
+    Q_OBJECT
+
+public:
+    /*!
+        Конструктор
+        @param dbConnectionInfo - ссылка на информацию о подключении к БД
+        @param connectionName - уникальное имя подключения к БД
+        @param parent - указатель на родительский класс
+    */
+    StatusWriter(const Common::DBConnectionInfo& dbConnectionInfo, const QString& connectionName, QObject* parent = nullptr);
+
+    /*!
+        Деструктор
+    */
+    ~StatusWriter();
+
+    /*!
+        Проверяет работоспособность подключения к БД простым запросом. Используется после ошибки
+            выполнения запроса, чтобы отличить потерю подключения от ошибки данных
+        @param db - подключение к БД
+        @return true - если подключение работоспособно
+    */
+    static bool isConnectionAlive(QSqlDatabase& db);
+
+public slots:
+    /*!
+        Выполняет пакет запросов одной транзакцией
+        @param batchId - ИД пакета
+        @param queries - список запросов
+    */
+    void writeBatch(quint64 batchId, const QStringList& queries);
+
+    /*!
+        Закрывает подключение к БД. Должен вызываться в потоке писателя
+    */
+    void stop();
+
+signals:
+    /*!
+        Пакет успешно записан в БД
+        @param batchId - ИД пакета
+        @param count - количество выполненных запросов
+        @param writeTime - время записи, мсек
+        @param savedIDs - ИД добавленных записей. Пустой если запросы не возвращают ИД
+    */
+    void batchWrited(quint64 batchId, quint64 count, qint64 writeTime, const LevelGaugeService::SavedStatusesIDs& savedIDs);
+
+    /*!
+        Ошибка записи пакета. Транзакция отменена, ни одна запись пакета не сохранена
+        @param batchId - ИД пакета
+        @param errorString - текстовое описание ошибки
+        @param isConnectionLost - true - подключение к БД потеряно, false - ошибка данных пакета
+    */
+    void batchFailed(quint64 batchId, const QString& errorString, bool isConnectionLost);
+
+private:
+    StatusWriter() = delete;
+    Q_DISABLE_COPY_MOVE(StatusWriter)
+
+    bool checkDBConnection(QString* errorString);
+
+private:
+    const Common::DBConnectionInfo _dbConnectionInfo;
+    const QString _connectionName;
+
+    QSqlDatabase _db;
+
+    bool _isDBError = false; ///< Флаг потери подключения к БД. При записи следующего пакета подключение будет восстановлено
+
+}; //class StatusWriter
+
+} //namespace LevelGaugeService
@@ -1,21 +1,57 @@
+//STL
+#include <unordered_map>
+
 //Qt
 #include <QUuid>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QTimer>
+#include <QElapsedTimer>
 
 //My
 #include "Common/common.h"
 
+#include "jsonwriter.h"
+#include "compression.h"
+
 #include "suncsync.h"
 
 using namespace LevelGaugeService;
 using namespace Common;
 
+static const qsizetype MIN_COMPRESS_SIZE = 1024; ///< Минимальный размер тела запроса для сжатия, байт
+
 //static const QString BASE_URL = "https://sunp-api.qoldau.kz";
 //static const QString BASE_URL = "https://demo-sunp-api.qoldau.kz";
-static const QString MEASUMENT_DATETIME_FORMAT = "yyyy-MM-ddThh:mm:ss.zzzZ";
+
+//Возвращает строковое значение перечисления в UTF-8. Значение вычисляется один раз для каждого элемента перечисления
+template <typename T>
+static QByteArrayView cachedEnumString(T type, QString (*toString)(T))
+{
+    thread_local std::unordered_map<T, QByteArray> cache;
+
+    auto cache_it = cache.find(type);
+    if (cache_it == cache.end())
+    {
+        cache_it = cache.emplace(type, toString(type).toUtf8()).first;
+    }
+
+    return cache_it->second;
+}
+
+//Количество измерений в пакете. Используется для оценки размера JSON документа
+template <typename TList, typename TField>
+static qsizetype measurementsCount(const TList& list, TField field)
+{
+    qsizetype result = 0;
+    for (const auto& item: list)
+    {
+        result += (item.*field).size();
+    }
+
+    return result;
+}
 
 //вспомогательные функции
 QString SUNCSync::requestGuid()
@@ -71,6 +107,8 @@ QString SUNCSync::packageProcessingStatusToString(PackageProcessingStatus status
     case PackageProcessingStatus::INCORRECT_DATA_ERROR: return QString("INCORRECT_DATA_ERROR");
     case PackageProcessingStatus::SERVER_ERROR: return QString("SERVER_ERROR");
     case PackageProcessingStatus::SEND_TO_SERVER: return QString("SEND_TO_SERVER");
+    case PackageProcessingStatus::SERVER_UNAVAILABLE: return QString("SERVER_UNAVAILABLE");
+    case PackageProcessingStatus::REQUEST_ERROR: return QString("REQUEST_ERROR");
     default:
         Q_ASSERT(false);
     }
@@ -303,14 +341,19 @@ QString SUNCSync::transferOperationTypeToString(TransferOperationType type)
     return "Undefine";
 }
 
-LevelGaugeService::SUNCSync::SUNCSync(const QUrl& baseUrl, const QString& remoteBearerToken, QObject *parent /* = nullptr */)
+LevelGaugeService::SUNCSync::SUNCSync(HTTPClientPool* httpClientPool, const QUrl& baseUrl, const QString& remoteBearerToken,
+                                      int compressionLevel /* = 0 */, QObject *parent /* = nullptr */)
     : QObject{parent}
-    , _query(HTTPSSLQuery::ProxyList())
+    , _httpClientPool(httpClientPool)
     , _remoteBearerToken(remoteBearerToken)
     , _baseUrl(baseUrl)
+    , _compressionLevel(compressionLevel)
+    , _circuitBreaker(CircuitBreaker::Settings())
 {
+    Q_CHECK_PTR(_httpClientPool);
     Q_ASSERT(!_remoteBearerToken.isEmpty());
     Q_ASSERT(!_baseUrl.isEmpty() && _baseUrl.isValid());
+    Q_ASSERT(_compressionLevel >= 0 && _compressionLevel <= 9);
 
     qRegisterMetaType<LevelGaugeService::SUNCSync::PackageStatusInfo>("LevelGaugeService::SUNCSync::PackageStatusInfo");
     qRegisterMetaType<LevelGaugeService::SUNCSync::ApplicantDataInfo>("LevelGaugeService::SUNCSync::ApplicantDataInfo");
@@ -321,15 +364,18 @@ LevelGaugeService::SUNCSync::SUNCSync(const QUrl& baseUrl, const QString& remote
 
     _headers.insert("Content-Type", "application/json");
 
-    QObject::connect(&_query, SIGNAL(getAnswer(const QByteArray&, quint64)), SLOT(getAnswerHTTP(const QByteArray&, quint64)));
-    QObject::connect(&_query, SIGNAL(errorOccurred(QNetworkReply::NetworkError, quint64, const QString&, quint64)),
-                             SLOT(errorOccurredHTTP(QNetworkReply::NetworkError, quint64, const QString&, quint64)));
-    QObject::connect(&_query, SIGNAL(sendLogMsg(Common::TDBLoger::MSG_CODE, const QString&, quint64)),
-                             SLOT(sendLogMsgHTTP(Common::TDBLoger::MSG_CODE, const QString&, quint64)));
+    _httpClientPool->attach(_baseUrl);
+
+    QObject::connect(_httpClientPool, SIGNAL(getAnswer(const QByteArray&, quint64)), SLOT(getAnswerHTTP(const QByteArray&, quint64)));
+    QObject::connect(_httpClientPool, SIGNAL(errorOccurred(QNetworkReply::NetworkError, quint64, const QString&, quint64)),
+                                      SLOT(errorOccurredHTTP(QNetworkReply::NetworkError, quint64, const QString&, quint64)));
+    QObject::connect(_httpClientPool, SIGNAL(sendLogMsgRequest(Common::TDBLoger::MSG_CODE, const QString&, quint64)),
+                                      SLOT(sendLogMsgHTTP(Common::TDBLoger::MSG_CODE, const QString&, quint64)));
 }
 
 SUNCSync::~SUNCSync()
 {
+    _httpClientPool->detach(_baseUrl);
 }
 
 quint64 SUNCSync::sendGetPackageStatus(const QUuid& packageId)
@@ -343,6 +389,11 @@ quint64 SUNCSync::sendGetPackageStatus(const QUuid& packageId)
         return sendId;
     }
 
+    if (!_circuitBreaker.allowRequest())
+    {
+        return skipRequest("GetPackageStatus");
+    }
+
     QJsonObject data;
     data.insert("requestGuid", requestGuid());
     data.insert("packageId", packageId.toString(QUuid::WithoutBraces));
@@ -355,10 +406,10 @@ quint64 SUNCSync::sendGetPackageStatus(const QUuid& packageId)
     auto url = _baseUrl;
     url.setPath("/Provider/GetPackageStatus");
 
-    const auto id = _query.send(url,
-                                HTTPSSLQuery::RequestType::POST,
-                                body.toJson(QJsonDocument::Compact),
-                                headers);
+    const auto id = _httpClientPool->send(url,
+                                          HTTPSSLQuery::RequestType::POST,
+                                          body.toJson(QJsonDocument::Compact),
+                                          headers);
 
     _requests.insert(id, RequestType::GET_PACKAGE_STATUS);
 
@@ -383,19 +434,27 @@ quint64 SUNCSync::sendGetApplicantData(const QString& bin)
     }
 
 
+    if (!_circuitBreaker.allowRequest())
+    {
+        return skipRequest("GetApplicantData");
+    }
+
     QJsonObject data;
     data.insert("requestGuid", requestGuid());
     data.insert("bin", bin);
 
     QJsonDocument body(data);
 
+    auto headers(_headers);
+    headers.emplace("Authorization", _remoteBearerToken.toUtf8());
+
     auto url = _baseUrl;
     url.setPath("/Provider/GetApplicantData");
 
-    const auto id = _query.send(url,
-                                HTTPSSLQuery::RequestType::GET,
-                                body.toJson(QJsonDocument::Compact),
-                                _headers);
+    const auto id = _httpClientPool->send(url,
+                                          HTTPSSLQuery::RequestType::GET,
+                                          body.toJson(QJsonDocument::Compact),
+                                          headers);
 
     _requests.insert(id, RequestType::GET_APPLICANT_DATA);
 
@@ -439,18 +498,18 @@ quint64 SUNCSync::sendSendTankIndicators(const TankIndicators& tankIndicators)
         return sendId;
     }
 
-    QJsonObject data;
-    data.insert("requestGuid", requestGuid());
-    data.insert("packageId", tankIndicators.packageId.toString(QUuid::WithoutBraces));
+    JSONWriter writer(256 + 384 * measurementsCount(tankIndicators.tankMeasurements, &TankMeasurements::measuments));
+    writer.beginObject();
+    writer.writeString("requestGuid", requestGuid().toUtf8());
+    writer.writeUuid("packageId", tankIndicators.packageId);
 
-    QJsonArray JSONTanksMeasurements;
+    writer.beginArray("tanksMeasurements");
     for(const auto& tanksMeasurement: tankIndicators.tankMeasurements)
     {
-        QJsonObject JSONTanksMeasurement;
-        JSONTanksMeasurement.insert("tankId", static_cast<qint64>(tanksMeasurement.tankId));
-
-        QJsonArray JSONMeasurements;
+        writer.beginObject();
+        writer.writeNumber("tankId", static_cast<qint64>(tanksMeasurement.tankId));
 
+        writer.beginArray("measurements");
         for (const auto& measurement: tanksMeasurement.measuments)
         {
             if (!measurement.check())
@@ -462,46 +521,28 @@ quint64 SUNCSync::sendSendTankIndicators(const TankIndicators& tankIndicators)
                 return sendId;
             }
 
-            QJsonObject JSONMeasument;
-
-            JSONMeasument.insert("measurementDate", measurement.measurementDate.toString(MEASUMENT_DATETIME_FORMAT));
-            JSONMeasument.insert("mass", measurement.mass);
-            JSONMeasument.insert("massUnitType", massUnitTypeToString(measurement.massUnitType));
-            JSONMeasument.insert("volume", measurement.volume);
-            JSONMeasument.insert("volumeUnitType", volumeUnitTypeToString(measurement.volumeUnitType));
-            JSONMeasument.insert("level", measurement.level);
-            JSONMeasument.insert("levelUnitType", levelUnitTypeToString(measurement.levelUnitType));
-            JSONMeasument.insert("density", measurement.density);
-            JSONMeasument.insert("temperature", measurement.temperature);
-            JSONMeasument.insert("oilProductType", oilProductTypeToString(measurement.oilProductType));
-
-            JSONMeasurements.push_back(JSONMeasument);
+            writer.beginObject();
+            writer.writeDateTime("measurementDate", measurement.measurementDate);
+            writer.writeNumber("mass", measurement.mass);
+            writer.writeString("massUnitType", cachedEnumString(measurement.massUnitType, &massUnitTypeToString));
+            writer.writeNumber("volume", measurement.volume);
+            writer.writeString("volumeUnitType", cachedEnumString(measurement.volumeUnitType, &volumeUnitTypeToString));
+            writer.writeNumber("level", measurement.level);
+            writer.writeString("levelUnitType", cachedEnumString(measurement.levelUnitType, &levelUnitTypeToString));
+            writer.writeNumber("density", measurement.density);
+            writer.writeNumber("temperature", measurement.temperature);
+            writer.writeString("oilProductType", cachedEnumString(measurement.oilProductType, &oilProductTypeToString));
+            writer.endObject();
         }
+        writer.endArray();
 
-        JSONTanksMeasurement.insert("measurements", JSONMeasurements);
-
-        JSONTanksMeasurements.push_back(JSONTanksMeasurement);
+        writer.endObject();
     }
+    writer.endArray();
 
+    writer.endObject();
 
-    data.insert("tanksMeasurements", JSONTanksMeasurements);
-
-    QJsonDocument body(data);
-
-    auto headers(_headers);
-    headers.emplace("Authorization", _remoteBearerToken.toUtf8());
-
-    auto url = _baseUrl;
-    url.setPath("/Tank/SendTankIndicators");
-
-    const auto id = _query.send(url,
-                                HTTPSSLQuery::RequestType::POST,
-                                body.toJson(QJsonDocument::Compact),
-                                headers);
-
-    _requests.insert(id, RequestType::SEND_TANK_INDICATORS);
-
-    return id;
+    return sendPackage("/Tank/SendTankIndicators", writer.take(), RequestType::SEND_TANK_INDICATORS);
 }
 
 quint64 SUNCSync::sendSendTankTransfers(const TanksTransfers &tanksTransfers)
@@ -543,18 +584,18 @@ quint64 SUNCSync::sendSendTankTransfers(const TanksTransfers &tanksTransfers)
         return sendId;
     }
 
-    QJsonObject data;
-    data.insert("requestGuid", requestGuid());
-    data.insert("packageId", tanksTransfers.packageId.toString(QUuid::WithoutBraces));
+    JSONWriter writer(256 + 512 * measurementsCount(tanksTransfers.tankTransfers, &TankTransfers::transfers));
+    writer.beginObject();
+    writer.writeString("requestGuid", requestGuid().toUtf8());
+    writer.writeUuid("packageId", tanksTransfers.packageId);
 
-    QJsonArray JSONTanksTransfers;
+    writer.beginArray("tanksTransfers");
     for(const auto& tankIntakes: tanksTransfers.tankTransfers)
     {
-        QJsonObject JSONTankTransfers;
-        JSONTankTransfers.insert("tankId", static_cast<qint64>(tankIntakes.tankId));
-
-        QJsonArray JSONTransfers;
+        writer.beginObject();
+        writer.writeNumber("tankId", static_cast<qint64>(tankIntakes.tankId));
 
+        writer.beginArray("transfers");
         for (const auto& transfer: tankIntakes.transfers)
         {
             if (!transfer.check())
@@ -566,48 +607,31 @@ quint64 SUNCSync::sendSendTankTransfers(const TanksTransfers &tanksTransfers)
                 return sendId;
             }
 
-            QJsonObject JSONTransfer;
-            JSONTransfer.insert("startDate", transfer.startDate.toString(MEASUMENT_DATETIME_FORMAT));
-            JSONTransfer.insert("endDate", transfer.endDate.toString(MEASUMENT_DATETIME_FORMAT));
-            JSONTransfer.insert("levelStart", transfer.levelStart);
-            JSONTransfer.insert("levelEnd", transfer.levelEnd);
-            JSONTransfer.insert("levelUnitType", levelUnitTypeToString(transfer.levelUnitType));
-            JSONTransfer.insert("massStart", transfer.massStart);
-            JSONTransfer.insert("massEnd", transfer.massEnd);
-            JSONTransfer.insert("massUnitType", massUnitTypeToString(transfer.massUnitType));
-            JSONTransfer.insert("volumeStart", transfer.volumeStart);
-            JSONTransfer.insert("volumeEnd", transfer.volumeEnd);
-            JSONTransfer.insert("volumeUnitType", volumeUnitTypeToString(transfer.volumeUnitType));
-            JSONTransfer.insert("operationType", transferOperationTypeToString(tankIntakes.operationType));
-            JSONTransfer.insert("oilProductType", oilProductTypeToString(transfer.oilProductType));
-
-            JSONTransfers.push_back(JSONTransfer);
+            writer.beginObject();
+            writer.writeDateTime("startDate", transfer.startDate);
+            writer.writeDateTime("endDate", transfer.endDate);
+            writer.writeNumber("levelStart", transfer.levelStart);
+            writer.writeNumber("levelEnd", transfer.levelEnd);
+            writer.writeString("levelUnitType", cachedEnumString(transfer.levelUnitType, &levelUnitTypeToString));
+            writer.writeNumber("massStart", transfer.massStart);
+            writer.writeNumber("massEnd", transfer.massEnd);
+            writer.writeString("massUnitType", cachedEnumString(transfer.massUnitType, &massUnitTypeToString));
+            writer.writeNumber("volumeStart", transfer.volumeStart);
+            writer.writeNumber("volumeEnd", transfer.volumeEnd);
+            writer.writeString("volumeUnitType", cachedEnumString(transfer.volumeUnitType, &volumeUnitTypeToString));
+            writer.writeString("operationType", cachedEnumString(tankIntakes.operationType, &transferOperationTypeToString));
+            writer.writeString("oilProductType", cachedEnumString(transfer.oilProductType, &oilProductTypeToString));
+            writer.endObject();
         }
+        writer.endArray();
 
-        JSONTankTransfers.insert("transfers", JSONTransfers);
-
-        JSONTanksTransfers.push_back(JSONTankTransfers);
+        writer.endObject();
     }
+    writer.endArray();
 
+    writer.endObject();
 
-    data.insert("tanksTransfers", JSONTanksTransfers);
-
-    QJsonDocument body(data);
-
-    auto headers(_headers);
-    headers.emplace("Authorization", _remoteBearerToken.toUtf8());
-
-    auto url = _baseUrl;
-    url.setPath("/Tank/SendTankTransfers");
-
-    const auto id = _query.send(url,
-                                HTTPSSLQuery::RequestType::POST,
-                                body.toJson(QJsonDocument::Compact),
-                                headers);
-
-    _requests.insert(id, RequestType::SEND_TANK_INDICATORS);
-
-    return id;
+    return sendPackage("/Tank/SendTankTransfers", writer.take(), RequestType::SEND_TANK_TRANSFER);
 }
 
 quint64 SUNCSync::sendSendFlowmeterOutputIndicators(const FlowmeterOutputIndicators &flowmeterOutputIndicators)
@@ -643,19 +667,19 @@ quint64 SUNCSync::sendSendFlowmeterOutputIndicators(const FlowmeterOutputIndicat
         return sendId;
     }
 
-    QJsonObject data;
-    data.insert("requestGuid", requestGuid());
-    data.insert("packageId", flowmeterOutputIndicators.packageId.toString(QUuid::WithoutBraces));
+    JSONWriter writer(256 + 320 * measurementsCount(flowmeterOutputIndicators.flowmeterOutputMeasurements, &FlowmeterOutputMeasurements::flowmeterOutputMeasurementData));
+    writer.beginObject();
+    writer.writeString("requestGuid", requestGuid().toUtf8());
+    writer.writeUuid("packageId", flowmeterOutputIndicators.packageId);
 
-    QJsonArray JSONTanksMeasurements;
-    for(const auto& flowmeterOutputMeasurement: flowmeterOutputIndicators.flowmeterOutputMeasurements)
+    writer.beginArray("flowmetersOutputMeasurements");
+    for(const auto& flowmeterMeasurement: flowmeterOutputIndicators.flowmeterOutputMeasurements)
     {
-        QJsonObject JSONTanksMeasurement;
-        JSONTanksMeasurement.insert("deviceId", static_cast<qint64>(flowmeterOutputMeasurement.deviceId));
-
-        QJsonArray JSONMeasurements;
+        writer.beginObject();
+        writer.writeNumber("deviceId", static_cast<qint64>(flowmeterMeasurement.deviceId));
 
-        for (const auto& measurement: flowmeterOutputMeasurement.flowmeterOutputMeasurementData)
+        writer.beginArray("measurements");
+        for (const auto& measurement: flowmeterMeasurement.flowmeterOutputMeasurementData)
         {
             if (!measurement.check())
             {
@@ -666,42 +690,25 @@ quint64 SUNCSync::sendSendFlowmeterOutputIndicators(const FlowmeterOutputIndicat
                 return sendId;
             }
 
-            QJsonObject JSONMeasument;
-
-            JSONMeasument.insert("measurementDate", measurement.measurementDate.toString(MEASUMENT_DATETIME_FORMAT));
-            JSONMeasument.insert("totalMass", measurement.totalMass);
-            JSONMeasument.insert("flowMass", measurement.flowMass);
-            JSONMeasument.insert("totalVolume", measurement.totalVolume);
-            JSONMeasument.insert("currentDensity", measurement.currentDensity);
-            JSONMeasument.insert("currentTemperature", measurement.currentTemperature);
-            JSONMeasument.insert("oilProductType", oilProductTypeToString(measurement.oilProductType));
-
-            JSONMeasurements.push_back(JSONMeasument);
+            writer.beginObject();
+            writer.writeDateTime("measurementDate", measurement.measurementDate);
+            writer.writeNumber("totalMass", measurement.totalMass);
+            writer.writeNumber("flowMass", measurement.flowMass);
+            writer.writeNumber("totalVolume", measurement.totalVolume);
+            writer.writeNumber("currentDensity", measurement.currentDensity);
+            writer.writeNumber("currentTemperature", measurement.currentTemperature);
+            writer.writeString("oilProductType", cachedEnumString(measurement.oilProductType, &oilProductTypeToString));
+            writer.endObject();
         }
+        writer.endArray();
 
-        JSONTanksMeasurement.insert("flowmetersOutputMeasurements", JSONMeasurements);
-
-        JSONTanksMeasurements.push_back(JSONTanksMeasurement);
+        writer.endObject();
     }
+    writer.endArray();
 
-    data.insert("tanksMeasurements", JSONTanksMeasurements);
-
-    QJsonDocument body(data);
+    writer.endObject();
 
-    auto headers(_headers);
-    headers.emplace("Authorization", _remoteBearerToken.toUtf8());
-
-    auto url = _baseUrl;
-    url.setPath("/Device/SendFlowmeterOutputIndicators");
-
-    const auto id = _query.send(url,
-                                HTTPSSLQuery::RequestType::POST,
-                                body.toJson(QJsonDocument::Compact),
-                                headers);
-
-    _requests.insert(id, RequestType::SEND_FLOWERS_OUTPUT_INDICATOR);
-
-    return id;
+    return sendPackage("/Device/SendFlowmeterOutputIndicators", writer.take(), RequestType::SEND_FLOWERS_OUTPUT_INDICATOR);
 }
 
 quint64 SUNCSync::sendSendFlowmeterInputIndicators(const FlowmeterInputIndicators &flowmeterInputIndicators)
@@ -738,19 +745,19 @@ quint64 SUNCSync::sendSendFlowmeterInputIndicators(const FlowmeterInputIndicator
         return sendId;
     }
 
-    QJsonObject data;
-    data.insert("requestGuid", requestGuid());
-    data.insert("packageId", flowmeterInputIndicators.packageId.toString(QUuid::WithoutBraces));
+    JSONWriter writer(256 + 320 * measurementsCount(flowmeterInputIndicators.flowmeterInputMeasurements, &FlowmeterInputMeasurements::flowmeterInputMeasurementData));
+    writer.beginObject();
+    writer.writeString("requestGuid", requestGuid().toUtf8());
+    writer.writeUuid("packageId", flowmeterInputIndicators.packageId);
 
-    QJsonArray JSONTanksMeasurements;
-    for(const auto& flowmeterOutputMeasurement: flowmeterInputIndicators.flowmeterInputMeasurements)
+    writer.beginArray("flowmetersInputMeasurements");
+    for(const auto& flowmeterMeasurement: flowmeterInputIndicators.flowmeterInputMeasurements)
     {
-        QJsonObject JSONTanksMeasurement;
-        JSONTanksMeasurement.insert("deviceId", static_cast<qint64>(flowmeterOutputMeasurement.deviceId));
+        writer.beginObject();
+        writer.writeNumber("deviceId", static_cast<qint64>(flowmeterMeasurement.deviceId));
 
-        QJsonArray JSONMeasurements;
-
-        for (const auto& measurement: flowmeterOutputMeasurement.flowmeterInputMeasurementData)
+        writer.beginArray("measurements");
+        for (const auto& measurement: flowmeterMeasurement.flowmeterInputMeasurementData)
         {
             if (!measurement.check())
             {
@@ -761,52 +768,127 @@ quint64 SUNCSync::sendSendFlowmeterInputIndicators(const FlowmeterInputIndicator
                 return sendId;
             }
 
-            QJsonObject JSONMeasument;
-
-            JSONMeasument.insert("measurementDate", measurement.measurementDate.toString(MEASUMENT_DATETIME_FORMAT));
-            JSONMeasument.insert("totalMass", measurement.totalMass);
-            JSONMeasument.insert("flowMass", measurement.flowMass);
-            JSONMeasument.insert("totalVolume", measurement.totalVolume);
-            JSONMeasument.insert("currentDensity", measurement.currentDensity);
-            JSONMeasument.insert("currentTemperature", measurement.currentTemperature);
-            JSONMeasument.insert("oilProductType", oilProductTypeToString(measurement.oilProductType));
-
-            JSONMeasurements.push_back(JSONMeasument);
+            writer.beginObject();
+            writer.writeDateTime("measurementDate", measurement.measurementDate);
+            writer.writeNumber("totalMass", measurement.totalMass);
+            writer.writeNumber("flowMass", measurement.flowMass);
+            writer.writeNumber("totalVolume", measurement.totalVolume);
+            writer.writeNumber("currentDensity", measurement.currentDensity);
+            writer.writeNumber("currentTemperature", measurement.currentTemperature);
+            writer.writeString("oilProductType", cachedEnumString(measurement.oilProductType, &oilProductTypeToString));
+            writer.endObject();
         }
+        writer.endArray();
 
-        JSONTanksMeasurement.insert("flowmetersInputMeasurements", JSONMeasurements);
-
-        JSONTanksMeasurements.push_back(JSONTanksMeasurement);
+        writer.endObject();
     }
+    writer.endArray();
 
-    data.insert("tanksMeasurements", JSONTanksMeasurements);
+    writer.endObject();
 
-    QJsonDocument body(data);
+    return sendPackage("/Device/SendFlowmeterInputIndicators", writer.take(), RequestType::SEND_FLOWERS_INPUT_INDICATOR);
+}
+
+quint64 SUNCSync::sendPackage(const QString& path, QByteArray&& body, RequestType type)
+{
+    if (!_circuitBreaker.allowRequest())
+    {
+        return skipRequest(path);
+    }
 
     auto headers(_headers);
     headers.emplace("Authorization", _remoteBearerToken.toUtf8());
 
+    //небольшие пакеты не сжимаем - заголовок gzip и затраты CPU не окупаются
+    const auto sourceSize = body.size();
+    qint64 compressTime = 0;
+    if (_compressionLevel > 0 && sourceSize >= MIN_COMPRESS_SIZE)
+    {
+        QElapsedTimer compressTimer;
+        compressTimer.start();
+
+        auto compressedBody = gzipCompress(body, _compressionLevel);
+
+        compressTime = compressTimer.nsecsElapsed();
+
+        //в случае ошибки сжатия отправляем данные как есть
+        if (!compressedBody.isEmpty())
+        {
+            body = std::move(compressedBody);
+            headers.emplace("Content-Encoding", "gzip");
+        }
+    }
+
     auto url = _baseUrl;
-    url.setPath("/Device/SendFlowmeterInputIndicators");
+    url.setPath(path);
 
-    const auto id = _query.send(url,
-                                HTTPSSLQuery::RequestType::POST,
-                                body.toJson(QJsonDocument::Compact),
-                                headers);
+    const auto bodySize = body.size();
+    const auto id = _httpClientPool->send(url,
+                                          HTTPSSLQuery::RequestType::POST,
+                                          body,
+                                          headers);
 
-    _requests.insert(id, RequestType::SEND_FLOWERS_OUTPUT_INDICATOR);
+    _requests.insert(id, type);
+
+    if (bodySize != sourceSize)
+    {
+        emit sendLogMsg(TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Request body compressed to %1 bytes from %2 bytes (%3%) in %4 ms. Path: %5")
+                            .arg(bodySize)
+                            .arg(sourceSize)
+                            .arg(100.0 * bodySize / sourceSize, 0, 'f', 1)
+                            .arg(static_cast<double>(compressTime) / 1000000.0, 0, 'f', 3)
+                            .arg(path), id);
+    }
 
     return id;
 }
 
+quint64 SUNCSync::skipRequest(const QString& requestName)
+{
+    const auto msg = QString("%1: Server is unavailable (circuit breaker %2). Request skipped. Retry after %3 ms")
+                         .arg(requestName)
+                         .arg(CircuitBreaker::stateToString(_circuitBreaker.state()))
+                         .arg(_circuitBreaker.retryAfter());
+    const auto sendId = HTTPSSLQuery::getId();
+    QTimer::singleShot(0, this, [this, msg, sendId](){ emit errorRequest(msg, PackageProcessingStatus::SERVER_UNAVAILABLE, sendId); });
+
+    return sendId;
+}
+
+void SUNCSync::requestFinished(bool success, quint64 id)
+{
+    const auto isChanged = success ? _circuitBreaker.success() : _circuitBreaker.failure();
+    if (!isChanged)
+    {
+        return;
+    }
+
+    if (_circuitBreaker.state() == CircuitBreaker::State::CLOSED)
+    {
+        emit sendLogMsg(TDBLoger::MSG_CODE::INFORMATION_CODE, QString("SUNC API server is available again. Requests resumed. URL: %1").arg(_baseUrl.toString()), id);
+    }
+    else
+    {
+        emit sendLogMsg(TDBLoger::MSG_CODE::WARNING_CODE, QString("SUNC API server is unavailable after %1 failed requests. Requests suspended for %2 ms. URL: %3")
+                            .arg(_circuitBreaker.failureCount())
+                            .arg(_circuitBreaker.retryAfter())
+                            .arg(_baseUrl.toString()), id);
+    }
+}
+
 void SUNCSync::getAnswerHTTP(const QByteArray &answer, quint64 id)
 {
+    //пул HTTP клиентов общий для всех организаций - пропускаем ответы на чужие запросы
     const auto it_requests = _requests.constFind(id);
-
-    Q_ASSERT(it_requests != _requests.end());
+    if (it_requests == _requests.end())
+    {
+        return;
+    }
 
     const auto type = it_requests.value();
 
+    requestFinished(true, id);
+
     switch (type)
     {
     case SUNCSync::RequestType::GET_PACKAGE_STATUS:
@@ -818,6 +900,9 @@ void SUNCSync::getAnswerHTTP(const QByteArray &answer, quint64 id)
     case SUNCSync::RequestType::SEND_TANK_INDICATORS:
         parseSendTankIndicators(answer, id);
         break;
+    case SUNCSync::RequestType::SEND_TANK_TRANSFER:
+        parseSendTankTransfers(answer, id);
+        break;
     case SUNCSync::RequestType::SEND_FLOWERS_OUTPUT_INDICATOR:
         parseSendFlowmeterOutputIndicators(answer, id);
         break;
@@ -835,12 +920,20 @@ void SUNCSync::getAnswerHTTP(const QByteArray &answer, quint64 id)
 void SUNCSync::errorOccurredHTTP(QNetworkReply::NetworkError code, quint64 serverCode, const QString& msg, quint64 id)
 {
     const auto it_requests = _requests.constFind(id);
-
-    Q_ASSERT(it_requests != _requests.end());
+    if (it_requests == _requests.end())
+    {
+        return;
+    }
 
     const auto errorMsg = QString("SUNC API HTTPS: %1").arg(msg);
 
-    emit errorRequest(msg, PackageProcessingStatus::HTTP_ERROR, id);
+    //ответ с кодом 4xx (кроме 429) означает ошибку в самом запросе, а не перегрузку сервера или канала связи
+    const auto isRequestError = serverCode >= 400 && serverCode < 500 && serverCode != 429;
+
+    //сервер ответил на запрос с ошибкой - значит он доступен, поэтому такой ответ не считается отказом сервера
+    requestFinished(isRequestError, id);
+
+    emit errorRequest(msg, isRequestError ? PackageProcessingStatus::REQUEST_ERROR : PackageProcessingStatus::HTTP_ERROR, id);
 
     _requests.erase(it_requests);
 }
@@ -848,8 +941,10 @@ void SUNCSync::errorOccurredHTTP(QNetworkReply::NetworkError code, quint64 serve
 void SUNCSync::sendLogMsgHTTP(Common::TDBLoger::MSG_CODE category, const QString &msg, quint64 id)
 {
     const auto it_requests = _requests.constFind(id);
-
-    Q_ASSERT(it_requests != _requests.end());
+    if (it_requests == _requests.end())
+    {
+        return;
+    }
 
     const auto logMsg = QString("SUNC API HTTPS request message: %1").arg(msg);
 
@@ -952,14 +1047,20 @@ void SUNCSync::parseGetApplicantData(const QByteArray &answerData, quint64 id)
             return;
         }
 
-        tmp.applicantData.applicantId = static_cast<qint64>(JSONReadNumber(data, "applicantId"));
-        tmp.applicantData.tokenNonce = JSONReadString(data, "tokenNonce");
+        if (!data["applicantData"].isObject())
+        {
+            throw ParseException(QString("Key (Root/applicantData) is not JSON object"));
+        }
+        const auto applicantData = data["applicantData"].toObject();
+
+        tmp.applicantData.applicantId = static_cast<qint64>(JSONReadNumber(applicantData, "applicantId"));
+        tmp.applicantData.tokenNonce = applicantData["tokenNonce"].toString();
 
-        if (!data["objects"].isArray())
+        if (!applicantData["objects"].isArray())
         {
-            throw ParseException(QString("Key (Root/objects) is not JSON array"));
+            throw ParseException(QString("Key (applicantData/objects) is not JSON array"));
         }
-        const auto objects = data["objects"].toArray();
+        const auto objects = applicantData["objects"].toArray();
         for (const auto objectRef: objects)
         {
             if (!objectRef.isObject())
@@ -981,15 +1082,24 @@ void SUNCSync::parseGetApplicantData(const QByteArray &answerData, quint64 id)
             const auto tanks = object["tanks"].toArray();
             for (const auto tankRef: tanks)
             {
-                if (!tankRef.isObject())
+                Tank tankData;
+
+                //сервер может возвращать как список ИД резервуаров, так и список объектов
+                if (tankRef.isDouble())
                 {
-                    throw ParseException(QString("Key (objects/object/tanks/tank) is not JSON object"));
+                    tankData.tankId = tankRef.toInteger();
                 }
-                const auto tank = tankRef.toObject();
+                else if (tankRef.isObject())
+                {
+                    const auto tank = tankRef.toObject();
 
-                Tank tankData;
-                tankData.tankId = static_cast<qint64>(JSONReadNumber(tank, "tankId"));
-                tankData.tankName = JSONReadString(tank, "tankName", false);
+                    tankData.tankId = static_cast<qint64>(JSONReadNumber(tank, "tankId"));
+                    tankData.tankName = JSONReadString(tank, "tankName", false);
+                }
+                else
+                {
+                    throw ParseException(QString("Key (objects/object/tanks/tank) is not JSON object or number"));
+                }
 
                 objData.tanks.emplaceBack(std::move(tankData));
             }
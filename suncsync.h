@@ -8,6 +8,9 @@
 //My
 #include "Common/httpsslquery.h"
 
+#include "circuitbreaker.h"
+#include "httpclientpool.h"
+
 namespace LevelGaugeService
 {
 
@@ -38,6 +41,8 @@ public:
         INCORRECT_DATA_ERROR = 3,   ///< Ошибка отправки - пакет содержит некорректные данные
         HTTP_ERROR = 4,             ///< Ошибка отправки - ошибка при пересылке данных. Необходимо повторить отправку
         SERVER_ERROR = 5,           ///<  Ошибка отправки - сервер не принял данные
+        SERVER_UNAVAILABLE = 6,     ///< Запрос не отправлен - сервер недоступен (открыт автоматический выключатель). В БД сохраняется как HTTP_ERROR
+        REQUEST_ERROR = 7,          ///< Сервер отклонил запрос с кодом 4xx (кроме 429). В БД сохраняется как HTTP_ERROR
         SUCCESS = 10                ///<  Сервер успешно принял данные и обработал их
     };
 
@@ -360,9 +365,13 @@ public:
 public:
     /*!
         Конструктор
+        @param httpClientPool - общий пул HTTP клиентов
+        @param baseUrl - адрес сервера
+        @param remoteBearerToken - токен авторизации
+        @param compressionLevel - уровень сжатия gzip тела запросов отправки данных. 0 - без сжатия
         @param parent - указатель на родительский класс
     */
-    explicit SUNCSync(const QUrl& baseUrl, const QString& remoteBearerToken, QObject* parent = nullptr);
+    SUNCSync(LevelGaugeService::HTTPClientPool* httpClientPool, const QUrl& baseUrl, const QString& remoteBearerToken, int compressionLevel = 0, QObject* parent = nullptr);
 
     /*!
         Деструктор
@@ -387,6 +396,17 @@ public:
     quint64 sendSendFlowmeterOutputIndicators(const FlowmeterOutputIndicators& flowmeterOutputIndicators);
     quint64 sendSendFlowmeterInputIndicators(const FlowmeterInputIndicators& flowmeterInputIndicators);
 
+    /*!
+        Возвращает true если сервер доступен и запрос может быть отправлен. После серии ошибок
+            запросы к серверу приостанавливаются с экспоненциально растущей задержкой
+    */
+    bool isAvailable() const { return _circuitBreaker.isAvailable(); }
+
+    /*!
+        Время до возобновления отправки запросов, мсек. 0 - запросы разрешены
+    */
+    qint64 retryAfter() const { return _circuitBreaker.retryAfter(); }
+
 signals:
     /*!
         Испускаеться при ошибке обработки запроса
@@ -412,6 +432,29 @@ private:
     // удаляем неиспользуемые конструкторы
     Q_DISABLE_COPY_MOVE(SUNCSync)
 
+    /*!
+        Отправляет пакет данных на сервер. При включенном сжатии тело запроса сжимается gzip
+        @param path - путь метода API
+        @param body - тело запроса
+        @param type - тип запроса
+        @return - ИД запроса
+    */
+    quint64 sendPackage(const QString& path, QByteArray&& body, RequestType type);
+
+    /*!
+        Отклоняет запрос без отправки на сервер, т.к. сервер недоступен. Генерирует сигнал errorRequest(...) со статусом SERVER_UNAVAILABLE
+        @param requestName - имя запроса для журнала
+        @return - ИД запроса
+    */
+    quint64 skipRequest(const QString& requestName);
+
+    /*!
+        Учитывает результат выполнения запроса в состоянии сервера
+        @param success - true если сервер ответил на запрос
+        @param id - ИД запроса
+    */
+    void requestFinished(bool success, quint64 id);
+
     void parseGetPackageStatus(const QByteArray& answerData, quint64 id);
     void parseGetApplicantData(const QByteArray& answerData, quint64 id);
     void parseSendTankIndicators(const QByteArray& answerData, quint64 id);
@@ -420,7 +463,7 @@ private:
     void parseSendFlowmeterInputIndicators(const QByteArray& answerData, quint64 id);
 
 private:
-    Common::HTTPSSLQuery _query;
+    LevelGaugeService::HTTPClientPool* _httpClientPool = nullptr; ///< Общий пул HTTP клиентов. Ответы пула содержат запросы всех организаций
     Common::HTTPSSLQuery::Headers _headers;
 
     QHash<quint64, RequestType> _requests;
@@ -429,6 +472,10 @@ private:
 
     const QUrl _baseUrl;
 
+    const int _compressionLevel = 0; ///< Уровень сжатия gzip. 0 - без сжатия
+
+    LevelGaugeService::CircuitBreaker _circuitBreaker; ///< Состояние доступности сервера
+
 };  //SUNCSync
 
 } // namespace LevelGaugeService
@@ -2,6 +2,10 @@
 #include "syncdbintake.h"
 #include "synchttpstatus.h"
 #include "synchttpintake.h"
+#include "synchttpflowmeter.h"
+#include "tconfig.h"
+#include "httpclientpool.h"
+#include "applicanttopologycache.h"
 
 #include "sync.h"
 
@@ -24,6 +28,18 @@ void SyncImpl::calculateIntakes(const LevelGaugeService::TankID& id, const Intak
 {
 }
 
+void SyncImpl::savedStatuses(const LevelGaugeService::SavedStatusesIDs& savedIDs)
+{
+}
+
+void SyncImpl::removeTanks(const LevelGaugeService::TankIDList& tanksId)
+{
+}
+
+void SyncImpl::addTanks(const LevelGaugeService::TankIDList& tanksId)
+{
+}
+
 void SyncImpl::start()
 {
 }
@@ -34,11 +50,49 @@ void SyncImpl::stop()
 
 Sync::Sync(const Common::DBConnectionInfo& dbConnectionInfo, TanksConfig* tanksConfig, QObject* parent /* = nullptr */)
     : QObject{parent}
+    , _tanksConfig(tanksConfig)
 {
-    Q_CHECK_PTR(tanksConfig);
+    Q_CHECK_PTR(_tanksConfig);
+
+    auto cnf = TConfig::config();
+    Q_CHECK_PTR(cnf);
+
+    FlushPolicy::Limits flushLimits;
+    flushLimits.maxRows = cnf->syncDB_FlushMaxRows();
+    flushLimits.maxBytes = cnf->syncDB_FlushMaxBytes();
+    flushLimits.maxAge = cnf->syncDB_FlushMaxAge();
+
+    PackageSizeController::Limits packageSizeLimits;
+    packageSizeLimits.minSize = cnf->syncHTTP_PackageMinSize();
+    packageSizeLimits.maxSize = cnf->syncHTTP_PackageMaxSize();
+    packageSizeLimits.sizeStep = cnf->syncHTTP_PackageSizeStep();
+    packageSizeLimits.minInterval = cnf->syncHTTP_SendMinInterval();
+    packageSizeLimits.maxInterval = cnf->syncHTTP_SendMaxInterval();
+    packageSizeLimits.intervalStep = cnf->syncHTTP_SendIntervalStep();
+    packageSizeLimits.fastAnswerTime = cnf->syncHTTP_FastAnswerTime();
+
+    HTTPClientPool::RequestTimeouts requestTimeouts;
+    requestTimeouts.defaultTimeout = cnf->syncHTTP_RequestTimeout();
+    requestTimeouts.pathTimeouts = cnf->syncHTTP_PathRequestTimeouts();
+
+    //HTTP клиенты общие для всех HTTP синхронизаторов
+    _httpClientPool = std::make_unique<HTTPClientPool>(requestTimeouts);
+
+    QObject::connect(_httpClientPool.get(), SIGNAL(sendLogMsg(const QString&, Common::TDBLoger::MSG_CODE, const QString&)),
+                     SLOT(sendLogMsgSync(const QString&, Common::TDBLoger::MSG_CODE, const QString&)));
+
+    //данные организаций на сервере для исключения из пакетов резервуаров и устройств, отсутствующих на сервере
+    _topologyCache = std::make_unique<ApplicantTopologyCache>(tanksConfig, _httpClientPool.get(), cnf->syncHTTP_ApplicantBINs(),
+                                                              cnf->syncHTTP_TopologyRefreshInterval());
+
+    QObject::connect(_topologyCache.get(), SIGNAL(sendLogMsg(const QString&, Common::TDBLoger::MSG_CODE, const QString&)),
+                     SLOT(sendLogMsgSync(const QString&, Common::TDBLoger::MSG_CODE, const QString&)));
 
     //HTTP Status
-    auto syncHTTPStatus = std::make_unique<SyncHTTPStatus>(dbConnectionInfo, tanksConfig);
+    auto syncHTTPStatus = std::make_unique<SyncHTTPStatus>(dbConnectionInfo, tanksConfig, _httpClientPool.get(), _topologyCache.get(),
+                                                          cnf->syncHTTP_CheckPackageWindow(), cnf->syncHTTP_SendPackageWindow(),
+                                                          cnf->syncHTTP_CompressionLevels(), packageSizeLimits, cnf->syncHTTP_StreamMode(),
+                                                          cnf->syncHTTP_RealtimeWindow(), cnf->syncHTTP_BacklogShare());
 
     QObject::connect(syncHTTPStatus.get(), SIGNAL(errorOccurred(const QString&, Common::EXIT_CODE, const QString&)),
                      SLOT(errorOccurredSync(const QString&, Common::EXIT_CODE, const QString&)));
@@ -48,7 +102,9 @@ Sync::Sync(const Common::DBConnectionInfo& dbConnectionInfo, TanksConfig* tanksC
     _syncList.emplace_back(std::move(syncHTTPStatus));
 
     //HTTP Intake
-    auto syncHTTPIntake = std::make_unique<SyncHTTPIntake>(dbConnectionInfo, tanksConfig);
+    auto syncHTTPIntake = std::make_unique<SyncHTTPIntake>(dbConnectionInfo, tanksConfig, _httpClientPool.get(), _topologyCache.get(),
+                                                          cnf->syncHTTP_CheckPackageWindow(), cnf->syncHTTP_CompressionLevels(),
+                                                          cnf->syncHTTP_SendIntakeInterval());
 
     QObject::connect(syncHTTPIntake.get(), SIGNAL(errorOccurred(const QString&, Common::EXIT_CODE, const QString&)),
                      SLOT(errorOccurredSync(const QString&, Common::EXIT_CODE, const QString&)));
@@ -57,18 +113,35 @@ Sync::Sync(const Common::DBConnectionInfo& dbConnectionInfo, TanksConfig* tanksC
 
     _syncList.emplace_back(std::move(syncHTTPIntake));
 
+    //HTTP Flowmeter
+    if (cnf->syncHTTP_FlowmeterEnabled())
+    {
+        auto syncHTTPFlowmeter = std::make_unique<SyncHTTPFlowmeter>(dbConnectionInfo, tanksConfig, _httpClientPool.get(), _topologyCache.get(),
+                                                                     cnf->syncHTTP_CheckPackageWindow(), cnf->syncHTTP_CompressionLevels(), packageSizeLimits);
+
+        QObject::connect(syncHTTPFlowmeter.get(), SIGNAL(errorOccurred(const QString&, Common::EXIT_CODE, const QString&)),
+                         SLOT(errorOccurredSync(const QString&, Common::EXIT_CODE, const QString&)));
+        QObject::connect(syncHTTPFlowmeter.get(), SIGNAL(sendLogMsg(const QString&, Common::TDBLoger::MSG_CODE, const QString&)),
+                         SLOT(sendLogMsgSync(const QString&, Common::TDBLoger::MSG_CODE, const QString&)));
+
+        _syncList.emplace_back(std::move(syncHTTPFlowmeter));
+    }
+
     //DB Status
-    auto syncDBStatus = std::make_unique<SyncDBStatus>(dbConnectionInfo, tanksConfig);
+    auto syncDBStatus = std::make_unique<SyncDBStatus>(dbConnectionInfo, tanksConfig, cnf->syncDB_SpoolFileName(), flushLimits,
+                                                       cnf->syncDB_ShardCount(), cnf->syncDB_WriteMode(), cnf->syncHTTP_StreamMode());
 
     QObject::connect(syncDBStatus.get(), SIGNAL(errorOccurred(const QString&, Common::EXIT_CODE, const QString&)),
                      SLOT(errorOccurredSync(const QString&, Common::EXIT_CODE, const QString&)));
     QObject::connect(syncDBStatus.get(), SIGNAL(sendLogMsg(const QString&, Common::TDBLoger::MSG_CODE, const QString&)),
                      SLOT(sendLogMsgSync(const QString&, Common::TDBLoger::MSG_CODE, const QString&)));
+    QObject::connect(syncDBStatus.get(), SIGNAL(statusesSaved(const LevelGaugeService::SavedStatusesIDs&)),
+                     SLOT(statusesSavedSync(const LevelGaugeService::SavedStatusesIDs&)));
 
     _syncList.emplace_back(std::move(syncDBStatus));
 
     //DB Intake
-    auto syncDBIntake = std::make_unique<SyncDBIntake>(dbConnectionInfo, tanksConfig);
+    auto syncDBIntake = std::make_unique<SyncDBIntake>(dbConnectionInfo, tanksConfig, flushLimits, cnf->syncDB_WriteMode());
 
     QObject::connect(syncDBIntake.get(), SIGNAL(errorOccurred(const QString&, Common::EXIT_CODE, const QString&)),
                      SLOT(errorOccurredSync(const QString&, Common::EXIT_CODE, const QString&)));
@@ -87,6 +160,12 @@ void Sync::calculateStatuses(const LevelGaugeService::TankID& id, const TankStat
 {
      Q_ASSERT(_isStarted);
 
+    //резервуар мог быть удален из конфигурации после вычисления статусов
+    if (!_tanksConfig->isExist(id))
+    {
+        return;
+    }
+
     for (auto& sync: _syncList)
     {
         sync->calculateStatuses(id, tankStatuses);
@@ -97,16 +176,31 @@ void Sync::calculateIntakes(const LevelGaugeService::TankID& id, const IntakesLi
 {
      Q_ASSERT(_isStarted);
 
+    if (!_tanksConfig->isExist(id))
+    {
+        return;
+    }
+
     for (auto& sync: _syncList)
     {
         sync->calculateIntakes(id, intakes);
     }
 }
 
+void Sync::statusesSavedSync(const LevelGaugeService::SavedStatusesIDs& savedIDs)
+{
+    for (auto& sync: _syncList)
+    {
+        sync->savedStatuses(savedIDs);
+    }
+}
+
 void Sync::start()
 {
     Q_ASSERT(!_isStarted);
 
+    _topologyCache->start();
+
     for (auto& sync: _syncList)
     {
         sync->start();
@@ -129,9 +223,41 @@ void Sync::stop()
 
     _syncList.clear();
 
+    _topologyCache->stop();
+
     _isStarted = false;
 }
 
+void Sync::removeTanks(const LevelGaugeService::TankIDList& tanksId)
+{
+    if (!_isStarted)
+    {
+        return;
+    }
+
+    for (auto& sync: _syncList)
+    {
+        sync->removeTanks(tanksId);
+    }
+
+    _topologyCache->removeTanks(tanksId);
+}
+
+void Sync::addTanks(const LevelGaugeService::TankIDList& tanksId)
+{
+    if (!_isStarted)
+    {
+        return;
+    }
+
+    _topologyCache->addTanks(tanksId);
+
+    for (auto& sync: _syncList)
+    {
+        sync->addTanks(tanksId);
+    }
+}
+
 void Sync::errorOccurredSync(const QString &syncName, Common::EXIT_CODE errorCode, const QString &errorString)
 {
     emit errorOccurred(errorCode, QString("Data synchronization error in module %1: %2").arg(syncName).arg(errorString));
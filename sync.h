@@ -13,6 +13,8 @@
 #include "tanksconfig.h"
 #include "tankstatuses.h"
 #include "intake.h"
+#include "httpclientpool.h"
+#include "applicanttopologycache.h"
 
 namespace LevelGaugeService
 {
@@ -52,6 +54,25 @@ public:
     */
     virtual void calculateIntakes(const LevelGaugeService::TankID& id, const LevelGaugeService::IntakesList& intakes);
 
+    /*!
+        Записи со статусами добавлены в БД другим синхронизатором
+        @param savedIDs - ИД добавленных записей
+    */
+    virtual void savedStatuses(const LevelGaugeService::SavedStatusesIDs& savedIDs);
+
+    /*!
+        Резервуары удаляются из конфигурации. Вызывается пока конфигурации резервуаров еще существуют.
+            Синхронизатор должен освободить ссылки на конфигурации и удалить ожидающие отправки данные резервуаров
+        @param tanksId - список ИД удаляемых резервуаров
+    */
+    virtual void removeTanks(const LevelGaugeService::TankIDList& tanksId);
+
+    /*!
+        Резервуары добавлены в конфигурацию. Вызывается после добавления конфигураций резервуаров
+        @param tanksId - список ИД добавленных резервуаров
+    */
+    virtual void addTanks(const LevelGaugeService::TankIDList& tanksId);
+
     /*!
         Вызывается при старте синхронизатора. Гарантируется что к моменту вызова сигналы  errorOccurred(...)
             и sendLogMsg(...) уже будут подключены к соотвестующим слотам.
@@ -80,6 +101,12 @@ signals:
     */
     void sendLogMsg(const QString& syncName, Common::TDBLoger::MSG_CODE category, const QString &msg);
 
+    /*!
+        Сигнал испускается после добавления записей со статусами в БД
+        @param savedIDs - ИД добавленных записей
+    */
+    void statusesSaved(const LevelGaugeService::SavedStatusesIDs& savedIDs);
+
 }; //class SyncImpl
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -126,6 +153,18 @@ public slots:
     */
     void stop();
 
+    /*!
+        Удаляет резервуары из синхронизаторов до удаления их конфигураций. Остальные резервуары продолжают синхронизироваться
+        @param tanksId - список ИД удаляемых резервуаров
+    */
+    void removeTanks(const LevelGaugeService::TankIDList& tanksId);
+
+    /*!
+        Добавляет резервуары в синхронизаторы после добавления их конфигураций
+        @param tanksId - список ИД добавленных резервуаров
+    */
+    void addTanks(const LevelGaugeService::TankIDList& tanksId);
+
 private slots:
     /*!
         Слот обработки сигналов errorOccurred(...) от синхронизаторов
@@ -137,6 +176,11 @@ private slots:
     */
     void sendLogMsgSync(const QString& syncName, Common::TDBLoger::MSG_CODE category, const QString &msg);
 
+    /*!
+        Слот обработки сигналов statusesSaved(...) от синхронизаторов. Передает ИД добавленных записей всем синхронизаторам
+    */
+    void statusesSavedSync(const LevelGaugeService::SavedStatusesIDs& savedIDs);
+
 signals:
     /*!
         Сигнал испускаться в случае фатальной ошибки и невозможности дальнейшей работы
@@ -157,6 +201,10 @@ signals:
     void started();
 
 private:
+    LevelGaugeService::TanksConfig* _tanksConfig = nullptr;
+
+    std::unique_ptr<LevelGaugeService::HTTPClientPool> _httpClientPool; ///< Общий пул HTTP клиентов. Должен удаляться после синхронизаторов
+    std::unique_ptr<LevelGaugeService::ApplicantTopologyCache> _topologyCache; ///< Кеш данных организаций на сервере. Должен удаляться после синхронизаторов
     std::list<std::unique_ptr<SyncImpl>> _syncList;  ///< Список указателей на синхронизаторы
     bool _isStarted = false;  ///< Флаг работы синхонизаторов (==true между вызовами start() и stop()
 
@@ -11,12 +11,17 @@ static const QString SYNC_NAME = "SyncDBIntake";
 
 SyncDBIntake::SyncDBIntake(const Common::DBConnectionInfo& dbConnectionInfo,
            LevelGaugeService::TanksConfig* tanksConfig,
+           const LevelGaugeService::FlushPolicy::Limits& flushLimits,
+           LevelGaugeService::DBWriteMode writeMode,
            QObject *parent /* = nullptr */)
     : SyncImpl{parent}
     , _tanksConfig(tanksConfig)
     , _dbConnectionInfo(dbConnectionInfo)
+    , _writeMode(writeMode)
+    , _flushPolicy(flushLimits)
 {
     Q_CHECK_PTR(_tanksConfig);
+    Q_ASSERT(_writeMode != DBWriteMode::UNDEFINE);
 }
 
 SyncDBIntake::~SyncDBIntake()
@@ -39,6 +44,12 @@ void SyncDBIntake::start()
         return;
     }
 
+    _saveTimer = new QTimer();
+
+    QObject::connect(_saveTimer, SIGNAL(timeout()), SLOT(checkFlush()));
+
+    _saveTimer->start(_flushPolicy.checkInterval());
+
     _isStarted = true;
 }
 
@@ -49,47 +60,44 @@ void SyncDBIntake::stop()
         return;
     }
 
+    saveToDB();
+
+    delete _saveTimer;
+    _saveTimer = nullptr;
+
     closeDB(_db);
-}
 
+    _isStarted = false;
+}
 
 void SyncDBIntake::calculateIntakes(const LevelGaugeService::TankID& id, const IntakesList &intakes)
 {
     Q_ASSERT(!intakes.empty());
     Q_ASSERT(_isStarted);
 
-    saveIntakesToDB(id, intakes);
-
-    QDateTime lastIntake = QDateTime::currentDateTime().addYears(-100);
-    for (const auto& intake: intakes)
+    const auto tankConfig = _tanksConfig->findTankConfig(id);
+    if (tankConfig == nullptr)
     {
-        lastIntake = std::max(lastIntake, intake.finishTankStatus().dateTime());
+        return;
     }
 
-    auto tankConfig = _tanksConfig->getTankConfig(id);
-    tankConfig->setLastIntake(lastIntake);
-}
-
-void SyncDBIntake::saveIntakesToDB(const LevelGaugeService::TankID& id, const LevelGaugeService::IntakesList& intakes)
-{
-    Q_ASSERT(!intakes.empty());
-    Q_ASSERT(_db.isOpen());
+    auto& intakesForSave = _intakesForSave[id];
 
-    const auto tankConfig = _tanksConfig->getTankConfig(id);
+    auto lastIntakes_it = _lastIntakesForSave.find(id);
+    if (lastIntakes_it == _lastIntakesForSave.end())
+    {
+        lastIntakes_it = _lastIntakesForSave.insert(id, QDateTime::currentDateTime().addYears(-100));
+    }
 
-    //вставляем в нашу таблицу
-    QDateTime lastIntake = QDateTime::currentDateTime().addYears(-100);
+    //строки VALUES формируются сразу, чтобы политика сохранения учитывала реальный объем запроса.
+    //Время сохранения ([DateTime]) добавляется при сохранении
+    qsizetype bytes = 0;
     for (const auto& intake: intakes)
     {
-        const auto queryText =
-            QString("INSERT INTO [dbo].[TanksIntake] "
-                        "([DateTime], [AZSCode], [TankNumber], [Product], [Status], "
-                        "[StartDateTime] ,[StartHeight], [StartVolume], [StartTemp], [StartDensity], [StartMass], "
-                        "[FinishDateTime], [FinishHeight], [FinishVolume], [FinishTemp], [FinishDensity], [FinishMass]) "
-                    "VALUES (CAST('%1' AS DATETIME2), '%2', %3, '%4', %5, "
-                        "CAST('%6' AS DATETIME2), %7, %8, %9, %10, %11, "
-                        "CAST('%12' AS DATETIME2), %13, %14, %15, %16, %17)")
-                .arg(QDateTime::currentDateTime().toString(DATETIME_FORMAT))
+        const auto values =
+            QString("'%1', %2, '%3', %4, "
+                        "CAST('%5' AS DATETIME2), %6, %7, %8, %9, %10, "
+                        "CAST('%11' AS DATETIME2), %12, %13, %14, %15, %16)")
                 .arg(id.levelGaugeCode())
                 .arg(id.tankNumber())
                 .arg(tankConfig->product())
@@ -107,15 +115,113 @@ void SyncDBIntake::saveIntakesToDB(const LevelGaugeService::TankID& id, const Le
                 .arg(intake.finishTankStatus().density(), 0, 'f', 1)
                 .arg(intake.finishTankStatus().mass(), 0, 'f', 0);
 
-        try
+        bytes += values.size();
+        intakesForSave.push_back(values);
+
+        lastIntakes_it.value() = std::max(lastIntakes_it.value(), intake.finishTankStatus().dateTime());
+    }
+
+    _flushPolicy.append(intakes.size(), bytes);
+
+    if (_flushPolicy.isFull())
+    {
+        saveToDB();
+    }
+}
+
+void SyncDBIntake::checkFlush()
+{
+    Q_ASSERT(_isStarted);
+
+    if (_flushPolicy.needFlush())
+    {
+        saveToDB();
+    }
+}
+
+void SyncDBIntake::saveToDB()
+{
+    Q_ASSERT(_db.isOpen());
+
+    if (_intakesForSave.empty())
+    {
+        return;
+    }
+
+    static const QString COLUMNS =
+        "([DateTime], [AZSCode], [TankNumber], [Product], [Status], "
+        "[StartDateTime] ,[StartHeight], [StartVolume], [StartTemp], [StartDensity], [StartMass], "
+        "[FinishDateTime], [FinishHeight], [FinishVolume], [FinishTemp], [FinishDensity], [FinishMass])";
+
+    static const QString INSERT_PREFIX = QString("INSERT INTO [dbo].[TanksIntake] %1 VALUES ").arg(COLUMNS);
+
+    //прием однозначно определяется резервуаром и временем начала
+    static const QString MERGE_PREFIX = "MERGE [dbo].[TanksIntake] WITH (HOLDLOCK) AS T USING (VALUES ";
+    static const QString MERGE_SUFFIX =
+        QString(") AS S %1 "
+                "ON T.[AZSCode] = S.[AZSCode] AND T.[TankNumber] = S.[TankNumber] AND T.[StartDateTime] = S.[StartDateTime] "
+                "WHEN NOT MATCHED BY TARGET THEN "
+                    "INSERT %1 "
+                    "VALUES (S.[DateTime], S.[AZSCode], S.[TankNumber], S.[Product], S.[Status], "
+                        "S.[StartDateTime], S.[StartHeight], S.[StartVolume], S.[StartTemp], S.[StartDensity], S.[StartMass], "
+                        "S.[FinishDateTime], S.[FinishHeight], S.[FinishVolume], S.[FinishTemp], S.[FinishDensity], S.[FinishMass]);")
+            .arg(COLUMNS);
+
+    const auto flushReason = _flushPolicy.reason();
+
+    quint64 recordCount = 0;
+
+    try
+    {
+        transactionDB(_db);
+
+        QSqlQuery query(_db);
+
+        const auto saveDateTimeStr = QString("(CAST('%1' AS DATETIME2), ").arg(QDateTime::currentDateTime().toString(DATETIME_FORMAT));
+
+        for (auto intakesForSave_it = _intakesForSave.begin(); intakesForSave_it != _intakesForSave.end(); ++intakesForSave_it)
         {
-            DBQueryExecute(_db, queryText);
+            //вставляем в нашу таблицу
+            for (const auto& values: intakesForSave_it.value())
+            {
+                const auto row = saveDateTimeStr + values;
+                const auto queryText = _writeMode == DBWriteMode::MERGE ? MERGE_PREFIX + row + MERGE_SUFFIX : INSERT_PREFIX + row;
+
+                if (!query.exec(queryText))
+                {
+                    throw SQLException(executeDBErrorString(_db, query));
+                }
+
+                ++recordCount;
+            }
         }
-        catch (const SQLException& err)
-        {
-            emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_EXECUTE_QUERY_ERR, err.what());
 
-            return;
+        commitDB(_db);
+    }
+    catch (const SQLException& err)
+    {
+        _db.rollback();
+
+        emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_EXECUTE_QUERY_ERR, err.what());
+
+        return;
+    }
+
+    //время последнего приема сохраняется в [TanksInfo], поэтому переносится в конфигурацию только после сохранения приемов в БД
+    for (auto lastIntakes_it = _lastIntakesForSave.begin(); lastIntakes_it != _lastIntakesForSave.end(); ++lastIntakes_it)
+    {
+        auto tankConfig = _tanksConfig->findTankConfig(lastIntakes_it.key());
+        if (tankConfig != nullptr)
+        {
+            tankConfig->setLastIntake(lastIntakes_it.value());
         }
     }
+
+    _intakesForSave.clear();
+    _lastIntakesForSave.clear();
+    _flushPolicy.reset();
+
+    emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Intakes saved to DB successfull. Count: %1. Reason: %2")
+                        .arg(recordCount)
+                        .arg(flushReason));
 }
@@ -14,12 +14,15 @@
 #include <QTimer>
 #include <QQueue>
 #include <QUuid>
+#include <QStringList>
 
 //My
 #include "Common/common.h"
 #include "tankstatuses.h"
 #include "tanksconfig.h"
 #include "intake.h"
+#include "flushpolicy.h"
+#include "dbwritemode.h"
 #include "sync.h"
 
 namespace LevelGaugeService
@@ -38,9 +41,13 @@ public:
         Конструктор
         @param dbConnectionInfo - ссылка на информацию о подключении к БД
         @param tankConfig - ссылка на конфигурацию резервуара
+        @param flushLimits - пороги сохранения накопленных приемов в БД
+        @param writeMode - режим записи в БД
         @param parent - указатель на родительский класс
     */
-    SyncDBIntake(const Common::DBConnectionInfo& dbConnectionInfo, LevelGaugeService::TanksConfig* tanksConfig, QObject* parent = nullptr);
+    SyncDBIntake(const Common::DBConnectionInfo& dbConnectionInfo, LevelGaugeService::TanksConfig* tanksConfig,
+                 const LevelGaugeService::FlushPolicy::Limits& flushLimits, LevelGaugeService::DBWriteMode writeMode,
+                 QObject* parent = nullptr);
 
     /*!
         Деструктор
@@ -56,16 +63,25 @@ private:
      SyncDBIntake() = delete;
      Q_DISABLE_COPY_MOVE(SyncDBIntake)
 
-    void saveIntakesToDB(const LevelGaugeService::TankID& id, const LevelGaugeService::IntakesList& intakes);
+private slots:
+    void checkFlush();
+    void saveToDB();
 
 private:
     TanksConfig* _tanksConfig;
     const Common::DBConnectionInfo _dbConnectionInfo;
+    const LevelGaugeService::DBWriteMode _writeMode = LevelGaugeService::DBWriteMode::INSERT;
 
     QSqlDatabase _db;      //база данных с исходными данными
 
     bool _isStarted = false;
 
+    QTimer* _saveTimer = nullptr;
+
+    QHash<LevelGaugeService::TankID, QStringList> _intakesForSave;    ///< Подготовленные строки VALUES приемов без времени сохранения
+    QHash<LevelGaugeService::TankID, QDateTime> _lastIntakesForSave;  ///< Время окончания последнего накопленного приема. Переносится в конфигурацию после сохранения в БД
+    LevelGaugeService::FlushPolicy _flushPolicy; ///< Политика сохранения накопленных приемов
+
 }; //class Sync
 
 } //namespace LevelGaugeService
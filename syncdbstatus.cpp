@@ -1,6 +1,13 @@
+//Qt
+#include <QCoreApplication>
+
 //My
 #include "Common/common.h"
 
+#include "tconfig.h"
+#include "statuswriter.h"
+#include "tankscalculatequery.h"
+
 #include "syncdbstatus.h"
 
 using namespace LevelGaugeService;
@@ -11,12 +18,26 @@ static const QString SYNC_NAME = "SyncToDBStatus";
 
 SyncDBStatus::SyncDBStatus(const Common::DBConnectionInfo& dbConnectionInfo,
            LevelGaugeService::TanksConfig* tanksConfig,
+           const QString& spoolFileName,
+           const LevelGaugeService::FlushPolicy::Limits& flushLimits,
+           quint32 shardCount,
+           LevelGaugeService::DBWriteMode writeMode,
+           bool returnSavedIDs,
            QObject *parent /* = nullptr */)
     : SyncImpl{parent}
     , _tanksConfig(tanksConfig)
     , _dbConnectionInfo(dbConnectionInfo)
+    , _flushPolicy(flushLimits)
+    , _shardCount(shardCount)
+    , _writeMode(writeMode)
+    , _returnSavedIDs(returnSavedIDs)
+    , _spool(spoolFileName)
 {
     Q_CHECK_PTR(_tanksConfig);
+    Q_ASSERT(_shardCount > 0);
+    Q_ASSERT(_writeMode != DBWriteMode::UNDEFINE);
+
+    qRegisterMetaType<LevelGaugeService::SavedStatusesIDs>("LevelGaugeService::SavedStatusesIDs");
 }
 
 SyncDBStatus::~SyncDBStatus()
@@ -41,11 +62,22 @@ void SyncDBStatus::start()
 
     _saveTimer = new QTimer();
 
-    QObject::connect(_saveTimer, SIGNAL(timeout()), SLOT(saveToDB()));
+    QObject::connect(_saveTimer, SIGNAL(timeout()), SLOT(checkFlush()));
+
+    _saveTimer->start(_flushPolicy.checkInterval());
+
+    _lastSaveTimer.start();
 
-    _saveTimer->start(30000);
+    _staticFragments.clear();
+
+    startShards();
 
     _isStarted = true;
+
+    if (_spool.hasData())
+    {
+        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("Spool file %1 contains unsaved statuses. They will be saved to DB").arg(_spool.fileName()));
+    }
 }
 
 void SyncDBStatus::stop()
@@ -57,9 +89,61 @@ void SyncDBStatus::stop()
 
     saveToDB();
 
+    stopShards();
+
     delete _saveTimer;
+    _saveTimer = nullptr;
 
     closeDB(_db);
+
+    _isStarted = false;
+}
+
+void SyncDBStatus::startShards()
+{
+    Q_ASSERT(_shards.empty());
+
+    for (quint32 i = 0; i < _shardCount; ++i)
+    {
+        Shard shard;
+        shard.thread = new QThread();
+        shard.writer = new StatusWriter(_dbConnectionInfo, QString("%1_Shard%2").arg(CONNECTION_TO_DB_NAME).arg(i));
+        shard.writer->moveToThread(shard.thread);
+
+        QObject::connect(shard.writer, SIGNAL(batchWrited(quint64, quint64, qint64, const LevelGaugeService::SavedStatusesIDs&)),
+                         SLOT(batchWrited(quint64, quint64, qint64, const LevelGaugeService::SavedStatusesIDs&)), Qt::QueuedConnection);
+        QObject::connect(shard.writer, SIGNAL(batchFailed(quint64, const QString&, bool)),
+                         SLOT(batchFailed(quint64, const QString&, bool)), Qt::QueuedConnection);
+
+        shard.thread->start();
+
+        _shards.push_back(shard);
+    }
+}
+
+void SyncDBStatus::stopShards()
+{
+    //дожидаемся завершения записи всех отправленных пакетов. Вызов ставится в очередь после них
+    for (auto& shard: _shards)
+    {
+        QMetaObject::invokeMethod(shard.writer, "stop", Qt::BlockingQueuedConnection);
+    }
+
+    //обрабатываем результаты записи, которые еще находятся в очереди
+    QCoreApplication::sendPostedEvents(this);
+
+    for (auto& shard: _shards)
+    {
+        shard.thread->quit();
+        shard.thread->wait();
+
+        delete shard.writer;
+        delete shard.thread;
+    }
+
+    _shards.clear();
+
+    Q_ASSERT(_writeBatches.empty());
 }
 
 void SyncDBStatus::calculateStatuses(const LevelGaugeService::TankID& id, const LevelGaugeService::TankStatusesList &tankStatuses)
@@ -67,113 +151,564 @@ void SyncDBStatus::calculateStatuses(const LevelGaugeService::TankID& id, const
     Q_ASSERT(!tankStatuses.empty());
     Q_ASSERT(_isStarted);
 
+    const auto tankConfig = _tanksConfig->findTankConfig(id);
+    if (tankConfig == nullptr)
+    {
+        return;
+    }
+
     auto dataForSave_it = _dataForSave.find(id);
     if (dataForSave_it == _dataForSave.end())
     {
          dataForSave_it = _dataForSave.insert(id, LevelGaugeService::TankStatusesList{});
     }
 
+    auto& rowsForSave = _rowsForSave[id];
+
+    //строки VALUES формируются сразу, чтобы политика сохранения учитывала реальный объем запросов
+    const auto& fragment = staticFragment(*tankConfig);
+    const auto timeShift = tankConfig->timeShift();
+
+    QElapsedTimer buildTimer;
+    buildTimer.start();
+
+    qsizetype bytes = 0;
     for(const auto& status: tankStatuses)
     {
+        auto row = renderRow(fragment, timeShift, status);
+        bytes += row.size();
+
+        rowsForSave.push_back(std::move(row));
         dataForSave_it.value().push_back(status);
     }
+
+    _rowsBuildTime += buildTimer.nsecsElapsed();
+
+    _flushPolicy.append(tankStatuses.size(), bytes);
+
+    //при всплеске данных сохраняем сразу, не дожидаясь таймера
+    if (_flushPolicy.isFull())
+    {
+        saveToDB();
+    }
 }
 
-void SyncDBStatus::saveToDB()
+void SyncDBStatus::checkFlush()
 {
-    Q_ASSERT(_db.isOpen());
+    Q_ASSERT(_isStarted);
 
-    if ( _dataForSave.empty())
+    //спул воспроизводим не чаще чем раз в допустимый возраст буфера, чтобы не переподключаться к БД слишком часто
+    const bool needReplay = _lastSaveTimer.elapsed() >= _flushPolicy.limits().maxAge && _spool.hasData();
+
+    if (_flushPolicy.needFlush() || needReplay)
+    {
+        saveToDB();
+    }
+}
+
+bool SyncDBStatus::checkDBConnection()
+{
+    if (!_isDBError)
+    {
+        return true;
+    }
+
+    try
+    {
+        closeDB(_db);
+        connectToDB(_db, _dbConnectionInfo, QString("%1").arg(CONNECTION_TO_DB_NAME));
+    }
+    catch (const SQLException& err)
+    {
+        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("DB is still unavailable. Error: %1").arg(err.what()));
+
+        return false;
+    }
+
+    _isDBError = false;
+
+    emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, "Connection to DB restored");
+
+    return true;
+}
+
+const QString& SyncDBStatus::staticFragment(const TankConfig& tankConfig)
+{
+    const auto& tankId = tankConfig.tankId();
+
+    auto staticFragments_it = _staticFragments.find(tankId);
+    if (staticFragments_it == _staticFragments.end())
+    {
+        const auto fragment = tanksCalculateFragment(tankId.levelGaugeCode(), tankId.tankNumber(), tankConfig.totalVolume(), tankConfig.product(),
+                                                     static_cast<quint8>(tankConfig.productStatus()), tankConfig.name(),
+                                                     static_cast<quint8>(tankConfig.type()), static_cast<quint8>(tankConfig.mode()));
+
+        staticFragments_it = _staticFragments.insert(tankId, fragment);
+    }
+
+    return staticFragments_it.value();
+}
+
+void SyncDBStatus::invalidateStaticFragment(const LevelGaugeService::TankID& id)
+{
+    _staticFragments.remove(id);
+}
+
+void SyncDBStatus::removeTanks(const LevelGaugeService::TankIDList& tanksId)
+{
+    //накопленные статусы не удаляются: статусы удаленного резервуара пропускаются при формировании запроса,
+    //фрагмент измененного резервуара будет сформирован заново по новой конфигурации
+    for (const auto& tankId: tanksId)
+    {
+        invalidateStaticFragment(tankId);
+    }
+}
+
+QString SyncDBStatus::renderRow(const QString& fragment, qint64 timeShift, const TankStatus& status)
+{
+    return tanksCalculateRow(fragment, status.dateTime(), timeShift, status.volume(), status.mass(), status.density(), status.height(), status.temp(),
+                             static_cast<quint8>(status.additionFlag()), static_cast<quint8>(status.status()));
+}
+
+quint64 SyncDBStatus::renderStatuses(const StatusesData& data, DBWriteMode writeMode, QStringList* queries, LastSaveDateTime* lastSave)
+{
+    Q_CHECK_PTR(queries);
+    Q_CHECK_PTR(lastSave);
+
+    QStringList rows;
+
+    for (auto dataForSave_it = data.begin(); dataForSave_it != data.end(); ++dataForSave_it)
+    {
+        //резервуар мог быть удален из конфигурации пока данные находились в спуле
+        const auto tankConfig = _tanksConfig->findTankConfig(dataForSave_it.key());
+        if (tankConfig == nullptr)
+        {
+            emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("Tank %1 have not config on [TanksInfo]. Statuses skipped. Count: %2")
+                                .arg(dataForSave_it.key().toString())
+                                .arg(dataForSave_it.value().size()));
+
+            invalidateStaticFragment(dataForSave_it.key());
+
+            continue;
+        }
+
+        const auto timeShift = tankConfig->timeShift();
+        const auto& fragment = staticFragment(*tankConfig);
+
+        QStringList tankRows;
+        for (const auto& status: dataForSave_it.value())
+        {
+            tankRows.push_back(renderRow(fragment, timeShift, status));
+        }
+
+        appendTankRows(dataForSave_it.value(), tankRows, writeMode, &rows);
+
+        lastSave->insert(dataForSave_it.key(), lastStatusDateTime(dataForSave_it.value()));
+    }
+
+    tanksCalculateQueries(rows, writeMode, _returnSavedIDs, tanksCalculateSaveDateTimeSuffix(), queries);
+
+    return rows.size();
+}
+
+void SyncDBStatus::appendTankRows(const TankStatusesList& tankStatuses, const QStringList& tankRows, DBWriteMode writeMode, QStringList* rows)
+{
+    Q_CHECK_PTR(rows);
+    Q_ASSERT(tankStatuses.size() == tankRows.size());
+
+    if (writeMode != DBWriteMode::MERGE)
     {
-        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, "No statuses for save to DB");
+        rows->append(tankRows);
 
         return;
     }
 
-    QHash<LevelGaugeService::TankID, QDateTime> lastStatuses;
+    //MERGE завершается ошибкой, если несколько строк источника соответствуют одной записи таблицы,
+    //поэтому из статусов с одинаковым временем остается последний
+    QHash<QDateTime, qsizetype> lastIndexes;
+    qsizetype index = 0;
+    for (const auto& status: tankStatuses)
+    {
+        lastIndexes.insert(status.dateTime(), index++);
+    }
 
-    quint64 recordCount = 0;
+    index = 0;
+    for (const auto& status: tankStatuses)
+    {
+        if (lastIndexes.value(status.dateTime()) == index)
+        {
+            rows->push_back(tankRows[index]);
+        }
+        ++index;
+    }
+}
+
+QDateTime SyncDBStatus::lastStatusDateTime(const TankStatusesList& tankStatuses)
+{
+    QDateTime result = QDateTime::currentDateTime().addYears(-100);
+    for (const auto& status: tankStatuses)
+    {
+        result = std::max(result, status.dateTime());
+    }
+
+    return result;
+}
+
+quint64 SyncDBStatus::insertStatuses(const StatusesData& data, DBWriteMode writeMode, LastSaveDateTime* lastSave)
+{
+    Q_ASSERT(_db.isOpen());
+
+    QStringList queries;
+    const auto recordCount = renderStatuses(data, writeMode, &queries, lastSave);
+
+    transactionDB(_db);
+
+    QSqlQuery query(_db);
+    for (const auto& queryText: queries)
+    {
+        if (!query.exec(queryText))
+        {
+            throw SQLException(executeDBErrorString(_db, query));
+        }
+    }
+
+    commitDB(_db);
+
+    return recordCount;
+}
+
+bool SyncDBStatus::replaySpool()
+{
+    if (!_spool.hasData())
+    {
+        return true;
+    }
+
+    StatusesData spoolData;
+    const auto readCount = _spool.beginReplay(&spoolData);
+    if (readCount < 0)
+    {
+        emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_EXECUTE_QUERY_ERR, QString("Cannot read statuses from spool: %1").arg(_spool.errorString()));
+
+        return false;
+    }
+
+    if (_spool.lastCorruptedCount() != 0)
+    {
+        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("Spool file %1 contains corrupted records. They was skipped. Count: %2")
+                            .arg(_spool.fileName())
+                            .arg(_spool.lastCorruptedCount()));
+    }
 
+    LastSaveDateTime lastStatuses;
+    quint64 recordCount = 0;
     try
     {
-        transactionDB(_db);
+        recordCount = insertStatuses(spoolData, DBWriteMode::MERGE, &lastStatuses);
+    }
+    catch (const SQLException& err)
+    {
+        _db.rollback();
 
-        QSqlQuery query(_db);
+        if (!StatusWriter::isConnectionAlive(_db))
+        {
+            _isDBError = true;
+
+            //файл воспроизведения остается на диске и будет повторно обработан при следующей попытке
+            emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("Cannot save statuses from spool to DB. Will retry later. Error: %1").arg(err.what()));
+
+            return false;
+        }
 
-        for (auto dataForSave_it = _dataForSave.begin(); dataForSave_it != _dataForSave.end(); ++dataForSave_it)
+        //ошибку данных повторное воспроизведение не исправит - файл откладывается, чтобы спул не рос бесконечно
+        const auto rejectedFileName = _spool.rejectReplay();
+        if (rejectedFileName.isEmpty())
         {
-            const auto tankConfig = _tanksConfig->getTankConfig(dataForSave_it.key());
-            const auto& tankId = tankConfig->tankId();
+            emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_EXECUTE_QUERY_ERR, QString("Cannot save statuses from spool to DB. Error: %1. Spool error: %2")
+                                   .arg(err.what())
+                                   .arg(_spool.errorString()));
+
+            return false;
+        }
+
+        emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_EXECUTE_QUERY_ERR, QString("Cannot save statuses from spool to DB. Spool data moved to %1. Error: %2")
+                               .arg(rejectedFileName)
+                               .arg(err.what()));
+
+        return false;
+    }
+
+    if (!_spool.commitReplay())
+    {
+        emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_EXECUTE_QUERY_ERR, QString("Statuses from spool saved to DB, but spool cannot be cleared: %1").arg(_spool.errorString()));
+
+        return false;
+    }
+
+    //все отложенные статусы сохранены - время последнего сохранения резервуаров больше не ограничивается спулом
+    if (!_spool.hasData())
+    {
+        _spoolLastSaveHolds.clear();
+    }
+
+    updateLastSave(lastStatuses);
+
+    emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Statuses from spool saved to DB successfull. Count: %1").arg(recordCount));
+
+    return true;
+}
+
+void SyncDBStatus::saveToSpool(const StatusesData& data, const QString& reason)
+{
+    if (data.empty())
+    {
+        return;
+    }
+
+    holdLastSave(data, &_spoolLastSaveHolds);
+
+    const auto count = _spool.append(data);
+    if (count < 0)
+    {
+        emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_EXECUTE_QUERY_ERR, QString("DB is unavailable (%1) and statuses cannot be saved to spool: %2")
+                               .arg(reason)
+                               .arg(_spool.errorString()));
+
+        return;
+    }
 
-            auto lastStatus_it = lastStatuses.insert(tankId, QDateTime::currentDateTime().addYears(-100));
+    emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("DB is unavailable. Statuses saved to spool file %1. Count: %2. Error: %3")
+                        .arg(_spool.fileName())
+                        .arg(count)
+                        .arg(reason));
+}
 
-            for (auto data_it = dataForSave_it.value().begin(); data_it != dataForSave_it.value().end(); ++data_it)
+void SyncDBStatus::updateLastSave(const LastSaveDateTime& lastSave)
+{
+    for (auto lastSave_it = lastSave.begin(); lastSave_it != lastSave.end(); ++lastSave_it)
+    {
+        auto tankConfig = _tanksConfig->findTankConfig(lastSave_it.key());
+        if (tankConfig == nullptr)
+        {
+            continue;
+        }
+
+        //время последнего сохранения не должно переходить через несохраненные статусы, иначе после перезапуска
+        //резервуар не пересчитает их заново
+        auto lastSave = lastSave_it.value();
+        for (const auto holds: {&_spoolLastSaveHolds, &_failedLastSaveHolds})
+        {
+            const auto holds_it = holds->constFind(lastSave_it.key());
+            if (holds_it != holds->end())
             {
-                const auto queryText =
-                    QString("INSERT INTO [dbo].[TanksCalculate] "
-                            "([AZSCode], [TankNumber], [DateTime], "
-                            "[Volume], [TotalVolume], [Mass], [Density], [Height], [Temp], [Product], [ProductStatus], "
-                            "[TankName], [Type], [AdditionFlag], [Status], [Mode], [SaveDateTime]) "
-                        "VALUES ("
-                            "'%1', %2, CAST('%3' AS DATETIME2), "
-                            "%4, %5, %6, %7, %8, %9, '%10', %11, "
-                            "'%12', %13, %14, %15, %16, CAST('%17' AS DATETIME2))")
-                .arg(tankId.levelGaugeCode())                                                           //1
-                .arg(tankId.tankNumber())                                                               //2
-                .arg(data_it->dateTime().addSecs(tankConfig->timeShift()).toString(DATETIME_FORMAT))    //3
-                .arg(data_it->volume(), 0, 'f', 0)                                                      //4
-                .arg(tankConfig->totalVolume(), 0, 'f', 0)                                              //5
-                .arg(data_it->mass(), 0, 'f', 0)                                                        //6
-                .arg(data_it->density(), 0, 'f', 1)                                                     //7
-                .arg(data_it->height(), 0, 'f', 1)                                                      //8
-                .arg(data_it->temp(), 0, 'f', 1)                                                        //9
-                .arg(tankConfig->product())                                                             //10
-                .arg(static_cast<quint8>(tankConfig->productStatus()))                                  //11
-                .arg(tankConfig->name())                                                                //12
-                .arg(static_cast<quint8>(tankConfig->type()))                                           //13
-                .arg(static_cast<quint8>(data_it->additionFlag()))                                      //14
-                .arg(static_cast<quint8>(data_it->status()))                                            //15
-                .arg( static_cast<quint8>(tankConfig->mode()))                                          //16
-                .arg((QDateTime::currentDateTime().toString(DATETIME_FORMAT)));                         //17
-
-                *lastStatus_it = std::max(lastStatus_it.value(), data_it->dateTime());
-
-                if (!query.exec(queryText))
-                {
-                    throw SQLException(executeDBErrorString(_db, query));
-                }
-
-                ++recordCount;
+                lastSave = std::min(lastSave, holds_it.value().addMSecs(-1));
             }
         }
 
-        commitDB(_db);
+        if (tankConfig->lastSave() < lastSave)
+        {
+            tankConfig->setLastSave(lastSave);
+        }
+    }
+}
+
+void SyncDBStatus::holdLastSave(const StatusesData& data, LastSaveDateTime* holds)
+{
+    Q_CHECK_PTR(holds);
 
-        _dataForSave.clear();
+    for (auto data_it = data.begin(); data_it != data.end(); ++data_it)
+    {
+        for (const auto& status: data_it.value())
+        {
+            auto holds_it = holds->find(data_it.key());
+            if (holds_it == holds->end())
+            {
+                holds->insert(data_it.key(), status.dateTime());
+            }
+            else if (status.dateTime() < holds_it.value())
+            {
+                holds_it.value() = status.dateTime();
+            }
+        }
     }
-    catch (const SQLException& err)
+}
+
+void SyncDBStatus::clearDataForSave()
+{
+    _dataForSave.clear();
+    _rowsForSave.clear();
+    _rowsBuildTime = 0;
+    _flushPolicy.reset();
+}
+
+void SyncDBStatus::saveToDB()
+{
+    Q_ASSERT(_isStarted);
+
+    const auto flushReason = _flushPolicy.reason();
+
+    _lastSaveTimer.restart();
+
+    if (!checkDBConnection())
     {
-        _db.rollback();
+        saveToSpool(_dataForSave, "No connection to DB");
+        clearDataForSave();
+
+        return;
+    }
+
+    //сначала сохраняем ранее накопленные данные, чтобы сохранить порядок записей
+    if (!replaySpool())
+    {
+        //при ошибке данных спула сервис останавливается, а новые статусы остаются в буфере
+        if (_isDBError)
+        {
+            saveToSpool(_dataForSave, "Spool replay failed");
+            clearDataForSave();
+        }
+
+        return;
+    }
+
+    if ( _dataForSave.empty())
+    {
+        return;
+    }
+
+    //распределяем статусы по секциям по коду АЗС. Каждая секция записывается своим писателем в отдельной транзакции
+    std::vector<StatusesData> shardsData(_shards.size());
+    std::vector<QStringList> shardsRows(_shards.size());
+    for (auto dataForSave_it = _dataForSave.begin(); dataForSave_it != _dataForSave.end(); ++dataForSave_it)
+    {
+        const auto shard = shardIndex(dataForSave_it.key());
+        appendTankRows(dataForSave_it.value(), _rowsForSave.value(dataForSave_it.key()), _writeMode, &shardsRows[shard]);
+        shardsData[shard].insert(dataForSave_it.key(), std::move(dataForSave_it.value()));
+    }
+
+    if (TConfig::config()->sys_DebugMode())
+    {
+        const auto recordCount = std::max<qsizetype>(_flushPolicy.rows(), 1);
+        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Query build time: %1 ns per row. Count: %2. Size: %3 bytes")
+                            .arg(_rowsBuildTime / recordCount)
+                            .arg(_flushPolicy.rows())
+                            .arg(_flushPolicy.bytes()));
+    }
+
+    clearDataForSave();
+
+    const auto rowSuffix = tanksCalculateSaveDateTimeSuffix();
+
+    for (size_t shard = 0; shard < shardsData.size(); ++shard)
+    {
+        if (shardsData[shard].empty())
+        {
+            continue;
+        }
 
-        emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_EXECUTE_QUERY_ERR, err.what());
+        WriteBatch batch;
+        batch.shard = shard;
+        batch.data = std::move(shardsData[shard]);
+        batch.count = shardsRows[shard].size();
+        batch.flushReason = flushReason;
+
+        for (auto data_it = batch.data.begin(); data_it != batch.data.end(); ++data_it)
+        {
+            batch.lastSave.insert(data_it.key(), lastStatusDateTime(data_it.value()));
+        }
+
+        QStringList queries;
+        tanksCalculateQueries(shardsRows[shard], _writeMode, _returnSavedIDs, rowSuffix, &queries);
+
+        const auto batchId = ++_lastBatchId;
+        _writeBatches.emplace(batchId, std::move(batch));
+
+        QMetaObject::invokeMethod(_shards[shard].writer, "writeBatch", Qt::QueuedConnection,
+                                  Q_ARG(quint64, batchId), Q_ARG(QStringList, queries));
     }
+}
+
+void SyncDBStatus::batchWrited(quint64 batchId, quint64 queryCount, qint64 writeTime, const LevelGaugeService::SavedStatusesIDs& savedIDs)
+{
+    const auto writeBatches_it = _writeBatches.find(batchId);
+    Q_ASSERT(writeBatches_it != _writeBatches.end());
 
-    QString lastStatusStr;
-    bool isFirst = true;
+    const auto& batch = writeBatches_it->second;
 
-    for (auto lastStatuses_it = lastStatuses.begin(); lastStatuses_it != lastStatuses.end(); ++lastStatuses_it)
+    updateLastSave(batch.lastSave);
+
+    emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Statuses saved to DB successfull. Shard: %1. Count: %2. Queries: %3. Write time: %4 ms. Reason: %5. Tanks: %6")
+                        .arg(batch.shard)
+                        .arg(batch.count)
+                        .arg(queryCount)
+                        .arg(writeTime)
+                        .arg(batch.flushReason)
+                        .arg(batch.lastSave.size()));
+
+    //список времени последнего сохранения растет с количеством резервуаров, поэтому формируется только в режиме отладки
+    if (TConfig::config()->sys_DebugMode())
     {
-        auto tankConfig = _tanksConfig->getTankConfig(lastStatuses_it.key());
-        tankConfig->setLastSave(lastStatuses_it.value());
+        QString lastStatusStr;
+        bool isFirst = true;
 
-        if (!isFirst)
+        for (auto lastStatuses_it = batch.lastSave.begin(); lastStatuses_it != batch.lastSave.end(); ++lastStatuses_it)
         {
-            lastStatusStr += ", ";
+            if (!isFirst)
+            {
+                lastStatusStr += ", ";
+            }
+            isFirst = false;
+
+            lastStatusStr += QString("%1=%2").arg(lastStatuses_it.key().toString()).arg(lastStatuses_it.value().toString(DATETIME_FORMAT));
         }
-        isFirst = false;
 
-        lastStatusStr += QString("%1=%2").arg(lastStatuses_it.key().toString()).arg(lastStatuses_it.value().toString(DATETIME_FORMAT));
+        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("New last save time. Shard: %1. %2")
+                            .arg(batch.shard)
+                            .arg(lastStatusStr));
+    }
+
+    _writeBatches.erase(writeBatches_it);
+
+    if (_returnSavedIDs && !savedIDs.isEmpty())
+    {
+        emit statusesSaved(savedIDs);
     }
+}
+
+void SyncDBStatus::batchFailed(quint64 batchId, const QString& errorString, bool isConnectionLost)
+{
+    const auto writeBatches_it = _writeBatches.find(batchId);
+    Q_ASSERT(writeBatches_it != _writeBatches.end());
+
+    //ошибку данных повторная запись не исправит, поэтому пакет в спул не сохраняется
+    if (!isConnectionLost)
+    {
+        const auto shard = writeBatches_it->second.shard;
+        const auto count = writeBatches_it->second.count;
+
+        //следующие пакеты не должны сдвигать время последнего сохранения за потерянные статусы
+        holdLastSave(writeBatches_it->second.data, &_failedLastSaveHolds);
+
+        _writeBatches.erase(writeBatches_it);
+
+        emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_EXECUTE_QUERY_ERR, QString("Cannot save statuses to DB. Shard: %1. Count: %2. Error: %3")
+                               .arg(shard)
+                               .arg(count)
+                               .arg(errorString));
+
+        return;
+    }
+
+    //до восстановления подключения основного соединения все новые данные будут сохраняться в спул
+    _isDBError = true;
+
+    saveToSpool(writeBatches_it->second.data, QString("Shard %1: %2").arg(writeBatches_it->second.shard).arg(errorString));
+
+    _writeBatches.erase(writeBatches_it);
+}
+
+size_t SyncDBStatus::shardIndex(const LevelGaugeService::TankID& id) const
+{
+    Q_ASSERT(!_shards.empty());
 
-    emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Statuses saved to DB successfull. Count: %1. New last save time: %2").arg(recordCount).arg(lastStatusStr));
+    return qHash(id.levelGaugeCode(), 0) % _shards.size();
 }
@@ -7,11 +7,16 @@
 
 //STL
 #include <queue>
+#include <vector>
+#include <unordered_map>
 
 //Qt
 #include <QObject>
 #include <QHash>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QStringList>
 #include <QQueue>
 #include <QUuid>
 
@@ -19,6 +24,10 @@
 #include "Common/common.h"
 #include "tankstatuses.h"
 #include "tanksconfig.h"
+#include "statusspool.h"
+#include "flushpolicy.h"
+#include "statuswriter.h"
+#include "dbwritemode.h"
 #include "sync.h"
 
 namespace LevelGaugeService
@@ -37,9 +46,16 @@ public:
         Конструктор
         @param dbConnectionInfo - ссылка на информацию о подключении к БД
         @param tankConfig - ссылка на конфигурации резервуаров
+        @param spoolFileName - имя файла спула, в который сохраняются статусы на время недоступности БД
+        @param flushLimits - пороги сохранения накопленных статусов в БД
+        @param shardCount - количество параллельных писателей. Статусы распределяются между ними по коду АЗС
+        @param writeMode - режим записи в БД
+        @param returnSavedIDs - возвращать ИД добавленных записей сигналом statusesSaved(...)
         @param parent - указатель на родительский класс
     */
-    SyncDBStatus(const Common::DBConnectionInfo& dbConnectionInfo, LevelGaugeService::TanksConfig* tanksConfig, QObject* parent = nullptr);
+    SyncDBStatus(const Common::DBConnectionInfo& dbConnectionInfo, LevelGaugeService::TanksConfig* tanksConfig,
+                 const QString& spoolFileName, const LevelGaugeService::FlushPolicy::Limits& flushLimits,
+                 quint32 shardCount, LevelGaugeService::DBWriteMode writeMode, bool returnSavedIDs, QObject* parent = nullptr);
 
     /*!
         Деструктор
@@ -47,17 +63,142 @@ public:
     ~SyncDBStatus();
 
     void calculateStatuses(const LevelGaugeService::TankID& id, const LevelGaugeService::TankStatusesList& tankStatuses) override;
+    void removeTanks(const LevelGaugeService::TankIDList& tanksId) override;
 
     void start() override;
     void stop() override;
 
+    /*!
+        Сбрасывает закешированный фрагмент запроса с постоянными значениями резервуара.
+            Должен вызываться при изменении конфигурации резервуара
+        @param id - ИД резервуара
+    */
+    void invalidateStaticFragment(const LevelGaugeService::TankID& id);
+
+private:
+     using StatusesData = LevelGaugeService::StatusSpool::StatusesData;
+     using LastSaveDateTime = QHash<LevelGaugeService::TankID, QDateTime>;
+
+     struct Shard
+     {
+         QThread* thread = nullptr;
+         LevelGaugeService::StatusWriter* writer = nullptr;
+     };
+
+     ///< Пакет статусов, переданный писателю и ожидающий результата записи
+     struct WriteBatch
+     {
+         size_t shard = 0;
+         StatusesData data;          ///< Исходные статусы. При ошибке записи сохраняются в спул
+         LastSaveDateTime lastSave;  ///< Время последнего статуса по каждому резервуару пакета
+         quint64 count = 0;
+         QString flushReason;
+     };
+
 private:
      SyncDBStatus() = delete;
      Q_DISABLE_COPY_MOVE(SyncDBStatus)
 
+     /*!
+        Проверяет подключение к БД и переподключается после ошибки
+        @return true - если БД доступна
+     */
+     bool checkDBConnection();
+
+     /*!
+        Формирует запросы на вставку статусов
+        @param data - статусы для сохранения
+        @param writeMode - режим записи в БД
+        @param queries - [out] список запросов
+        @param lastSave - [out] время последнего статуса по каждому резервуару
+        @return количество статусов
+     */
+     quint64 renderStatuses(const StatusesData& data, LevelGaugeService::DBWriteMode writeMode, QStringList* queries, LastSaveDateTime* lastSave);
+
+     /*!
+        Формирует строку VALUES статуса без завершающего значения [SaveDateTime]
+        @param fragment - фрагмент с постоянными значениями резервуара
+        @param timeShift - смещение времени резервуара, сек
+        @param status - статус
+        @return строка VALUES
+     */
+     static QString renderRow(const QString& fragment, qint64 timeShift, const LevelGaugeService::TankStatus& status);
+
+     static QDateTime lastStatusDateTime(const LevelGaugeService::TankStatusesList& tankStatuses);
+
+     /*!
+        Добавляет строки VALUES статусов резервуара. В режиме MERGE из статусов с одинаковым временем добавляется только последний
+        @param tankStatuses - статусы резервуара
+        @param tankRows - строки VALUES статусов резервуара в том же порядке
+        @param writeMode - режим записи в БД
+        @param rows - [out] список строк VALUES
+     */
+     static void appendTankRows(const LevelGaugeService::TankStatusesList& tankStatuses, const QStringList& tankRows,
+                                LevelGaugeService::DBWriteMode writeMode, QStringList* rows);
+
+     /*!
+        Сохраняет статусы в БД одной транзакцией через основное подключение. В случае ошибки генерирует SQLException
+        @param data - статусы для сохранения
+        @param writeMode - режим записи в БД
+        @param lastSave - [out] время последнего сохраненного статуса по каждому резервуару
+        @return количество сохраненных записей
+     */
+     quint64 insertStatuses(const StatusesData& data, LevelGaugeService::DBWriteMode writeMode, LastSaveDateTime* lastSave);
+
+     /*!
+        Сохраняет в БД ранее накопленные в спуле статусы. Спул воспроизводится через MERGE независимо от режима записи,
+            т.к. после аварийного завершения часть его статусов может уже находиться в БД
+        @return true - если спул пуст или успешно воспроизведен. При потере подключения к БД устанавливается _isDBError
+     */
+     bool replaySpool();
+
+     /*!
+        Сохраняет статусы в спул при недоступности БД
+     */
+     void saveToSpool(const StatusesData& data, const QString& reason);
+
+     /*!
+        Обновляет время последнего сохранения резервуаров. Время не сдвигается дальше самого старого
+            статуса, находящегося в спуле или потерянного при ошибке записи
+        @param lastSave - время последнего сохраненного статуса по каждому резервуару
+     */
+     void updateLastSave(const LastSaveDateTime& lastSave);
+
+     /*!
+        Запоминает время самого старого статуса каждого резервуара
+        @param data - несохраненные статусы
+        @param holds - [in/out] время самого старого несохраненного статуса по каждому резервуару
+     */
+     static void holdLastSave(const StatusesData& data, LastSaveDateTime* holds);
+
+     /*!
+        Очищает буфер статусов для сохранения
+     */
+     void clearDataForSave();
+
+     /*!
+        Возвращает фрагмент VALUES с постоянными значениями резервуара (AZSCode, TankNumber, TotalVolume,
+            Product, ProductStatus, TankName, Type, Mode). Фрагмент формируется один раз и кешируется
+        @param tankConfig - конфигурация резервуара
+     */
+     const QString& staticFragment(const LevelGaugeService::TankConfig& tankConfig);
+
+     void startShards();
+
+     /*!
+        Останавливает писателей, предварительно дождавшись записи всех переданных им пакетов
+     */
+     void stopShards();
+
+     size_t shardIndex(const LevelGaugeService::TankID& id) const;
+
 private slots:
+     void checkFlush();
      void saveToDB();
 
+     void batchWrited(quint64 batchId, quint64 queryCount, qint64 writeTime, const LevelGaugeService::SavedStatusesIDs& savedIDs);
+     void batchFailed(quint64 batchId, const QString& errorString, bool isConnectionLost);
+
 private:
     TanksConfig* _tanksConfig;
     const Common::DBConnectionInfo _dbConnectionInfo;
@@ -65,10 +206,28 @@ private:
     QSqlDatabase _db;      //база данных с исходными данными
 
     bool _isStarted = false;
+    bool _isDBError = false;  ///< Флаг ошибки БД. Данные сохраняются в спул до восстановления подключения
 
     QTimer* _saveTimer = nullptr;
+    QElapsedTimer _lastSaveTimer; ///< Время с последней попытки сохранения. Используется для повтора воспроизведения спула
+
+    StatusesData _dataForSave;  ///< Статусы для сохранения. При ошибке записи сохраняются в спул
+    QHash<LevelGaugeService::TankID, QStringList> _rowsForSave; ///< Строки VALUES статусов _dataForSave
+    qint64 _rowsBuildTime = 0;  ///< Время формирования строк _rowsForSave, нсек
+    LevelGaugeService::FlushPolicy _flushPolicy; ///< Политика сохранения накопленных статусов
+
+    QHash<LevelGaugeService::TankID, QString> _staticFragments; ///< Кеш фрагментов запроса с постоянными значениями резервуаров
+
+    const quint32 _shardCount = 1;
+    const LevelGaugeService::DBWriteMode _writeMode = LevelGaugeService::DBWriteMode::INSERT;
+    const bool _returnSavedIDs = false; ///< Запросы возвращают ИД добавленных записей
+    std::vector<Shard> _shards;  ///< Писатели статусов
+    std::unordered_map<quint64, WriteBatch> _writeBatches; ///< Пакеты ожидающие результата записи
+    quint64 _lastBatchId = 0;
 
-    QHash<LevelGaugeService::TankID, LevelGaugeService::TankStatusesList> _dataForSave;
+    LevelGaugeService::StatusSpool _spool; ///< Спул статусов на время недоступности БД
+    LastSaveDateTime _spoolLastSaveHolds;  ///< Время самого старого статуса резервуара в спуле. Очищается после воспроизведения спула
+    LastSaveDateTime _failedLastSaveHolds; ///< Время самого старого статуса резервуара, не сохраненного из-за ошибки данных
 
 }; //class Sync
 
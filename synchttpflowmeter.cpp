@@ -0,0 +1,818 @@
+//STL
+#include <algorithm>
+
+//Qt
+#include <QSqlResult>
+#include <QList>
+
+#include "synchttpflowmeter.h"
+
+using namespace LevelGaugeService;
+using namespace Common;
+
+static const QString CONNECTION_TO_DB_NAME = "SyncHTTPFlowmeter";
+static const QString SYNC_NAME = "SyncToHTTPFlowmeter";
+static const QString TABLE_NAME = "FlowmetersMeasurements";
+
+static const qint64 CHECK_PACKAGE_INTERVAL = 60 * 10;   ///< Интервал проверки статуса пакета, сек
+static const quint32 INIT_PACKAGE_SIZE = 1000;         ///< Начальный размер пакета показаний, записей
+
+template <typename TMeasurementData>
+static TMeasurementData measurementDataFromQuery(const QSqlQuery& query)
+{
+    TMeasurementData measurementData;
+    measurementData.measurementDate = query.value("DateTime").toDateTime();
+    measurementData.totalMass = query.value("TotalMass").toDouble();
+    measurementData.flowMass = query.value("FlowMass").toDouble();
+    measurementData.totalVolume = query.value("TotalVolume").toDouble();
+    measurementData.currentDensity = query.value("Density").toDouble();
+    measurementData.currentTemperature = query.value("Temp").toDouble();
+    measurementData.oilProductType = SUNCSync::stringToOilProductType(query.value("Product").toString());
+
+    return measurementData;
+}
+
+QString SyncHTTPFlowmeter::directionToString(Direction direction)
+{
+    switch (direction)
+    {
+    case Direction::UNDEFINED: return "Undefined";
+    case Direction::OUTPUT: return "Output";
+    case Direction::INPUT: return "Input";
+    default:
+        Q_ASSERT(false);
+    }
+
+    return "Undefined";
+}
+
+SyncHTTPFlowmeter::SyncHTTPFlowmeter(const Common::DBConnectionInfo& dbConnectionInfo, TanksConfig* tanksConfig, HTTPClientPool* httpClientPool,
+                                     ApplicantTopologyCache* topologyCache, quint32 checkPackageWindow, const CompressionLevels& compressionLevels, const PackageSizeController::Limits& packageSizeLimits,
+                                     QObject *parent /* = nullptr */)
+    : SyncImpl{parent}
+    , _dbConnectionInfo(dbConnectionInfo)
+    , _tanksConfig(tanksConfig)
+    , _httpClientPool(httpClientPool)
+    , _topologyCache(topologyCache)
+    , _compressionLevels(compressionLevels)
+    , _packageSizeLimits(packageSizeLimits)
+    , _packageTracker(SYNC_NAME, "flowmeter", &_packageIndex, checkPackageWindow)
+{
+    Q_CHECK_PTR(_tanksConfig);
+    Q_CHECK_PTR(_httpClientPool);
+    Q_CHECK_PTR(_topologyCache);
+
+    QObject::connect(&_packageTracker, SIGNAL(sendLogMsg(const QString&, Common::TDBLoger::MSG_CODE, const QString&)),
+                     SIGNAL(sendLogMsg(const QString&, Common::TDBLoger::MSG_CODE, const QString&)));
+    QObject::connect(&_packageTracker, SIGNAL(packageStatusReceived(const QUuid&, LevelGaugeService::SUNCSync::PackageProcessingStatus, const QString&)),
+                     SLOT(updatePackageStatus(const QUuid&, LevelGaugeService::SUNCSync::PackageProcessingStatus, const QString&)));
+    QObject::connect(&_packageTracker, SIGNAL(packageNotFound(const QUuid&)), SLOT(clearPackageStatus(const QUuid&)));
+}
+
+SyncHTTPFlowmeter::~SyncHTTPFlowmeter()
+{
+    stop();
+}
+
+void SyncHTTPFlowmeter::loadPackagesFromDB(const QStringList& AZSCodes /* = {} */)
+{
+    Q_ASSERT(_db.isOpen());
+
+    QStringList AZSFilterCodes;
+    for (const auto& AZSCode: AZSCodes)
+    {
+        AZSFilterCodes.push_back(QString("'%1'").arg(AZSCode));
+    }
+
+    const auto queryText =
+        QString("SELECT [PackageID], [AZSCode], MAX([SendStatus]) AS [SendStatus], MAX([UpdateStatusDateTime]) AS [UpdateStatusDateTime] "
+                "FROM [%1] "
+                "WHERE [PackageID] IS NOT NULL AND [SendStatus] IN (%2, %3, %4) %5"
+                "GROUP BY [PackageID], [AZSCode] ")
+            .arg(TABLE_NAME)
+            .arg(static_cast<quint8>(SUNCSync::PackageProcessingStatus::PENDING))
+            .arg(static_cast<quint8>(SUNCSync::PackageProcessingStatus::HTTP_ERROR))
+            .arg(static_cast<quint8>(SUNCSync::PackageProcessingStatus::SEND_TO_SERVER))
+            .arg(AZSFilterCodes.isEmpty() ? QString() : QString("AND [AZSCode] IN (%1) ").arg(AZSFilterCodes.join(',')));
+
+    if (AZSCodes.isEmpty())
+    {
+        _packageIndex.clear();
+    }
+
+    const auto oldSize = _packageIndex.size();
+
+    try
+    {
+        transactionDB(_db);
+
+        QSqlQuery query(_db);
+        query.setForwardOnly(true);
+
+        DBQueryExecute(_db, query, queryText);
+
+        while (query.next())
+        {
+            const auto packageId = query.value("PackageID").toUuid();
+            const auto applicants_it = _applicantsByAZS.constFind(query.value("AZSCode").toString());
+
+            if (packageId.isNull() || applicants_it == _applicantsByAZS.end())
+            {
+                continue;
+            }
+
+            //пакет был отправлен другой организации до изменения конфигурации и уже проверяется
+            const auto packageInfo = _packageIndex.package(packageId);
+            if (packageInfo != nullptr && packageInfo->applicantId != applicants_it.value())
+            {
+                continue;
+            }
+
+            const auto status = static_cast<SUNCSync::PackageProcessingStatus>(query.value("SendStatus").toUInt());
+            const auto nextCheck = query.value("UpdateStatusDateTime").toDateTime().addSecs(CHECK_PACKAGE_INTERVAL);
+
+            _packageIndex.addPackage(packageId, applicants_it.value(), status, nextCheck);
+        }
+
+        commitDB(_db);
+    }
+    catch (const SQLException& err)
+    {
+        _db.rollback();
+
+        emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_EXECUTE_QUERY_ERR, err.what());
+    }
+
+    if (_packageIndex.size() > oldSize)
+    {
+        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Find %1 unchecked flowmeter package").arg(_packageIndex.size() - oldSize));
+    }
+}
+
+QString SyncHTTPFlowmeter::AZSFilter(qint64 applicantID) const
+{
+    const auto& applicant = _suncSyncs.at(applicantID);
+
+    QStringList AZSCodes;
+    for (const auto& AZSCode: applicant.AZSCodes)
+    {
+        AZSCodes.push_back(QString("'%1'").arg(AZSCode));
+    }
+
+    auto result = QString("[AZSCode] IN (%1)").arg(AZSCodes.join(','));
+
+    //показания устройств, отсутствующих на сервере, не отправляем - сервер отклонит весь пакет
+    if (_topologyCache->isLoaded(applicantID))
+    {
+        QStringList devices;
+        for (const auto deviceId: _topologyCache->devices(applicantID))
+        {
+            devices.push_back(QString::number(deviceId));
+        }
+
+        if (devices.isEmpty())
+        {
+            return QString();
+        }
+
+        result += QString(" AND [DeviceID] IN (%1)").arg(devices.join(','));
+    }
+
+    return result;
+}
+
+bool SyncHTTPFlowmeter::sendNewIndicatorsFromDB(qint64 applicantID, Direction direction)
+{
+    Q_ASSERT(_db.isOpen());
+    Q_ASSERT(_isStarted);
+    Q_ASSERT(direction != Direction::UNDEFINED);
+
+    auto& applicant = _suncSyncs.at(applicantID);
+
+    const auto filter = AZSFilter(applicantID);
+    if (filter.isEmpty())
+    {
+        return false;
+    }
+
+    //записи с некорректными данными помечаются статусом INCORRECT_DATA_ERROR и повторно не выбираются
+    const auto queryText =
+        QString("SELECT TOP (%3) "
+                    "[ID], [DeviceID], [DateTime], [TotalMass], [FlowMass], [TotalVolume], [Density], [Temp], [Product] "
+                "FROM [%1] "
+                "WHERE %2 AND [Direction] = %4 AND [PackageID] IS NULL AND [SendStatus] IS NULL "
+                "ORDER BY [DateTime] ")
+            .arg(TABLE_NAME, filter, QString::number(applicant.sizeController->packageSize()), QString::number(static_cast<quint8>(direction)));
+
+    IdList sendIdList; ///< список ИД записей, которые будут отправлены в текущем пакете
+    IdList incorrectIdList; ///< список ИД записей с некорректными данными
+    std::unordered_map<qint64, QList<SUNCSync::FlowmeterOutputMeasurementData>> outputData; //key - deviceId
+    std::unordered_map<qint64, QList<SUNCSync::FlowmeterInputMeasurementData>> inputData; //key - deviceId
+    try
+    {
+        transactionDB(_db);
+
+        QSqlQuery query(_db);
+        query.setForwardOnly(true);
+
+        DBQueryExecute(_db, query, queryText);
+
+        while (query.next())
+        {
+            const auto recordID = query.value("ID").toString();
+            const auto deviceId = query.value("DeviceID").toLongLong();
+
+            QString incorrectData;
+            if (deviceId <= 0)
+            {
+                incorrectData = QString("Value [%1]/DeviceID must be positive").arg(TABLE_NAME);
+            }
+            else if (direction == Direction::OUTPUT)
+            {
+                auto measurementData = measurementDataFromQuery<SUNCSync::FlowmeterOutputMeasurementData>(query);
+                if (measurementData.check())
+                {
+                    outputData[deviceId].emplaceBack(std::move(measurementData));
+                }
+                else
+                {
+                    incorrectData = measurementData.toString();
+                }
+            }
+            else
+            {
+                auto measurementData = measurementDataFromQuery<SUNCSync::FlowmeterInputMeasurementData>(query);
+                if (measurementData.check())
+                {
+                    inputData[deviceId].emplaceBack(std::move(measurementData));
+                }
+                else
+                {
+                    incorrectData = measurementData.toString();
+                }
+            }
+
+            if (!incorrectData.isEmpty())
+            {
+                emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("Invalid value flowmeter measurement from [%1]. Record skipped. Data: %2. Record ID: %3")
+                                .arg(TABLE_NAME)
+                                .arg(incorrectData)
+                                .arg(recordID));
+
+                incorrectIdList.push_back(recordID);
+
+                continue;
+            }
+
+            sendIdList.push_back(recordID);
+        }
+
+        if (!incorrectIdList.isEmpty())
+        {
+            const auto updateQueryText =
+                QString("UPDATE [%1] "
+                        "SET [SendStatus] = %2, [UpdateStatusDateTime] = CAST('%3' AS DATETIME2), [ErrorText] = '%4' "
+                        "WHERE [ID] IN (%5) ")
+                    .arg(TABLE_NAME)
+                    .arg(static_cast<quint8>(SUNCSync::PackageProcessingStatus::INCORRECT_DATA_ERROR))
+                    .arg(QDateTime::currentDateTime().toString(DATETIME_FORMAT))
+                    .arg(QString("Incorrect data").toUtf8().toBase64())
+                    .arg(incorrectIdList.join(','));
+
+            DBQueryExecute(_db, updateQueryText);
+        }
+
+        commitDB(_db);
+    }
+    catch (const SQLException& err)
+    {
+        _db.rollback();
+
+        emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_EXECUTE_QUERY_ERR, err.what());
+
+        return false;
+    }
+
+    if (sendIdList.isEmpty())
+    {
+        return false;
+    }
+
+    const auto packageId = QUuid::createUuid();
+
+    PackageInfo packageInfo;
+    packageInfo.packageId = packageId;
+    packageInfo.applicantId = applicantID;
+    packageInfo.recordsCount = sendIdList.size();
+
+    quint64 sendId = 0;
+    if (direction == Direction::OUTPUT)
+    {
+        SUNCSync::FlowmeterOutputIndicators data;
+        data.packageId = packageId;
+        for (auto& [deviceId, measurementData]: outputData)
+        {
+            SUNCSync::FlowmeterOutputMeasurements measurements;
+            measurements.deviceId = deviceId;
+            measurements.flowmeterOutputMeasurementData = std::move(measurementData);
+            data.flowmeterOutputMeasurements.emplaceBack(std::move(measurements));
+        }
+
+        packageInfo.type = SUNCSync::RequestType::SEND_FLOWERS_OUTPUT_INDICATOR;
+        sendId = applicant.suncSync->sendSendFlowmeterOutputIndicators(data);
+    }
+    else
+    {
+        SUNCSync::FlowmeterInputIndicators data;
+        data.packageId = packageId;
+        for (auto& [deviceId, measurementData]: inputData)
+        {
+            SUNCSync::FlowmeterInputMeasurements measurements;
+            measurements.deviceId = deviceId;
+            measurements.flowmeterInputMeasurementData = std::move(measurementData);
+            data.flowmeterInputMeasurements.emplaceBack(std::move(measurements));
+        }
+
+        packageInfo.type = SUNCSync::RequestType::SEND_FLOWERS_INPUT_INDICATOR;
+        sendId = applicant.suncSync->sendSendFlowmeterInputIndicators(data);
+    }
+
+    packageInfo.sendTimer.start();
+
+    _sendedRequest.emplace(std::move(sendId), std::move(packageInfo));
+
+    updatePackageStatus(sendIdList, packageId, applicantID, SUNCSync::PackageProcessingStatus::SEND_TO_SERVER);
+
+    applicant.isSending = true;
+
+    emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Send flowmeter %1 package for applicant ID: %2. Package ID: %3. Record ID in [%4]: %5")
+                    .arg(directionToString(direction))
+                    .arg(applicantID)
+                    .arg(packageId.toString())
+                    .arg(TABLE_NAME)
+                    .arg(sendIdList.join(',')));
+
+    return true;
+}
+
+void SyncHTTPFlowmeter::updatePackageStatus(const IdList &idList, const QUuid& packageId, qint64 applicantId, SUNCSync::PackageProcessingStatus status)
+{
+    Q_ASSERT(!packageId.isNull());
+    Q_ASSERT(_db.isOpen());
+
+    try
+    {
+        transactionDB(_db);
+
+        const auto currentDateTime = QDateTime::currentDateTime().toString(DATETIME_FORMAT);
+
+        for (const auto& id: idList)
+        {
+            const auto queryText =
+                    QString("UPDATE [%1] "
+                            "SET [SendDateTime] = CAST('%2' AS DATETIME2), [UpdateStatusDateTime] = CAST('%3' AS DATETIME2), [PackageID] = '%4', [SendStatus] = %5 "
+                            "WHERE [ID] = %6 ")
+                    .arg(TABLE_NAME)
+                    .arg(currentDateTime)
+                    .arg(currentDateTime)
+                    .arg(packageId.toString())
+                    .arg(static_cast<quint8>(status))
+                    .arg(id);
+
+            QSqlQuery query(_db);
+
+            DBQueryExecute(_db, query, queryText);
+        }
+
+        commitDB(_db);
+
+        _packageIndex.addPackage(packageId, applicantId, status, QDateTime::currentDateTime().addSecs(CHECK_PACKAGE_INTERVAL));
+    }
+    catch (const SQLException& err)
+    {
+        _db.rollback();
+
+        emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_EXECUTE_QUERY_ERR, QString("Cannot create PackageID status. Package ID: %1. New status: %2. Records ID: %3. Error: %4")
+                           .arg(packageId.toString())
+                           .arg(SUNCSync::packageProcessingStatusToString(status))
+                           .arg(idList.join(','))
+                           .arg(err.what()));
+    }
+}
+
+void SyncHTTPFlowmeter::updatePackageStatus(const QUuid &packageId, SUNCSync::PackageProcessingStatus status, const QString &errorMessage)
+{
+    Q_ASSERT(!packageId.isNull());
+    Q_ASSERT(_db.isOpen());
+
+    const auto msg = errorMessage.toUtf8().toBase64();
+
+    const auto queryText =
+                QString("UPDATE [%1] "
+                        "SET [SendStatus] = %2, [UpdateStatusDateTime] = CAST('%3' AS DATETIME2), [ErrorText] = '%4' "
+                        "WHERE [PackageID] = '%5' ")
+                .arg(TABLE_NAME)
+                .arg(static_cast<quint8>(status))
+                .arg(QDateTime::currentDateTime().toString(DATETIME_FORMAT))
+                .arg(msg)
+                .arg(packageId.toString());
+
+    try
+    {
+        DBQueryExecute(_db, queryText);
+
+        _packageIndex.updateStatus(packageId, status, QDateTime::currentDateTime().addSecs(CHECK_PACKAGE_INTERVAL));
+    }
+    catch (const SQLException& err)
+    {
+        emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_EXECUTE_QUERY_ERR, QString("Cannot update Package ID status. Package ID: %1. New status: %2. Error: %3")
+                           .arg(packageId.toString())
+                           .arg(SUNCSync::packageProcessingStatusToString(status))
+                           .arg(err.what()));
+    }
+}
+
+void SyncHTTPFlowmeter::clearPackageStatus(const QUuid &packageId)
+{
+    Q_ASSERT(!packageId.isNull());
+    Q_ASSERT(_db.isOpen());
+
+    //после очистки записи будут отправлены повторно в новом пакете
+    const auto queryText =
+                QString("UPDATE [%1] "
+                        "SET [PackageID] = NULL, [SendStatus] = NULL "
+                        "WHERE [PackageID] = '%2' ")
+                .arg(TABLE_NAME)
+                .arg(packageId.toString());
+
+    try
+    {
+        DBQueryExecute(_db, queryText);
+
+        _packageIndex.remove(packageId);
+    }
+    catch (const SQLException& err)
+    {
+        emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_EXECUTE_QUERY_ERR, QString("Cannot clear [%1]/Package ID. Package ID: %2. Error: %3")
+                           .arg(TABLE_NAME)
+                           .arg(packageId.toString())
+                           .arg(err.what()));
+    }
+}
+
+bool SyncHTTPFlowmeter::addApplicantAZS(const TankID& tankId)
+{
+    const auto tankConfig =  _tanksConfig->getTankConfig(tankId);
+    const auto applicantId = tankConfig->remoteApplicantId();
+    const auto& AZSCode = tankId.levelGaugeCode();
+
+    const auto applicants_it = _applicantsByAZS.constFind(AZSCode);
+    if (applicants_it != _applicantsByAZS.end())
+    {
+        if (applicants_it.value() != applicantId)
+        {
+            emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("AZS %1 belongs to several applicants (ID: %2 and %3). Flowmeters will be sent to applicant ID: %2")
+                            .arg(AZSCode)
+                            .arg(applicants_it.value())
+                            .arg(applicantId));
+        }
+
+        return false;
+    }
+
+    _applicantsByAZS.insert(AZSCode, applicantId);
+
+    auto suncSyncs_it = _suncSyncs.find(applicantId);
+    if (suncSyncs_it != _suncSyncs.end())
+    {
+        suncSyncs_it->second.AZSCodes.push_back(AZSCode);
+
+        return true;
+    }
+
+    ApplicantData applicant;
+    applicant.AZSCodes.push_back(AZSCode);
+    applicant.suncSync = std::make_unique<SUNCSync>(_httpClientPool, tankConfig->remoteBaseUrl(), tankConfig->remoteBearerToken(),
+                                                     _compressionLevels.level(applicantId));
+
+    QObject::connect(applicant.suncSync.get(), SIGNAL(errorRequest(const QString&, LevelGaugeService::SUNCSync::PackageProcessingStatus, quint64)),
+                                 SLOT(errorRequest(const QString&, LevelGaugeService::SUNCSync::PackageProcessingStatus, quint64)));
+    QObject::connect(applicant.suncSync.get(), SIGNAL(sendLogMsg(Common::TDBLoger::MSG_CODE, const QString&, quint64)),
+                                 SLOT(sendLogMsgHTTP(Common::TDBLoger::MSG_CODE, const QString&, quint64)));
+    QObject::connect(applicant.suncSync.get(), SIGNAL(sendFlowmeterOutputIndicators(const LevelGaugeService::SUNCSync::FlowmeterOutputIndicatorsInfo&, quint64)),
+                                 SLOT(sendFlowmeterOutputIndicators(const LevelGaugeService::SUNCSync::FlowmeterOutputIndicatorsInfo&, quint64)));
+    QObject::connect(applicant.suncSync.get(), SIGNAL(sendFlowmeterInputIndicators(const LevelGaugeService::SUNCSync::FlowmeterInputIndicatorsInfo&, quint64)),
+                                 SLOT(sendFlowmeterInputIndicators(const LevelGaugeService::SUNCSync::FlowmeterInputIndicatorsInfo&, quint64)));
+
+    applicant.sizeController = std::make_unique<PackageSizeController>(_packageSizeLimits, INIT_PACKAGE_SIZE);
+    applicant.nextSend = QDateTime::currentDateTime().addMSecs(applicant.sizeController->sendInterval());
+
+    _packageTracker.addApplicant(applicantId, applicant.suncSync.get());
+
+    _suncSyncs.emplace(applicantId, std::move(applicant));
+
+    return true;
+}
+
+void SyncHTTPFlowmeter::removeTanks(const LevelGaugeService::TankIDList& tanksId)
+{
+    if (!_isStarted)
+    {
+        return;
+    }
+
+    const QSet<TankID> removedTanks(tanksId.begin(), tanksId.end());
+
+    //АЗС остается у организации, пока в конфигурации есть другие резервуары этой АЗС
+    QSet<QString> removedAZSCodes;
+    for (const auto& tankId: tanksId)
+    {
+        removedAZSCodes.insert(tankId.levelGaugeCode());
+    }
+
+    for (const auto& tankId: _tanksConfig->getTanksID())
+    {
+        if (!removedTanks.contains(tankId))
+        {
+            removedAZSCodes.remove(tankId.levelGaugeCode());
+        }
+    }
+
+    for (const auto& AZSCode: removedAZSCodes)
+    {
+        const auto applicants_it = _applicantsByAZS.find(AZSCode);
+        if (applicants_it == _applicantsByAZS.end())
+        {
+            continue;
+        }
+
+        const auto applicantId = applicants_it.value();
+        _applicantsByAZS.erase(applicants_it);
+
+        const auto suncSyncs_it = _suncSyncs.find(applicantId);
+        if (suncSyncs_it == _suncSyncs.end())
+        {
+            continue;
+        }
+
+        auto& applicant = suncSyncs_it->second;
+        applicant.AZSCodes.removeAll(AZSCode);
+
+        if (!applicant.AZSCodes.isEmpty())
+        {
+            continue;
+        }
+
+        //у организации не осталось АЗС. Ответы на отправленные запросы будут пропущены
+        _packageTracker.removeApplicant(applicantId);
+        _packageIndex.removeApplicant(applicantId);
+        _sendedRequest.removeIf([applicantId](QHash<quint64, PackageInfo>::iterator it){ return it->applicantId == applicantId; });
+
+        _suncSyncs.erase(suncSyncs_it);
+
+        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Applicant has no AZS and removed. Applicant ID: %1").arg(applicantId));
+    }
+}
+
+void SyncHTTPFlowmeter::addTanks(const LevelGaugeService::TankIDList& tanksId)
+{
+    if (!_isStarted)
+    {
+        return;
+    }
+
+    QStringList addedAZSCodes;
+    for (const auto& tankId: tanksId)
+    {
+        if (_tanksConfig->isExist(tankId) && addApplicantAZS(tankId))
+        {
+            addedAZSCodes.push_back(tankId.levelGaugeCode());
+        }
+    }
+
+    if (!addedAZSCodes.isEmpty())
+    {
+        loadPackagesFromDB(addedAZSCodes);
+    }
+}
+
+void SyncHTTPFlowmeter::start()
+{
+    Q_ASSERT(!_isStarted);
+
+    for (const auto& tankId: _tanksConfig->getTanksID())
+    {
+        addApplicantAZS(tankId);
+    }
+
+    try
+    {
+        connectToDB(_db, _dbConnectionInfo, QString("%1").arg(CONNECTION_TO_DB_NAME));
+    }
+    catch (const SQLException& err)
+    {
+        emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_NOT_CONNECT, err.what());
+
+        return;
+    }
+
+    loadPackagesFromDB();
+
+    _packageTracker.start();
+
+    //send indicators
+    Q_ASSERT(_sendIndicatorsTimer == nullptr);
+    _sendIndicatorsTimer = new QTimer();
+
+    QObject::connect(_sendIndicatorsTimer, SIGNAL(timeout()), SLOT(sendNewIndicators()));
+
+    _sendIndicatorsTimer->start(1000);
+
+    _isStarted = true;
+}
+
+void SyncHTTPFlowmeter::stop()
+{
+    if (!_isStarted)
+    {
+        return;
+    }
+
+    _packageTracker.stop();
+
+    _suncSyncs.clear();
+    _applicantsByAZS.clear();
+    _sendedRequest.clear();
+    _packageIndex.clear();
+
+    delete _sendIndicatorsTimer;
+    _sendIndicatorsTimer = nullptr;
+
+    closeDB(_db);
+
+    _isStarted = false;
+}
+
+void SyncHTTPFlowmeter::sendNewIndicators()
+{
+    Q_ASSERT(_isStarted);
+
+    const auto currentDateTime = QDateTime::currentDateTime();
+    for (auto& [applicantId, applicant]: _suncSyncs)
+    {
+        if (applicant.isSending || applicant.nextSend > currentDateTime || !applicant.suncSync->isAvailable())
+        {
+            continue;
+        }
+
+        applicant.nextSend = currentDateTime.addMSecs(applicant.sizeController->sendInterval());
+
+        //направления чередуем, чтобы большой объем показаний одного направления не задерживал отправку другого
+        const auto firstDirection = applicant.nextDirection;
+        const auto secondDirection = firstDirection == Direction::OUTPUT ? Direction::INPUT : Direction::OUTPUT;
+        if (sendNewIndicatorsFromDB(applicantId, firstDirection))
+        {
+            applicant.nextDirection = secondDirection;
+        }
+        else
+        {
+            sendNewIndicatorsFromDB(applicantId, secondDirection);
+        }
+    }
+}
+
+void SyncHTTPFlowmeter::sendLogMsgHTTP(Common::TDBLoger::MSG_CODE category, const QString &msg, quint64 id)
+{
+    emit sendLogMsg(SYNC_NAME, category, msg);
+}
+
+void SyncHTTPFlowmeter::errorRequest(const QString &msg, LevelGaugeService::SUNCSync::PackageProcessingStatus status, quint64 id)
+{
+    if (!_isStarted)
+    {
+        return;
+    }
+
+    //ошибки запросов проверки статуса пакета обрабатывает PackageTracker
+    const auto sendedRequest_it = _sendedRequest.find(id);
+    if (sendedRequest_it == _sendedRequest.end())
+    {
+        return;
+    }
+
+    const auto& packageInfo = sendedRequest_it.value();
+
+    Q_ASSERT(packageInfo.type == SUNCSync::RequestType::SEND_FLOWERS_OUTPUT_INDICATOR ||
+             packageInfo.type == SUNCSync::RequestType::SEND_FLOWERS_INPUT_INDICATOR);
+
+    switch (status)
+    {
+    case SUNCSync::PackageProcessingStatus::INCORRECT_DATA_ERROR:
+        updatePackageStatus(packageInfo.packageId, status, msg);
+
+        break;
+    case SUNCSync::PackageProcessingStatus::HTTP_ERROR:
+    case SUNCSync::PackageProcessingStatus::SERVER_UNAVAILABLE:
+    case SUNCSync::PackageProcessingStatus::REQUEST_ERROR:
+        updatePackageStatus(packageInfo.packageId, SUNCSync::PackageProcessingStatus::HTTP_ERROR, msg);
+        _packageTracker.sendFailed(packageInfo.packageId, packageInfo.applicantId);
+        //размер пакета уменьшается только при перегрузке сервера или канала связи. Запрос, отклоненный без отправки
+        //или из-за ошибки в самом запросе, о перегрузке не говорит
+        if (status == SUNCSync::PackageProcessingStatus::HTTP_ERROR)
+        {
+            packageSent(packageInfo, false);
+        }
+
+        break;
+    default:
+        Q_ASSERT(false);
+    }
+
+    emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("An unsuccessful attempt to send flowmeter data to the server. Package ID: %1. Status: %2. Message: %3")
+                         .arg(packageInfo.packageId.toString())
+                         .arg(SUNCSync::packageProcessingStatusToString(status))
+                         .arg(msg));
+
+    finishSendPackage(packageInfo);
+
+    _sendedRequest.erase(sendedRequest_it);
+}
+
+void SyncHTTPFlowmeter::sendFlowmeterOutputIndicators(const SUNCSync::FlowmeterOutputIndicatorsInfo& indicators, quint64 id)
+{
+    indicatorsSent(id, indicators.success, indicators.error);
+}
+
+void SyncHTTPFlowmeter::sendFlowmeterInputIndicators(const SUNCSync::FlowmeterInputIndicatorsInfo& indicators, quint64 id)
+{
+    indicatorsSent(id, indicators.success, indicators.error);
+}
+
+void SyncHTTPFlowmeter::indicatorsSent(quint64 id, bool success, const QString& error)
+{
+    if (!_isStarted)
+    {
+        return;
+    }
+
+    //запрос организации, удаленной при изменении конфигурации резервуаров
+    const auto sendedRequest_it = _sendedRequest.find(id);
+    if (sendedRequest_it == _sendedRequest.end())
+    {
+        return;
+    }
+
+    const auto& packageInfo = sendedRequest_it.value();
+
+    if (success)
+    {
+        updatePackageStatus(packageInfo.packageId, SUNCSync::PackageProcessingStatus::PENDING, "");
+
+        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Flowmeter package sended to the server successfully and chenged status to PENDING. Package ID: %1")
+                    .arg(packageInfo.packageId.toString()));
+    }
+    else
+    {
+        updatePackageStatus(packageInfo.packageId, SUNCSync::PackageProcessingStatus::SERVER_ERROR, error);
+
+        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("Failed to sending flowmeter package to the server and chenged status to SERVER_ERROR. Package ID: %1. Error: %2")
+                    .arg(packageInfo.packageId.toString())
+                    .arg(error));
+    }
+
+    packageSent(packageInfo, success);
+
+    finishSendPackage(packageInfo);
+
+    _sendedRequest.erase(sendedRequest_it);
+}
+
+void SyncHTTPFlowmeter::packageSent(const PackageInfo& packageInfo, bool success)
+{
+    const auto suncSyncs_it = _suncSyncs.find(packageInfo.applicantId);
+    if (suncSyncs_it == _suncSyncs.end())
+    {
+        return;
+    }
+
+    auto& sizeController = suncSyncs_it->second.sizeController;
+    const auto isChanged = success ? sizeController->success(packageInfo.sendTimer.elapsed(), packageInfo.recordsCount) : sizeController->failure();
+    if (isChanged)
+    {
+        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Flowmeter package parameters changed for applicant ID: %1. %2")
+                        .arg(packageInfo.applicantId)
+                        .arg(sizeController->toString()));
+    }
+}
+
+void SyncHTTPFlowmeter::finishSendPackage(const PackageInfo& packageInfo)
+{
+    Q_ASSERT(packageInfo.type == SUNCSync::RequestType::SEND_FLOWERS_OUTPUT_INDICATOR ||
+             packageInfo.type == SUNCSync::RequestType::SEND_FLOWERS_INPUT_INDICATOR);
+
+    const auto suncSyncs_it = _suncSyncs.find(packageInfo.applicantId);
+    if (suncSyncs_it != _suncSyncs.end())
+    {
+        suncSyncs_it->second.isSending = false;
+    }
+}
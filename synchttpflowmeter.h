@@ -0,0 +1,182 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Отправка показаний расходомеров на сервер НИТа по HTTP
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//STL
+#include <unordered_map>
+
+//Qt
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QElapsedTimer>
+
+//My
+#include "Common/common.h"
+
+#include "tanksconfig.h"
+#include "sync.h"
+
+#include "suncsync.h"
+#include "httpclientpool.h"
+#include "applicanttopologycache.h"
+#include "packageindex.h"
+#include "packagetracker.h"
+#include "compression.h"
+#include "packagesizecontroller.h"
+
+namespace LevelGaugeService
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// Показания расходомеров записываются в таблицу [FlowmetersMeasurements]
+///     внешними системами. Организация, которой принадлежит расходомер,
+///     определяется по коду АЗС через конфигурацию резервуаров. Показания
+///     отпуска и приема отправляются разными пакетами, далее статус пакетов
+///     отслеживается так же, как для статусов резервуаров
+///
+class SyncHTTPFlowmeter final
+    : public  SyncImpl
+{
+    Q_OBJECT
+
+public:
+    /*!
+        Конструктор
+        @param dbConnectionInfo - ссылка на информацию о подключении к БД
+        @param tankConfig - ссылка на конфигурацию резервуаров. Используется для определения организации по коду АЗС
+        @param httpClientPool - общий пул HTTP клиентов
+        @param topologyCache - кеш данных организаций на сервере
+        @param checkPackageWindow - максимальное количество одновременных запросов проверки статуса пакета для одной организации
+        @param compressionLevels - уровни сжатия запросов отправки данных на сервер
+        @param packageSizeLimits - ограничения размера пакета и интервала отправки показаний для одной организации
+        @param parent - указатель на родительский класс
+    */
+    SyncHTTPFlowmeter(const Common::DBConnectionInfo& dbConnectionInfo, LevelGaugeService::TanksConfig* tanksConfig,
+                      LevelGaugeService::HTTPClientPool* httpClientPool, LevelGaugeService::ApplicantTopologyCache* topologyCache,
+                      quint32 checkPackageWindow, const LevelGaugeService::CompressionLevels& compressionLevels,
+                      const LevelGaugeService::PackageSizeController::Limits& packageSizeLimits, QObject* parent = nullptr);
+
+    /*!
+        Деструктор
+    */
+    ~SyncHTTPFlowmeter();
+
+    void removeTanks(const LevelGaugeService::TankIDList& tanksId) override;
+    void addTanks(const LevelGaugeService::TankIDList& tanksId) override;
+
+    void start() override;
+    void stop() override;
+
+private slots:
+    void sendNewIndicators();
+
+    void sendLogMsgHTTP(Common::TDBLoger::MSG_CODE category, const QString& msg, quint64 id);
+    void errorRequest(const QString& msg, LevelGaugeService::SUNCSync::PackageProcessingStatus status, quint64 id);
+    void sendFlowmeterOutputIndicators(const LevelGaugeService::SUNCSync::FlowmeterOutputIndicatorsInfo& indicators, quint64 id);
+    void sendFlowmeterInputIndicators(const LevelGaugeService::SUNCSync::FlowmeterInputIndicatorsInfo& indicators, quint64 id);
+
+    void updatePackageStatus(const QUuid& packageId, LevelGaugeService::SUNCSync::PackageProcessingStatus status, const QString& errorMessage);
+    void clearPackageStatus(const QUuid& packageId);
+
+private:
+    using IdList = QStringList;
+
+    ///< Направление движения топлива через расходомер. Значение хранится в [FlowmetersMeasurements]/Direction
+    enum class Direction: quint8
+    {
+        UNDEFINED = 0,
+        OUTPUT = 1,     ///< Отпуск
+        INPUT = 2       ///< Прием
+    };
+
+    struct PackageInfo
+    {
+        QUuid packageId;
+        SUNCSync::RequestType type = SUNCSync::RequestType::UNDEFINED;
+        qint64 applicantId = 0;
+        quint32 recordsCount = 0;   ///< Количество записей в пакете
+        QElapsedTimer sendTimer;    ///< Время с момента отправки пакета
+    };
+
+    struct ApplicantData
+    {
+        std::unique_ptr<LevelGaugeService::SUNCSync> suncSync;
+        QStringList AZSCodes;                ///< Коды АЗС организации
+        std::unique_ptr<LevelGaugeService::PackageSizeController> sizeController; ///< Размер пакета и интервал отправки показаний
+        bool isSending = false;              ///< Пакет с показаниями отправлен, ответ еще не получен
+        QDateTime nextSend;                  ///< Время следующей отправки показаний
+        Direction nextDirection = Direction::OUTPUT; ///< Направление, показания которого отправляются первыми в следующий раз
+    };
+
+private:
+    // Удаляем неиспользуемые конструкторы
+    SyncHTTPFlowmeter() = delete;
+    Q_DISABLE_COPY_MOVE(SyncHTTPFlowmeter)
+
+    static QString directionToString(Direction direction);
+
+    /*!
+        Заполняет индекс пакетов всеми пакетами, которые находятся в состоянии обработки. Вызывается при запуске и при
+            добавлении АЗС
+        @param AZSCodes - коды АЗС, пакеты которых загружаются. Если список пустой - индекс очищается и загружаются пакеты всех АЗС
+    */
+    void loadPackagesFromDB(const QStringList& AZSCodes = {});
+
+    /*!
+        Добавляет АЗС резервуара в список АЗС организации. Если организации еще нет - создает клиент сервера организации
+        @param tankId - ИД резервуара
+        @return true если АЗС добавлена, false если АЗС уже есть у одной из организаций
+    */
+    bool addApplicantAZS(const LevelGaugeService::TankID& tankId);
+
+    /*!
+        Отправляет на сервер пакет неотправленных показаний расходомеров организации одного направления
+        @param applicantID - ИД организации
+        @param direction - направление
+        @return true если пакет отправлен
+    */
+    bool sendNewIndicatorsFromDB(qint64 applicantID, Direction direction);
+
+    /*!
+        Обрабатывает ответ сервера на отправку пакета показаний
+        @param id - ИД запроса
+        @param success - true если сервер принял пакет
+        @param error - текст ошибки сервера
+    */
+    void indicatorsSent(quint64 id, bool success, const QString& error);
+    void packageSent(const PackageInfo& packageInfo, bool success);
+    void finishSendPackage(const PackageInfo& packageInfo);
+
+    void updatePackageStatus(const IdList &idList, const QUuid& packageID, qint64 applicantId, SUNCSync::PackageProcessingStatus status);
+
+    QString AZSFilter(qint64 applicantID) const;
+
+private:
+    const Common::DBConnectionInfo _dbConnectionInfo;
+    LevelGaugeService::TanksConfig* _tanksConfig;
+    LevelGaugeService::HTTPClientPool* _httpClientPool = nullptr; ///< Общий пул HTTP клиентов
+    LevelGaugeService::ApplicantTopologyCache* _topologyCache = nullptr; ///< Кеш данных организаций на сервере
+
+    std::unordered_map<qint64, ApplicantData> _suncSyncs; //key - ApplicantID, value SUNCSync;
+    QHash<QString, qint64> _applicantsByAZS; ///< Организации по коду АЗС
+
+    QSqlDatabase _db;      //база данных с исходными данными
+
+    QHash<quint64, PackageInfo> _sendedRequest; ///< Карта отправленных запросов. Ключ - ИД запроса из SUNCSync
+
+    QTimer* _sendIndicatorsTimer = nullptr;
+
+    bool _isStarted = false;
+
+    const LevelGaugeService::CompressionLevels _compressionLevels; ///< Уровни сжатия запросов отправки данных на сервер
+    const LevelGaugeService::PackageSizeController::Limits _packageSizeLimits; ///< Ограничения размера пакета и интервала отправки показаний
+    LevelGaugeService::PackageIndex _packageIndex;    ///< Незавершенные пакеты и время их следующей проверки
+    LevelGaugeService::PackageTracker _packageTracker; ///< Проверка статуса пакетов на сервере
+};
+
+}
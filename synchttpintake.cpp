@@ -1,6 +1,8 @@
+//STL
+#include <algorithm>
+
 //Qt
 #include <QSqlResult>
-#include <QRandomGenerator64>
 #include <QList>
 
 #include "synchttpintake.h"
@@ -11,28 +13,62 @@ using namespace Common;
 static const QString CONNECTION_TO_DB_NAME = "SyncHTTPIntake";
 static const QString SYNC_NAME = "SyncToHTTPIntake";
 
-SyncHTTPIntake::SyncHTTPIntake(const Common::DBConnectionInfo& dbConnectionInfo, TanksConfig* tanksConfig, QObject *parent /* = nullptr */)
+static const qint64 CHECK_PACKAGE_INTERVAL = 60 * 10;   ///< Интервал проверки статуса пакета, сек
+
+SyncHTTPIntake::SyncHTTPIntake(const Common::DBConnectionInfo& dbConnectionInfo, TanksConfig* tanksConfig, HTTPClientPool* httpClientPool,
+                               ApplicantTopologyCache* topologyCache, quint32 checkPackageWindow, const CompressionLevels& compressionLevels,
+                               qint64 sendIntakeInterval, QObject *parent /* = nullptr */)
     : SyncImpl{parent}
     , _dbConnectionInfo(dbConnectionInfo)
     , _tanksConfig(tanksConfig)
+    , _httpClientPool(httpClientPool)
+    , _topologyCache(topologyCache)
+    , _compressionLevels(compressionLevels)
+    , _sendIntakeInterval(sendIntakeInterval)
+    , _packageTracker(SYNC_NAME, "intake", &_packageIndex, checkPackageWindow)
 {
+    Q_CHECK_PTR(_tanksConfig);
+    Q_CHECK_PTR(_httpClientPool);
+    Q_CHECK_PTR(_topologyCache);
+    Q_ASSERT(_sendIntakeInterval > 0);
+
+    QObject::connect(&_packageTracker, SIGNAL(sendLogMsg(const QString&, Common::TDBLoger::MSG_CODE, const QString&)),
+                     SIGNAL(sendLogMsg(const QString&, Common::TDBLoger::MSG_CODE, const QString&)));
+    QObject::connect(&_packageTracker, SIGNAL(packageStatusReceived(const QUuid&, LevelGaugeService::SUNCSync::PackageProcessingStatus, const QString&)),
+                     SLOT(updatePackageIntake(const QUuid&, LevelGaugeService::SUNCSync::PackageProcessingStatus, const QString&)));
+    QObject::connect(&_packageTracker, SIGNAL(packageNotFound(const QUuid&)), SLOT(clearPackageIntake(const QUuid&)));
 }
 
-std::optional<SyncHTTPIntake::CheckPackageData> SyncHTTPIntake::needCheckPackageFromDB(const QString& tableName)
+void SyncHTTPIntake::loadPackagesFromDB(const QString& tableName, const TankIDList& tanksId /* = {} */)
 {
     Q_ASSERT(_db.isOpen());
 
+    QString tanksFilter;
+    for (const auto& tankId: tanksId)
+    {
+        tanksFilter += QString("%1([AZSCode] = '%2' AND [TankNumber] = %3)")
+                           .arg(tanksFilter.isEmpty() ? "" : " OR ")
+                           .arg(tankId.levelGaugeCode())
+                           .arg(tankId.tankNumber());
+    }
+
     const auto queryText =
-        QString("SELECT [PackageID], [AZSCode], [TankNumber] "
+        QString("SELECT [PackageID], [AZSCode], [TankNumber], MAX([SendStatus]) AS [SendStatus], MAX([UpdateStatusDateTime]) AS [UpdateStatusDateTime] "
                 "FROM [%1] "
-                "WHERE [PackageID] IS NOT NULL AND [SendStatus] IN (%2, %3, %4) AND [UpdateStatusDateTime] < CAST('%5' AS DATETIME2) ")
+                "WHERE [PackageID] IS NOT NULL AND [SendStatus] IN (%2, %3, %4) %5"
+                "GROUP BY [PackageID], [AZSCode], [TankNumber] ")
             .arg(tableName)
             .arg(static_cast<quint8>(SUNCSync::PackageProcessingStatus::PENDING))
             .arg(static_cast<quint8>(SUNCSync::PackageProcessingStatus::HTTP_ERROR))
             .arg(static_cast<quint8>(SUNCSync::PackageProcessingStatus::SEND_TO_SERVER))
-            .arg(QDateTime::currentDateTime().addSecs(-(60 * 10)).toString(DATETIME_FORMAT));
+            .arg(tanksFilter.isEmpty() ? QString() : QString("AND (%1) ").arg(tanksFilter));
 
-    QList<CheckPackageData> uuids;
+    if (tanksId.isEmpty())
+    {
+        _packageIndex.clear();
+    }
+
+    const auto oldSize = _packageIndex.size();
 
     try
     {
@@ -43,16 +79,31 @@ std::optional<SyncHTTPIntake::CheckPackageData> SyncHTTPIntake::needCheckPackage
 
         DBQueryExecute(_db, query, queryText);
 
-
         while (query.next())
         {
-            CheckPackageData packageData;
-            packageData.packageId = query.value("PackageID").toUuid();
+            const auto packageId = query.value("PackageID").toUuid();
             const auto AZSCode = query.value("AZSCode").toString();
             const auto tankNumber = query.value("TankNumber").toUInt();
-            packageData.tankId = TankID(AZSCode, tankNumber);
+            const auto tankId = TankID(AZSCode, tankNumber);
 
-            uuids.emplaceBack(std::move(packageData));
+            const auto tankConfig = _tanksConfig->findTankConfig(tankId);
+            if (packageId.isNull() || tankConfig == nullptr)
+            {
+                continue;
+            }
+
+            //пакет был отправлен другой организации до изменения конфигурации резервуара и уже проверяется. Статус пакета
+            //обновляется по его ИД, поэтому записи резервуара также получат статус
+            const auto packageInfo = _packageIndex.package(packageId);
+            if (packageInfo != nullptr && packageInfo->applicantId != tankConfig->remoteApplicantId())
+            {
+                continue;
+            }
+
+            const auto status = static_cast<SUNCSync::PackageProcessingStatus>(query.value("SendStatus").toUInt());
+            const auto nextCheck = query.value("UpdateStatusDateTime").toDateTime().addSecs(CHECK_PACKAGE_INTERVAL);
+
+            _packageIndex.addPackage(packageId, tankId, tankConfig->remoteApplicantId(), status, nextCheck);
         }
 
         commitDB(_db);
@@ -64,16 +115,10 @@ std::optional<SyncHTTPIntake::CheckPackageData> SyncHTTPIntake::needCheckPackage
         emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_EXECUTE_QUERY_ERR, err.what());
     }
 
-    emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Find %1 unchecked intake package").arg(uuids.size()));
-
-    if (!uuids.empty())
+    if (_packageIndex.size() > oldSize)
     {
-        const auto shift = QRandomGenerator64::global()->bounded(uuids.size());
-
-        return *std::next(uuids.begin(), shift);
+        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Find %1 unchecked intake package").arg(_packageIndex.size() - oldSize));
     }
-
-    return {};
 }
 
 QString SyncHTTPIntake::tankFilter(qint64 applicantID) const
@@ -83,6 +128,12 @@ QString SyncHTTPIntake::tankFilter(qint64 applicantID) const
     QString result;
     for (const auto& tankId: applicant.tanksID)
     {
+        //данные резервуаров, отсутствующих на сервере, не отправляем - сервер отклонит весь пакет
+        if (!_topologyCache->isTankValid(tankId))
+        {
+            continue;
+        }
+
         if (!isFirst)
         {
             result += " OR ";
@@ -105,6 +156,12 @@ void SyncHTTPIntake::sendNewIntakesFromDB(qint64 applicantID)
 
     const auto& applicant = _suncSyncs.at(applicantID);
 
+    const auto filter = tankFilter(applicantID);
+    if (filter.isEmpty())
+    {
+        return;
+    }
+
     //т.к. приоритетное значение имеет сохранненные измерения - то сначала загружаем их
     const auto queryText =
         QString("SELECT TOP (1000) "
@@ -113,7 +170,7 @@ void SyncHTTPIntake::sendNewIntakesFromDB(qint64 applicantID)
                 "FROM [TanksIntake] "
                 "WHERE (%1) AND [PackageID] IS NULL "
                 "ORDER BY [DateTime] ")
-            .arg(tankFilter(applicantID));
+            .arg(filter);
 
     IdList sendIdList; ///< список ИД записей, которые будут отправлены в текущем пакете
     std::unordered_map<qint64, std::list<SUNCSync::Transfer>> transfersData; //key - remotetankId
@@ -232,10 +289,11 @@ void SyncHTTPIntake::sendNewIntakesFromDB(qint64 applicantID)
     packageInfo.packageId = data.packageId;
     packageInfo.type = SUNCSync::RequestType::SEND_TANK_TRANSFER;
     packageInfo.lastSendDateTime = lastSendDateTime;
+    packageInfo.applicantId = applicantID;
 
     _sendedRequest.emplace(std::move(sendId), std::move(packageInfo));
 
-    updatePackageIntake(sendIdList, data.packageId, SUNCSync::PackageProcessingStatus::SEND_TO_SERVER);
+    updatePackageIntake(sendIdList, data.packageId, applicantID, lastSendDateTime, SUNCSync::PackageProcessingStatus::SEND_TO_SERVER);
 
     ++_sendedIntakeCount;
 
@@ -245,7 +303,8 @@ void SyncHTTPIntake::sendNewIntakesFromDB(qint64 applicantID)
                     .arg(sendIdList.join(',')));
 }
 
-void SyncHTTPIntake::updatePackageIntake(const IdList &idList, const QUuid& packageId, SUNCSync::PackageProcessingStatus status)
+void SyncHTTPIntake::updatePackageIntake(const IdList &idList, const QUuid& packageId, qint64 applicantId, const LastSendDateTime& lastSendDateTime,
+                                         SUNCSync::PackageProcessingStatus status)
 {
     Q_ASSERT(!packageId.isNull());
     Q_ASSERT(_db.isOpen());
@@ -275,6 +334,12 @@ void SyncHTTPIntake::updatePackageIntake(const IdList &idList, const QUuid& pack
         }
 
         commitDB(_db);
+
+        const auto nextCheck = QDateTime::currentDateTime().addSecs(CHECK_PACKAGE_INTERVAL);
+        for (const auto& lastSend: lastSendDateTime)
+        {
+            _packageIndex.addPackage(packageId, lastSend.first, applicantId, status, nextCheck);
+        }
     }
     catch (const SQLException& err)
     {
@@ -307,6 +372,8 @@ void SyncHTTPIntake::updatePackageIntake(const QUuid &packageId, SUNCSync::Packa
     try
     {
         DBQueryExecute(_db, queryText);
+
+        _packageIndex.updateStatus(packageId, status, QDateTime::currentDateTime().addSecs(CHECK_PACKAGE_INTERVAL));
     }
     catch (const SQLException& err)
     {
@@ -332,6 +399,8 @@ void SyncHTTPIntake::clearPackageIntake(const QUuid &packageId)
     try
     {
         DBQueryExecute(_db, queryText);
+
+        _packageIndex.remove(packageId);
     }
     catch (const SQLException& err)
     {
@@ -347,36 +416,106 @@ SyncHTTPIntake::~SyncHTTPIntake()
     stop();
 }
 
-void SyncHTTPIntake::start()
+void SyncHTTPIntake::addApplicantTank(const TankID& tankId)
 {
-    Q_ASSERT(!_isStarted);
+    const auto tankConfig =  _tanksConfig->getTankConfig(tankId);
 
-    for (const auto& tankId: _tanksConfig->getTanksID())
+    auto suncSyncs_it = _suncSyncs.find(tankConfig->remoteApplicantId());
+    if (suncSyncs_it != _suncSyncs.end())
+    {
+        suncSyncs_it->second.tanksID.push_back(tankId);
+
+        return;
+    }
+
+    ApplicantData applicant;
+    applicant.tanksID.push_back(tankId);
+    applicant.suncSync = std::make_unique<SUNCSync>(_httpClientPool, tankConfig->remoteBaseUrl(), tankConfig->remoteBearerToken(),
+                                                     _compressionLevels.level(tankConfig->remoteApplicantId()));
+
+    QObject::connect(applicant.suncSync.get(), SIGNAL(errorRequest(const QString&, LevelGaugeService::SUNCSync::PackageProcessingStatus, quint64)),
+                                 SLOT(errorRequest(const QString&, LevelGaugeService::SUNCSync::PackageProcessingStatus, quint64)));
+    QObject::connect(applicant.suncSync.get(), SIGNAL(sendLogMsg(Common::TDBLoger::MSG_CODE, const QString&, quint64)),
+                                 SLOT(sendLogMsgHTTP(Common::TDBLoger::MSG_CODE, const QString&, quint64)));
+    QObject::connect(applicant.suncSync.get(), SIGNAL(sendTankTransfers(const LevelGaugeService::SUNCSync::TankTransfersInfo&, quint64)),
+                                 SLOT(sendTankTransfers(const LevelGaugeService::SUNCSync::TankTransfersInfo&, quint64)));
+
+    _packageTracker.addApplicant(tankConfig->remoteApplicantId(), applicant.suncSync.get());
+
+    _suncSyncs.emplace(tankConfig->remoteApplicantId(), std::move(applicant));
+}
+
+void SyncHTTPIntake::removeTanks(const LevelGaugeService::TankIDList& tanksId)
+{
+    if (!_isStarted)
+    {
+        return;
+    }
+
+    const QSet<TankID> removedTanks(tanksId.begin(), tanksId.end());
+
+    _packageIndex.removeTanks(removedTanks);
+
+    for (auto suncSyncs_it = _suncSyncs.begin(); suncSyncs_it != _suncSyncs.end();)
     {
-        const auto tankConfig =  _tanksConfig->getTankConfig(tankId);
+        auto& applicant = suncSyncs_it->second;
+        applicant.tanksID.remove_if([&removedTanks](const TankID& tankId){ return removedTanks.contains(tankId); });
 
-        auto suncSyncs_it = _suncSyncs.find(tankConfig->remoteApplicantId());
-        if (suncSyncs_it != _suncSyncs.end())
+        if (!applicant.tanksID.empty())
         {
-            suncSyncs_it->second.tanksID.push_back(tankId);
+            ++suncSyncs_it;
+
+            continue;
+        }
+
+        //у организации не осталось резервуаров. Ответы на отправленные запросы будут пропущены
+        const auto applicantId = suncSyncs_it->first;
+
+        _packageTracker.removeApplicant(applicantId);
+        _packageIndex.removeApplicant(applicantId);
+
+        const auto removedCount = _sendedRequest.removeIf([applicantId](QHash<quint64, PackageInfo>::iterator it){ return it->applicantId == applicantId; });
+        _sendedIntakeCount -= std::min<quint64>(_sendedIntakeCount, removedCount);
+
+        suncSyncs_it = _suncSyncs.erase(suncSyncs_it);
+
+        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Applicant has no tanks and removed. Applicant ID: %1").arg(applicantId));
+    }
+}
 
+void SyncHTTPIntake::addTanks(const LevelGaugeService::TankIDList& tanksId)
+{
+    if (!_isStarted)
+    {
+        return;
+    }
+
+    TankIDList addedTanks;
+    for (const auto& tankId: tanksId)
+    {
+        if (!_tanksConfig->isExist(tankId))
+        {
             continue;
         }
 
-        ApplicantData applicant;
-        applicant.tanksID.push_back(tankId);
-        applicant.suncSync = std::make_unique<SUNCSync>(tankConfig->remoteBaseUrl(), tankConfig->remoteBearerToken());
+        addApplicantTank(tankId);
 
-        QObject::connect(applicant.suncSync.get(), SIGNAL(errorRequest(const QString&, LevelGaugeService::SUNCSync::PackageProcessingStatus, quint64)),
-                                     SLOT(errorRequest(const QString&, LevelGaugeService::SUNCSync::PackageProcessingStatus, quint64)));
-        QObject::connect(applicant.suncSync.get(), SIGNAL(sendLogMsg(Common::TDBLoger::MSG_CODE, const QString&, quint64)),
-                                     SLOT(sendLogMsgHTTP(Common::TDBLoger::MSG_CODE, const QString&, quint64)));
-        QObject::connect(applicant.suncSync.get(), SIGNAL(getPackageStatus(const LevelGaugeService::SUNCSync::PackageStatusInfo&, quint64)),
-                                     SLOT(getPackageStatus(const LevelGaugeService::SUNCSync::PackageStatusInfo&, quint64)));
-        QObject::connect(applicant.suncSync.get(), SIGNAL(sendTankTransfers(const LevelGaugeService::SUNCSync::TankTransfersInfo&, quint64)),
-                                     SLOT(sendTankTransfers(const LevelGaugeService::SUNCSync::TankTransfersInfo&, quint64)));
+        addedTanks.push_back(tankId);
+    }
 
-        _suncSyncs.emplace(tankConfig->remoteApplicantId(), std::move(applicant));
+    if (!addedTanks.isEmpty())
+    {
+        loadPackagesFromDB("TanksIntake", addedTanks);
+    }
+}
+
+void SyncHTTPIntake::start()
+{
+    Q_ASSERT(!_isStarted);
+
+    for (const auto& tankId: _tanksConfig->getTanksID())
+    {
+        addApplicantTank(tankId);
     }
 
     try
@@ -390,13 +529,9 @@ void SyncHTTPIntake::start()
         return;
     }
 
-    //check status
-    Q_ASSERT(_checkIntakeTimer == nullptr);
-    _checkIntakeTimer = new QTimer();
+    loadPackagesFromDB("TanksIntake");
 
-    QObject::connect(_checkIntakeTimer, SIGNAL(timeout()), SLOT(checkPackage()));
-
-    _checkIntakeTimer->start(1000);
+    _packageTracker.start();
 
     //send Status
     Q_ASSERT(_sendIntakeTimer == nullptr);
@@ -404,7 +539,7 @@ void SyncHTTPIntake::start()
 
     QObject::connect(_sendIntakeTimer, SIGNAL(timeout()), SLOT(sendNewIntakes()));
 
-    _sendIntakeTimer->start(60000);
+    _sendIntakeTimer->start(_sendIntakeInterval);
 
     _isStarted = true;
 }
@@ -416,10 +551,16 @@ void SyncHTTPIntake::stop()
         return;
     }
 
+    _packageTracker.stop();
+
     _suncSyncs.clear();
+    _sendedRequest.clear();
+    _packageIndex.clear();
 
     delete _sendIntakeTimer;
-    delete _checkIntakeTimer;
+    _sendIntakeTimer = nullptr;
+
+    _sendedIntakeCount = 0;
 
     closeDB(_db);
 
@@ -437,28 +578,16 @@ void SyncHTTPIntake::sendNewIntakes()
 
     for (const auto& applicant: _suncSyncs)
     {
+        //сервер недоступен - не отправляем пакеты до истечения задержки
+        if (!applicant.second.suncSync->isAvailable())
+        {
+            continue;
+        }
+
         sendNewIntakesFromDB(applicant.first);
     }
 }
 
-void SyncHTTPIntake::sendCheckPackage(const CheckPackageData& packageData)
-{
-    Q_ASSERT(_isStarted);
-
-    const auto tankConfig = _tanksConfig->getTankConfig(packageData.tankId);
-    const auto sendId = _suncSyncs.at(tankConfig->remoteApplicantId()).suncSync->sendGetPackageStatus(packageData.packageId);
-
-    PackageInfo packageInfo;
-    packageInfo.packageId = packageData.packageId;
-    packageInfo.type = SUNCSync::RequestType::GET_PACKAGE_STATUS;
-
-    _sendedRequest.emplace(std::move(sendId), std::move(packageInfo));
-
-    emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Check intake package on the server. Package ID: %1").arg(packageData.packageId.toString()));
-
-    _isSendedCheckPackage = true;
-}
-
 void SyncHTTPIntake::sendLogMsgHTTP(Common::TDBLoger::MSG_CODE category, const QString &msg, quint64 id)
 {
     emit sendLogMsg(SYNC_NAME, category, msg);
@@ -471,112 +600,56 @@ void SyncHTTPIntake::errorRequest(const QString &msg, LevelGaugeService::SUNCSyn
         return;
     }
 
+    //ошибки запросов проверки статуса пакета обрабатывает PackageTracker
     const auto sendedRequest_it = _sendedRequest.find(id);
-
-    Q_ASSERT(sendedRequest_it != _sendedRequest.end());
-
-    const auto& packageInfo = sendedRequest_it.value();
-
-    switch (packageInfo.type)
-    {
-    case SUNCSync::RequestType::SEND_TANK_TRANSFER:
+    if (sendedRequest_it == _sendedRequest.end())
     {
-        switch (status)
-        {
-        case SUNCSync::PackageProcessingStatus::INCORRECT_DATA_ERROR:
-            updatePackageIntake(packageInfo.packageId, status, msg);
-
-            break;
-        case SUNCSync::PackageProcessingStatus::HTTP_ERROR:
-            updatePackageIntake(packageInfo.packageId, status, msg);
-            break;
-        default:
-            Q_ASSERT(false);
-        }
+        return;
+    }
 
-        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("An unsuccessful attempt to send intake data to the server. Package ID: %1. Status: %2. Message: %3")
-                             .arg(packageInfo.packageId.toString())
-                             .arg(SUNCSync::packageProcessingStatusToString(status))
-                             .arg(msg));
+    const auto& packageInfo = sendedRequest_it.value();
 
-        --_sendedIntakeCount;
+    Q_ASSERT(packageInfo.type == SUNCSync::RequestType::SEND_TANK_TRANSFER);
 
-        break;
-    }
-    case SUNCSync::RequestType::GET_PACKAGE_STATUS:
+    switch (status)
     {
-        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("An unsuccessful check package intake status to the server. Package ID: %1. Status: %2. Message: %3")
-                             .arg(packageInfo.packageId.toString())
-                             .arg(SUNCSync::packageProcessingStatusToString(status))
-                             .arg(msg));
-
-        _isSendedCheckPackage = false;
+    case SUNCSync::PackageProcessingStatus::INCORRECT_DATA_ERROR:
+        updatePackageIntake(packageInfo.packageId, status, msg);
 
         break;
-    }
+    case SUNCSync::PackageProcessingStatus::HTTP_ERROR:
+    case SUNCSync::PackageProcessingStatus::SERVER_UNAVAILABLE:
+    case SUNCSync::PackageProcessingStatus::REQUEST_ERROR:
+        updatePackageIntake(packageInfo.packageId, SUNCSync::PackageProcessingStatus::HTTP_ERROR, msg);
+        _packageTracker.sendFailed(packageInfo.packageId, packageInfo.applicantId);
 
+        break;
     default:
         Q_ASSERT(false);
     }
 
-    _sendedRequest.erase(sendedRequest_it);
-}
-
-void SyncHTTPIntake::getPackageStatus(const SUNCSync::PackageStatusInfo& status, quint64 id)
-{
-    if (!_isStarted)
-    {
-        return;
-    }
-
-    const auto sendedRequest_it = _sendedRequest.find(id);
-
-    Q_ASSERT(sendedRequest_it != _sendedRequest.end());
-
-    const auto& packageInfo = sendedRequest_it.value();
-
-    if (status.success)
-    {
-        updatePackageIntake(packageInfo.packageId, status.packageProcessingStatus, "");
-
-        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("The package intake has been successfully received from the server and chenged status to SUCCESS. Package ID: %1. Status: %2")
-                        .arg(packageInfo.packageId.toString())
-                        .arg(SUNCSync::packageProcessingStatusToString(status.packageProcessingStatus)));
-    }
-    else
-    {
-        //полное сообщение выглядит как "PackageId %1 wasn`t found.", но символ ` заменяеться ' на в QString и сравнение не срабатывает
-        //поэтому срас=вниваем только половину фразы
-        if (status.error.contains(QString("PackageId %1 wasn").arg(packageInfo.packageId.toString(QUuid::WithoutBraces)), Qt::CaseInsensitive))
-        {
-            clearPackageIntake(packageInfo.packageId);
-
-            emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Intake package not found on server. Clear PackageID and will retry send statuses. Package ID: %1")
-                        .arg(packageInfo.packageId.toString()));
-        }
-        else
-        {
-            updatePackageIntake(packageInfo.packageId, SUNCSync::PackageProcessingStatus::SERVER_ERROR, status.error);
+    emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("An unsuccessful attempt to send intake data to the server. Package ID: %1. Status: %2. Message: %3")
+                         .arg(packageInfo.packageId.toString())
+                         .arg(SUNCSync::packageProcessingStatusToString(status))
+                         .arg(msg));
 
-            emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("Failed to get the package intake status from the server and chenged status to SERVER_ERROR. Package ID: %1. Error: %2")
-                        .arg(packageInfo.packageId.toString())
-                        .arg(status.error));
-        }
-    }
+    --_sendedIntakeCount;
 
     _sendedRequest.erase(sendedRequest_it);
-
-    _isSendedCheckPackage = false;
 }
 
 void SyncHTTPIntake::sendTankTransfers(const SUNCSync::TankTransfersInfo& tankTransfers, quint64 id)
 {
     Q_ASSERT(_isStarted);
-    Q_ASSERT(_sendedIntakeCount != 0);
 
+    //запрос организации, удаленной при изменении конфигурации резервуаров
     const auto sendedRequest_it = _sendedRequest.find(id);
+    if (sendedRequest_it == _sendedRequest.end())
+    {
+        return;
+    }
 
-    Q_ASSERT(sendedRequest_it != _sendedRequest.end());
+    Q_ASSERT(_sendedIntakeCount != 0);
 
     const auto& packageInfo = sendedRequest_it.value();
 
@@ -598,37 +671,15 @@ void SyncHTTPIntake::sendTankTransfers(const SUNCSync::TankTransfersInfo& tankTr
 
     for (const auto& lastSend: packageInfo.lastSendDateTime)
     {
-        _tanksConfig->getTankConfig(lastSend.first)->setLastSendIntake(lastSend.second);
+        //резервуар мог быть удален из конфигурации после отправки пакета
+        auto tankConfig = _tanksConfig->findTankConfig(lastSend.first);
+        if (tankConfig != nullptr)
+        {
+            tankConfig->setLastSendIntake(lastSend.second);
+        }
     }
 
     _sendedRequest.erase(sendedRequest_it);
 
     --_sendedIntakeCount;
 }
-
-void SyncHTTPIntake::checkPackage()
-{
-    Q_ASSERT(_isStarted);
-
-    if (_isSendedCheckPackage)
-    {
-        return;
-    }
-
-    const auto needCheckUuid = needCheckPackageFromDB("TanksIntake");
-    if (needCheckUuid.has_value())
-    {
-       sendCheckPackage(needCheckUuid.value());
-       _checkIntakeTimer->setInterval(1000);
-    }
-    else
-    {
-        _checkIntakeTimer->setInterval(60000);
-    }
-
-    //далее ждем сигнала getPackageStatus(...)
-}
-
-
-
-
@@ -15,6 +15,11 @@
 #include "sync.h"
 
 #include "suncsync.h"
+#include "httpclientpool.h"
+#include "applicanttopologycache.h"
+#include "packageindex.h"
+#include "packagetracker.h"
+#include "compression.h"
 
 namespace LevelGaugeService
 {
@@ -29,43 +34,50 @@ public:
         Конструктор
         @param dbConnectionInfo - ссылка на информацию о подключении к БД
         @param tankConfig - ссылка на конфигурацию резервуара
+        @param httpClientPool - общий пул HTTP клиентов
+        @param topologyCache - кеш данных организаций на сервере
+        @param checkPackageWindow - максимальное количество одновременных запросов проверки статуса пакета для одной организации
+        @param compressionLevels - уровни сжатия запросов отправки данных на сервер
+        @param sendIntakeInterval - интервал отправки приходов на сервер, мсек
         @param parent - указатель на родительский класс
     */
-    SyncHTTPIntake(const Common::DBConnectionInfo& dbConnectionInfo, LevelGaugeService::TanksConfig* tanksConfig, QObject* parent = nullptr);
+    SyncHTTPIntake(const Common::DBConnectionInfo& dbConnectionInfo, LevelGaugeService::TanksConfig* tanksConfig,
+                   LevelGaugeService::HTTPClientPool* httpClientPool, LevelGaugeService::ApplicantTopologyCache* topologyCache,
+                   quint32 checkPackageWindow,
+                   const LevelGaugeService::CompressionLevels& compressionLevels, qint64 sendIntakeInterval, QObject* parent = nullptr);
 
     /*!
         Деструктор
     */
     ~SyncHTTPIntake();
 
+    void removeTanks(const LevelGaugeService::TankIDList& tanksId) override;
+    void addTanks(const LevelGaugeService::TankIDList& tanksId) override;
+
     void start() override;
     void stop() override;
 
 private slots:
     void sendNewIntakes();
-    void checkPackage();
 
     void sendLogMsgHTTP(Common::TDBLoger::MSG_CODE category, const QString& msg, quint64 id);
     void errorRequest(const QString& msg, LevelGaugeService::SUNCSync::PackageProcessingStatus status, quint64 id);
-    void getPackageStatus(const LevelGaugeService::SUNCSync::PackageStatusInfo& status, quint64 id);
     void sendTankTransfers(const LevelGaugeService::SUNCSync::TankTransfersInfo& tankTransfers, quint64 id);
 
+    void updatePackageIntake(const QUuid& packageId, LevelGaugeService::SUNCSync::PackageProcessingStatus status, const QString& errorMessage);
+    void clearPackageIntake(const QUuid& packageId);
+
 private:
     using IdList = QStringList;
 
     using LastSendDateTime = std::unordered_map<TankID, QDateTime>;
 
-    struct CheckPackageData
-    {
-        QUuid packageId;
-        LevelGaugeService::TankID tankId;
-    };
-
     struct PackageInfo
     {
         QUuid packageId;
         LevelGaugeService::SUNCSync::RequestType type = SUNCSync::RequestType::UNDEFINED;
         LastSendDateTime lastSendDateTime;
+        qint64 applicantId = 0;
     };
 
     struct ApplicantData
@@ -79,24 +91,32 @@ private:
     SyncHTTPIntake() = delete;
     Q_DISABLE_COPY_MOVE(SyncHTTPIntake)
 
-    std::optional<CheckPackageData> needCheckPackageFromDB(const QString& tableName); ///< загружает повторно все записи по которые находятся в состоянии обработки и отправлет запрос на подтверждение
+    /*!
+        Заполняет индекс пакетов всеми пакетами, которые находятся в состоянии обработки. Вызывается при запуске и при
+            добавлении резервуаров, далее индекс поддерживается при изменении статусов пакетов
+        @param tableName - имя таблицы
+        @param tanksId - резервуары, пакеты которых загружаются. Если список пустой - индекс очищается и загружаются пакеты всех резервуаров
+    */
+    void loadPackagesFromDB(const QString& tableName, const LevelGaugeService::TankIDList& tanksId = {});
 
-    void sendNewIntakesFromDB(qint64 applicantID);
     /*!
-        Проверяет состояние обработки отправленного на сервер пакета
-        @param packetId - ИД пакета
+        Добавляет резервуар в список резервуаров организации. Если организации еще нет - создает клиент сервера организации
+        @param tankId - ИД резервуара
     */
-    void sendCheckPackage(const CheckPackageData& packageData);
+    void addApplicantTank(const LevelGaugeService::TankID& tankId);
 
-    void updatePackageIntake(const IdList &idList, const QUuid& packageID, SUNCSync::PackageProcessingStatus status);
-    void updatePackageIntake(const QUuid& packageId, SUNCSync::PackageProcessingStatus status, const QString& errorMessage);
-    void clearPackageIntake(const QUuid& packageId);
+    void sendNewIntakesFromDB(qint64 applicantID);
+
+    void updatePackageIntake(const IdList &idList, const QUuid& packageID, qint64 applicantId, const LastSendDateTime& lastSendDateTime,
+                             SUNCSync::PackageProcessingStatus status);
 
     QString tankFilter(qint64 applicantID) const;
 
 private:
     const Common::DBConnectionInfo _dbConnectionInfo;
     LevelGaugeService::TanksConfig* _tanksConfig;
+    LevelGaugeService::HTTPClientPool* _httpClientPool = nullptr; ///< Общий пул HTTP клиентов
+    LevelGaugeService::ApplicantTopologyCache* _topologyCache = nullptr; ///< Кеш данных организаций на сервере
 
     std::unordered_map<qint64, ApplicantData> _suncSyncs; //key - ApplicantID, value SUNCSync;
 
@@ -104,12 +124,15 @@ private:
 
     QHash<quint64, PackageInfo> _sendedRequest; ///< Карта отправленных запросов для которух нужно проверить статус. Ключ - ИД запроса из SUNCSync
 
-    QTimer* _checkIntakeTimer = nullptr;
     QTimer* _sendIntakeTimer = nullptr;
 
     bool _isStarted = false;
     quint64 _sendedIntakeCount = 0; // количество незвершенных  запросов со статусами резервуаров отправленных на сервер
-    bool _isSendedCheckPackage = false;
+
+    const LevelGaugeService::CompressionLevels _compressionLevels; ///< Уровни сжатия запросов отправки данных на сервер
+    const qint64 _sendIntakeInterval = 60000; ///< Интервал отправки приходов на сервер, мсек
+    LevelGaugeService::PackageIndex _packageIndex;    ///< Незавершенные пакеты и время их следующей проверки
+    LevelGaugeService::PackageTracker _packageTracker; ///< Проверка статуса пакетов на сервере
 };
 
 }
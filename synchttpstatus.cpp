@@ -1,6 +1,9 @@
+//STL
+#include <algorithm>
+#include <cmath>
+
 //Qt
 #include <QSqlResult>
-#include <QRandomGenerator64>
 #include <QList>
 
 #include "synchttpstatus.h"
@@ -11,28 +14,72 @@ using namespace Common;
 static const QString CONNECTION_TO_DB_NAME = "SyncHTTPStatus";
 static const QString SYNC_NAME = "SyncToHTTPStatus";
 
-SyncHTTPStatus::SyncHTTPStatus(const Common::DBConnectionInfo& dbConnectionInfo, TanksConfig* tanksConfig, QObject *parent /* = nullptr */)
+static const qint64 CHECK_PACKAGE_INTERVAL = 60 * 10;   ///< Интервал проверки статуса пакета, сек
+static const quint32 INIT_PACKAGE_SIZE = 1000;         ///< Начальный размер пакета статусов, записей
+static const qint64 STREAM_WAIT_TIMEOUT = 60 * 10 * 1000; ///< Максимальное время ожидания ИД записи вычисленного статуса в потоковом режиме, мсек
+
+SyncHTTPStatus::SyncHTTPStatus(const Common::DBConnectionInfo& dbConnectionInfo, TanksConfig* tanksConfig, HTTPClientPool* httpClientPool,
+                               ApplicantTopologyCache* topologyCache, quint32 checkPackageWindow, quint32 sendPackageWindow, const CompressionLevels& compressionLevels, const PackageSizeController::Limits& packageSizeLimits,
+                               bool streamMode, qint64 realtimeWindow, quint32 backlogShare, QObject *parent /* = nullptr */)
     : SyncImpl{parent}
     , _dbConnectionInfo(dbConnectionInfo)
     , _tanksConfig(tanksConfig)
+    , _httpClientPool(httpClientPool)
+    , _topologyCache(topologyCache)
+    , _sendPackageWindow(sendPackageWindow)
+    , _compressionLevels(compressionLevels)
+    , _packageSizeLimits(packageSizeLimits)
+    , _packageTracker(SYNC_NAME, "status", &_packageIndex, checkPackageWindow)
+    , _streamMode(streamMode)
+    , _realtimeWindow(realtimeWindow)
+    , _backlogShare(backlogShare)
 {
+    Q_CHECK_PTR(_tanksConfig);
+    Q_CHECK_PTR(_httpClientPool);
+    Q_CHECK_PTR(_topologyCache);
+    Q_ASSERT(_sendPackageWindow > 0);
+    Q_ASSERT(_realtimeWindow >= 0);
+    Q_ASSERT(_backlogShare > 0 && _backlogShare < 100);
+
+    QObject::connect(&_packageTracker, SIGNAL(sendLogMsg(const QString&, Common::TDBLoger::MSG_CODE, const QString&)),
+                     SIGNAL(sendLogMsg(const QString&, Common::TDBLoger::MSG_CODE, const QString&)));
+    QObject::connect(&_packageTracker, SIGNAL(packageStatusReceived(const QUuid&, LevelGaugeService::SUNCSync::PackageProcessingStatus, const QString&)),
+                     SLOT(updatePackageStatus(const QUuid&, LevelGaugeService::SUNCSync::PackageProcessingStatus, const QString&)));
+    QObject::connect(&_packageTracker, SIGNAL(packageNotFound(const QUuid&)), SLOT(clearPackageStatus(const QUuid&)));
+
+    QObject::connect(_topologyCache, SIGNAL(tanksValid(const LevelGaugeService::TankIDList&)), SLOT(tanksValid(const LevelGaugeService::TankIDList&)));
 }
 
-std::optional<SyncHTTPStatus::CheckPackageData> SyncHTTPStatus::needCheckPackageFromDB(const QString& tableName)
+void SyncHTTPStatus::loadPackagesFromDB(const QString& tableName, const TankIDList& tanksId /* = {} */)
 {
     Q_ASSERT(_db.isOpen());
 
+    QString tanksFilter;
+    for (const auto& tankId: tanksId)
+    {
+        tanksFilter += QString("%1([AZSCode] = '%2' AND [TankNumber] = %3)")
+                           .arg(tanksFilter.isEmpty() ? "" : " OR ")
+                           .arg(tankId.levelGaugeCode())
+                           .arg(tankId.tankNumber());
+    }
+
     const auto queryText =
-        QString("SELECT [PackageID], [AZSCode], [TankNumber] "
+        QString("SELECT [PackageID], [AZSCode], [TankNumber], MAX([SendStatus]) AS [SendStatus], MAX([UpdateStatusDateTime]) AS [UpdateStatusDateTime] "
                 "FROM [%1] "
-                "WHERE [PackageID] IS NOT NULL AND [SendStatus] IN (%2, %3, %4) AND [UpdateStatusDateTime] < CAST('%5' AS DATETIME2) ")
+                "WHERE [PackageID] IS NOT NULL AND [SendStatus] IN (%2, %3, %4) %5"
+                "GROUP BY [PackageID], [AZSCode], [TankNumber] ")
             .arg(tableName)
             .arg(static_cast<quint8>(SUNCSync::PackageProcessingStatus::PENDING))
             .arg(static_cast<quint8>(SUNCSync::PackageProcessingStatus::HTTP_ERROR))
             .arg(static_cast<quint8>(SUNCSync::PackageProcessingStatus::SEND_TO_SERVER))
-            .arg(QDateTime::currentDateTime().addSecs(-(60 * 10)).toString(DATETIME_FORMAT));
+            .arg(tanksFilter.isEmpty() ? QString() : QString("AND (%1) ").arg(tanksFilter));
+
+    if (tanksId.isEmpty())
+    {
+        _packageIndex.clear();
+    }
 
-    QList<CheckPackageData> uuids;
+    const auto oldSize = _packageIndex.size();
 
     try
     {
@@ -45,15 +92,30 @@ std::optional<SyncHTTPStatus::CheckPackageData> SyncHTTPStatus::needCheckPackage
 
         while (query.next())
         {
-            CheckPackageData packageData;
-            packageData.packageId = query.value("PackageID").toUuid();
+            const auto packageId = query.value("PackageID").toUuid();
             const auto AZSCode = query.value("AZSCode").toString();
             const auto tankNumber = query.value("TankNumber").toUInt();
-            packageData.tankId = TankID(AZSCode, tankNumber);
+            const auto tankId = TankID(AZSCode, tankNumber);
 
-            uuids.emplaceBack(std::move(packageData));
-        }
+            const auto tankConfig = _tanksConfig->findTankConfig(tankId);
+            if (packageId.isNull() || tankConfig == nullptr)
+            {
+                continue;
+            }
 
+            //пакет был отправлен другой организации до изменения конфигурации резервуара и уже проверяется. Статус пакета
+            //обновляется по его ИД, поэтому записи резервуара также получат статус
+            const auto packageInfo = _packageIndex.package(packageId);
+            if (packageInfo != nullptr && packageInfo->applicantId != tankConfig->remoteApplicantId())
+            {
+                continue;
+            }
+
+            const auto status = static_cast<SUNCSync::PackageProcessingStatus>(query.value("SendStatus").toUInt());
+            const auto nextCheck = query.value("UpdateStatusDateTime").toDateTime().addSecs(CHECK_PACKAGE_INTERVAL);
+
+            _packageIndex.addPackage(packageId, tankId, tankConfig->remoteApplicantId(), status, nextCheck);
+        }
 
         commitDB(_db);
     }
@@ -61,132 +123,210 @@ std::optional<SyncHTTPStatus::CheckPackageData> SyncHTTPStatus::needCheckPackage
     {
         _db.rollback();
 
-        emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_EXECUTE_QUERY_ERR, err.what());        
+        emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_EXECUTE_QUERY_ERR, err.what());
     }
 
-    emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Find %1 unchecked status package").arg(uuids.size()));
-
-    if (!uuids.empty())
+    if (_packageIndex.size() > oldSize)
     {
-        const auto shift = QRandomGenerator64::global()->bounded(uuids.size());
+        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Find %1 unchecked status package").arg(_packageIndex.size() - oldSize));
+    }
+}
+
+QDateTime SyncHTTPStatus::sendFrom(const TankID& tankId) const
+{
+    const auto& lastSend = _tanksConfig->getTankConfig(tankId)->lastSend();
 
-        return *std::next(uuids.begin(), shift);
+    const auto backlogFrom_it = _backlogFrom.find(tankId);
+    if (backlogFrom_it == _backlogFrom.end())
+    {
+        return lastSend;
     }
 
-    return {};
+    return std::min(lastSend, backlogFrom_it.value());
 }
 
-QString SyncHTTPStatus::tankFilter(qint64 applicantID) const
+QString SyncHTTPStatus::tankFilter(qint64 applicantID, SendLaneType laneType, const QDateTime& currentDateTime) const
 {
     const auto& applicant = _suncSyncs.at(applicantID);
     bool isFirst = true;
     QString result;
     for (const auto& tankId: applicant.tanksID)
     {
+        //данные резервуаров, отсутствующих на сервере, не отправляем - сервер отклонит весь пакет
+        if (!_topologyCache->isTankValid(tankId))
+        {
+            continue;
+        }
+
         if (!isFirst)
         {
             result += " OR ";
         }
         isFirst = false;
 
-        result += QString("([AZSCode] = '%1' AND [TankNumber] = %2 AND [DateTime] > CAST('%3' AS DATETIME2))")
+        QString laneFilter;
+        if (laneType != SendLaneType::ALL)
+        {
+            //время статусов в БД сохраняется с учетом сдвига времени резервуара
+            const auto realtimeFrom = currentDateTime.addSecs(_tanksConfig->getTankConfig(tankId)->timeShift()).addMSecs(-_realtimeWindow);
+
+            laneFilter = QString(" AND [DateTime] %1 CAST('%2' AS DATETIME2)")
+                .arg(laneType == SendLaneType::REALTIME ? ">=" : "<")
+                .arg(realtimeFrom.toString(DATETIME_FORMAT));
+        }
+
+        //записи пакета, не найденного на сервере, отправляются повторно даже если время последней отправки резервуара уже больше
+        result += QString("([AZSCode] = '%1' AND [TankNumber] = %2 AND ([DateTime] > CAST('%3' AS DATETIME2) OR [SendStatus] IS NOT NULL)%4)")
                 .arg(tankId.levelGaugeCode())
                 .arg(tankId.tankNumber())
-                .arg(_tanksConfig->getTankConfig(tankId)->lastSend().toString(DATETIME_FORMAT));
+                .arg(sendFrom(tankId).toString(DATETIME_FORMAT))
+                .arg(laneFilter);
     }
 
     return result;
 }
 
-void SyncHTTPStatus::sendNewStatusesFromDB(qint64 applicantID)
+SyncHTTPStatus::SendFromDBResult SyncHTTPStatus::sendNewStatusesFromDB(qint64 applicantID)
 {
     Q_ASSERT(_db.isOpen());
     Q_ASSERT(_isStarted);
 
-    const auto& applicant = _suncSyncs.at(applicantID);
+    auto& applicant = _suncSyncs.at(applicantID);
 
-    //т.к. приоритетное значение имеет сохранненные измерения - то сначала загружаем их
-    const auto queryText =
-        QString("SELECT TOP (1000) "
-                    "[ID], [AZSCode], [TankNumber], [DateTime], [Volume], [Mass], [Density], [Height], [Temp], [AdditionFlag], [Status] "
-                "FROM [TanksCalculate] "
-                "WHERE (%1) AND [PackageID] IS NULL "
-                "ORDER BY [DateTime] ")
-            .arg(tankFilter(applicantID));
+    const auto packageSize = applicant.sizeController->packageSize();
+    const auto currentDateTime = QDateTime::currentDateTime();
+
+    //свежие статусы отправляются в первую очередь, чтобы после перерыва связи они не ждали отправки всего накопленного архива.
+    //Накопленные статусы занимают остаток пакета, но не меньше доли _backlogShare
+    std::list<SendLane> lanes;
+    if (_realtimeWindow > 0)
+    {
+        const auto backlogLimit = std::max<quint32>(1, packageSize * _backlogShare / 100);
+
+        lanes.push_back({SendLaneType::REALTIME, packageSize > backlogLimit ? packageSize - backlogLimit : 1});
+        lanes.push_back({SendLaneType::BACKLOG, backlogLimit});
+    }
+    else
+    {
+        lanes.push_back({SendLaneType::ALL, packageSize});
+    }
+
+    for (auto& lane: lanes)
+    {
+        lane.filter = tankFilter(applicantID, lane.type, currentDateTime);
+        if (lane.filter.isEmpty())
+        {
+            return SendFromDBResult::NO_TANKS;
+        }
+    }
 
     IdList sendIdList; ///< список ИД записей, которые будут отправлены в текущем пакете
     std::unordered_map<qint64, std::list<SUNCSync::Measument>> measumentsData; //key - remotetankId
     LastSendDateTime lastSendDateTime;
+    LastSendDateTime realtimeLastSendDateTime; ///< время отправки резервуаров по свежим статусам
+    bool isFull = false;       ///< хотя бы одна из полос заполнена полностью
+    bool isBacklogDrained = true; ///< все накопленные статусы выбраны
+    quint32 realtimeSelectedCount = 0;
     try
     {
         transactionDB(_db);
 
-        QSqlQuery query(_db);
-        query.setForwardOnly(true);
+        for (const auto& lane: lanes)
+        {
+            //полоса накопленных статусов получает также место, не занятое свежими статусами
+            const auto limit = lane.type == SendLaneType::BACKLOG ? std::max(lane.limit, packageSize - std::min(packageSize, realtimeSelectedCount)) : lane.limit;
 
-        DBQueryExecute(_db, query, queryText);
+            //т.к. приоритетное значение имеет сохранненные измерения - то сначала загружаем их
+            const auto queryText =
+                QString("SELECT TOP (%2) "
+                            "[ID], [AZSCode], [TankNumber], [DateTime], [Volume], [Mass], [Density], [Height], [Temp], [AdditionFlag], [Status], [SendStatus] "
+                        "FROM [TanksCalculate] "
+                        "WHERE (%1) AND [PackageID] IS NULL "
+                        "ORDER BY [DateTime] ")
+                    .arg(lane.filter, QString::number(limit));
 
-        while (query.next())
-        {
-            class TankStatusLoadException
-                : public std::runtime_error
-            {
-            public:
-                explicit TankStatusLoadException(const QString& what)
-                    : std::runtime_error(what.toStdString())
-                {}
-            };
+            QSqlQuery query(_db);
+            query.setForwardOnly(true);
 
-            try
+            DBQueryExecute(_db, query, queryText);
+
+            auto& laneLastSendDateTime = lane.type == SendLaneType::REALTIME ? realtimeLastSendDateTime : lastSendDateTime;
+            quint32 selectedCount = 0; ///< количество выбранных из БД записей, включая пропущенные
+            while (query.next())
             {
-                const auto recordID = query.value("ID").toULongLong();
-                const auto AZSCode = query.value("AZSCode").toString();
-                if (AZSCode.isEmpty())
-                {
-                    throw TankStatusLoadException(QString("Value [TanksCalculate]/AZSCode cannot be empty. Record ID: %1").arg(recordID));
-                }
+                ++selectedCount;
 
-                const auto tankNumber = query.value("TankNumber").toUInt();
-                if (tankNumber == 0)
+                class TankStatusLoadException
+                    : public std::runtime_error
                 {
-                    throw TankStatusLoadException(QString("Value [TanksCalculate]/TankNumber cannot be empty. Record ID: %1").arg(recordID));
-                }
-                const auto id = TankID(AZSCode, tankNumber);
+                public:
+                    explicit TankStatusLoadException(const QString& what)
+                        : std::runtime_error(what.toStdString())
+                    {}
+                };
 
-                const auto tankConfig = _tanksConfig->getTankConfig(id);
-                const auto lastSendFromDB = query.value("DateTime").toDateTime();
-                if (lastSendFromDB < tankConfig->lastSend())
+                try
                 {
-                    continue;
-                }
+                    const auto recordID = query.value("ID").toULongLong();
+                    const auto AZSCode = query.value("AZSCode").toString();
+                    if (AZSCode.isEmpty())
+                    {
+                        throw TankStatusLoadException(QString("Value [TanksCalculate]/AZSCode cannot be empty. Record ID: %1").arg(recordID));
+                    }
+
+                    const auto tankNumber = query.value("TankNumber").toUInt();
+                    if (tankNumber == 0)
+                    {
+                        throw TankStatusLoadException(QString("Value [TanksCalculate]/TankNumber cannot be empty. Record ID: %1").arg(recordID));
+                    }
+                    const auto id = TankID(AZSCode, tankNumber);
+
+                    const auto tankConfig = _tanksConfig->getTankConfig(id);
+                    const auto lastSendFromDB = query.value("DateTime").toDateTime();
+                    if (lastSendFromDB < sendFrom(id) && query.value("SendStatus").isNull())
+                    {
+                        continue;
+                    }
+
+                    SUNCSync::Measument measument;
+                    measument.volume = query.value("Volume").toDouble();
+                    measument.volumeUnitType = SUNCSync::VolumeUnitType::CUBIC_DECIMETER;
+                    measument.mass = query.value("Mass").toDouble();
+                    measument.massUnitType = SUNCSync::MassUnitType::KILOGRAM;
+                    measument.density = query.value("Density").toDouble();
+                    measument.level = query.value("Height").toDouble();
+                    measument.levelUnitType = SUNCSync::LevelUnitType::MILLIMETER;
+                    measument.measurementDate = query.value("DateTime").toDateTime();
+                    measument.temperature = query.value("Temp").toDouble();
+                    measument.oilProductType = SUNCSync::stringToOilProductType(tankConfig->product());
+
+                    if (!measument.check())
+                    {
+                        throw TankStatusLoadException(QString("Invalid value tank status from [TanksCalculate]. Data: %1. Record ID: %2").arg(measument.toString()).arg(recordID));
+                    }
+
+                    sendIdList.push_back(query.value("ID").toString());
+                    measumentsData[tankConfig->remoteTankId()].emplace_back(std::move(measument));
+                    laneLastSendDateTime.emplace(id, lastSendFromDB);
 
-                SUNCSync::Measument measument;
-                measument.volume = query.value("Volume").toDouble();
-                measument.volumeUnitType = SUNCSync::VolumeUnitType::CUBIC_DECIMETER;
-                measument.mass = query.value("Mass").toDouble();
-                measument.massUnitType = SUNCSync::MassUnitType::KILOGRAM;
-                measument.density = query.value("Density").toDouble();
-                measument.level = query.value("Height").toDouble();
-                measument.levelUnitType = SUNCSync::LevelUnitType::MILLIMETER;
-                measument.measurementDate = query.value("DateTime").toDateTime();
-                measument.temperature = query.value("Temp").toDouble();
-                measument.oilProductType = SUNCSync::stringToOilProductType(tankConfig->product());
-
-                if (!measument.check())
+                }
+                catch (TankStatusLoadException& err)
                 {
-                    throw TankStatusLoadException(QString("Invalid value tank status from [TanksCalculate]. Data: %1. Record ID: %2").arg(measument.toString()).arg(recordID));
+                    emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("Cannot load tank status from DB. Record skipped. Error: %1").arg(err.what()));
                 }
+            }
 
-                sendIdList.push_back(query.value("ID").toString());
-                measumentsData[tankConfig->remoteTankId()].emplace_back(std::move(measument));
-                lastSendDateTime.emplace(id, lastSendFromDB);
+            isFull = isFull || selectedCount >= limit;
 
+            if (lane.type == SendLaneType::REALTIME)
+            {
+                realtimeSelectedCount = selectedCount;
             }
-            catch (TankStatusLoadException& err)
+            else if (lane.type == SendLaneType::BACKLOG)
             {
-                emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("Cannot load tank status from DB. Record skipped. Error: %1").arg(err.what()));
+                isBacklogDrained = selectedCount < limit;
             }
-        } 
+        }
 
         commitDB(_db);
     }
@@ -196,14 +336,14 @@ void SyncHTTPStatus::sendNewStatusesFromDB(qint64 applicantID)
 
         emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_EXECUTE_QUERY_ERR, err.what());
 
-        return;
+        return SendFromDBResult::DB_ERROR;
     }
 
     if (measumentsData.empty())
     {
         emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("No unsent statuses for applicant ID: %1. Skipped").arg(applicantID));
 
-        return;
+        return SendFromDBResult::DRAINED;
     }
 
     SUNCSync::TankIndicators data;
@@ -220,26 +360,377 @@ void SyncHTTPStatus::sendNewStatusesFromDB(qint64 applicantID)
         data.tankMeasurements.emplaceBack(std::move(measuments));
     }
 
+    //время последней отправки по свежим статусам сдвигаем только если накопленные статусы выбраны полностью,
+    //иначе невыбранные накопленные статусы окажутся раньше времени последней отправки и не будут отправлены
+    LastSendDateTime packageTanks = lastSendDateTime;
+    packageTanks.insert(realtimeLastSendDateTime.begin(), realtimeLastSendDateTime.end());
+    if (isBacklogDrained)
+    {
+        lastSendDateTime = packageTanks;
+    }
+
     const auto sendId = applicant.suncSync->sendSendTankIndicators(data);
 
     PackageInfo packageInfo;
     packageInfo.packageId = data.packageId;
     packageInfo.type = SUNCSync::RequestType::SEND_TANK_INDICATORS;
     packageInfo.lastSendDateTime = lastSendDateTime;
+    packageInfo.applicantId = applicantID;
+    packageInfo.recordsCount = sendIdList.size();
+    packageInfo.sendTimer.start();
 
     _sendedRequest.emplace(std::move(sendId), std::move(packageInfo));
 
-    updatePackageStatus(sendIdList, data.packageId, SUNCSync::PackageProcessingStatus::SEND_TO_SERVER);
+    const auto isUpdated = updatePackageStatus(sendIdList, data.packageId, applicantID, packageTanks, SUNCSync::PackageProcessingStatus::SEND_TO_SERVER);
 
+    ++applicant.sendInFlight;
     ++_sendedStatusesCount;
 
     emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Send status package for applicant ID: %1. Package ID: %2. Record ID in [TanksCalculate]: %3")
                     .arg(applicantID)
                     .arg(data.packageId.toString())
                     .arg(sendIdList.join(',')));
+
+    //если записи не помечены ИД пакета - следующий пакет выберет их повторно
+    if (!isUpdated)
+    {
+        return SendFromDBResult::DB_ERROR;
+    }
+
+    //пакет не заполнен - все неотправленные статусы выбраны
+    return isFull ? SendFromDBResult::FULL : SendFromDBResult::DRAINED;
+}
+
+void SyncHTTPStatus::calculateStatuses(const LevelGaugeService::TankID& id, const LevelGaugeService::TankStatusesList& tankStatuses)
+{
+    Q_ASSERT(!tankStatuses.empty());
+
+    if (!_streamMode || !_isStarted)
+    {
+        return;
+    }
+
+    const auto tankConfig = _tanksConfig->findTankConfig(id);
+    if (tankConfig == nullptr)
+    {
+        return;
+    }
+
+    const auto timeShift = tankConfig->timeShift();
+
+    //статусы резервуара, отсутствующего на сервере, в поток не попадают. Они будут выбраны из БД,
+    //когда резервуар появится на сервере (сигнал ApplicantTopologyCache::tanksValid)
+    if (!_topologyCache->isTankValid(id))
+    {
+        //условие выборки из БД строгое, поэтому время сдвигаем на 1 мсек
+        addBacklogFrom(id, tankStatuses.front().dateTime().addSecs(timeShift).addMSecs(-1));
+
+        return;
+    }
+
+    const auto oilProductType = SUNCSync::stringToOilProductType(tankConfig->product());
+    const auto currentDateTime = QDateTime::currentDateTime();
+
+    auto& waiting = _streamWaiting[id];
+    for (const auto& status: tankStatuses)
+    {
+        //время и значения приводятся к виду, в котором они сохраняются в БД, чтобы пакет не отличался от сформированного чтением из БД
+        StreamStatus streamStatus;
+        streamStatus.measument.measurementDate = status.dateTime().addSecs(timeShift);
+        streamStatus.measument.volume = std::round(status.volume());
+        streamStatus.measument.volumeUnitType = SUNCSync::VolumeUnitType::CUBIC_DECIMETER;
+        streamStatus.measument.mass = std::round(status.mass());
+        streamStatus.measument.massUnitType = SUNCSync::MassUnitType::KILOGRAM;
+        streamStatus.measument.density = std::round(status.density() * 10.0f) / 10.0f;
+        streamStatus.measument.level = std::round(status.height() * 10.0f) / 10.0f;
+        streamStatus.measument.levelUnitType = SUNCSync::LevelUnitType::MILLIMETER;
+        streamStatus.measument.temperature = std::round(status.temp() * 10.0f) / 10.0f;
+        streamStatus.measument.oilProductType = oilProductType;
+        streamStatus.receiveDateTime = currentDateTime;
+
+        waiting.insert(streamStatus.measument.measurementDate.toString(DATETIME_FORMAT), std::move(streamStatus));
+    }
+}
+
+void SyncHTTPStatus::savedStatuses(const LevelGaugeService::SavedStatusesIDs& savedIDs)
+{
+    if (!_streamMode || !_isStarted)
+    {
+        return;
+    }
+
+    for (auto savedIDs_it = savedIDs.begin(); savedIDs_it != savedIDs.end(); ++savedIDs_it)
+    {
+        const auto& tankId = savedIDs_it.key();
+
+        auto streamWaiting_it = _streamWaiting.find(tankId);
+        if (streamWaiting_it == _streamWaiting.end())
+        {
+            continue;
+        }
+
+        const auto tankConfig = _tanksConfig->findTankConfig(tankId);
+        if (tankConfig == nullptr)
+        {
+            continue;
+        }
+
+        auto suncSyncs_it = _suncSyncs.find(tankConfig->remoteApplicantId());
+        if (suncSyncs_it == _suncSyncs.end())
+        {
+            continue;
+        }
+
+        auto& applicant = suncSyncs_it->second;
+        auto& waiting = streamWaiting_it.value();
+        for (auto ids_it = savedIDs_it.value().begin(); ids_it != savedIDs_it.value().end(); ++ids_it)
+        {
+            const auto waiting_it = waiting.find(ids_it.key().toString(DATETIME_FORMAT));
+            if (waiting_it == waiting.end())
+            {
+                continue;
+            }
+
+            //пока отправляются записи из БД готовые статусы не накапливаем - они будут прочитаны из БД
+            if (!applicant.isBacklog)
+            {
+                ReadyStatus readyStatus;
+                readyStatus.recordId = ids_it.value();
+                readyStatus.tankId = tankId;
+                readyStatus.measument = std::move(waiting_it->measument);
+
+                applicant.streamReady.push_back(std::move(readyStatus));
+            }
+
+            waiting.erase(waiting_it);
+        }
+
+        if (waiting.isEmpty())
+        {
+            _streamWaiting.erase(streamWaiting_it);
+        }
+    }
 }
 
-void SyncHTTPStatus::updatePackageStatus(const IdList &idList, const QUuid& packageId, SUNCSync::PackageProcessingStatus status)
+void SyncHTTPStatus::expireStreamStatuses(const QDateTime& currentDateTime)
+{
+    Q_ASSERT(_streamMode);
+
+    const auto expireDateTime = currentDateTime.addMSecs(-STREAM_WAIT_TIMEOUT);
+    for (auto streamWaiting_it = _streamWaiting.begin(); streamWaiting_it != _streamWaiting.end();)
+    {
+        const auto& tankId = streamWaiting_it.key();
+        auto& waiting = streamWaiting_it.value();
+
+        //статусы поступают в порядке времени, поэтому достаточно проверить начало списка
+        quint64 expiredCount = 0;
+        while (!waiting.isEmpty() && waiting.first().receiveDateTime < expireDateTime)
+        {
+            //условие выборки из БД строгое, поэтому время сдвигаем на 1 мсек
+            addBacklogFrom(tankId, waiting.first().measument.measurementDate.addMSecs(-1));
+
+            waiting.erase(waiting.begin());
+            ++expiredCount;
+        }
+
+        const auto tankConfig = expiredCount != 0 ? _tanksConfig->findTankConfig(tankId) : nullptr;
+        if (tankConfig != nullptr)
+        {
+            const auto suncSyncs_it = _suncSyncs.find(tankConfig->remoteApplicantId());
+            if (suncSyncs_it != _suncSyncs.end())
+            {
+                suncSyncs_it->second.isBacklog = true;
+            }
+
+            emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("Record IDs of calculated statuses were not received in time. Statuses will be sent from DB. Tank: %1. Count: %2")
+                            .arg(tankId.toString())
+                            .arg(expiredCount));
+        }
+
+        if (waiting.isEmpty())
+        {
+            streamWaiting_it = _streamWaiting.erase(streamWaiting_it);
+        }
+        else
+        {
+            ++streamWaiting_it;
+        }
+    }
+}
+
+void SyncHTTPStatus::addBacklogFrom(const TankID& tankId, const QDateTime& backlogFrom)
+{
+    auto backlogFrom_it = _backlogFrom.find(tankId);
+    if (backlogFrom_it == _backlogFrom.end())
+    {
+        _backlogFrom.insert(tankId, backlogFrom);
+    }
+    else
+    {
+        backlogFrom_it.value() = std::min(backlogFrom_it.value(), backlogFrom);
+    }
+}
+
+bool SyncHTTPStatus::sendNewStatusesFromStream(qint64 applicantID)
+{
+    Q_ASSERT(_db.isOpen());
+    Q_ASSERT(_isStarted);
+    Q_ASSERT(_streamMode);
+
+    auto& applicant = _suncSyncs.at(applicantID);
+
+    const auto packageSize = applicant.sizeController->packageSize();
+
+    std::list<ReadyStatus> packageStatuses;
+    IdList idList;
+    while (!applicant.streamReady.empty() && static_cast<quint32>(idList.size()) < packageSize)
+    {
+        //резервуар мог быть исключен после получения данных организации с сервера. Статус будет выбран из БД,
+        //когда резервуар снова появится на сервере
+        const auto& readyStatus = applicant.streamReady.front();
+        if (!_topologyCache->isTankValid(readyStatus.tankId))
+        {
+            addBacklogFrom(readyStatus.tankId, readyStatus.measument.measurementDate.addMSecs(-1));
+            applicant.streamReady.pop_front();
+
+            continue;
+        }
+
+        idList.push_back(QString::number(applicant.streamReady.front().recordId));
+        packageStatuses.splice(packageStatuses.end(), applicant.streamReady, applicant.streamReady.begin());
+    }
+
+    if (idList.isEmpty())
+    {
+        return false;
+    }
+
+    const auto isFull = !applicant.streamReady.empty();
+
+    SUNCSync::TankIndicators data;
+    data.packageId = QUuid::createUuid();
+
+    const auto claimedIdList = claimPackageStatus(idList, data.packageId, QDateTime::currentDateTime());
+    if (!claimedIdList.has_value())
+    {
+        return false;
+    }
+
+    //записи, уже отправленные чтением из БД, не закрепляются за пакетом
+    if (claimedIdList->isEmpty())
+    {
+        return isFull;
+    }
+
+    const QSet<QString> claimedIds(claimedIdList->begin(), claimedIdList->end());
+
+    std::unordered_map<qint64, QList<SUNCSync::Measument>> measumentsData; //key - remotetankId
+    LastSendDateTime lastSendDateTime;
+    for (auto& readyStatus: packageStatuses)
+    {
+        if (!claimedIds.contains(QString::number(readyStatus.recordId)))
+        {
+            continue;
+        }
+
+        const auto lastSendDateTime_it = lastSendDateTime.find(readyStatus.tankId);
+        if (lastSendDateTime_it == lastSendDateTime.end())
+        {
+            lastSendDateTime.emplace(readyStatus.tankId, readyStatus.measument.measurementDate);
+        }
+        else
+        {
+            lastSendDateTime_it->second = std::max(lastSendDateTime_it->second, readyStatus.measument.measurementDate);
+        }
+
+        measumentsData[_tanksConfig->getTankConfig(readyStatus.tankId)->remoteTankId()].emplaceBack(std::move(readyStatus.measument));
+    }
+
+    for (auto& tankMeasumentsData: measumentsData)
+    {
+        SUNCSync::TankMeasurements measuments;
+        measuments.tankId = tankMeasumentsData.first;
+        measuments.measuments = std::move(tankMeasumentsData.second);
+
+        data.tankMeasurements.emplaceBack(std::move(measuments));
+    }
+
+    const auto sendId = applicant.suncSync->sendSendTankIndicators(data);
+
+    PackageInfo packageInfo;
+    packageInfo.packageId = data.packageId;
+    packageInfo.type = SUNCSync::RequestType::SEND_TANK_INDICATORS;
+    packageInfo.lastSendDateTime = lastSendDateTime;
+    packageInfo.applicantId = applicantID;
+    packageInfo.recordsCount = claimedIdList->size();
+    packageInfo.sendTimer.start();
+
+    _sendedRequest.emplace(std::move(sendId), std::move(packageInfo));
+
+    const auto nextCheck = QDateTime::currentDateTime().addSecs(CHECK_PACKAGE_INTERVAL);
+    for (const auto& lastSend: lastSendDateTime)
+    {
+        _packageIndex.addPackage(data.packageId, lastSend.first, applicantID, SUNCSync::PackageProcessingStatus::SEND_TO_SERVER, nextCheck);
+    }
+
+    ++applicant.sendInFlight;
+    ++_sendedStatusesCount;
+
+    emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Send status package from stream for applicant ID: %1. Package ID: %2. Record ID in [TanksCalculate]: %3")
+                    .arg(applicantID)
+                    .arg(data.packageId.toString())
+                    .arg(claimedIdList->join(',')));
+
+    return isFull;
+}
+
+std::optional<SyncHTTPStatus::IdList> SyncHTTPStatus::claimPackageStatus(const IdList& idList, const QUuid& packageId, const QDateTime& currentDateTime)
+{
+    Q_ASSERT(!packageId.isNull());
+    Q_ASSERT(_db.isOpen());
+
+    const auto currentDateTimeStr = currentDateTime.toString(DATETIME_FORMAT);
+
+    //одним запросом закрепляем за пакетом только еще не отправленные записи и получаем их ИД
+    const auto queryText =
+            QString("UPDATE [TanksCalculate] "
+                    "SET [SendDateTime] = CAST('%1' AS DATETIME2), [UpdateStatusDateTime] = CAST('%2' AS DATETIME2), [PackageID] = '%3', [SendStatus] = %4 "
+                    "OUTPUT INSERTED.[ID] "
+                    "WHERE [ID] IN (%5) AND [PackageID] IS NULL ")
+            .arg(currentDateTimeStr)
+            .arg(currentDateTimeStr)
+            .arg(packageId.toString())
+            .arg(static_cast<quint8>(SUNCSync::PackageProcessingStatus::SEND_TO_SERVER))
+            .arg(idList.join(','));
+
+    IdList result;
+    try
+    {
+        QSqlQuery query(_db);
+        query.setForwardOnly(true);
+
+        DBQueryExecute(_db, query, queryText);
+
+        while (query.next())
+        {
+            result.push_back(query.value("ID").toString());
+        }
+    }
+    catch (const SQLException& err)
+    {
+        emit errorOccurred(SYNC_NAME, EXIT_CODE::SQL_EXECUTE_QUERY_ERR, QString("Cannot claim records for package. Package ID: %1. Records ID: %2. Error: %3")
+                           .arg(packageId.toString())
+                           .arg(idList.join(','))
+                           .arg(err.what()));
+
+        return std::nullopt;
+    }
+
+    return result;
+}
+
+bool SyncHTTPStatus::updatePackageStatus(const IdList &idList, const QUuid& packageId, qint64 applicantId, const LastSendDateTime& lastSendDateTime,
+                                         SUNCSync::PackageProcessingStatus status)
 {
     Q_ASSERT(!packageId.isNull());
     Q_ASSERT(_db.isOpen());
@@ -250,25 +741,30 @@ void SyncHTTPStatus::updatePackageStatus(const IdList &idList, const QUuid& pack
 
         const auto currentDateTime = QDateTime::currentDateTime().toString(DATETIME_FORMAT);
 
-        for (const auto& id: idList)
-        {
-            const auto queryText =
-                    QString("UPDATE [TanksCalculate] "
-                            "SET [SendDateTime] = CAST('%1' AS DATETIME2), [UpdateStatusDateTime] = CAST('%2' AS DATETIME2), [PackageID] = '%3', [SendStatus] = %4 "
-                            "WHERE [ID] = %5 ")
-                    .arg(currentDateTime)
-                    .arg(currentDateTime)
-                    .arg(packageId.toString())
-                    .arg(static_cast<quint8>(status))
-                    .arg(id);
+        //все записи пакета помечаем одним запросом
+        const auto queryText =
+                QString("UPDATE [TanksCalculate] "
+                        "SET [SendDateTime] = CAST('%1' AS DATETIME2), [UpdateStatusDateTime] = CAST('%2' AS DATETIME2), [PackageID] = '%3', [SendStatus] = %4 "
+                        "WHERE [ID] IN (%5) ")
+                .arg(currentDateTime)
+                .arg(currentDateTime)
+                .arg(packageId.toString())
+                .arg(static_cast<quint8>(status))
+                .arg(idList.join(','));
+
+        QSqlQuery query(_db);
 
+        DBQueryExecute(_db, query, queryText);
 
-            QSqlQuery query(_db);
+        commitDB(_db);
 
-            DBQueryExecute(_db, query, queryText);
+        const auto nextCheck = QDateTime::currentDateTime().addSecs(CHECK_PACKAGE_INTERVAL);
+        for (const auto& lastSend: lastSendDateTime)
+        {
+            _packageIndex.addPackage(packageId, lastSend.first, applicantId, status, nextCheck);
         }
 
-        commitDB(_db);
+        return true;
     }
     catch (const SQLException& err)
     {       
@@ -279,6 +775,8 @@ void SyncHTTPStatus::updatePackageStatus(const IdList &idList, const QUuid& pack
                            .arg(SUNCSync::packageProcessingStatusToString(status))
                            .arg(idList.join(','))
                            .arg(err.what()));
+
+        return false;
     }
 }
 
@@ -301,6 +799,8 @@ void SyncHTTPStatus::updatePackageStatus(const QUuid &packageId, SUNCSync::Packa
     try
     {
         DBQueryExecute(_db, queryText);
+
+        _packageIndex.updateStatus(packageId, status, QDateTime::currentDateTime().addSecs(CHECK_PACKAGE_INTERVAL));
     }
     catch (const SQLException& err)
     {
@@ -326,6 +826,19 @@ void SyncHTTPStatus::clearPackageStatus(const QUuid &packageId)
     try
     {
         DBQueryExecute(_db, queryText);
+
+        //записи пакета будут отправлены повторно чтением из БД
+        const auto packageInfo = _packageIndex.package(packageId);
+        if (packageInfo != nullptr)
+        {
+            const auto suncSyncs_it = _suncSyncs.find(packageInfo->applicantId);
+            if (suncSyncs_it != _suncSyncs.end())
+            {
+                suncSyncs_it->second.isBacklog = true;
+            }
+        }
+
+        _packageIndex.remove(packageId);
     }
     catch (const SQLException& err)
     {
@@ -336,41 +849,149 @@ void SyncHTTPStatus::clearPackageStatus(const QUuid &packageId)
     }
 }
 
+void SyncHTTPStatus::tanksValid(const LevelGaugeService::TankIDList& tanksId)
+{
+    if (!_streamMode)
+    {
+        return;
+    }
+
+    //статусы, не попавшие в поток пока резервуара не было на сервере, отправляются чтением из БД
+    for (const auto& tankId: tanksId)
+    {
+        const auto tankConfig = _tanksConfig->findTankConfig(tankId);
+        if (tankConfig == nullptr)
+        {
+            continue;
+        }
+
+        const auto suncSyncs_it = _suncSyncs.find(tankConfig->remoteApplicantId());
+        if (suncSyncs_it != _suncSyncs.end())
+        {
+            suncSyncs_it->second.isBacklog = true;
+        }
+    }
+}
+
 SyncHTTPStatus::~SyncHTTPStatus()
 {
     stop();
 }
 
-void SyncHTTPStatus::start()
+void SyncHTTPStatus::addApplicantTank(const TankID& tankId)
 {
-    Q_ASSERT(!_isStarted);
+    const auto tankConfig =  _tanksConfig->getTankConfig(tankId);
 
-    for (const auto& tankId: _tanksConfig->getTanksID())
+    auto suncSyncs_it = _suncSyncs.find(tankConfig->remoteApplicantId());
+    if (suncSyncs_it != _suncSyncs.end())
     {
-        const auto tankConfig =  _tanksConfig->getTankConfig(tankId);
+        suncSyncs_it->second.tanksID.push_back(tankId);
 
-        auto suncSyncs_it = _suncSyncs.find(tankConfig->remoteApplicantId());
-        if (suncSyncs_it != _suncSyncs.end())
+        return;
+    }
+
+    ApplicantData applicant;
+    applicant.tanksID.push_back(tankId);
+    applicant.suncSync = std::make_unique<SUNCSync>(_httpClientPool, tankConfig->remoteBaseUrl(), tankConfig->remoteBearerToken(),
+                                                     _compressionLevels.level(tankConfig->remoteApplicantId()));
+
+    QObject::connect(applicant.suncSync.get(), SIGNAL(errorRequest(const QString&, LevelGaugeService::SUNCSync::PackageProcessingStatus, quint64)),
+                                 SLOT(errorRequest(const QString&, LevelGaugeService::SUNCSync::PackageProcessingStatus, quint64)));
+    QObject::connect(applicant.suncSync.get(), SIGNAL(sendLogMsg(Common::TDBLoger::MSG_CODE, const QString&, quint64)),
+                                 SLOT(sendLogMsgHTTP(Common::TDBLoger::MSG_CODE, const QString&, quint64)));
+    QObject::connect(applicant.suncSync.get(), SIGNAL(sendTankIndicators(const LevelGaugeService::SUNCSync::TankIndicatorsInfo&, quint64)),
+                                 SLOT(sendTankIndicators(const LevelGaugeService::SUNCSync::TankIndicatorsInfo&, quint64)));
+
+    applicant.sizeController = std::make_unique<PackageSizeController>(_packageSizeLimits, INIT_PACKAGE_SIZE);
+    applicant.nextSend = QDateTime::currentDateTime().addMSecs(applicant.sizeController->sendInterval());
+
+    _packageTracker.addApplicant(tankConfig->remoteApplicantId(), applicant.suncSync.get());
+
+    _suncSyncs.emplace(tankConfig->remoteApplicantId(), std::move(applicant));
+}
+
+void SyncHTTPStatus::removeTanks(const LevelGaugeService::TankIDList& tanksId)
+{
+    if (!_isStarted)
+    {
+        return;
+    }
+
+    const QSet<TankID> removedTanks(tanksId.begin(), tanksId.end());
+
+    //статусы резервуаров, ожидающие отправки, остаются в БД и будут прочитаны из БД если резервуар будет добавлен снова
+    for (const auto& tankId: tanksId)
+    {
+        _streamWaiting.remove(tankId);
+        _backlogFrom.remove(tankId);
+    }
+
+    _packageIndex.removeTanks(removedTanks);
+
+    for (auto suncSyncs_it = _suncSyncs.begin(); suncSyncs_it != _suncSyncs.end();)
+    {
+        auto& applicant = suncSyncs_it->second;
+        applicant.tanksID.remove_if([&removedTanks](const TankID& tankId){ return removedTanks.contains(tankId); });
+        applicant.streamReady.remove_if([&removedTanks](const ReadyStatus& readyStatus){ return removedTanks.contains(readyStatus.tankId); });
+
+        if (!applicant.tanksID.empty())
         {
-            suncSyncs_it->second.tanksID.push_back(tankId);
+            ++suncSyncs_it;
+
+            continue;
+        }
+
+        //у организации не осталось резервуаров. Ответы на отправленные запросы будут пропущены
+        const auto applicantId = suncSyncs_it->first;
+
+        _packageTracker.removeApplicant(applicantId);
+        _packageIndex.removeApplicant(applicantId);
 
+        const auto removedCount = _sendedRequest.removeIf([applicantId](QHash<quint64, PackageInfo>::iterator it){ return it->applicantId == applicantId; });
+        _sendedStatusesCount -= std::min<quint64>(_sendedStatusesCount, removedCount);
+
+        suncSyncs_it = _suncSyncs.erase(suncSyncs_it);
+
+        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Applicant has no tanks and removed. Applicant ID: %1").arg(applicantId));
+    }
+}
+
+void SyncHTTPStatus::addTanks(const LevelGaugeService::TankIDList& tanksId)
+{
+    if (!_isStarted)
+    {
+        return;
+    }
+
+    TankIDList addedTanks;
+    for (const auto& tankId: tanksId)
+    {
+        if (!_tanksConfig->isExist(tankId))
+        {
             continue;
         }
 
-        ApplicantData applicant;
-        applicant.tanksID.push_back(tankId);
-        applicant.suncSync = std::make_unique<SUNCSync>(tankConfig->remoteBaseUrl(), tankConfig->remoteBearerToken());
+        addApplicantTank(tankId);
 
-        QObject::connect(applicant.suncSync.get(), SIGNAL(errorRequest(const QString&, LevelGaugeService::SUNCSync::PackageProcessingStatus, quint64)),
-                                     SLOT(errorRequest(const QString&, LevelGaugeService::SUNCSync::PackageProcessingStatus, quint64)));
-        QObject::connect(applicant.suncSync.get(), SIGNAL(sendLogMsg(Common::TDBLoger::MSG_CODE, const QString&, quint64)),
-                                     SLOT(sendLogMsgHTTP(Common::TDBLoger::MSG_CODE, const QString&, quint64)));
-        QObject::connect(applicant.suncSync.get(), SIGNAL(getPackageStatus(const LevelGaugeService::SUNCSync::PackageStatusInfo&, quint64)),
-                                     SLOT(getPackageStatus(const LevelGaugeService::SUNCSync::PackageStatusInfo&, quint64)));
-        QObject::connect(applicant.suncSync.get(), SIGNAL(sendTankIndicators(const LevelGaugeService::SUNCSync::TankIndicatorsInfo&, quint64)),
-                                     SLOT(sendTankIndicators(const LevelGaugeService::SUNCSync::TankIndicatorsInfo&, quint64)));
+        //неотправленные статусы добавленного резервуара есть только в БД
+        _suncSyncs.at(_tanksConfig->getTankConfig(tankId)->remoteApplicantId()).isBacklog = true;
 
-        _suncSyncs.emplace(tankConfig->remoteApplicantId(), std::move(applicant));
+        addedTanks.push_back(tankId);
+    }
+
+    if (!addedTanks.isEmpty())
+    {
+        loadPackagesFromDB("TanksCalculate", addedTanks);
+    }
+}
+
+void SyncHTTPStatus::start()
+{
+    Q_ASSERT(!_isStarted);
+
+    for (const auto& tankId: _tanksConfig->getTanksID())
+    {
+        addApplicantTank(tankId);
     }
 
     try
@@ -384,13 +1005,9 @@ void SyncHTTPStatus::start()
         return;
     }
 
-    //check status
-    Q_ASSERT(_checkStatusTimer == nullptr);
-    _checkStatusTimer = new QTimer();
+    loadPackagesFromDB("TanksCalculate");
 
-    QObject::connect(_checkStatusTimer, SIGNAL(timeout()), SLOT(checkPackage()));
-
-    _checkStatusTimer->start(1000);
+    _packageTracker.start();
 
     //send Status
     Q_ASSERT(_sendStatusTimer == nullptr);
@@ -398,7 +1015,7 @@ void SyncHTTPStatus::start()
 
     QObject::connect(_sendStatusTimer, SIGNAL(timeout()), SLOT(sendNewStatuses()));
 
-    _sendStatusTimer->start(60000);
+    _sendStatusTimer->start(1000);
 
     _isStarted = true;
 }
@@ -410,10 +1027,18 @@ void SyncHTTPStatus::stop()
         return;
     }
 
+    _packageTracker.stop();
+
     _suncSyncs.clear();
+    _sendedRequest.clear();
+    _packageIndex.clear();
+    _streamWaiting.clear();
+    _backlogFrom.clear();
 
     delete _sendStatusTimer;
-    delete _checkStatusTimer;
+    _sendStatusTimer = nullptr;
+
+    _sendedStatusesCount = 0;
 
     closeDB(_db);
 
@@ -424,33 +1049,63 @@ void SyncHTTPStatus::sendNewStatuses()
 {
     Q_ASSERT(_isStarted);
 
-    if (_sendedStatusesCount != 0)
+    //каждая организация с собственным интервалом отправляет до _sendPackageWindow пакетов одновременно.
+    //Пакеты формируются из непересекающихся наборов записей, т.к. записи отправленного пакета сразу помечаются его ИД.
+    //Следующий пакет в пределах окна формируется только если предыдущий был заполнен полностью - т.е. есть накопленные данные
+    const auto currentDateTime = QDateTime::currentDateTime();
+
+    if (_streamMode)
     {
-        return;
+        expireStreamStatuses(currentDateTime);
     }
 
-    for (const auto& applicant: _suncSyncs)
+    for (auto& [applicantId, applicant]: _suncSyncs)
     {
-        sendNewStatusesFromDB(applicant.first);
-    }
-}
+        if (applicant.sendInFlight >= _sendPackageWindow || applicant.nextSend > currentDateTime || !applicant.suncSync->isAvailable())
+        {
+            continue;
+        }
 
-void SyncHTTPStatus::sendCheckPackage(const CheckPackageData& packageData)
-{
-    Q_ASSERT(_isStarted);
+        applicant.nextSend = currentDateTime.addMSecs(applicant.sizeController->sendInterval());
+
+        while (applicant.sendInFlight < _sendPackageWindow && applicant.suncSync->isAvailable())
+        {
+            //в потоковом режиме записи читаются из БД только пока в БД могут быть неотправленные записи, отсутствующие в потоке
+            if (_streamMode && !applicant.isBacklog)
+            {
+                if (!sendNewStatusesFromStream(applicantId))
+                {
+                    break;
+                }
 
-    const auto tankConfig = _tanksConfig->getTankConfig(packageData.tankId);
-    const auto sendId = _suncSyncs.at(tankConfig->remoteApplicantId()).suncSync->sendGetPackageStatus(packageData.packageId);
+                continue;
+            }
 
-    PackageInfo packageInfo;
-    packageInfo.packageId = packageData.packageId;
-    packageInfo.type = SUNCSync::RequestType::GET_PACKAGE_STATUS;
+            const auto result = sendNewStatusesFromDB(applicantId);
+            if (result == SendFromDBResult::FULL)
+            {
+                continue;
+            }
 
-    _sendedRequest.emplace(std::move(sendId), std::move(packageInfo));
+            //при ошибке или отсутствии резервуаров для отправки накопленные статусы остаются в БД
+            if (_streamMode && result == SendFromDBResult::DRAINED)
+            {
+                applicant.isBacklog = false;
+                for (const auto& tankId: applicant.tanksID)
+                {
+                    //статусы резервуаров, отсутствующих на сервере, из БД не выбирались - их время сохраняется до появления резервуара на сервере
+                    if (_topologyCache->isTankValid(tankId))
+                    {
+                        _backlogFrom.remove(tankId);
+                    }
+                }
 
-    emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Check status package on the server. Package ID: %1").arg(packageData.packageId.toString()));
+                emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("All unsent statuses read from DB. Switch to stream mode for applicant ID: %1").arg(applicantId));
+            }
 
-    _isSendedCheckPackage = true;
+            break;
+        }
+    }
 }
 
 void SyncHTTPStatus::sendLogMsgHTTP(Common::TDBLoger::MSG_CODE category, const QString &msg, quint64 id)
@@ -465,112 +1120,60 @@ void SyncHTTPStatus::errorRequest(const QString &msg, LevelGaugeService::SUNCSyn
         return;
     }
 
+    //ошибки запросов проверки статуса пакета обрабатывает PackageTracker
     const auto sendedRequest_it = _sendedRequest.find(id);
-
-    Q_ASSERT(sendedRequest_it != _sendedRequest.end());
-
-    const auto& packageInfo = sendedRequest_it.value();
-
-    switch (packageInfo.type)
-    {
-    case SUNCSync::RequestType::SEND_TANK_INDICATORS:
+    if (sendedRequest_it == _sendedRequest.end())
     {
-        switch (status)
-        {
-        case SUNCSync::PackageProcessingStatus::INCORRECT_DATA_ERROR:
-            updatePackageStatus(packageInfo.packageId, status, msg);
-
-            break;
-        case SUNCSync::PackageProcessingStatus::HTTP_ERROR:
-            updatePackageStatus(packageInfo.packageId, status, msg);
-            break;
-        default:
-            Q_ASSERT(false);
-        }
+        return;
+    }
 
-        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("An unsuccessful attempt to send status data to the server. Package ID: %1. Status: %2. Message: %3")
-                             .arg(packageInfo.packageId.toString())
-                             .arg(SUNCSync::packageProcessingStatusToString(status))
-                             .arg(msg));
+    const auto& packageInfo = sendedRequest_it.value();
 
-        --_sendedStatusesCount;
+    Q_ASSERT(packageInfo.type == SUNCSync::RequestType::SEND_TANK_INDICATORS);
 
-        break;
-    }
-    case SUNCSync::RequestType::GET_PACKAGE_STATUS:
+    switch (status)
     {
-        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("An unsuccessful check package status to the server. Package ID: %1. Status: %2. Message: %3")
-                             .arg(packageInfo.packageId.toString())
-                             .arg(SUNCSync::packageProcessingStatusToString(status))
-                             .arg(msg));
-
-        _isSendedCheckPackage = false;
+    case SUNCSync::PackageProcessingStatus::INCORRECT_DATA_ERROR:
+        updatePackageStatus(packageInfo.packageId, status, msg);
 
         break;
-    }
+    case SUNCSync::PackageProcessingStatus::HTTP_ERROR:
+    case SUNCSync::PackageProcessingStatus::SERVER_UNAVAILABLE:
+    case SUNCSync::PackageProcessingStatus::REQUEST_ERROR:
+        updatePackageStatus(packageInfo.packageId, SUNCSync::PackageProcessingStatus::HTTP_ERROR, msg);
+        _packageTracker.sendFailed(packageInfo.packageId, packageInfo.applicantId);
+        //размер пакета уменьшается только при перегрузке сервера или канала связи. Запрос, отклоненный без отправки
+        //или из-за ошибки в самом запросе, о перегрузке не говорит
+        if (status == SUNCSync::PackageProcessingStatus::HTTP_ERROR)
+        {
+            packageSent(packageInfo, false);
+        }
 
+        break;
     default:
         Q_ASSERT(false);
     }
 
-    _sendedRequest.erase(sendedRequest_it);
-}
-
-void SyncHTTPStatus::getPackageStatus(const SUNCSync::PackageStatusInfo& status, quint64 id)
-{
-    if (!_isStarted)
-    {
-        return;
-    }
-
-    const auto sendedRequest_it = _sendedRequest.find(id);
-
-    Q_ASSERT(sendedRequest_it != _sendedRequest.end());
-
-    const auto& packageInfo = sendedRequest_it.value();
-
-    if (status.success)
-    {
-        updatePackageStatus(packageInfo.packageId, status.packageProcessingStatus, "");
-
-        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("The package status has been successfully received from the server and chenged status to SUCCESS. Package ID: %1. Status: %2")
-                        .arg(packageInfo.packageId.toString())
-                        .arg(SUNCSync::packageProcessingStatusToString(status.packageProcessingStatus)));
-    }
-    else
-    {
-        //полное сообщение выглядит как "PackageId %1 wasn`t found.", но символ ` заменяеться ' на в QString и сравнение не срабатывает
-        //поэтому срас=вниваем только половину фразы
-        if (status.error.contains(QString("PackageId %1 wasn").arg(packageInfo.packageId.toString(QUuid::WithoutBraces)), Qt::CaseInsensitive))
-        {
-            clearPackageStatus(packageInfo.packageId);
-
-            emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Status package not found on server. Clear PackageID and will retry send statuses. Package ID: %1")
-                        .arg(packageInfo.packageId.toString()));
-        }
-        else
-        {
-            updatePackageStatus(packageInfo.packageId, SUNCSync::PackageProcessingStatus::SERVER_ERROR, status.error);
+    emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("An unsuccessful attempt to send status data to the server. Package ID: %1. Status: %2. Message: %3")
+                         .arg(packageInfo.packageId.toString())
+                         .arg(SUNCSync::packageProcessingStatusToString(status))
+                         .arg(msg));
 
-            emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("Failed to get the package status from the server and chenged status to SERVER_ERROR. Package ID: %1. Error: %2")
-                        .arg(packageInfo.packageId.toString())
-                        .arg(status.error));
-        }
-    }
+    finishSendPackage(packageInfo);
 
     _sendedRequest.erase(sendedRequest_it);
-
-    _isSendedCheckPackage = false;
 }
 
 void SyncHTTPStatus::sendTankIndicators(const SUNCSync::TankIndicatorsInfo& tankIndicators, quint64 id)
 {
     Q_ASSERT(_isStarted);
-    Q_ASSERT(_sendedStatusesCount != 0);
 
+    //запрос организации, удаленной при изменении конфигурации резервуаров
     const auto sendedRequest_it = _sendedRequest.find(id);
-
-    Q_ASSERT(sendedRequest_it != _sendedRequest.end());
+    if (sendedRequest_it == _sendedRequest.end())
+    {
+        return;
+    }
 
     const auto& packageInfo = sendedRequest_it.value();
 
@@ -580,6 +1183,8 @@ void SyncHTTPStatus::sendTankIndicators(const SUNCSync::TankIndicatorsInfo& tank
 
         emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("Package sended to the server successfully and chenged status to PENDING. Package ID: %1")
                     .arg(packageInfo.packageId.toString()));
+
+        packageSent(packageInfo, true);
     }
     else
     {
@@ -588,40 +1193,58 @@ void SyncHTTPStatus::sendTankIndicators(const SUNCSync::TankIndicatorsInfo& tank
         emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::WARNING_CODE, QString("Failed to sending package status to the server and chenged status to SERVER_ERROR. Package ID: %1. Error: %2")
                     .arg(packageInfo.packageId.toString())
                     .arg(tankIndicators.error));
+
+        packageSent(packageInfo, false);
     }
 
+    //ответы на одновременно отправленные пакеты могут приходить в любом порядке - время последней отправки только увеличиваем
     for (const auto& lastSend: packageInfo.lastSendDateTime)
     {
-        _tanksConfig->getTankConfig(lastSend.first)->setLastSend(lastSend.second);
+        //резервуар мог быть удален из конфигурации после отправки пакета
+        auto tankConfig = _tanksConfig->findTankConfig(lastSend.first);
+        if (tankConfig != nullptr && tankConfig->lastSend() < lastSend.second)
+        {
+            tankConfig->setLastSend(lastSend.second);
+        }
     }
 
-    _sendedRequest.erase(sendedRequest_it);
+    finishSendPackage(packageInfo);
 
-    --_sendedStatusesCount;
+    _sendedRequest.erase(sendedRequest_it);
 }
 
-void SyncHTTPStatus::checkPackage()
+void SyncHTTPStatus::packageSent(const PackageInfo& packageInfo, bool success)
 {
-    Q_ASSERT(_isStarted);
+    Q_ASSERT(packageInfo.type == SUNCSync::RequestType::SEND_TANK_INDICATORS);
 
-    if (_isSendedCheckPackage)
+    const auto suncSyncs_it = _suncSyncs.find(packageInfo.applicantId);
+    if (suncSyncs_it == _suncSyncs.end())
     {
         return;
     }
 
-    const auto needCheckUuid = needCheckPackageFromDB("TanksCalculate");
-    if (needCheckUuid.has_value())
+    auto& sizeController = suncSyncs_it->second.sizeController;
+    const auto isChanged = success ? sizeController->success(packageInfo.sendTimer.elapsed(), packageInfo.recordsCount) : sizeController->failure();
+    if (isChanged)
     {
-       sendCheckPackage(needCheckUuid.value());
-       _checkStatusTimer->setInterval(1000);
+        emit sendLogMsg(SYNC_NAME, TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Status package parameters changed for applicant ID: %1. %2")
+                        .arg(packageInfo.applicantId)
+                        .arg(sizeController->toString()));
     }
-    else
-    {
-        _checkStatusTimer->setInterval(60000);
-    }
-
-    //далее ждем сигнала getPackageStatus(...)
 }
 
+void SyncHTTPStatus::finishSendPackage(const PackageInfo& packageInfo)
+{
+    Q_ASSERT(packageInfo.type == SUNCSync::RequestType::SEND_TANK_INDICATORS);
 
+    const auto suncSyncs_it = _suncSyncs.find(packageInfo.applicantId);
+    if (suncSyncs_it != _suncSyncs.end() && suncSyncs_it->second.sendInFlight != 0)
+    {
+        --suncSyncs_it->second.sendInFlight;
+    }
 
+    if (_sendedStatusesCount != 0)
+    {
+        --_sendedStatusesCount;
+    }
+}
@@ -6,12 +6,15 @@
 
 //STL
 #include <optional>
+#include <list>
 
 //Qt
 #include <QObject>
 #include <QHash>
+#include <QMap>
 #include <QSet>
 #include <QTimer>
+#include <QElapsedTimer>
 
 //My
 #include "Common/common.h"
@@ -22,6 +25,12 @@
 #include "sync.h"
 
 #include "suncsync.h"
+#include "httpclientpool.h"
+#include "applicanttopologycache.h"
+#include "packageindex.h"
+#include "packagetracker.h"
+#include "compression.h"
+#include "packagesizecontroller.h"
 
 namespace LevelGaugeService
 {
@@ -36,36 +45,76 @@ public:
         Конструктор
         @param dbConnectionInfo - ссылка на информацию о подключении к БД
         @param tankConfig - ссылка на конфигурацию резервуара
+        @param httpClientPool - общий пул HTTP клиентов
+        @param topologyCache - кеш данных организаций на сервере
+        @param checkPackageWindow - максимальное количество одновременных запросов проверки статуса пакета для одной организации
+        @param sendPackageWindow - максимальное количество одновременно отправляемых пакетов статусов для одной организации
+        @param compressionLevels - уровни сжатия запросов отправки данных на сервер
+        @param packageSizeLimits - ограничения размера пакета и интервала отправки статусов для одной организации
+        @param streamMode - формировать пакеты из вычисленных статусов и ИД добавленных в БД записей без повторного чтения из БД
+        @param realtimeWindow - статусы моложе этого времени отправляются в первую очередь, мсек. 0 - статусы отправляются в порядке времени
+        @param backlogShare - минимальная доля пакета для накопленных статусов, %
         @param parent - указатель на родительский класс
     */
-    SyncHTTPStatus(const Common::DBConnectionInfo& dbConnectionInfo, LevelGaugeService::TanksConfig* tanksConfig, QObject* parent = nullptr);
+    SyncHTTPStatus(const Common::DBConnectionInfo& dbConnectionInfo, LevelGaugeService::TanksConfig* tanksConfig,
+                   LevelGaugeService::HTTPClientPool* httpClientPool, LevelGaugeService::ApplicantTopologyCache* topologyCache,
+                   quint32 checkPackageWindow, quint32 sendPackageWindow, const LevelGaugeService::CompressionLevels& compressionLevels,
+                   const LevelGaugeService::PackageSizeController::Limits& packageSizeLimits, bool streamMode, qint64 realtimeWindow, quint32 backlogShare,
+                   QObject* parent = nullptr);
 
     /*!
         Деструктор
     */
     ~SyncHTTPStatus();
 
+    void calculateStatuses(const LevelGaugeService::TankID& id, const LevelGaugeService::TankStatusesList& tankStatuses) override;
+    void savedStatuses(const LevelGaugeService::SavedStatusesIDs& savedIDs) override;
+
+    void removeTanks(const LevelGaugeService::TankIDList& tanksId) override;
+    void addTanks(const LevelGaugeService::TankIDList& tanksId) override;
+
     void start() override;
     void stop() override;
 
 private slots:
     void sendNewStatuses();
-    void checkPackage();
 
     void sendLogMsgHTTP(Common::TDBLoger::MSG_CODE category, const QString& msg, quint64 id);
     void errorRequest(const QString& msg, LevelGaugeService::SUNCSync::PackageProcessingStatus status, quint64 id);
-    void getPackageStatus(const LevelGaugeService::SUNCSync::PackageStatusInfo& status, quint64 id);
     void sendTankIndicators(const LevelGaugeService::SUNCSync::TankIndicatorsInfo& tankIndicators, quint64 id);
 
+    void updatePackageStatus(const QUuid& packageId, LevelGaugeService::SUNCSync::PackageProcessingStatus status, const QString& errorMessage);
+    void clearPackageStatus(const QUuid& packageId);
+
+    void tanksValid(const LevelGaugeService::TankIDList& tanksId);
+
 private:
     using IdList = QStringList;
 
     using LastSendDateTime = std::unordered_map<TankID, QDateTime>;
 
-    struct CheckPackageData
+    ///< Полоса отправки статусов
+    enum class SendLaneType: quint8
     {
-        QUuid packageId;
-        TankID tankId;
+        ALL = 0,        ///< Все статусы в порядке времени
+        REALTIME = 1,   ///< Свежие статусы (за последние _realtimeWindow мсек)
+        BACKLOG = 2     ///< Накопленные статусы
+    };
+
+    ///< Результат отправки статусов чтением из БД
+    enum class SendFromDBResult: quint8
+    {
+        FULL = 0,       ///< Пакет заполнен полностью - в БД вероятно остались неотправленные статусы
+        DRAINED = 1,    ///< Все неотправленные статусы выбраны из БД
+        NO_TANKS = 2,   ///< У организации нет резервуаров, данные которых можно отправить
+        DB_ERROR = 3    ///< Ошибка выборки статусов или пометки записей ИД пакета
+    };
+
+    struct SendLane
+    {
+        SendLaneType type = SendLaneType::ALL;
+        quint32 limit = 0;  ///< Количество записей полосы в пакете
+        QString filter;     ///< Условие выборки записей полосы
     };
 
     struct PackageInfo
@@ -73,12 +122,35 @@ private:
         QUuid packageId;
         SUNCSync::RequestType type = SUNCSync::RequestType::UNDEFINED;
         LastSendDateTime lastSendDateTime;
+        qint64 applicantId = 0;
+        quint32 recordsCount = 0;   ///< Количество записей в пакете
+        QElapsedTimer sendTimer;    ///< Время с момента отправки пакета
+    };
+
+    ///< Вычисленный статус, ожидающий ИД записи в БД
+    struct StreamStatus
+    {
+        SUNCSync::Measument measument;
+        QDateTime receiveDateTime;  ///< Время получения статуса
+    };
+
+    ///< Сохраненный в БД статус, готовый к отправке
+    struct ReadyStatus
+    {
+        quint64 recordId = 0;       ///< ИД записи в [TanksCalculate]
+        TankID tankId;
+        SUNCSync::Measument measument;
     };
 
     struct ApplicantData
     {
         std::unique_ptr<LevelGaugeService::SUNCSync> suncSync;
         std::list<TankID> tanksID;
+        std::unique_ptr<LevelGaugeService::PackageSizeController> sizeController; ///< Размер пакета и интервал отправки статусов
+        quint32 sendInFlight = 0;            ///< Количество отправленных пакетов статусов, на которые еще не получен ответ
+        QDateTime nextSend;                  ///< Время следующей отправки статусов
+        std::list<ReadyStatus> streamReady;  ///< Статусы, готовые к отправке в потоковом режиме
+        bool isBacklog = true;               ///< В БД могут быть неотправленные записи, отсутствующие в потоке. Они отправляются чтением из БД
     };
 
 private:
@@ -86,24 +158,94 @@ private:
     SyncHTTPStatus() = delete;
     Q_DISABLE_COPY_MOVE(SyncHTTPStatus)
 
-    std::optional<CheckPackageData> needCheckPackageFromDB(const QString& tableName); ///< загружает повторно все записи по которые находятся в состоянии обработки и отправлет запрос на подтверждение
+    /*!
+        Заполняет индекс пакетов всеми пакетами, которые находятся в состоянии обработки. Вызывается при запуске и при
+            добавлении резервуаров, далее индекс поддерживается при изменении статусов пакетов
+        @param tableName - имя таблицы
+        @param tanksId - резервуары, пакеты которых загружаются. Если список пустой - индекс очищается и загружаются пакеты всех резервуаров
+    */
+    void loadPackagesFromDB(const QString& tableName, const LevelGaugeService::TankIDList& tanksId = {});
 
-    void sendNewStatusesFromDB(qint64 applicantID);
     /*!
-        Проверяет состояние обработки отправленного на сервер пакета
-        @param packetId - ИД пакета
+        Добавляет резервуар в список резервуаров организации. Если организации еще нет - создает клиент сервера организации
+        @param tankId - ИД резервуара
     */
-    void sendCheckPackage(const CheckPackageData& packageData);
+    void addApplicantTank(const LevelGaugeService::TankID& tankId);
 
-    void updatePackageStatus(const IdList &idList, const QUuid& packageID, SUNCSync::PackageProcessingStatus status);
-    void updatePackageStatus(const QUuid& packageId, SUNCSync::PackageProcessingStatus status, const QString& errorMessage);
-    void clearPackageStatus(const QUuid& packageId);
+    /*!
+        Формирует и отправляет на сервер пакет неотправленных статусов организации
+        @param applicantID - ИД организации
+        @return результат отправки. Накопленные статусы считаются отправленными только при SendFromDBResult::DRAINED
+    */
+    SendFromDBResult sendNewStatusesFromDB(qint64 applicantID);
+
+    /*!
+        Формирует и отправляет на сервер пакет из статусов, готовых к отправке в потоковом режиме. Записи пакета
+            предварительно закрепляются за пакетом в БД, записи уже отправленные чтением из БД пропускаются
+        @param applicantID - ИД организации
+        @return true если пакет заполнен полностью, т.е. есть еще готовые к отправке статусы
+    */
+    bool sendNewStatusesFromStream(qint64 applicantID);
+
+    /*!
+        Удаляет статусы, ИД записей которых не были получены за допустимое время (запись в БД не удалась или
+            запись уже существовала). Такие записи будут отправлены чтением из БД
+        @param currentDateTime - текущее время
+    */
+    void expireStreamStatuses(const QDateTime& currentDateTime);
+
+    /*!
+        Запоминает время статуса резервуара, не попавшего в поток. Статусы начиная с этого времени будут выбраны из БД
+        @param tankId - ИД резервуара
+        @param backlogFrom - время статуса в БД
+    */
+    void addBacklogFrom(const LevelGaugeService::TankID& tankId, const QDateTime& backlogFrom);
+
+    /*!
+        Закрепляет записи за пакетом. Записи, уже закрепленные за другим пакетом, пропускаются
+        @param idList - список ИД записей
+        @param packageId - ИД пакета
+        @param currentDateTime - время отправки пакета
+        @return список ИД закрепленных записей или std::nullopt в случае ошибки
+    */
+    std::optional<IdList> claimPackageStatus(const IdList& idList, const QUuid& packageId, const QDateTime& currentDateTime);
+
+    /*!
+        Возвращает время, начиная с которого статусы резервуара выбираются из БД
+        @param tankId - ИД резервуара
+    */
+    QDateTime sendFrom(const TankID& tankId) const;
+
+    /*!
+        Передает результат отправки пакета регулятору размера пакета организации
+        @param packageInfo - информация о запросе отправки
+        @param success - true если сервер принял пакет
+    */
+    void packageSent(const PackageInfo& packageInfo, bool success);
+
+    /*!
+        Завершает отправку пакета и освобождает место в окне отправки организации
+        @param packageInfo - информация о запросе отправки
+    */
+    void finishSendPackage(const PackageInfo& packageInfo);
 
-    QString tankFilter(qint64 applicantID) const;
+    bool updatePackageStatus(const IdList &idList, const QUuid& packageID, qint64 applicantId, const LastSendDateTime& lastSendDateTime,
+                             SUNCSync::PackageProcessingStatus status);
+
+    /*!
+        Возвращает условие выборки неотправленных статусов организации
+        @param applicantID - ИД организации
+        @param laneType - полоса отправки
+        @param currentDateTime - текущее время, от которого отсчитывается граница свежих статусов
+        @return условие выборки. Пустая строка если отправлять нечего
+    */
+    QString tankFilter(qint64 applicantID, SendLaneType laneType, const QDateTime& currentDateTime) const;
 
 private:
     const Common::DBConnectionInfo _dbConnectionInfo;
     LevelGaugeService::TanksConfig* _tanksConfig;
+    LevelGaugeService::HTTPClientPool* _httpClientPool = nullptr; ///< Общий пул HTTP клиентов
+    LevelGaugeService::ApplicantTopologyCache* _topologyCache = nullptr; ///< Кеш данных организаций на сервере
 
     std::unordered_map<qint64, ApplicantData> _suncSyncs; //key - ApplicantID, value SUNCSync;
 
@@ -111,12 +253,23 @@ private:
 
     QHash<quint64, PackageInfo> _sendedRequest; ///< Карта отправленных запросов для которух нужно проверить статус. Ключ - ИД запроса из SUNCSync
 
-    QTimer* _checkStatusTimer = nullptr;
     QTimer* _sendStatusTimer = nullptr;
 
     bool _isStarted = false;
     quint64 _sendedStatusesCount = 0; // количество незвершенных  запросов со статусами резервуаров отправленных на сервер
-    bool _isSendedCheckPackage = false;
+
+    const quint32 _sendPackageWindow = 1;   ///< Максимальное количество одновременно отправляемых пакетов статусов для одной организации
+    const LevelGaugeService::CompressionLevels _compressionLevels; ///< Уровни сжатия запросов отправки данных на сервер
+    const LevelGaugeService::PackageSizeController::Limits _packageSizeLimits; ///< Ограничения размера пакета и интервала отправки статусов
+    LevelGaugeService::PackageIndex _packageIndex;    ///< Незавершенные пакеты и время их следующей проверки
+    LevelGaugeService::PackageTracker _packageTracker; ///< Проверка статуса пакетов на сервере
+
+    const bool _streamMode = false;         ///< Потоковый режим формирования пакетов
+    const qint64 _realtimeWindow = 0;       ///< Статусы моложе этого времени отправляются в первую очередь, мсек. 0 - полосы отправки не используются
+    const quint32 _backlogShare = 30;       ///< Минимальная доля пакета для накопленных статусов, %
+
+    QHash<TankID, QMap<QString, StreamStatus>> _streamWaiting; ///< Статусы, ожидающие ИД записи. Ключ - время статуса в БД в формате DATETIME_FORMAT
+    QHash<TankID, QDateTime> _backlogFrom; ///< Время самого раннего статуса, не попавшего в поток
 };
 
 }
@@ -7,19 +7,7 @@
 using namespace LevelGaugeService;
 using namespace Common;
 
-static const int MIN_STEP_COUNT_START_INTAKE = 5;   //время полочки в начале приемки топлива
-static const int MIN_STEP_COUNT_FINISH_INTAKE = 10; //время полочки по окончанию приемки топлива
-static constexpr int MIN_TIME_START_INTAKE = 60 * MIN_STEP_COUNT_START_INTAKE;   //время полочки в начале приемки топлива, сек
-static constexpr int MIN_TIME_FINISH_INTAKE = 60 * MIN_STEP_COUNT_FINISH_INTAKE; //время полочки по окончанию приемки топлива, сек
-
-static const int MIN_STEP_COUNT_START_PUMPING_OUT = 5;   //время полочки в начале отпуска топлива
-static const int MIN_STEP_COUNT_FINISH_PUMPING_OUT = 10; //время полочки по окончанию отпуска топлива
-
-static const int SKIP_TIME = 40; ///< минимальное время между последним имеющимся статусом и вновь добалемым
-
-static constexpr int TIME_TO_SAVE = std::max(MIN_TIME_START_INTAKE, MIN_STEP_COUNT_START_PUMPING_OUT * 60) + 60;
-
-static constexpr int AZS_CONNECTION_TIMEOUT = 60 * 10;     //Таймаут обрыва связи с уровнемером, сек
+//параметры обнаружения приемов/отпусков и интервалы задаются для каждого резервуара - см. TankConfig::Timing
 static const float FLOAT_EPSILON = 0.0000001f;
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -35,6 +23,7 @@ Tank::Tank(const LevelGaugeService::TankConfig* tankConfig, const TankStatusesLi
 
     _lastSendToSaveDateTime = _tankConfig->lastSave();
     _lastPumpingOut = _tankConfig->lastSave();
+    _lastIntake = _tankConfig->lastIntake();
 
     for (auto& tankStatus: tankSavedStatuses)
     {
@@ -71,7 +60,7 @@ void Tank::start()
     QObject::connect(_saveToDBTimer, SIGNAL(timeout()), SLOT(sendNewStatusesToSave()));
 
     // Start
-    _saveToDBTimer->start(60000);
+    _saveToDBTimer->start(_tankConfig->timing().saveInterval);
 
     _isStarted = true;
 
@@ -116,7 +105,7 @@ void Tank::newStatuses(const TankID &id, const TankStatusesList &tankStatuses)
 void Tank::addStatuses(const TankStatusesList &tankStatuses)
 {
     ///< Удаляем все неиспользуемые статусы, которые раньше самого раннего из имеющехся
-    const auto lastStatusDateTime = _tankStatuses.empty() ? QDateTime::currentDateTime().addYears(-1) : _tankStatuses.crbegin()->first.addSecs(SKIP_TIME);
+    const auto lastStatusDateTime = _tankStatuses.empty() ? QDateTime::currentDateTime().addYears(-1) : _tankStatuses.crbegin()->first.addSecs(_tankConfig->timing().skipTime);
     auto tankStatusesSorted = tankStatuses;
     const auto removeCount = tankStatusesSorted.filtered(lastStatusDateTime);
     if (removeCount != 0)
@@ -263,7 +252,7 @@ void Tank::sendNewStatusesToSave()
 
     TankStatusesList statusesForSave;
     for(auto tankStatus_it = startSave_it;
-        (tankStatus_it != _tankStatuses.end() && (QDateTime::currentDateTime().secsTo(tankStatus_it->first) < -TIME_TO_SAVE));
+        (tankStatus_it != _tankStatuses.end() && (QDateTime::currentDateTime().secsTo(tankStatus_it->first) < -_tankConfig->timing().timeToSave()));
         ++tankStatus_it)
     {
         statusesForSave.push_back(*tankStatus_it->second);
@@ -367,9 +356,9 @@ void Tank::addStatusesIntake(const TankStatus& tankStatus)
     //расчитываем сколько шагов нужно для подъема уровня
     const auto lastTankStatus = *(_tankStatuses.crbegin()->second.get());
 
-    const int startStepCount = MIN_TIME_START_INTAKE / 60 + 1;
+    const int startStepCount = _tankConfig->timing().minStepCountStartIntake + 1;
     const int intakeStepCount = static_cast<int>(tankStatus.height() - lastTankStatus.height()) / (_tankConfig->deltaIntake().height * 0.95);
-    const int finishStepCount = MIN_TIME_FINISH_INTAKE / 60 + 1;
+    const int finishStepCount = _tankConfig->timing().minStepCountFinishIntake + 1;
 
     //время на текущем шаге
     auto time = lastTankStatus.dateTime();
@@ -450,7 +439,7 @@ void Tank::addStatusEnd()
     }
 
     auto time = _tankStatuses.crbegin()->first;  //время последнего статуса
-    if (time.secsTo(QDateTime::currentDateTime()) < AZS_CONNECTION_TIMEOUT)
+    if (time.secsTo(QDateTime::currentDateTime()) < _tankConfig->timing().connectionTimeout)
     {
         return;
     }
@@ -467,7 +456,7 @@ void Tank::addStatusEnd()
     lastStatus.setAdditionFlag(static_cast<quint8>(TankStatus::AdditionFlag::UNKNOWN));
 
     quint64 addedCount = 0;
-    while (time.secsTo(QDateTime::currentDateTime()) >= AZS_CONNECTION_TIMEOUT)
+    while (time.secsTo(QDateTime::currentDateTime()) >= _tankConfig->timing().connectionTimeout)
     {
         time = time.addSecs(60);
 
@@ -513,7 +502,7 @@ void Tank::clearTankStatuses()
     auto lastTankStatuses_it = _tankStatuses.end();
     for (auto tankStatuses_it = _tankStatuses.begin(); tankStatuses_it != _tankStatuses.end(); ++tankStatuses_it)
     {
-        if (tankStatuses_it->first < _tankConfig->lastIntake() /* && {last Pamping Out})*/)
+        if (tankStatuses_it->first < _lastIntake /* && {last Pamping Out})*/)
         {
             lastTankStatuses_it = tankStatuses_it;
         }
@@ -527,19 +516,21 @@ void Tank::clearTankStatuses()
 
 Tank::TankStatusesIterator Tank::getStartIntake()
 {
-    auto startTankStatus_it = _tankStatuses.upper_bound(_tankConfig->lastIntake());
-    if (std::distance(startTankStatus_it, _tankStatuses.end()) <= MIN_STEP_COUNT_START_INTAKE)
+    const auto stepCount = _tankConfig->timing().minStepCountStartIntake;
+
+    auto startTankStatus_it = _tankStatuses.upper_bound(_lastIntake);
+    if (std::distance(startTankStatus_it, _tankStatuses.end()) <= stepCount)
     {
         return _tankStatuses.end();
     }
 
-    for (auto finishTankStatus_it = std::next(startTankStatus_it, MIN_STEP_COUNT_START_INTAKE);
+    for (auto finishTankStatus_it = std::next(startTankStatus_it, stepCount);
          finishTankStatus_it != _tankStatuses.end();
          ++finishTankStatus_it)
     {
         if (finishTankStatus_it->second->height() - startTankStatus_it->second->height() >= _tankConfig->deltaIntakeHeight())
         {
-            return std::prev(finishTankStatus_it, MIN_STEP_COUNT_START_INTAKE);
+            return std::prev(finishTankStatus_it, stepCount);
         }
 
         ++startTankStatus_it;
@@ -549,13 +540,15 @@ Tank::TankStatusesIterator Tank::getStartIntake()
 
 Tank::TankStatusesIterator Tank::getFinishedIntake()
 {
+    const auto stepCount = _tankConfig->timing().minStepCountFinishIntake;
+
     auto startTankStatus_it = _tankStatuses.upper_bound(_isIntake.value());
-    if (std::distance(startTankStatus_it, _tankStatuses.end()) <= MIN_STEP_COUNT_FINISH_INTAKE)
+    if (std::distance(startTankStatus_it, _tankStatuses.end()) <= stepCount)
     {
         return _tankStatuses.end();
     }
 
-    for (auto finishTankStatus_it = std::next(startTankStatus_it, MIN_STEP_COUNT_FINISH_INTAKE);
+    for (auto finishTankStatus_it = std::next(startTankStatus_it, stepCount);
          finishTankStatus_it != _tankStatuses.end();
          ++finishTankStatus_it)
     {
@@ -571,7 +564,8 @@ Tank::TankStatusesIterator Tank::getFinishedIntake()
 
 void Tank::findIntake()
 {
-    if (_tankStatuses.size() <  MIN_STEP_COUNT_START_INTAKE + MIN_STEP_COUNT_FINISH_INTAKE)
+    const auto& timing = _tankConfig->timing();
+    if (_tankStatuses.size() < static_cast<size_t>(timing.minStepCountStartIntake + timing.minStepCountFinishIntake))
     {
         return;
     }
@@ -631,6 +625,8 @@ void Tank::findIntake()
 
     intakesList.emplace_back(std::move(tmp));
 
+    _lastIntake = finish_it->first;
+
      emit calculateIntakes(_tankConfig->tankId(), intakesList);
 
     _isIntake.reset();
@@ -638,19 +634,21 @@ void Tank::findIntake()
 
 Tank::TankStatusesIterator Tank::getStartPumpingOut()
 {
+    const auto stepCount = _tankConfig->timing().minStepCountStartPumpingOut;
+
     auto startTankStatus_it = _tankStatuses.upper_bound(_lastPumpingOut);
-    if (std::distance(startTankStatus_it, _tankStatuses.end()) <= MIN_STEP_COUNT_START_PUMPING_OUT)
+    if (std::distance(startTankStatus_it, _tankStatuses.end()) <= stepCount)
     {
         return _tankStatuses.end();
     }
 
-    for (auto finishTankStatus_it = std::next(startTankStatus_it, MIN_STEP_COUNT_START_PUMPING_OUT);
+    for (auto finishTankStatus_it = std::next(startTankStatus_it, stepCount);
          finishTankStatus_it != _tankStatuses.end();
          ++finishTankStatus_it)
     {
         if (finishTankStatus_it->second->height() - startTankStatus_it->second->height() <= -_tankConfig->deltaPumpingOutHeight())
         {
-            return std::prev(finishTankStatus_it, MIN_STEP_COUNT_START_PUMPING_OUT);
+            return std::prev(finishTankStatus_it, stepCount);
         }
 
         ++startTankStatus_it;
@@ -666,13 +664,15 @@ Tank::TankStatusesIterator Tank::getFinishedPumpingOut()
         return _tankStatuses.end();
     }
 
+    const auto stepCount = _tankConfig->timing().minStepCountFinishPumpingOut;
+
     auto startTankStatus_it = _tankStatuses.upper_bound(_isPumpingOut.value());
-    if (std::distance(startTankStatus_it, _tankStatuses.end()) <= MIN_STEP_COUNT_FINISH_PUMPING_OUT)
+    if (std::distance(startTankStatus_it, _tankStatuses.end()) <= stepCount)
     {
         return _tankStatuses.end();
     }
 
-    for (auto finishTankStatus_it = std::next(startTankStatus_it, MIN_STEP_COUNT_FINISH_PUMPING_OUT);
+    for (auto finishTankStatus_it = std::next(startTankStatus_it, stepCount);
          finishTankStatus_it != _tankStatuses.end();
          ++finishTankStatus_it)
     {
@@ -688,7 +688,7 @@ Tank::TankStatusesIterator Tank::getFinishedPumpingOut()
 
 void Tank::findPumpingOut()
 {
-/*    if (_tankStatuses.size() <  MIN_STEP_COUNT_START_PUMPING_OUT + MIN_STEP_COUNT_FINISH_PUMPING_OUT)
+/*    if (_tankStatuses.size() <  _tankConfig->timing().minStepCountStartPumpingOut + _tankConfig->timing().minStepCountFinishPumpingOut)
     {
         return;
     }
@@ -125,6 +125,7 @@ private:
     LevelGaugeService::TankStatuses _tankStatuses;
     QDateTime _lastSendToSaveDateTime;
     QDateTime _lastPumpingOut;
+    QDateTime _lastIntake;  ///< Время окончания последнего найденного приема. В конфигурации время обновляется только после сохранения приема в БД
 
     std::optional<QDateTime> _isIntake;
     std::optional<QDateTime> _isPumpingOut;
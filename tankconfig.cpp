@@ -3,8 +3,6 @@
 
 //QT
 #include <QSqlQuery>
-#include <QMutex>
-#include <QMutexLocker>
 
 //My
 #include "Common/common.h"
@@ -15,7 +13,6 @@ using namespace LevelGaugeService;
 using namespace Common;
 
 static const QString TANKS_CONFIG_CONNECTION_TO_DB_NAME = "TANKS_CONFIG_DB";
-static QMutex lastTimeMutex;
 
 //statis
 TankConfig::Status TankConfig::intToStatus(quint8 status)
@@ -77,247 +74,262 @@ TankConfig::TankConfig(const TankID& id,
                        const qint64 remoteApplicantId, const qint64 remoteObjectId, const qint64 remoteTankId, const QString& name, const QString& remoteBearerToken, const QUrl& remoteBaseUrl,
                        float totalVolume, float diametr, qint64 timeShift, Mode mode, Type type,
                        const Delta& deltaMax, const Delta& deltaIntake, float deltaIntakeHeight, float deltaPumpingOutHeight, Status status,
-                       const QString& product, ProductStatus productStatus,
+                       const QString& product, ProductStatus productStatus, const Timing& timing,
                        QObject* parent /* = nullptr */)
     : QObject{parent}
-    , _id(id)
-    , _remoteApplicantId(remoteApplicantId)
-    , _remoteObjectId(remoteObjectId)
-    , _remoteTankId(remoteTankId)
-    , _name(name)
-    , _remoteBearerToken(remoteBearerToken)
-    , _remoteBaseUrl(remoteBaseUrl)
-    , _totalVolume(totalVolume)
-    , _diametr(diametr)
-    , _timeShift(timeShift)
-    , _deltaMax(deltaMax)
-    , _deltaIntake(deltaIntake)
-    , _deltaIntakeHeight(deltaIntakeHeight)
-    , _deltaPumpingOutHeight(deltaPumpingOutHeight)
-    , _status(status)
-    , _mode(mode)
-    , _type(type)
-    , _product(product)
-    , _productStatus(productStatus)
-{
-    Q_ASSERT(_id.tankNumber() != 0);
-    Q_ASSERT(_remoteApplicantId != 0);
-    Q_ASSERT(_remoteObjectId != 0);
-    Q_ASSERT(_remoteTankId != 0);
-    Q_ASSERT(!_id.levelGaugeCode().isEmpty());
-    Q_ASSERT(!_name.isEmpty());
-    Q_ASSERT(!_remoteBearerToken.isEmpty());
-    Q_ASSERT(!_remoteBaseUrl.isEmpty() && _remoteBaseUrl.isValid());
-    Q_ASSERT(_totalVolume > 0.0f);
-    Q_ASSERT(_diametr > 0.0f);
-    Q_ASSERT(_deltaMax.check());
-    Q_ASSERT(_deltaIntake.check());
-    Q_ASSERT(_deltaIntakeHeight > 0.0f);
-    Q_ASSERT(_deltaPumpingOutHeight > 0.0f);
-    Q_ASSERT(!_product.isEmpty());
-    Q_ASSERT(_type != Type::UNDEFINE);
-    Q_ASSERT(_mode != Mode::UNDEFINE);
-    Q_ASSERT(_productStatus != ProductStatus::UNDEFINE);
-
-    makeLimits();
-}
-
-
-void TankConfig::makeLimits()
-{
-    _limits.density = std::make_pair<float>(350.0f, 1200.0f);
-    _limits.height  = std::make_pair<float>(0.0f, _diametr);
-    _limits.mass    = std::make_pair<float>(0.0f, _totalVolume * _limits.density.second);
-    _limits.volume  = std::make_pair<float>(0.0f, _totalVolume);
-    _limits.temp    = std::make_pair<float>(-50.0f, 100.0f);
+{
+    auto params = std::make_shared<Params>();
+    params->id = id;
+    params->remoteApplicantId = remoteApplicantId;
+    params->remoteObjectId = remoteObjectId;
+    params->remoteTankId = remoteTankId;
+    params->name = name;
+    params->remoteBearerToken = remoteBearerToken;
+    params->remoteBaseUrl = remoteBaseUrl;
+    params->totalVolume = totalVolume;
+    params->diametr = diametr;
+    params->timeShift = timeShift;
+    params->deltaMax = deltaMax;
+    params->deltaIntake = deltaIntake;
+    params->deltaIntakeHeight = deltaIntakeHeight;
+    params->deltaPumpingOutHeight = deltaPumpingOutHeight;
+    params->status = status;
+    params->mode = mode;
+    params->type = type;
+    params->product = product;
+    params->productStatus = productStatus;
+    params->timing = timing;
+
+    Q_ASSERT(params->id.tankNumber() != 0);
+    Q_ASSERT(params->remoteApplicantId != 0);
+    Q_ASSERT(params->remoteObjectId != 0);
+    Q_ASSERT(params->remoteTankId != 0);
+    Q_ASSERT(!params->id.levelGaugeCode().isEmpty());
+    Q_ASSERT(!params->name.isEmpty());
+    Q_ASSERT(!params->remoteBearerToken.isEmpty());
+    Q_ASSERT(!params->remoteBaseUrl.isEmpty() && params->remoteBaseUrl.isValid());
+    Q_ASSERT(params->totalVolume > 0.0f);
+    Q_ASSERT(params->diametr > 0.0f);
+    Q_ASSERT(params->deltaMax.check());
+    Q_ASSERT(params->deltaIntake.check());
+    Q_ASSERT(params->deltaIntakeHeight > 0.0f);
+    Q_ASSERT(params->deltaPumpingOutHeight > 0.0f);
+    Q_ASSERT(!params->product.isEmpty());
+    Q_ASSERT(params->type != Type::UNDEFINE);
+    Q_ASSERT(params->mode != Mode::UNDEFINE);
+    Q_ASSERT(params->productStatus != ProductStatus::UNDEFINE);
+    Q_ASSERT(params->timing.check());
+
+    //пределы значений вычисляются один раз, далее параметры не изменяются
+    params->limits.density = std::make_pair<float>(350.0f, 1200.0f);
+    params->limits.height  = std::make_pair<float>(0.0f, params->diametr);
+    params->limits.mass    = std::make_pair<float>(0.0f, params->totalVolume * params->limits.density.second);
+    params->limits.volume  = std::make_pair<float>(0.0f, params->totalVolume);
+    params->limits.temp    = std::make_pair<float>(-50.0f, 100.0f);
+
+    _params = std::move(params);
+
+    const auto defaultLastTime = QDateTime::currentDateTime().addYears(-100).toMSecsSinceEpoch();
+    for (auto& lastTime: _lastTimes)
+    {
+        lastTime.store(defaultLastTime, std::memory_order_relaxed);
+    }
+}
+
+std::shared_ptr<const TankConfig::Params> TankConfig::params() const
+{
+    return _params;
 }
 
 const TankID &TankConfig::tankId() const
 {
-    return _id;
+    return _params->id;
 }
 
 qint64 TankConfig::remoteTankId() const
 {
-    return _remoteTankId;
+    return _params->remoteTankId;
 }
 
 qint64 TankConfig::remoteObjectId() const
 {
-    return _remoteObjectId;
+    return _params->remoteObjectId;
 }
 
 qint64 TankConfig::remoteApplicantId() const
 {
-    return _remoteApplicantId;
+    return _params->remoteApplicantId;
 }
 
 const QString& TankConfig::name() const
 {
-    return _name;
+    return _params->name;
 }
 
 const QString &TankConfig::remoteBearerToken() const
 {
-    return _remoteBearerToken;
+    return _params->remoteBearerToken;
 }
 
 const QUrl &TankConfig::remoteBaseUrl() const
 {
-    return _remoteBaseUrl;
+    return _params->remoteBaseUrl;
 }
 
 float TankConfig::totalVolume() const
 {
-    return _totalVolume;
+    return _params->totalVolume;
 }
 
 float TankConfig::diametr() const
 {
-    return _diametr;
+    return _params->diametr;
 }
 
 qint64 TankConfig::timeShift() const
 {
-    return _timeShift;
+    return _params->timeShift;
 }
 
 const TankConfig::Limits &TankConfig::limits() const
 {
-    return _limits;
+    return _params->limits;
 }
 
 const TankConfig::Delta &TankConfig::deltaMax() const
 {
-    return _deltaMax;
+    return _params->deltaMax;
 }
 
 const TankConfig::Delta &TankConfig::deltaIntake() const
 {
-    return _deltaIntake;
+    return _params->deltaIntake;
 }
 
 float TankConfig::deltaIntakeHeight() const
 {
-    return _deltaIntakeHeight;
+    return _params->deltaIntakeHeight;
 }
 
 float TankConfig::deltaPumpingOutHeight() const
 {
-    return _deltaPumpingOutHeight;
+    return _params->deltaPumpingOutHeight;
 }
 
 TankConfig::Status TankConfig::status() const
 {
-    return _status;
+    return _params->status;
 }
 
 TankConfig::Mode TankConfig::mode() const
 {
-    return _mode;
+    return _params->mode;
 }
 
 TankConfig::Type TankConfig::type() const
 {
-    return _type;
+    return _params->type;
 }
 
 const QString &TankConfig::product() const
 {
-    return _product;
+    return _params->product;
 }
 
 TankConfig::ProductStatus TankConfig::productStatus() const
 {
-    return _productStatus;
+    return _params->productStatus;
 }
 
-const QDateTime &TankConfig::lastMeasuments() const
+const TankConfig::Timing& TankConfig::timing() const
 {
-    QMutexLocker<QMutex> locker(&lastTimeMutex);
+    return _params->timing;
+}
 
-    return _lastMeasuments;
+QDateTime TankConfig::lastTime(LastTime lastTime) const
+{
+    return QDateTime::fromMSecsSinceEpoch(_lastTimes[static_cast<quint8>(lastTime)].load(std::memory_order_acquire));
 }
 
-void TankConfig::setLastMeasuments(const QDateTime &lastTime)
+void TankConfig::setLastTime(LastTime lastTime, const QDateTime& dateTime)
 {
-    Q_ASSERT(_lastMeasuments <= lastTime);
+    if (!dateTime.isValid())
+    {
+        return;
+    }
 
-    QMutexLocker<QMutex> locker(&lastTimeMutex);
+    const auto newValue = dateTime.toMSecsSinceEpoch();
+    auto& value = _lastTimes[static_cast<quint8>(lastTime)];
 
-    _lastMeasuments = lastTime;
+    //время может обновляться из нескольких потоков - сохраняем максимальное
+    auto oldValue = value.load(std::memory_order_relaxed);
+    while (oldValue < newValue)
+    {
+        if (value.compare_exchange_weak(oldValue, newValue, std::memory_order_release, std::memory_order_relaxed))
+        {
+            _changedLastTimes.fetch_or(static_cast<quint8>(1 << static_cast<quint8>(lastTime)), std::memory_order_release);
 
-    emit lastMeasuments(_id, lastTime);
+            return;
+        }
+    }
 }
 
-const QDateTime &TankConfig::lastSave() const
+quint8 TankConfig::takeChangedLastTimes()
 {
-    QMutexLocker<QMutex> locker(&lastTimeMutex);
-
-    return _lastSave;
+    return _changedLastTimes.exchange(0, std::memory_order_acquire);
 }
 
-void TankConfig::setLastSave(const QDateTime &lastTime)
+void TankConfig::markChangedLastTimes(quint8 changedLastTimes)
 {
-    Q_ASSERT(_lastSave <= lastTime);
+    _changedLastTimes.fetch_or(changedLastTimes, std::memory_order_release);
+}
 
-    QMutexLocker<QMutex> locker(&lastTimeMutex);
+QDateTime TankConfig::lastMeasuments() const
+{
+    return lastTime(LastTime::MEASUMENTS);
+}
 
-    _lastSave = lastTime;
+void TankConfig::setLastMeasuments(const QDateTime &lastTime)
+{
+    setLastTime(LastTime::MEASUMENTS, lastTime);
+}
 
-    emit lastSave(_id, lastTime);
+QDateTime TankConfig::lastSave() const
+{
+    return lastTime(LastTime::SAVE);
 }
 
-const QDateTime &TankConfig::lastSend() const
+void TankConfig::setLastSave(const QDateTime &lastTime)
 {
-    QMutexLocker<QMutex> locker(&lastTimeMutex);
+    setLastTime(LastTime::SAVE, lastTime);
+}
 
-    return _lastSend;
+QDateTime TankConfig::lastSend() const
+{
+    return lastTime(LastTime::SEND);
 }
 
 void TankConfig::setLastSend(const QDateTime &lastTime)
 {
-    Q_ASSERT(_lastSend <= lastTime);
-
-    QMutexLocker<QMutex> locker(&lastTimeMutex);
-
-    _lastSend = lastTime;
-
-    emit lastSend(_id, lastTime);
+    setLastTime(LastTime::SEND, lastTime);
 }
 
-const QDateTime &TankConfig::lastIntake() const
+QDateTime TankConfig::lastIntake() const
 {
-    QMutexLocker<QMutex> locker(&lastTimeMutex);
-
-    return _lastIntake;
+    return lastTime(LastTime::INTAKE);
 }
 
 void TankConfig::setLastIntake(const QDateTime &lastTime)
 {
-    Q_ASSERT(_lastIntake <= lastTime);
-
-    QMutexLocker<QMutex> locker(&lastTimeMutex);
-
-    _lastIntake = lastTime;
-
-    emit lastIntake(_id, lastTime);
+    setLastTime(LastTime::INTAKE, lastTime);
 }
 
-const QDateTime &TankConfig::lastSendIntake() const
+QDateTime TankConfig::lastSendIntake() const
 {
-    QMutexLocker<QMutex> locker(&lastTimeMutex);
-
-    return _lastSendIntake;
+    return lastTime(LastTime::SEND_INTAKE);
 }
 
 void TankConfig::setLastSendIntake(const QDateTime &lastTime)
 {
-    Q_ASSERT(_lastSendIntake <= lastTime);
-
-    QMutexLocker<QMutex> locker(&lastTimeMutex);
-
-    _lastSendIntake = lastTime;
-
-    emit lastSendIntake(_id, lastTime);
+    setLastTime(LastTime::SEND_INTAKE, lastTime);
 }
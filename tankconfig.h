@@ -1,5 +1,11 @@
 #pragma once
 
+//STL
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+
 //QT
 #include <QObject>
 #include <QDateTime>
@@ -37,6 +43,31 @@ public:
         }
     };
 
+    struct Timing //Параметры обнаружения приемов/отпусков и интервалы обработки данных резервуара
+    {
+        qint32 minStepCountStartIntake = 5;        ///< время полочки в начале приемки топлива, шагов (минут)
+        qint32 minStepCountFinishIntake = 10;      ///< время полочки по окончанию приемки топлива, шагов (минут)
+        qint32 minStepCountStartPumpingOut = 5;    ///< время полочки в начале отпуска топлива, шагов (минут)
+        qint32 minStepCountFinishPumpingOut = 10;  ///< время полочки по окончанию отпуска топлива, шагов (минут)
+        qint64 skipTime = 40;                      ///< минимальное время между последним имеющимся статусом и вновь добалемым, сек
+        qint64 connectionTimeout = 60 * 10;        ///< Таймаут обрыва связи с уровнемером, сек
+        qint64 saveInterval = 60000;               ///< Интервал передачи новых статусов на сохранение, мсек
+
+        ///< Статус передается на сохранение не раньше, чем по нему может быть обнаружено начало приема или отпуска, сек
+        qint64 timeToSave() const { return std::max(minStepCountStartIntake, minStepCountStartPumpingOut) * 60 + 60; }
+
+        bool check() const
+        {
+            return (minStepCountStartIntake >= 1 && minStepCountStartIntake <= 60) &&
+                   (minStepCountFinishIntake >= 1 && minStepCountFinishIntake <= 60) &&
+                   (minStepCountStartPumpingOut >= 1 && minStepCountStartPumpingOut <= 60) &&
+                   (minStepCountFinishPumpingOut >= 1 && minStepCountFinishPumpingOut <= 60) &&
+                   (skipTime >= 0 && skipTime <= 3600) &&
+                   (connectionTimeout >= 60 && connectionTimeout <= 86400) &&
+                   (saveInterval >= 1000 && saveInterval <= 3600000);
+        }
+    };
+
     struct Limits //Предельные значения
     {
         QPair<float, float> volume;  //объем
@@ -77,6 +108,56 @@ public:
         UNDEFINE = 100  ///< неопределено
     };
 
+    ///< Неизменяемые параметры резервуара. Создаются один раз при загрузке конфигурации, поэтому читаются из любого потока без блокировок.
+    ///< При изменении настроек в БД конфигурация резервуара заменяется целиком (см. TanksConfig::refresh())
+    struct Params
+    {
+        TankID id;                         ///< Внутренний  ID резервуара
+        qint64 remoteApplicantId = 0;      ///< ID организации на сервере
+        qint64 remoteObjectId = 0;         ///< ID объекта на сервере
+        qint64 remoteTankId = 0;           ///< ID резервуара на сервере
+
+        QString name;                      ///< Текстовое название резервуара (!=empty Для нефтебазы)
+
+        QString remoteBearerToken;
+
+        QUrl remoteBaseUrl;
+
+        float totalVolume = 0.0;           ///< Объем резервуара
+        float diametr = 0.0;               ///< Диаметр резервуара
+
+        qint64 timeShift = 0;              ///< смещение времени на АЗС относительно сервера в секундах
+
+        Limits limits;                     ///< Пределы значений
+
+        Delta deltaMax;                    ///< максимально допустимое изменение параметров резервуара за 1 минуту при нормальной работе
+        Delta deltaIntake;                 ///< максимально допустимое изменение параметров резервуара за 1 минуту при приеме топлива
+
+        float deltaIntakeHeight = 0.0;     ///< пороговое значение изменения уровня топлива за 10 минут с котого считаем что произошел прием
+        float deltaPumpingOutHeight = 0.0;
+
+        Status status = Status::UNDEFINE;  ///< Текущий статус резервуара (Слив/прием/ремонт....)
+        Mode mode = Mode::UNDEFINE;        ///< Режим работы резервуара(АЗС/Нефтебаза)
+        Type type = Type::UNDEFINE;        ///< Вид резервуара (РГС/РВС)
+
+        QString product;                   ///< Название продукта (92, 95, 96,...)
+        ProductStatus productStatus = ProductStatus::UNDEFINE; ///< Статус НП
+
+        Timing timing;                     ///< Параметры обнаружения приемов/отпусков и интервалы обработки
+    };
+
+    ///< Времена последней обработки данных резервуара. Используются как битовые флаги в takeChangedLastTimes()
+    enum class LastTime: quint8
+    {
+        MEASUMENTS = 0,   ///< время последней загруженной записи из БД Измерений
+        SAVE = 1,         ///< время последней сохраненной записи (время АЗС)
+        SEND = 2,         ///< время последней отправленной на сервер записи
+        INTAKE = 3,       ///< Время последнего прихода
+        SEND_INTAKE = 4   ///< Время последнего отправленного прихода
+    };
+
+    static constexpr quint8 LAST_TIMES_COUNT = 5;
+
 public:
     static Status intToStatus(quint8 status);
     static Mode intToMode(quint8 mode);
@@ -89,9 +170,14 @@ public:
                float totalVolume, float diametr, qint64 timeShift,
                Mode mode, Type type,
                const Delta& deltaMax, const Delta& deltaIntake, float deltaIntakeHeight, float deltaPumpingOutHeight, Status status,
-               const QString& product, ProductStatus productStatus,
+               const QString& product, ProductStatus productStatus, const Timing& timing,
                QObject* parent = nullptr);
 
+    /*!
+        Возвращает неизменяемые параметры резервуара. Указатель можно хранить дольше времени жизни конфигурации
+    */
+    std::shared_ptr<const Params> params() const;
+
     const TankID& tankId() const;
     qint64 remoteTankId() const;
     qint64 remoteObjectId() const;
@@ -122,71 +208,50 @@ public:
     const QString& product() const;
     ProductStatus productStatus()const;
 
-    const QDateTime& lastMeasuments() const;
+    const Timing& timing() const;
+
+    //Времена последней обработки данных только увеличиваются - значение меньше текущего игнорируется
+    QDateTime lastMeasuments() const;
     void setLastMeasuments(const QDateTime& lastTime);
 
-    const QDateTime& lastSave() const;
+    QDateTime lastSave() const;
     void setLastSave(const QDateTime& lastTime);
 
-    const QDateTime& lastSend() const;
+    QDateTime lastSend() const;
     void setLastSend(const QDateTime& lastTime);
 
-    const QDateTime& lastIntake() const;
+    QDateTime lastIntake() const;
     void setLastIntake(const QDateTime& lastTime);
 
-    const QDateTime& lastSendIntake() const;
+    QDateTime lastSendIntake() const;
     void setLastSendIntake(const QDateTime& lastTime);
 
-signals:
-    void lastMeasuments(const LevelGaugeService::TankID& id, const QDateTime& lastTime);
-    void lastSave(const LevelGaugeService::TankID& id, const QDateTime& lastTime);
-    void lastIntake(const LevelGaugeService::TankID& id, const QDateTime& lastTime);
-    void lastSend(const LevelGaugeService::TankID& id, const QDateTime& lastTime);
-    void lastSendIntake(const LevelGaugeService::TankID& id, const QDateTime& lastTime);
+    QDateTime lastTime(LastTime lastTime) const;
+
+    /*!
+        Возвращает флаги времен, измененных с предыдущего вызова, и сбрасывает их. Используется для сохранения времен в БД
+        @return битовая маска. Бит (1 << LastTime) установлен если время изменилось
+    */
+    quint8 takeChangedLastTimes();
+
+    /*!
+        Повторно помечает времена как измененные. Вызывается если сохранить их в БД не удалось
+        @param changedLastTimes - битовая маска, полученная от takeChangedLastTimes()
+    */
+    void markChangedLastTimes(quint8 changedLastTimes);
 
 private:
     TankConfig() = delete;
     Q_DISABLE_COPY_MOVE(TankConfig);
 
-    void makeLimits();
+    void setLastTime(LastTime lastTime, const QDateTime& dateTime);
 
 private:    
-    const TankID _id;                ///< Внутренний  ID резервуара
-    const qint64 _remoteApplicantId = 0;  ///< ID организации на сервере
-    const qint64 _remoteObjectId = 0;  ///< ID объекта на сервере
-    const qint64 _remoteTankId = 0;  ///< ID резервуара на сервере
-
-    const QString _name;             ///< Текстовое название резервуара (!=empty Для нефтебазы)
-
-    const QString _remoteBearerToken;
-
-    const QUrl _remoteBaseUrl;
-
-    const float _totalVolume = 0.0;  ///< Объем резервуара
-    const float _diametr = 0.0;      ///< Диаметр резервуара
-
-    const qint64 _timeShift = 0;     ///< смещение времени на АЗС относительно сервера в секундах
-
-    mutable Limits _limits;     ///< Пределы значений
-
-    const Delta _deltaMax;      ///< максимально допустимое изменение параметров резервуара за 1 минуту при нормальной работе
-    const Delta _deltaIntake;   ///< максимально допустимое изменение параметров резервуара за 1 минуту при приеме топлива
-
-    const float _deltaIntakeHeight = 0.0; ///< пороговое значение изменения уровня топлива за 10 минут с котого считаем что произошел прием
-    const float _deltaPumpingOutHeight = 0.0;
-
-    const Status _status = Status::UNDEFINE;  ///< Текущий статус резервуара (Слив/прием/ремонт....)
-    const Mode _mode = Mode::UNDEFINE;        ///< Режим работы резервуара(АЗС/Нефтебаза)
-    const Type _type = Type::UNDEFINE;        ///< Вид резервуара (РГС/РВС)
-
-    const QString _product;  ///< Название продукта (92, 95, 96,...)
-    const ProductStatus _productStatus = ProductStatus::UNDEFINE; ///< Статус НП
+    std::shared_ptr<const Params> _params;  ///< Задается в конструкторе и далее не изменяется
 
-    QDateTime _lastMeasuments = QDateTime::currentDateTime().addYears(-100); ///< время последней загруженной записи из БД Измерений
-    QDateTime _lastSave = QDateTime::currentDateTime().addYears(-100);       ///< время последней сохраненной записи (время АЗС)
-    QDateTime _lastSend = QDateTime::currentDateTime().addYears(-100);       ///< время последней отправленной на сервер записи
-    QDateTime _lastIntake = QDateTime::currentDateTime().addYears(-100);     ///< Время последнего прихода
-    QDateTime _lastSendIntake = QDateTime::currentDateTime().addYears(-100);     ///< Время последнего прихода
+    ///< Времена последней обработки данных, мсек от начала эпохи. Изменяются из разных потоков без блокировок
+    std::array<std::atomic<qint64>, LAST_TIMES_COUNT> _lastTimes;
+    std::atomic<quint8> _changedLastTimes = 0;  ///< Флаги времен, не сохраненных в БД
 };
 
 } //namespace LevelGaugeService
@@ -5,6 +5,7 @@ using namespace LevelGaugeService;
 TankID::TankID(const QString &levelGaugeCode, quint8 tankNumber)
     :_levelGaugeCode(levelGaugeCode)
     ,_tankNumber(tankNumber)
+    ,_hash(qHashMulti(0, levelGaugeCode, tankNumber))
 {
     Q_ASSERT(_tankNumber != 0);
     Q_ASSERT(!levelGaugeCode.isEmpty());
@@ -26,7 +27,8 @@ quint8 TankID::tankNumber() const
 
 bool TankID::operator==(const TankID& other) const
 {
-    return (_tankNumber == other._tankNumber) && (_levelGaugeCode == other._levelGaugeCode);
+    //сравнение хешей отсекает большинство несовпадающих ИД без сравнения строк
+    return (_hash == other._hash) && (_tankNumber == other._tankNumber) && (_levelGaugeCode == other._levelGaugeCode);
 }
 
 QString TankID::toString() const
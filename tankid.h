@@ -1,6 +1,7 @@
 #pragma once
 
 //STL
+#include <limits>
 #include "unordered_map"
 
 //QT
@@ -25,18 +26,29 @@ public:
 
     QString toString() const;
 
+    /*!
+        Хеш ИД. Вычисляется один раз при создании ИД, т.к. ИД используется как ключ таблиц при обработке каждого статуса
+    */
+    size_t hash() const noexcept { return _hash; }
+
 private:
     QString _levelGaugeCode; //код измерительной системы
     quint8 _tankNumber = 0; //номер резервуара
+    size_t _hash = 0; //хеш кода измерительной системы и номера резервуара
 
 }; //class TankID
 
 using TankIDList = QList<TankID>;
 
+///< Дескриптор резервуара - индекс конфигурации резервуара в TanksConfig. Назначается при первой загрузке резервуара и далее не меняется
+using TankHandle = quint32;
+using TankHandleList = QList<TankHandle>;
+inline constexpr TankHandle INVALID_TANK_HANDLE = std::numeric_limits<TankHandle>::max();
+
 //Hash for QT
 inline size_t qHash(const TankID &key, size_t seed) noexcept
 {
-    return qHashMulti(seed, key.levelGaugeCode(), key.tankNumber());
+    return qHash(key.hash(), seed);
 }
 
 } //namespace LevelGaugeService
@@ -47,7 +59,7 @@ struct std::hash<LevelGaugeService::TankID>
 {
     inline std::size_t operator()(const LevelGaugeService::TankID& id) const noexcept
     {
-        return qHash(id, 0);
+        return id.hash();
     }
 };
 
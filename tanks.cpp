@@ -7,12 +7,15 @@ using namespace Common;
 
 static const QString TANKS_CONNECTION_TO_DB_NAME = "TANKS_DB";
 
-Tanks::Tanks(const Common::DBConnectionInfo dbConnectionInfo, LevelGaugeService::TanksConfig *tanksConfig, QObject *parent /* = nullptr */)
+Tanks::Tanks(const Common::DBConnectionInfo dbConnectionInfo, LevelGaugeService::TanksConfig *tanksConfig, qint64 checkMeasumentsInterval,
+             QObject *parent /* = nullptr */)
     : QObject{parent}
     , _dbConnectionInfo(dbConnectionInfo)
     , _tanksConfig(tanksConfig)
+    , _checkMeasumentsInterval(checkMeasumentsInterval)
 {
     Q_CHECK_PTR(_tanksConfig);
+    Q_ASSERT(_checkMeasumentsInterval > 0);
 
     qRegisterMetaType<LevelGaugeService::TankStatusesList>("TankStatusesList");
     qRegisterMetaType<LevelGaugeService::IntakesList>("IntakesList");
@@ -45,7 +48,7 @@ void Tanks::start()
 
     QObject::connect(_checkNewMeasumentsTimer, SIGNAL(timeout()), SLOT(loadFromMeasumentsDB()));
 
-    makeTanks();
+    makeTanks(_tanksConfig->getTanksHandle());
 
     _isStarted = true;
 }
@@ -70,14 +73,86 @@ void Tanks::stop()
         tank.second->thread->wait();
     }
     _tanks.clear();
+    _addedTanks.clear();
 
     emit finished();
 }
 
+void Tanks::addTanks(const TankIDList& tanksId)
+{
+    if (!_isStarted)
+    {
+        return;
+    }
+
+    TankHandleList newTanksHandle;
+    for (const auto& tankId: tanksId)
+    {
+        const auto handle = _tanksConfig->tankHandle(tankId);
+        if (_tanksConfig->findTankConfig(handle) != nullptr && !_tanks.contains(tankId))
+        {
+            newTanksHandle.push_back(handle);
+
+            //измерения, загруженные до добавления резервуара, догружаем после его запуска
+            _addedTanks.insert(tankId);
+        }
+    }
+
+    if (newTanksHandle.isEmpty())
+    {
+        return;
+    }
+
+    makeTanks(newTanksHandle);
+
+    emit sendLogMsg(TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Tanks added: %1").arg(newTanksHandle.size()));
+}
+
+void Tanks::removeTanks(const TankIDList& tanksId)
+{
+    if (!_isStarted)
+    {
+        return;
+    }
+
+    std::list<std::unique_ptr<TankThread>> removedTanks;
+    for (const auto& tankId: tanksId)
+    {
+        const auto tanks_it = _tanks.find(tankId);
+        if (tanks_it == _tanks.end())
+        {
+            continue;
+        }
+
+        QMetaObject::invokeMethod(tanks_it->second->tank.get(), "stop", Qt::QueuedConnection);
+
+        removedTanks.emplace_back(std::move(tanks_it->second));
+        _tanks.erase(tanks_it);
+        _addedTanks.remove(tankId);
+    }
+
+    //сначала останавливаем все резервуары, затем ждем их завершения
+    for (const auto& tank: removedTanks)
+    {
+        tank->thread->wait();
+    }
+
+    if (!removedTanks.empty())
+    {
+        emit sendLogMsg(TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Tanks removed: %1").arg(removedTanks.size()));
+    }
+}
+
 void Tanks::calculateStatusesTank(const TankID &id, const TankStatusesList &tankStatuses)
 {
     Q_ASSERT(_isStarted);
 
+    //резервуар мог быть удален после отправки сигнала
+    if (!_tanks.contains(id))
+    {
+        return;
+    }
+
     emit calculateStatuses(id, tankStatuses);
 }
 
@@ -85,31 +160,51 @@ void Tanks::calculateIntakesTank(const TankID &id, const IntakesList &intakes)
 {
     Q_ASSERT(_isStarted);
 
+    if (!_tanks.contains(id))
+    {
+        return;
+    }
+
     emit calculateIntakes(id, intakes);
 }
 
 void Tanks::errorOccurredTank(const LevelGaugeService::TankID& id, Common::EXIT_CODE errorCode, const QString& msg)
-{    
+{
+    emit tankErrorOccurred(id);
+
     emit errorOccurred(errorCode, QString("Tank error. AZSCode: %1. TankNumber: %2. Error: %3")
                        .arg(id.levelGaugeCode())
                        .arg(id.tankNumber())
                        .arg(msg));
 }
 
-void Tanks::sendLogMsgTank(const TankID &id, Common::TDBLoger::MSG_CODE category, const QString &msg)
-{
-    emit sendLogMsg(category, QString("Tank: AZSCode: %1. TankNumber: %2. Message: %3")
-                        .arg(id.levelGaugeCode())
-                        .arg(id.tankNumber())
-                        .arg(msg));
-}
-
 void Tanks::startedTank(const TankID &id)
 {
-    Q_ASSERT(_tanks.contains(id));
     Q_CHECK_PTR(_checkNewMeasumentsTimer);
 
-    _tanks.at(id)->isStarted = true;
+    //резервуар мог быть удален или заменен до обработки сигнала
+    const auto tanks_it = _tanks.find(id);
+    if (tanks_it == _tanks.end() || tanks_it->second->tank.get() != sender())
+    {
+        return;
+    }
+
+    auto& tankThread = tanks_it->second;
+    tankThread->isStarted = true;
+
+    //новые измерения передаем только запущенным резервуарам
+    QObject::connect(this, SIGNAL(newStatuses(const LevelGaugeService::TankID&, const LevelGaugeService::TankStatusesList&)),
+                     tankThread->tank.get(), SLOT(newStatuses(const LevelGaugeService::TankID&, const LevelGaugeService::TankStatusesList&)), Qt::QueuedConnection);
+
+    //для резервуара, добавленного во время работы, загружаем измерения, пропущенные загрузкой по [ID]
+    if (_addedTanks.remove(id) && _lastLoadId != 0)
+    {
+        loadMeasuments(QString("SELECT [ID], [AZSCode], [TankNumber], [DateTime], [Density], [Height], [Volume], [Mass], [Temp] "
+                               "FROM [TanksMeasument] "
+                               "WHERE [ID] <= %1 AND (%2) ")
+                           .arg(_lastLoadId)
+                           .arg(tanksFilterMeasument({_tanksConfig->tankHandle(id)})));
+    }
 
     const auto allStarted = std::all_of(_tanks.begin(), _tanks.end(),
         [](const auto& tank)
@@ -118,17 +213,17 @@ void Tanks::startedTank(const TankID &id)
         }
     );
 
-    if (allStarted)
+    if (allStarted && !_checkNewMeasumentsTimer->isActive())
     {
-        _checkNewMeasumentsTimer->start(60000);
+        _checkNewMeasumentsTimer->start(_checkMeasumentsInterval);
     }
 }
 
-QString Tanks::tanksFilterCalculate() const
+QString Tanks::tanksFilterCalculate(const TankHandleList& tanksHandle) const
 {
     bool isFirst = true;
     QString result;
-    for (const auto& tankId: _tanksConfig->getTanksID())
+    for (const auto handle: tanksHandle)
     {
         if (!isFirst)
         {
@@ -136,7 +231,8 @@ QString Tanks::tanksFilterCalculate() const
         }
         isFirst = false;
 
-        const auto tankConfig = _tanksConfig->getTankConfig(tankId);
+        const auto tankConfig = _tanksConfig->getTankConfig(handle);
+        const auto& tankId = tankConfig->tankId();
 
         const auto lastSave = std::min(tankConfig->lastSave(), tankConfig->lastIntake());
 
@@ -149,9 +245,9 @@ QString Tanks::tanksFilterCalculate() const
     return result;
 }
 
-Tanks::TanksLoadStatuses Tanks::loadFromCalculatedDB()
+Tanks::TanksLoadStatuses Tanks::loadFromCalculatedDB(const TankHandleList& tanksHandle)
 {
-    Q_ASSERT(!_isStarted);
+    Q_ASSERT(!tanksHandle.isEmpty());
     Q_ASSERT(_db.isOpen());
 
     //т.к. приоритетное значение имеет сохранненные измерения - то сначала загружаем их
@@ -160,11 +256,12 @@ Tanks::TanksLoadStatuses Tanks::loadFromCalculatedDB()
                 "FROM [TanksCalculate] "
                 "WHERE (%1) "
                 "ORDER BY [DateTime] DESC ")
-            .arg(tanksFilterCalculate());
+            .arg(tanksFilterCalculate(tanksHandle));
 
-    TanksLoadStatuses result;
+    //статусы и время последнего измерения накапливаются в массивах по дескриптору - на запись приходится один поиск в хеш-таблице
+    TanksLoadStatuses result(_tanksConfig->handlesCount());
     quint64 countStatuses = 0;
-    std::unordered_map<TankID, QDateTime> lastMeasuments;
+    std::vector<QDateTime> lastMeasuments(_tanksConfig->handlesCount());
 
     try
     {
@@ -200,14 +297,14 @@ Tanks::TanksLoadStatuses Tanks::loadFromCalculatedDB()
                 {
                     throw TankStatusLoadException(QString("Value [TanksCalculate]/TankNumber cannot be empty. Record ID: %1").arg(recordID));
                 }
-                const auto id = TankID(AZSCode, tankNumber);
+                const auto handle = _tanksConfig->tankHandle(TankID(AZSCode, tankNumber));
 
-                if (!_tanksConfig->checkID(id))
+                auto tankConfig = _tanksConfig->findTankConfig(handle);
+                if (tankConfig == nullptr)
                 {
                     continue;
                     //throw TankStatusLoadException(QString("Tank with ID %1 have not config on [TanksInfo]. Record ID: %2").arg(id.toString()).arg(recordID));
                 }
-                auto tankConfig = _tanksConfig->getTankConfig(id);
 
                 TankStatus::TankStatusData tmp;
                 tmp.dateTime = query.value("DateTime").toDateTime();
@@ -229,19 +326,14 @@ Tanks::TanksLoadStatuses Tanks::loadFromCalculatedDB()
                     throw TankStatusLoadException(QString("Invalid value tank status from DB [TanksCalculate]. Record ID: %1").arg(recordID));
                 }
 
-                auto lastMeasuments_it = lastMeasuments.find(id);
-                if (lastMeasuments_it == lastMeasuments.end())
+                auto& lastMeasument = lastMeasuments[handle];
+                if (!lastMeasument.isValid() || tmp.dateTime > lastMeasument)
                 {
-                    lastMeasuments.emplace(id, tmp.dateTime);
-                }
-                else
-                {
-                    lastMeasuments_it->second = std::max(tmp.dateTime, lastMeasuments_it->second);
+                    lastMeasument = tmp.dateTime;
                 }
 
                 TankStatus tankStatus(std::move(tmp));
-                auto& tankStatusList = result[id];
-                tankStatusList.emplace_back(std::move(tankStatus));
+                result[handle].emplace_back(std::move(tankStatus));
             }
             catch (TankStatusLoadException& err)
             {
@@ -262,25 +354,18 @@ Tanks::TanksLoadStatuses Tanks::loadFromCalculatedDB()
         return result;
     }
 
-    for (const auto& lastMeasument: lastMeasuments)
-    {
-        auto tankConfig = _tanksConfig->getTankConfig(lastMeasument.first);
-        if (lastMeasument.second > tankConfig->lastMeasuments())
-        {
-            tankConfig->setLastMeasuments(lastMeasument.second);
-        }
-    }
+    updateLastMeasuments(lastMeasuments);
 
     emit sendLogMsg(TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Load saved statuses from DB [TanksCalculate] complited. Count saved statuses: %1").arg(countStatuses));
 
     return result;
 }
 
-QString Tanks::tanksFilterMeasument() const
+QString Tanks::tanksFilterMeasument(const TankHandleList& tanksHandle) const
 {
     bool isFirst = true;
     QString result;
-    for (const auto& tankId: _tanksConfig->getTanksID())
+    for (const auto handle: tanksHandle)
     {
         if (!isFirst)
         {
@@ -288,7 +373,8 @@ QString Tanks::tanksFilterMeasument() const
         }
         isFirst = false;
 
-        const auto tankConfig = _tanksConfig->getTankConfig(tankId);
+        const auto tankConfig = _tanksConfig->getTankConfig(handle);
+        const auto& tankId = tankConfig->tankId();
 
         result += QString("([AZSCode] = '%1' AND [TankNumber] = %2 AND [DateTime] > CAST('%3' AS DATETIME2))")
                 .arg(tankId.levelGaugeCode())
@@ -307,10 +393,12 @@ void Tanks::loadFromMeasumentsDB()
     QString queryText;
     if (_lastLoadId == 0)
     {
+        const auto tanksHandle = _tanksConfig->getTanksHandle();
+
         QDateTime lastMeasument = QDateTime::currentDateTime().addYears(1);
-        for (const auto& tankId: _tanksConfig->getTanksID())
+        for (const auto handle: tanksHandle)
         {
-            const auto tankConfig = _tanksConfig->getTankConfig(tankId);
+            const auto tankConfig = _tanksConfig->getTankConfig(handle);
 
             lastMeasument = std::min(lastMeasument, tankConfig->lastMeasuments());
         }
@@ -319,7 +407,7 @@ void Tanks::loadFromMeasumentsDB()
             QString("SELECT [ID], [AZSCode], [TankNumber], [DateTime], [Density], [Height], [Volume], [Mass], [Temp] "
                     "FROM [TanksMeasument] "
                     "WHERE (%1) ")
-                .arg(tanksFilterMeasument());
+                .arg(tanksFilterMeasument(tanksHandle));
 
     }
     else
@@ -332,9 +420,16 @@ void Tanks::loadFromMeasumentsDB()
     }
     Q_ASSERT(!queryText.isEmpty());
 
-    TanksLoadStatuses tanksStatuses;
+    loadMeasuments(queryText);
+}
+
+void Tanks::loadMeasuments(const QString& queryText)
+{
+    Q_ASSERT(_db.isOpen());
+
+    TanksLoadStatuses tanksStatuses(_tanksConfig->handlesCount());
     quint64 countNewStatuses = 0;
-    std::unordered_map<TankID, QDateTime> lastMeasuments;
+    std::vector<QDateTime> lastMeasuments(_tanksConfig->handlesCount());
 
     try
     {
@@ -372,16 +467,15 @@ void Tanks::loadFromMeasumentsDB()
                 {
                     throw TankStatusLoadException(QString("Value [TanksMeasument]/TankNumber cannot be empty. Record ID: %1").arg(recordID));
                 }
-                const auto id = TankID(AZSCode, tankNumber);
+                const auto handle = _tanksConfig->tankHandle(TankID(AZSCode, tankNumber));
     
-                if (!_tanksConfig->checkID(id))
+                auto tankConfig = _tanksConfig->findTankConfig(handle);
+                if (tankConfig == nullptr)
                 {
                     continue;
                  //   throw TankStatusLoadException(QString("Tank with ID %1 have not config on [TanksInfo]. Record ID: %2").arg(id.toString()).arg(recordID));
                 }
     
-                auto tankConfig = _tanksConfig->getTankConfig(id);
-    
                 TankStatus::TankStatusData tmp;
                 tmp.dateTime = query.value("DateTime").toDateTime();
                 if (tankConfig->lastMeasuments() > tmp.dateTime)
@@ -409,19 +503,14 @@ void Tanks::loadFromMeasumentsDB()
                     throw TankStatusLoadException(QString("Invalid value tank status from [TanksMeasument]. Record ID: %1").arg(recordID));
                 }
     
-                auto lastMeasuments_it = lastMeasuments.find(id);
-                if (lastMeasuments_it == lastMeasuments.end())
+                auto& lastMeasument = lastMeasuments[handle];
+                if (!lastMeasument.isValid() || tmp.dateTime > lastMeasument)
                 {
-                    lastMeasuments.emplace(id, tmp.dateTime);
-                }
-                else
-                {
-                    lastMeasuments_it->second = std::max(tmp.dateTime, lastMeasuments_it->second);
+                    lastMeasument = tmp.dateTime;
                 }
     
                 TankStatus tankStatus(std::move(tmp));
-                auto& tankStatusList = tanksStatuses[id];
-                tankStatusList.emplace_back(std::move(tankStatus));
+                tanksStatuses[handle].emplace_back(std::move(tankStatus));
             }
             catch (TankStatusLoadException& err)
             {
@@ -443,44 +532,55 @@ void Tanks::loadFromMeasumentsDB()
         return;
     }
 
-    for (const auto& lastMeasument: lastMeasuments)
+    updateLastMeasuments(lastMeasuments);
+
+    emit sendLogMsg(TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Load new statuses from DB [TanksMeasument] complited. Count new statuses: %1").arg(countNewStatuses));
+
+    for (TankHandle handle = 0; handle < tanksStatuses.size(); ++handle)
     {
-        auto tankConfig = _tanksConfig->getTankConfig(lastMeasument.first);
-        if (lastMeasument.second > tankConfig->lastMeasuments())
+        if (tanksStatuses[handle].empty())
         {
-            tankConfig->setLastMeasuments(lastMeasument.second);
+            continue;
         }
+
+        emit newStatuses(_tanksConfig->getTankConfig(handle)->tankId(), tanksStatuses[handle]);
     }
+}
 
-    emit sendLogMsg(TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Load new statuses from DB [TanksMeasument] complited. Count new statuses: %1").arg(countNewStatuses));
+void Tanks::updateLastMeasuments(const std::vector<QDateTime>& lastMeasuments)
+{
+    Q_CHECK_PTR(_tanksConfig);
 
-    for (auto tanksStatuses_it = tanksStatuses.begin(); tanksStatuses_it != tanksStatuses.end(); ++tanksStatuses_it)
+    for (TankHandle handle = 0; handle < lastMeasuments.size(); ++handle)
     {
-        emit newStatuses(tanksStatuses_it->first, tanksStatuses_it->second);
+        const auto& lastMeasument = lastMeasuments[handle];
+        if (!lastMeasument.isValid())
+        {
+            continue;
+        }
+
+        auto tankConfig = _tanksConfig->getTankConfig(handle);
+        if (tankConfig->lastMeasuments() < lastMeasument)
+        {
+            tankConfig->setLastMeasuments(lastMeasument);
+        }
     }
 }
 
-void Tanks::makeTanks()
+void Tanks::makeTanks(const TankHandleList& tanksHandle)
 {
     Q_CHECK_PTR(_tanksConfig);
 
-    const auto tanksSavedStatuses = loadFromCalculatedDB();
+    const auto tanksSavedStatuses = loadFromCalculatedDB(tanksHandle);
 
-    for (const auto& tankId: _tanksConfig->getTanksID())
+    for (const auto handle: tanksHandle)
     {
         auto tmp = std::make_unique<TankThread>();
 
-        auto tankConfig = _tanksConfig->getTankConfig(tankId);
+        auto tankConfig = _tanksConfig->getTankConfig(handle);
+        const auto& tankId = tankConfig->tankId();
 
-        auto tanksSavedStatuses_it = tanksSavedStatuses.find(tankId);
-        if (tanksSavedStatuses_it != tanksSavedStatuses.end())
-        {
-            tmp->tank = std::make_unique<Tank>(tankConfig, tanksSavedStatuses_it->second);
-        }
-        else
-        {
-            tmp->tank = std::make_unique<Tank>(tankConfig, TankStatusesList{});
-        }
+        tmp->tank = std::make_unique<Tank>(tankConfig, tanksSavedStatuses[handle]);
         tmp->thread = std::make_unique<QThread>();
 
         tmp->tank->moveToThread(tmp->thread.get());
@@ -492,11 +592,9 @@ void Tanks::makeTanks()
 
         QObject::connect(tmp->tank.get(), SIGNAL(errorOccurred(const LevelGaugeService::TankID&, Common::EXIT_CODE, const QString&)),
                          SLOT(errorOccurredTank(const LevelGaugeService::TankID&, Common::EXIT_CODE, const QString&)), Qt::QueuedConnection);
+        //сообщения передаются в буфер лога из потока резервуара, минуя основной поток
         QObject::connect(tmp->tank.get(), SIGNAL(sendLogMsg(const LevelGaugeService::TankID&, Common::TDBLoger::MSG_CODE, const QString&)),
-                         SLOT(sendLogMsgTank(const LevelGaugeService::TankID&, Common::TDBLoger::MSG_CODE, const QString &)), Qt::QueuedConnection);
-
-        QObject::connect(this, SIGNAL(newStatuses(const LevelGaugeService::TankID&, const LevelGaugeService::TankStatusesList&)),
-                         tmp->tank.get(), SLOT(newStatuses(const LevelGaugeService::TankID&, const LevelGaugeService::TankStatusesList&)), Qt::QueuedConnection);
+                         SIGNAL(sendTankLogMsg(const LevelGaugeService::TankID&, Common::TDBLoger::MSG_CODE, const QString &)), Qt::DirectConnection);
 
         QObject::connect(tmp->tank.get(), SIGNAL(calculateStatuses(const LevelGaugeService::TankID&, const TankStatusesList&)),
                          SLOT(calculateStatusesTank(const LevelGaugeService::TankID&, const TankStatusesList&)), Qt::QueuedConnection);
@@ -511,10 +609,19 @@ void Tanks::makeTanks()
 
     //запускаем резервуары с лагом по времени чтобы сбалансировать нагрузку
     quint64 tankNumber = 0;
-    for (const auto& tankId: _tanksConfig->getTanksID())
+    for (const auto handle: tanksHandle)
     {
-        auto& tankThread =  _tanks.at(tankId)->thread;
-        QTimer::singleShot((60000 / _tanks.size()) * tankNumber, this, [&tankThread](){ tankThread->start(); });
+        const auto tankId = _tanksConfig->getTankConfig(handle)->tankId();
+        QTimer::singleShot((60000 / tanksHandle.size()) * tankNumber, this,
+            [this, tankId]()
+            {
+                //резервуар мог быть удален до запуска
+                const auto tanks_it = _tanks.find(tankId);
+                if (tanks_it != _tanks.end())
+                {
+                    tanks_it->second->thread->start();
+                }
+            });
     }
 
     //далее ждем когда все емкости запустяться и придут сигналы Tank::started(...)
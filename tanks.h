@@ -2,13 +2,16 @@
 
 //STL
 #include <memory>
+#include <list>
 #include <unordered_map>
-#include <string>
+#include <vector>
 
 //QT
 #include <QObject>
+#include <QSet>
 #include <QTimer>
 #include <QThread>
+#include <QUuid>
 
 //My
 #include "Common/common.h"
@@ -25,19 +28,31 @@ class Tanks
     Q_OBJECT
 
 public:
-    Tanks(const Common::DBConnectionInfo dbConnectionInfo, TanksConfig* tanksConfig, QObject* parent = nullptr);
+    Tanks(const Common::DBConnectionInfo dbConnectionInfo, TanksConfig* tanksConfig, qint64 checkMeasumentsInterval, QObject* parent = nullptr);
     ~Tanks();
 
 public slots:
     void start();
     void stop();
 
+    /*!
+        Создает и запускает резервуары, добавленные в конфигурацию во время работы
+        @param tanksId - ИД резервуаров
+    */
+    void addTanks(const LevelGaugeService::TankIDList& tanksId);
+
+    /*!
+        Останавливает и удаляет резервуары. Метод возвращает управление после остановки потоков резервуаров,
+            поэтому после его вызова резервуары больше не обращаются к своим конфигурациям
+        @param tanksId - ИД резервуаров
+    */
+    void removeTanks(const LevelGaugeService::TankIDList& tanksId);
+
 private slots:
     void calculateStatusesTank(const LevelGaugeService::TankID& id, const TankStatusesList &tankStatuses);
     void calculateIntakesTank(const LevelGaugeService::TankID& id, const IntakesList &intakes);
 
     void errorOccurredTank(const LevelGaugeService::TankID& id, Common::EXIT_CODE errorCode, const QString& msg);
-    void sendLogMsgTank(const LevelGaugeService::TankID& id, Common::TDBLoger::MSG_CODE category, const QString &msg);
 
     void loadFromMeasumentsDB();  //загружает новые данные из таблицы измерений
     void startedTank(const LevelGaugeService::TankID& id);
@@ -46,6 +61,21 @@ signals:
     void stopAll();
     void errorOccurred(Common::EXIT_CODE errorCode, const QString& errorString);
     void sendLogMsg(Common::TDBLoger::MSG_CODE category, const QString &msg);
+
+    /*!
+        Сообщение резервуара. Сигнал испускается в потоке резервуара, текст сообщения дополняется ИД резервуара получателем
+        @param id - ИД резервуара
+        @param category - тип сообщения
+        @param msg - текст сообщения
+    */
+    void sendTankLogMsg(const LevelGaugeService::TankID& id, Common::TDBLoger::MSG_CODE category, const QString &msg);
+
+    /*!
+        Сигнал испускается при ошибке резервуара перед errorOccurred(...)
+        @param id - ИД резервуара
+    */
+    void tankErrorOccurred(const LevelGaugeService::TankID& id);
+
     void finished();
 
     void newStatuses(const LevelGaugeService::TankID& id, const LevelGaugeService::TankStatusesList& tankStatuses);
@@ -54,18 +84,20 @@ signals:
     void calculateIntakes(const LevelGaugeService::TankID& id, const IntakesList &intakes);
 
 private:  
-    using TanksLoadStatuses = std::unordered_map<TankID, TankStatusesList>;
+    using TanksLoadStatuses = std::vector<TankStatusesList>; ///< Статусы резервуаров. Индекс - дескриптор резервуара
 
 private:
     Tanks() = delete;
     Q_DISABLE_COPY_MOVE(Tanks)
 
-    TanksLoadStatuses loadFromCalculatedDB();  //загружает данне о предыдыщих сохранениях из БД
+    TanksLoadStatuses loadFromCalculatedDB(const TankHandleList& tanksHandle);  //загружает данне о предыдыщих сохранениях из БД
+    void loadMeasuments(const QString& queryText);
+    void updateLastMeasuments(const std::vector<QDateTime>& lastMeasuments); //обновляет время последнего измерения резервуаров. Индекс - дескриптор резервуара
 
-    void makeTanks();
+    void makeTanks(const TankHandleList& tanksHandle);
 
-    QString tanksFilterCalculate() const;
-    QString tanksFilterMeasument() const;
+    QString tanksFilterCalculate(const TankHandleList& tanksHandle) const;
+    QString tanksFilterMeasument(const TankHandleList& tanksHandle) const;
 
 private:
     struct TankThread
@@ -78,12 +110,14 @@ private:
 private:
     const Common::DBConnectionInfo _dbConnectionInfo;
     LevelGaugeService::TanksConfig* _tanksConfig = nullptr;
+    const qint64 _checkMeasumentsInterval = 60000; ///< Интервал загрузки новых измерений, мсек
 
     QTimer* _checkNewMeasumentsTimer = nullptr;
 
     QSqlDatabase _db;
 
     std::unordered_map<LevelGaugeService::TankID, std::unique_ptr<TankThread>> _tanks;
+    QSet<LevelGaugeService::TankID> _addedTanks;  ///< Резервуары, добавленные во время работы, для которых еще не загружены измерения
 
     quint64 _lastLoadId = 0;
 
@@ -94,12 +128,13 @@ private:
 
 } //namespace LevelGaugeService
 
+//Hash for STL. qHash(QUuid) хеширует 128 бит ИД без формирования строки
 template<>
 struct std::hash<QUuid>
 {
     std::size_t operator()(const QUuid& id) const noexcept
     {
-        return std::hash<std::string>{}(id.toString().toStdString());
+        return qHash(id, 0);
     }
 };
 
@@ -0,0 +1,130 @@
+//STL
+#include <algorithm>
+
+//My
+#include "tankscalculatequery.h"
+
+using namespace LevelGaugeService;
+
+static const QString DATETIME_FORMAT = "yyyy-MM-dd hh:mm:ss.zzz"; ///< Формат времени MS SQL. Совпадает с Common::DATETIME_FORMAT
+static const qsizetype ROWS_PER_QUERY = 500; ///< Количество статусов в одном запросе MERGE. Не более 1000 (ограничение MS SQL для VALUES)
+
+QString LevelGaugeService::tanksCalculateFragment(const QString& levelGaugeCode, quint8 tankNumber, double totalVolume, const QString& product,
+                                                  quint8 productStatus, const QString& name, quint8 type, quint8 mode)
+{
+    auto escapedName = name;
+    auto escapedProduct = product;
+
+    return QString("'%1', %2, %3, '%4', %5, '%6', %7, %8, ")
+        .arg(levelGaugeCode)                            //1
+        .arg(tankNumber)                                //2
+        .arg(totalVolume, 0, 'f', 0)                    //3
+        .arg(escapedProduct.replace('\'', "''"))        //4
+        .arg(productStatus)                             //5
+        .arg(escapedName.replace('\'', "''"))           //6
+        .arg(type)                                      //7
+        .arg(mode);                                     //8
+}
+
+QString LevelGaugeService::tanksCalculateRow(const QString& fragment, const QDateTime& dateTime, qint64 timeShift, double volume, double mass,
+                                             double density, double height, double temp, quint8 additionFlag, quint8 status)
+{
+    QString row;
+    row.reserve(fragment.size() + 128);
+
+    row += "(";
+    row += fragment;
+    row += "CAST('";
+    row += dateTime.addSecs(timeShift).toString(DATETIME_FORMAT);
+    row += "' AS DATETIME2), ";
+    row += QString::number(volume, 'f', 0);
+    row += ", ";
+    row += QString::number(mass, 'f', 0);
+    row += ", ";
+    row += QString::number(density, 'f', 1);
+    row += ", ";
+    row += QString::number(height, 'f', 1);
+    row += ", ";
+    row += QString::number(temp, 'f', 1);
+    row += ", ";
+    row += QString::number(additionFlag);
+    row += ", ";
+    row += QString::number(status);
+    row += ", ";
+
+    return row;
+}
+
+QString LevelGaugeService::tanksCalculateSaveDateTimeSuffix()
+{
+    return QString("CAST('%1' AS DATETIME2))").arg(QDateTime::currentDateTime().toString(DATETIME_FORMAT));
+}
+
+void LevelGaugeService::tanksCalculateQueries(const QStringList& rows, DBWriteMode writeMode, bool returnSavedIDs,
+                                              const QString& rowSuffix, QStringList* queries)
+{
+    Q_CHECK_PTR(queries);
+
+    //порядок колонок: сначала постоянные для резервуара значения, которые берутся из кеша, затем значения измерения
+    static const QString COLUMNS =
+        "([AZSCode], [TankNumber], [TotalVolume], [Product], [ProductStatus], [TankName], [Type], [Mode], "
+        "[DateTime], [Volume], [Mass], [Density], [Height], [Temp], [AdditionFlag], [Status], [SaveDateTime])";
+
+    //ИД добавленных записей возвращаются без временной таблицы, поэтому на [TanksCalculate] не должно быть триггеров
+    static const QString OUTPUT = "OUTPUT INSERTED.[ID], INSERTED.[AZSCode], INSERTED.[TankNumber], INSERTED.[DateTime] ";
+
+    const auto insertPrefix = QString("INSERT INTO [dbo].[TanksCalculate] %1 %2VALUES ").arg(COLUMNS, returnSavedIDs ? OUTPUT : QString());
+
+    //повторная запись уже сохраненных статусов (например после частичной ошибки) не приводит к дублированию
+    static const QString MERGE_PREFIX = "MERGE [dbo].[TanksCalculate] WITH (HOLDLOCK) AS T USING (VALUES ";
+    static const QString MERGE_SUFFIX =
+        QString(") AS S %1 "
+                "ON T.[AZSCode] = S.[AZSCode] AND T.[TankNumber] = S.[TankNumber] AND T.[DateTime] = S.[DateTime] "
+                "WHEN NOT MATCHED BY TARGET THEN "
+                    "INSERT %1 "
+                    "VALUES (S.[AZSCode], S.[TankNumber], S.[TotalVolume], S.[Product], S.[ProductStatus], S.[TankName], S.[Type], S.[Mode], "
+                        "S.[DateTime], S.[Volume], S.[Mass], S.[Density], S.[Height], S.[Temp], S.[AdditionFlag], S.[Status], S.[SaveDateTime]) ")
+            .arg(COLUMNS);
+
+    if (writeMode != DBWriteMode::MERGE)
+    {
+        for (const auto& row: rows)
+        {
+            QString queryText;
+            queryText.reserve(insertPrefix.size() + row.size() + rowSuffix.size());
+
+            queryText += insertPrefix;
+            queryText += row;
+            queryText += rowSuffix;
+
+            queries->push_back(std::move(queryText));
+        }
+
+        return;
+    }
+
+    for (qsizetype first = 0; first < rows.size(); first += ROWS_PER_QUERY)
+    {
+        const auto last = std::min(first + ROWS_PER_QUERY, rows.size());
+
+        QString queryText;
+        queryText += MERGE_PREFIX;
+        for (auto i = first; i < last; ++i)
+        {
+            if (i != first)
+            {
+                queryText += ", ";
+            }
+            queryText += rows[i];
+            queryText += rowSuffix;
+        }
+        queryText += MERGE_SUFFIX;
+        if (returnSavedIDs)
+        {
+            queryText += OUTPUT;
+        }
+        queryText += ";";
+
+        queries->push_back(std::move(queryText));
+    }
+}
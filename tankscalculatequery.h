@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Формирование запросов сохранения статусов в [TanksCalculate]
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//QT
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+
+//My
+#include "dbwritemode.h"
+
+namespace LevelGaugeService
+{
+
+//Функции не зависят от библиотеки Common и конфигурации сервиса, поэтому используются также в QueryBuildBench
+
+/*!
+    Формирует фрагмент VALUES с постоянными значениями резервуара (AZSCode, TankNumber, TotalVolume,
+        Product, ProductStatus, TankName, Type, Mode)
+    @return фрагмент, завершающийся разделителем
+*/
+QString tanksCalculateFragment(const QString& levelGaugeCode, quint8 tankNumber, double totalVolume, const QString& product,
+                               quint8 productStatus, const QString& name, quint8 type, quint8 mode);
+
+/*!
+    Формирует строку VALUES статуса без завершающего значения [SaveDateTime]
+    @param fragment - фрагмент с постоянными значениями резервуара (tanksCalculateFragment())
+    @param dateTime - время статуса
+    @param timeShift - смещение времени резервуара, сек
+    @return строка VALUES
+*/
+QString tanksCalculateRow(const QString& fragment, const QDateTime& dateTime, qint64 timeShift, double volume, double mass,
+                          double density, double height, double temp, quint8 additionFlag, quint8 status);
+
+/*!
+    Возвращает завершение строки VALUES со значением [SaveDateTime] равным текущему времени
+*/
+QString tanksCalculateSaveDateTimeSuffix();
+
+/*!
+    Формирует запросы из строк VALUES: в режиме INSERT - по одному запросу на статус, в режиме MERGE - многострочные запросы
+    @param rows - строки VALUES без завершающего значения [SaveDateTime]
+    @param writeMode - режим записи в БД
+    @param returnSavedIDs - запросы возвращают ИД добавленных записей
+    @param rowSuffix - завершение каждой строки VALUES
+    @param queries - [out] список запросов
+*/
+void tanksCalculateQueries(const QStringList& rows, LevelGaugeService::DBWriteMode writeMode, bool returnSavedIDs,
+                           const QString& rowSuffix, QStringList* queries);
+
+} //namespace LevelGaugeService
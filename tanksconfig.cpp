@@ -1,3 +1,15 @@
+//STL
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+//QT
+#include <QSqlQuery>
+#include <QStringList>
+
+#include "tconfig.h"
+
 #include "tanksconfig.h"
 
 using namespace LevelGaugeService;
@@ -5,21 +17,321 @@ using namespace Common;
 
 static const float FLOAT_EPSILON = 0.0000001f;
 static const QString TANKS_CONFIG_DB_NAME = "TANKS_CONFIG_DB";
+static const qint64 SAVE_LAST_TIMES_INTERVAL = 5000; //мсек
+
+//названия полей [TanksInfo] в порядке TankConfig::LastTime
+static const std::array<QString, TankConfig::LAST_TIMES_COUNT> LAST_TIME_FIELD_NAMES =
+    {"LastMeasumentDateTime", "LastSaveDateTime", "LastSendDateTime", "LastIntakeDateTime", "LastSendIntakeDateTime"};
+
+//необязательные колонки [TanksInfo] с настройками обработки данных резервуара. Если колонки нет - используются значения по умолчанию для режима резервуара
+static const QStringList TIMING_FIELD_NAMES =
+    {"MinStepCountStartIntake", "MinStepCountFinishIntake", "MinStepCountStartPumpingOut", "MinStepCountFinishPumpingOut",
+     "SkipTime", "ConnectionTimeout", "SaveInterval"};
+
+//контрольная сумма считается только по настройкам резервуара, т.к. время последней обработки данных сервис обновляет постоянно
+static QString tanksConfigQuery(const QStringList& timingFieldNames)
+{
+    QString timingFields;
+    QString timingChecksumFields;
+    for (const auto& fieldName: TIMING_FIELD_NAMES)
+    {
+        //отсутствующая колонка возвращается как NULL, поэтому разбор записи не зависит от структуры таблицы
+        if (timingFieldNames.contains(fieldName))
+        {
+            timingFields += QString("[%1], ").arg(fieldName);
+            timingChecksumFields += QString(", [%1]").arg(fieldName);
+        }
+        else
+        {
+            timingFields += QString("NULL AS [%1], ").arg(fieldName);
+        }
+    }
+
+    return QString("SELECT "
+                       "[ID], [AZSCode], [TankNumber], [RemoteApplicantID], [RemoteObjectID], [RemoteTankID], [TankName], [RemoteBearerToken], [RemoteBaseURL], "
+                       "[Type], [Mode], [Status] ,[Volume] ,[Diametr], "
+                       "[Product], [ProductStatus], [LastMeasumentDateTime], [LastSaveDateTime], [LastSendDateTime], [LastIntakeDateTime], [LastSendIntakeDateTime], [TimeShift], "
+                       "[DeltaVolume], [DeltaMass], [DeltaDensity], [DeltaHeight], [DeltaTemp], "
+                       "[DeltaIntakeVolume], [DeltaIntakeMass], [DeltaIntakeDensity], [DeltaIntakeHeight], [DeltaIntakeTemp], "
+                       "[IntakeDetectHeight], [PumpingOutDetectHeight], "
+                       "%1"
+                       "BINARY_CHECKSUM([RemoteApplicantID], [RemoteObjectID], [RemoteTankID], [TankName], [RemoteBearerToken], [RemoteBaseURL], "
+                           "[Type], [Mode], [Status], [Volume], [Diametr], [Product], [ProductStatus], [TimeShift], "
+                           "[DeltaVolume], [DeltaMass], [DeltaDensity], [DeltaHeight], [DeltaTemp], "
+                           "[DeltaIntakeVolume], [DeltaIntakeMass], [DeltaIntakeDensity], [DeltaIntakeHeight], [DeltaIntakeTemp], "
+                           "[IntakeDetectHeight], [PumpingOutDetectHeight]%2) AS [ConfigChecksum] "
+                   "FROM [dbo].[TanksInfo] "
+                   "WHERE [Enabled] <> 0 ")
+        .arg(timingFields)
+        .arg(timingChecksumFields);
+}
+
+class TankConfigLoadException
+    : public std::runtime_error
+{
+public:
+    explicit TankConfigLoadException(const QString& what)
+        : std::runtime_error(what.toStdString())
+    {}
+};
 
-TanksConfig::TanksConfig(const Common::DBConnectionInfo& dbConnectionInfo, QObject* parent /* = nullptr */)
+TanksConfig::TanksConfig(const Common::DBConnectionInfo& dbConnectionInfo, qint64 refreshInterval, QObject* parent /* = nullptr */)
     : QObject{parent}
     , _dbConnectionInfo(dbConnectionInfo)
+    , _refreshInterval(refreshInterval)
 {
+    Q_ASSERT(_refreshInterval >= 0);
+
     qRegisterMetaType<LevelGaugeService::TankID>("TankID");
+
+    QObject::connect(&_refreshTimer, SIGNAL(timeout()), SLOT(refresh()));
+    QObject::connect(&_saveLastTimesTimer, SIGNAL(timeout()), SLOT(saveLastTimes()));
 }
 
 TanksConfig::~TanksConfig()
 {
+    _refreshTimer.stop();
+    _saveLastTimesTimer.stop();
+
+    if (_db.isOpen())
+    {
+        saveLastTimes();
+    }
+
+    _tanksId.clear();
+    _tanksHandleList.clear();
+    _tanksHandle.clear();
     _tanksConfig.clear();
 
     closeDB(_db);
 }
 
+std::unique_ptr<TankConfig> TanksConfig::parseTankConfig(const QSqlQuery& query) const
+{
+    const auto recordID = query.value("ID").toULongLong();
+    const auto AZSCode = query.value("AZSCode").toString();
+    if (AZSCode.isEmpty())
+    {
+        throw TankConfigLoadException(QString("Value [TanksInfo]/AZSCode cannot be empty. Record ID: %1").arg(recordID));
+    }
+
+    const auto tankNumber = query.value("TankNumber").toUInt();
+    if (tankNumber == 0)
+    {
+        throw TankConfigLoadException(QString("Value [TanksInfo]/TankNumber cannot be empty. Record ID: %1").arg(recordID));
+    }
+    const auto id = TankID(AZSCode, tankNumber);
+
+    const auto name = query.value("TankName").toString();
+    if (name.isEmpty())
+    {
+         throw TankConfigLoadException(QString("Value [TanksInfo]/TankName cannot be empty. Record ID: %1").arg(recordID));
+    }
+
+    const auto remoteBearerToken = query.value("RemoteBearerToken").toString();
+    if (remoteBearerToken.isEmpty() || remoteBearerToken == "UNDEFINED")
+    {
+         throw TankConfigLoadException(QString("Value [TanksInfo]/RemoteBearerToken cannot be empty or UNDEFINED. Record ID: %1").arg(recordID));
+    }
+
+    const auto remoteBaseUrl = query.value("RemoteBaseURL").toUrl();
+    auto tmpUrl = remoteBaseUrl; //исключаем ситуацию когда в качестве адреса указан только протокол. Например "https://"
+    tmpUrl.setPath("/tmp");
+    if (remoteBaseUrl.isEmpty() || !tmpUrl.isValid())
+    {
+         throw TankConfigLoadException(QString("Value [TanksInfo]/RemoteBaseURL cannot be empty or no valid. Record ID: %1").arg(recordID));
+    }
+
+    const auto remoteApplicantId = query.value("RemoteApplicantID").toLongLong();
+    if (remoteApplicantId == 0)
+    {
+         throw TankConfigLoadException(QString("Value [TanksInfo]/RemoteApplicantID cannot be null. Record ID: %1").arg(recordID));
+    }
+
+    const auto remoteObjectId = query.value("RemoteObjectID").toLongLong();
+    if (remoteObjectId == 0)
+    {
+         throw TankConfigLoadException(QString("Value [TanksInfo]/RemoteObjectID cannot be null. Record ID: %1").arg(recordID));
+    }
+
+    const auto remoteTankId = query.value("RemoteTankId").toLongLong();
+    if (remoteTankId == 0)
+    {
+         throw TankConfigLoadException(QString("Value [TanksInfo]/RemoteTankID cannot be null. Record ID: %1").arg(recordID));
+    }
+
+    const auto totalVolume = query.value("Volume").toFloat();
+    if (totalVolume <= FLOAT_EPSILON)
+    {
+         throw TankConfigLoadException(QString("Value [TanksInfo]/Volume cannot be null or negative number. Record ID: %1").arg(recordID));
+    }
+
+    const auto diametr = query.value("Diametr").toFloat();
+    if (diametr <= FLOAT_EPSILON)
+    {
+         throw TankConfigLoadException(QString("Value [TanksInfo]/Diametr cannot be null or negative number. Record ID: %1").arg(recordID));
+    }
+
+    const auto lastSave = query.value("LastSaveDateTime").toDateTime();
+    const auto lastMeasuments = query.value("LastMeasumentDateTime").toDateTime();
+    const auto lastIntake = query.value("LastIntakeDateTime").toDateTime();
+    const auto lastSend = query.value("LastSendDateTime").toDateTime();
+    const auto lastSendIntake = query.value("LastSendIntakeDateTime").toDateTime();
+
+    const auto timeShift = query.value("TimeShift").toInt(); //cмещение времени относительно сервера
+
+    TankConfig::Delta deltaMax;
+    deltaMax.volume = query.value("DeltaVolume").toFloat();
+    deltaMax.mass = query.value("DeltaMass").toFloat();
+    deltaMax.density = query.value("DeltaDensity").toFloat();
+    deltaMax.height = query.value("DeltaHeight").toFloat();
+    deltaMax.temp = query.value("DeltaTemp").toFloat();
+
+    if (!deltaMax.check())
+    {
+        throw TankConfigLoadException(QString("Value [TanksInfo]/Delta[Volume, Mass, Density, Height, Temp] cannot be null or negative number. Record ID: %1").arg(recordID));
+    }
+
+    TankConfig::Delta deltaIntake;
+    deltaIntake.volume = query.value("DeltaIntakeVolume").toFloat();
+    deltaIntake.mass = query.value("DeltaIntakeMass").toFloat();
+    deltaIntake.density = query.value("DeltaIntakeDensity").toFloat();
+    deltaIntake.height = query.value("DeltaIntakeHeight").toFloat();
+    deltaIntake.temp = query.value("DeltaIntakeTemp").toFloat();
+
+    if (!deltaIntake.check())
+    {
+        throw TankConfigLoadException(QString("Value [TanksInfo]/DeltaIntake[Volume, Mass, Density, Height, Temp] cannot be null or negative number. Record ID: %1").arg(recordID));
+    }
+
+    const auto deltaIntakeHeight = query.value("IntakeDetectHeight").toFloat();
+    if (deltaIntakeHeight <= FLOAT_EPSILON)
+    {
+         throw TankConfigLoadException(QString("Value [TanksInfo]/IntakeDetectHeight cannot be null or negative number. Record ID: %1").arg(recordID));
+    }
+
+    const auto deltaPumpingOutHeight = query.value("PumpingOutDetectHeight").toFloat();
+    if (deltaPumpingOutHeight <= FLOAT_EPSILON)
+    {
+         throw TankConfigLoadException(QString("Value [TanksInfo]/PumpingOutDetectHeight cannot be null or negative number. Record ID: %1").arg(recordID));
+    }
+
+    const TankConfig::Status status = TankConfig::intToStatus(query.value("Status").toUInt());
+    const TankConfig::Mode mode = TankConfig::intToMode(query.value("Mode").toUInt());
+    if (mode == TankConfig::Mode::UNDEFINE)
+    {
+        throw TankConfigLoadException(QString("Invalid value [TanksInfo]/Mode. Record ID: %1").arg(recordID));
+    }
+
+    const TankConfig::Type type = TankConfig::intToType(query.value("Type").toUInt());
+    if (type == TankConfig::Type::UNDEFINE)
+    {
+        throw TankConfigLoadException(QString("Invalid value [TanksInfo]/Type. Record ID: %1").arg(recordID));
+    }
+
+    const auto product = query.value("Product").toString();
+    if (product.isEmpty())
+    {
+         throw TankConfigLoadException(QString("Value [TanksInfo]/Product cannot be empty. Record ID: %1").arg(recordID));
+    }
+    const TankConfig::ProductStatus productStatus= TankConfig::intToProductStatus(query.value("ProductStatus").toUInt());
+    if (productStatus == TankConfig::ProductStatus::UNDEFINE)
+    {
+        throw TankConfigLoadException(QString("Invalid value [TanksInfo]/ProductStatus. Record ID: %1").arg(recordID));
+    }
+
+    //значения по умолчанию задаются для режима работы резервуара в конфигурационном файле. NULL - используется значение по умолчанию
+    auto timing = TConfig::config()->tank_Timing(mode);
+    if (!query.value("MinStepCountStartIntake").isNull())
+    {
+        timing.minStepCountStartIntake = query.value("MinStepCountStartIntake").toInt();
+    }
+    if (!query.value("MinStepCountFinishIntake").isNull())
+    {
+        timing.minStepCountFinishIntake = query.value("MinStepCountFinishIntake").toInt();
+    }
+    if (!query.value("MinStepCountStartPumpingOut").isNull())
+    {
+        timing.minStepCountStartPumpingOut = query.value("MinStepCountStartPumpingOut").toInt();
+    }
+    if (!query.value("MinStepCountFinishPumpingOut").isNull())
+    {
+        timing.minStepCountFinishPumpingOut = query.value("MinStepCountFinishPumpingOut").toInt();
+    }
+    if (!query.value("SkipTime").isNull())
+    {
+        timing.skipTime = query.value("SkipTime").toLongLong();
+    }
+    if (!query.value("ConnectionTimeout").isNull())
+    {
+        timing.connectionTimeout = query.value("ConnectionTimeout").toLongLong();
+    }
+    if (!query.value("SaveInterval").isNull())
+    {
+        timing.saveInterval = query.value("SaveInterval").toLongLong();
+    }
+
+    if (!timing.check())
+    {
+        throw TankConfigLoadException(QString("Value [TanksInfo]/[MinStepCountStartIntake, MinStepCountFinishIntake, MinStepCountStartPumpingOut, MinStepCountFinishPumpingOut] "
+                                              "must be between 1 and 60, [SkipTime] between 0 and 3600, [ConnectionTimeout] between 60 and 86400, [SaveInterval] between 1000 and 3600000. Record ID: %1").arg(recordID));
+    }
+
+    auto tankConfig_p = std::make_unique<TankConfig>(id,
+                                                     remoteApplicantId,  remoteObjectId,  remoteTankId, name, remoteBearerToken, remoteBaseUrl,
+                                                     totalVolume, diametr, timeShift, mode , type,
+                                                     deltaMax, deltaIntake,
+                                                     deltaIntakeHeight, deltaPumpingOutHeight,
+                                                     status, product, productStatus, timing);
+
+    tankConfig_p->setLastMeasuments(lastMeasuments);
+    tankConfig_p->setLastSave(lastSave);
+    tankConfig_p->setLastIntake(lastIntake);
+    tankConfig_p->setLastSend(lastSend);
+    tankConfig_p->setLastSendIntake(lastSendIntake);
+
+    //времена загружены из БД - сохранять их не нужно
+    tankConfig_p->takeChangedLastTimes();
+
+    return tankConfig_p;
+}
+
+QStringList TanksConfig::loadTimingFieldNames()
+{
+    Q_ASSERT(_db.isOpen());
+
+    QSqlQuery query(_db);
+    query.setForwardOnly(true);
+
+    DBQueryExecute(_db, query, QString("SELECT [name] "
+                                       "FROM sys.columns "
+                                       "WHERE [object_id] = OBJECT_ID('[dbo].[TanksInfo]') AND [name] IN ('%1')")
+                                   .arg(TIMING_FIELD_NAMES.join("', '")));
+
+    QStringList result;
+    while (query.next())
+    {
+        result.push_back(query.value("name").toString());
+    }
+
+    QStringList missingFieldNames;
+    for (const auto& fieldName: TIMING_FIELD_NAMES)
+    {
+        if (!result.contains(fieldName))
+        {
+            missingFieldNames.push_back(QString("[%1]").arg(fieldName));
+        }
+    }
+
+    if (!missingFieldNames.isEmpty())
+    {
+        emit sendLogMsg(TDBLoger::MSG_CODE::WARNING_CODE, QString("Columns %1 not found in [TanksInfo]. Default values from [TANK_AZS]/[TANK_OIL_DEPOT] will be used")
+                            .arg(missingFieldNames.join(", ")));
+    }
+
+    return result;
+}
+
 bool TanksConfig::loadFromDB()
 {
     Q_ASSERT(!_db.isOpen());
@@ -39,16 +351,6 @@ bool TanksConfig::loadFromDB()
     Q_ASSERT(_db.isOpen());
 
     //загружаем данные об АЗС
-    const auto queryText =
-            QString("SELECT "
-                        "[ID], [AZSCode], [TankNumber], [RemoteApplicantID], [RemoteObjectID], [RemoteTankID], [TankName], [RemoteBearerToken], [RemoteBaseURL], "
-                        "[Type], [Mode], [Status] ,[Volume] ,[Diametr], "
-                        "[Product], [ProductStatus], [LastMeasumentDateTime], [LastSaveDateTime], [LastSendDateTime], [LastIntakeDateTime], [LastSendIntakeDateTime], [TimeShift], "
-                        "[DeltaVolume], [DeltaMass], [DeltaDensity], [DeltaHeight], [DeltaTemp], "
-                        "[DeltaIntakeVolume], [DeltaIntakeMass], [DeltaIntakeDensity], [DeltaIntakeHeight], [DeltaIntakeTemp], "
-                        "[IntakeDetectHeight], [PumpingOutDetectHeight] "
-                    "FROM [dbo].[TanksInfo] "
-                    "WHERE [Enabled] <> 0 ");
     try
     {
         transactionDB(_db);
@@ -56,191 +358,113 @@ bool TanksConfig::loadFromDB()
         QSqlQuery query(_db);
         query.setForwardOnly(true);
 
-        DBQueryExecute(_db, query, queryText);
+        _configQuery = tanksConfigQuery(loadTimingFieldNames());
+
+        DBQueryExecute(_db, query, _configQuery);
 
         while (query.next())
         {
-            class TankConfigLoadException
-                : public std::runtime_error
-            {
-            public:
-                explicit TankConfigLoadException(const QString& what)
-                    : std::runtime_error(what.toStdString())
-                {}
-            };
-
             try
             {
-                const auto recordID = query.value("ID").toULongLong();
-                const auto AZSCode = query.value("AZSCode").toString();
-                if (AZSCode.isEmpty())
-                {
-                    throw TankConfigLoadException(QString("Value [TanksInfo]/AZSCode cannot be empty. Record ID: %1").arg(recordID));
-                }
+                auto tankConfig_p = parseTankConfig(query);
+                const auto id = tankConfig_p->tankId();
+                const auto remoteTankId = tankConfig_p->remoteTankId();
 
-                const auto tankNumber = query.value("TankNumber").toUInt();
-                if (tankNumber == 0)
+                if (std::find_if(_tanksConfig.begin(), _tanksConfig.end(),
+                    [remoteTankId](const auto& tankConfig)
+                    {
+                        return tankConfig && tankConfig->remoteTankId() == remoteTankId;
+                    }) != _tanksConfig.end())
                 {
-                    throw TankConfigLoadException(QString("Value [TanksInfo]/TankNumber cannot be empty. Record ID: %1").arg(recordID));
+                    throw TankConfigLoadException(QString("Value [TanksInfo]/RemoteTankID not unique. Record ID: %1").arg(query.value("ID").toULongLong()));
                 }
-                const auto id = TankID(AZSCode, tankNumber);
 
-                const auto name = query.value("TankName").toString();
-                if (name.isEmpty())
-                {
-                     throw TankConfigLoadException(QString("Value [TanksInfo]/TankName cannot be empty. Record ID: %1").arg(recordID));
-                }
+                setTankConfig(std::move(tankConfig_p));
+                _configChecksums.insert(id, query.value("ConfigChecksum").toLongLong());
+            }
+            catch (TankConfigLoadException& err)
+            {
+                emit sendLogMsg(TDBLoger::MSG_CODE::WARNING_CODE, QString("Cannot load tank configuration from DB. Tank skipped. Error: %1").arg(err.what()));
+            }
+        }
 
-                const auto remoteBearerToken = query.value("RemoteBearerToken").toString();
-                if (remoteBearerToken.isEmpty() || remoteBearerToken == "UNDEFINED")
-                {
-                     throw TankConfigLoadException(QString("Value [TanksInfo]/RemoteBearerToken cannot be empty or UNDEFINED. Record ID: %1").arg(recordID));
-                }
+        commitDB(_db);
+    }
+    catch (const SQLException& err)
+    {
+        _db.rollback();
 
-                const auto remoteBaseUrl = query.value("RemoteBaseURL").toUrl();
-                auto tmpUrl = remoteBaseUrl; //исключаем ситуацию когда в качестве адреса указан только протокол. Например "https://"
-                tmpUrl.setPath("/tmp");
-                if (remoteBaseUrl.isEmpty() || !tmpUrl.isValid())
-                {
-                     throw TankConfigLoadException(QString("Value [TanksInfo]/RemoteBaseURL cannot be empty or no valid. Record ID: %1").arg(recordID));
-                }
+        emit errorOccurred(EXIT_CODE::LOAD_CONFIG_ERR, QString("Cannot load tank configuration from DB: %1").arg(err.what()));
 
-                const auto remoteApplicantId = query.value("RemoteApplicantID").toLongLong();
-                if (remoteApplicantId == 0)
-                {
-                     throw TankConfigLoadException(QString("Value [TanksInfo]/RemoteApplicantID cannot be null. Record ID: %1").arg(recordID));
-                }
+        return false;
+    }
 
-                const auto remoteObjectId = query.value("RemoteObjectID").toLongLong();
-                if (remoteObjectId == 0)
-                {
-                     throw TankConfigLoadException(QString("Value [TanksInfo]/RemoteObjectID cannot be null. Record ID: %1").arg(recordID));
-                }
+    if (_tanksId.isEmpty())
+    {
+        emit errorOccurred(EXIT_CODE::LOAD_CONFIG_ERR, "No tanks for work. Total tanks: 0");
 
-                const auto remoteTankId = query.value("RemoteTankId").toLongLong();
-                if (remoteTankId == 0)
-                {
-                     throw TankConfigLoadException(QString("Value [TanksInfo]/RemoteTankID cannot be null. Record ID: %1").arg(recordID));
-                }
+        return false;
+    }
 
-                if (std::find_if(_tanksConfig.begin(),_tanksConfig.end(),
-                    [remoteTankId](const auto& tankConfig)
-                    {
-                        return tankConfig.second->remoteTankId() == remoteTankId;
-                    }) != _tanksConfig.end())
-                {
-                    throw TankConfigLoadException(QString("Value [TanksInfo]/RemoteTankID not unique. Record ID: %1").arg(recordID));
-                }
+    emit sendLogMsg(TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Load tank configuration from DB is successfully. Total tanks: %1").arg(_tanksId.size()));
 
-                const auto totalVolume = query.value("Volume").toFloat();
-                if (totalVolume <= FLOAT_EPSILON)
-                {
-                     throw TankConfigLoadException(QString("Value [TanksInfo]/Volume cannot be null or negative number. Record ID: %1").arg(recordID));
-                }
+    _saveLastTimesTimer.start(SAVE_LAST_TIMES_INTERVAL);
 
-                const auto diametr = query.value("Diametr").toFloat();
-                if (diametr <= FLOAT_EPSILON)
-                {
-                     throw TankConfigLoadException(QString("Value [TanksInfo]/Diametr cannot be null or negative number. Record ID: %1").arg(recordID));
-                }
+    if (_refreshInterval > 0)
+    {
+        _refreshTimer.start(_refreshInterval);
+    }
 
-                const auto lastSave = query.value("LastSaveDateTime").toDateTime();
-                const auto lastMeasuments = query.value("LastMeasumentDateTime").toDateTime();
-                const auto lastIntake = query.value("LastIntakeDateTime").toDateTime();
-                const auto lastSend = query.value("LastSendDateTime").toDateTime();
-                const auto lastSendIntake = query.value("LastSendIntakeDateTime").toDateTime();
+    return true;
+}
 
-                const auto timeShift = query.value("TimeShift").toInt(); //cмещение времени относительно сервера
+void TanksConfig::refresh()
+{
+    Q_ASSERT(_db.isOpen());
 
-                TankConfig::Delta deltaMax;
-                deltaMax.volume = query.value("DeltaVolume").toFloat();
-                deltaMax.mass = query.value("DeltaMass").toFloat();
-                deltaMax.density = query.value("DeltaDensity").toFloat();
-                deltaMax.height = query.value("DeltaHeight").toFloat();
-                deltaMax.temp = query.value("DeltaTemp").toFloat();
+    std::unordered_map<TankID, std::unique_ptr<TankConfig>> newConfigs; ///< новые и измененные резервуары
+    QHash<TankID, qint64> newChecksums;
+    QSet<TankID> existTanks;    ///< резервуары, присутствующие в [TanksInfo]
 
-                if (!deltaMax.check())
-                {
-                    throw TankConfigLoadException(QString("Value [TanksInfo]/Delta[Volume, Mass, Density, Height, Temp] cannot be null or negative number. Record ID: %1").arg(recordID));
-                }
+    try
+    {
+        transactionDB(_db);
 
-                TankConfig::Delta deltaIntake;
-                deltaIntake.volume = query.value("DeltaIntakeVolume").toFloat();
-                deltaIntake.mass = query.value("DeltaIntakeMass").toFloat();
-                deltaIntake.density = query.value("DeltaIntakeDensity").toFloat();
-                deltaIntake.height = query.value("DeltaIntakeHeight").toFloat();
-                deltaIntake.temp = query.value("DeltaIntakeTemp").toFloat();
+        QSqlQuery query(_db);
+        query.setForwardOnly(true);
 
-                if (!deltaIntake.check())
-                {
-                    throw TankConfigLoadException(QString("Value [TanksInfo]/DeltaIntake[Volume, Mass, Density, Height, Temp] cannot be null or negative number. Record ID: %1").arg(recordID));
-                }
+        DBQueryExecute(_db, query, _configQuery);
 
-                const auto deltaIntakeHeight = query.value("IntakeDetectHeight").toFloat();
-                if (deltaIntakeHeight <= FLOAT_EPSILON)
-                {
-                     throw TankConfigLoadException(QString("Value [TanksInfo]/IntakeDetectHeight cannot be null or negative number. Record ID: %1").arg(recordID));
-                }
+        while (query.next())
+        {
+            const auto AZSCode = query.value("AZSCode").toString();
+            const auto tankNumber = query.value("TankNumber").toUInt();
+            if (AZSCode.isEmpty() || tankNumber == 0)
+            {
+                continue;
+            }
 
-                const auto deltaPumpingOutHeight = query.value("PumpingOutDetectHeight").toFloat();
-                if (deltaPumpingOutHeight <= FLOAT_EPSILON)
-                {
-                     throw TankConfigLoadException(QString("Value [TanksInfo]/PumpingOutDetectHeight cannot be null or negative number. Record ID: %1").arg(recordID));
-                }
+            const auto id = TankID(AZSCode, tankNumber);
+            const auto checksum = query.value("ConfigChecksum").toLongLong();
 
-                const TankConfig::Status status = TankConfig::intToStatus(query.value("Status").toUInt());
-                const TankConfig::Mode mode = TankConfig::intToMode(query.value("Mode").toUInt());
-                if (mode == TankConfig::Mode::UNDEFINE)
-                {
-                    throw TankConfigLoadException(QString("Invalid value [TanksInfo]/Mode. Record ID: %1").arg(recordID));
-                }
+            existTanks.insert(id);
 
-                const TankConfig::Type type = TankConfig::intToType(query.value("Type").toUInt());
-                if (type == TankConfig::Type::UNDEFINE)
-                {
-                    throw TankConfigLoadException(QString("Invalid value [TanksInfo]/Type. Record ID: %1").arg(recordID));
-                }
+            //настройки резервуара не изменились
+            const auto configChecksums_it = _configChecksums.constFind(id);
+            if (configChecksums_it != _configChecksums.end() && configChecksums_it.value() == checksum)
+            {
+                continue;
+            }
 
-                const auto product = query.value("Product").toString();
-                if (product.isEmpty())
-                {
-                     throw TankConfigLoadException(QString("Value [TanksInfo]/Product cannot be empty. Record ID: %1").arg(recordID));
-                }
-                const TankConfig::ProductStatus productStatus= TankConfig::intToProductStatus(query.value("ProductStatus").toUInt());
-                if (productStatus == TankConfig::ProductStatus::UNDEFINE)
-                {
-                    throw TankConfigLoadException(QString("Invalid value [TanksInfo]/ProductStatus. Record ID: %1").arg(recordID));
-                }
+            newChecksums.insert(id, checksum);
 
-                auto tankConfig_p = std::make_unique<TankConfig>(id,
-                                                                 remoteApplicantId,  remoteObjectId,  remoteTankId, name, remoteBearerToken, remoteBaseUrl,
-                                                                 totalVolume, diametr, timeShift, mode , type,
-                                                                 deltaMax, deltaIntake,
-                                                                 deltaIntakeHeight, deltaPumpingOutHeight,
-                                                                 status, product, productStatus);
-
-                tankConfig_p->setLastMeasuments(lastMeasuments);
-                tankConfig_p->setLastSave(lastSave);
-                tankConfig_p->setLastIntake(lastIntake);
-                tankConfig_p->setLastSend(lastSend);
-                tankConfig_p->setLastSendIntake(lastSendIntake);
-
-                QObject::connect(tankConfig_p.get(), SIGNAL(lastMeasuments(const LevelGaugeService::TankID&, const QDateTime&)),
-                                 SLOT(lastMeasuments(const LevelGaugeService::TankID&, const QDateTime&)), Qt::DirectConnection);
-                QObject::connect(tankConfig_p.get(), SIGNAL(lastSave(const LevelGaugeService::TankID&, const QDateTime&)),
-                                 SLOT(lastSave(const LevelGaugeService::TankID&, const QDateTime&)), Qt::DirectConnection);
-                QObject::connect(tankConfig_p.get(), SIGNAL(lastIntake(const LevelGaugeService::TankID&, const QDateTime&)),
-                                 SLOT(lastIntake(const LevelGaugeService::TankID&, const QDateTime&)), Qt::DirectConnection);
-                QObject::connect(tankConfig_p.get(), SIGNAL(lastSend(const LevelGaugeService::TankID&, const QDateTime&)),
-                                 SLOT(lastSend(const LevelGaugeService::TankID&, const QDateTime&)), Qt::DirectConnection);
-                QObject::connect(tankConfig_p.get(), SIGNAL(lastSendIntake(const LevelGaugeService::TankID&, const QDateTime&)),
-                                 SLOT(lastSendIntake(const LevelGaugeService::TankID&, const QDateTime&)), Qt::DirectConnection);
-
-                _tanksConfig.emplace(id, std::move(tankConfig_p));
+            try
+            {
+                newConfigs.emplace(id, parseTankConfig(query));
             }
             catch (TankConfigLoadException& err)
             {
-                emit sendLogMsg(TDBLoger::MSG_CODE::WARNING_CODE, QString("Cannot load tank configuration from DB. Tank skipped. Error: %1").arg(err.what()));
+                emit sendLogMsg(TDBLoger::MSG_CODE::WARNING_CODE, QString("Cannot load changed tank configuration from DB. Previous configuration is used. Error: %1").arg(err.what()));
             }
         }
 
@@ -250,110 +474,298 @@ bool TanksConfig::loadFromDB()
     {
         _db.rollback();
 
-        emit errorOccurred(EXIT_CODE::LOAD_CONFIG_ERR, QString("Cannot load tank configuration from DB: %1").arg(err.what()));
+        emit sendLogMsg(TDBLoger::MSG_CODE::WARNING_CODE, QString("Cannot refresh tank configuration from DB. Previous configuration is used. Error: %1").arg(err.what()));
 
-        return false;
+        return;
     }
 
-    if (_tanksConfig.empty())
+    //некорректная конфигурация повторно не разбирается до ее следующего изменения
+    for (auto newChecksums_it = newChecksums.begin(); newChecksums_it != newChecksums.end(); ++newChecksums_it)
     {
-        emit errorOccurred(EXIT_CODE::LOAD_CONFIG_ERR, "No tanks for work. Total tanks: 0");
+        _configChecksums.insert(newChecksums_it.key(), newChecksums_it.value());
+    }
 
-        return false;
+    TankIDList removedTanks;
+    for (const auto& id: _tanksId)
+    {
+        if (!existTanks.contains(id))
+        {
+            removedTanks.push_back(id);
+        }
     }
 
-    emit sendLogMsg(TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Load tank configuration from DB is successfully. Total tanks: %1").arg(_tanksConfig.size()));
+    //ИД резервуаров на сервере должны остаться уникальными
+    QHash<qint64, TankID> remoteTankIds;
+    for (const auto& id: _tanksId)
+    {
+        if (!newConfigs.contains(id) && !removedTanks.contains(id))
+        {
+            remoteTankIds.insert(findTankConfig(id)->remoteTankId(), id);
+        }
+    }
 
-    return true;
+    for (auto newConfigs_it = newConfigs.begin(); newConfigs_it != newConfigs.end(); )
+    {
+        const auto remoteTankId = newConfigs_it->second->remoteTankId();
+        if (remoteTankIds.contains(remoteTankId))
+        {
+            emit sendLogMsg(TDBLoger::MSG_CODE::WARNING_CODE, QString("Cannot load changed tank configuration from DB. Previous configuration is used. "
+                                                                      "Error: Value [TanksInfo]/RemoteTankID not unique. Tank: %1")
+                                                                  .arg(newConfigs_it->first.toString()));
+
+            newConfigs_it = newConfigs.erase(newConfigs_it);
+
+            continue;
+        }
+
+        remoteTankIds.insert(remoteTankId, newConfigs_it->first);
+        ++newConfigs_it;
+    }
+
+    if (removedTanks.isEmpty() && newConfigs.empty())
+    {
+        return;
+    }
+
+    const auto addedCount = std::count_if(newConfigs.begin(), newConfigs.end(),
+        [this](const auto& newConfig)
+        {
+            return findTankConfig(newConfig.first) == nullptr;
+        });
+
+    if (_tanksId.size() + addedCount == removedTanks.size())
+    {
+        emit sendLogMsg(TDBLoger::MSG_CODE::WARNING_CODE, "Refreshed tank configuration contains no tanks. Previous configuration is used");
+
+        return;
+    }
+
+    TankIDList addedTanks;
+    TankIDList changedTanks;
+    for (const auto& [id, tankConfig]: newConfigs)
+    {
+        const auto oldConfig = findTankConfig(id);
+        if (oldConfig == nullptr)
+        {
+            addedTanks.push_back(id);
+
+            continue;
+        }
+
+        changedTanks.push_back(id);
+
+        //время последней обработки данных хранится в памяти и не должно откатываться при замене конфигурации
+        tankConfig->setLastMeasuments(std::max(tankConfig->lastMeasuments(), oldConfig->lastMeasuments()));
+        tankConfig->setLastSave(std::max(tankConfig->lastSave(), oldConfig->lastSave()));
+        tankConfig->setLastIntake(std::max(tankConfig->lastIntake(), oldConfig->lastIntake()));
+        tankConfig->setLastSend(std::max(tankConfig->lastSend(), oldConfig->lastSend()));
+        tankConfig->setLastSendIntake(std::max(tankConfig->lastSendIntake(), oldConfig->lastSendIntake()));
+    }
+
+    //пока обрабатывается сигнал, конфигурации удаляемых и изменяемых резервуаров остаются доступны
+    emit tanksRemoving(removedTanks + changedTanks);
+
+    //резервуары остановлены - сохраняем их последние времена до удаления конфигураций
+    saveLastTimes();
+
+    for (const auto& id: removedTanks)
+    {
+        removeTankConfig(id);
+        _configChecksums.remove(id);
+    }
+
+    for (auto& [id, tankConfig]: newConfigs)
+    {
+        setTankConfig(std::move(tankConfig));
+    }
+
+    emit tanksAdded(addedTanks + changedTanks);
+
+    emit sendLogMsg(TDBLoger::MSG_CODE::INFORMATION_CODE, QString("Tank configuration refreshed. Added: %1. Removed: %2. Changed: %3. Total tanks: %4")
+                        .arg(addedTanks.size())
+                        .arg(removedTanks.size())
+                        .arg(changedTanks.size())
+                        .arg(_tanksId.size()));
 }
 
-bool TanksConfig::checkID(const TankID &id) const
+TankHandle TanksConfig::internTankId(const TankID& id)
 {
-    return _tanksConfig.contains(id);
+    const auto tanksHandle_it = _tanksHandle.constFind(id);
+    if (tanksHandle_it != _tanksHandle.end())
+    {
+        return tanksHandle_it.value();
+    }
+
+    const auto handle = static_cast<TankHandle>(_tanksConfig.size());
+    _tanksConfig.emplace_back(nullptr);
+    _tanksHandle.insert(id, handle);
+
+    return handle;
 }
 
-TankConfig* TanksConfig::getTankConfig(const TankID &id)
+void TanksConfig::setTankConfig(std::unique_ptr<TankConfig> tankConfig)
 {
-    auto tanksConfig_it = _tanksConfig.find(id);
+    Q_CHECK_PTR(tankConfig);
 
-    Q_ASSERT(tanksConfig_it != _tanksConfig.end());
+    const auto id = tankConfig->tankId();
+    const auto handle = internTankId(id);
+    auto& slot = _tanksConfig[handle];
+    if (!slot)
+    {
+        _tanksId.push_back(id);
+        _tanksHandleList.push_back(handle);
+    }
 
-    return tanksConfig_it->second.get();
+    slot = std::move(tankConfig);
 }
 
-TankIDList TanksConfig::getTanksID() const
+void TanksConfig::removeTankConfig(const TankID& id)
 {
-    TankIDList result(_tanksConfig.size());
+    const auto handle = tankHandle(id);
+    if (handle == INVALID_TANK_HANDLE || !_tanksConfig[handle])
+    {
+        return;
+    }
 
-    std::transform(_tanksConfig.begin(), _tanksConfig.end(), result.begin(),
-        [](const auto& item)
-        {
-            return item.first;
-        });
+    //дескриптор остается за ИД резервуара - при повторном добавлении резервуар получит тот же дескриптор,
+    //а массивы загрузчиков, созданные до удаления, останутся корректными
+    _tanksConfig[handle].reset();
 
-    return result;
+    const auto index = _tanksHandleList.indexOf(handle);
+    Q_ASSERT(index >= 0 && _tanksId[index] == id);
+
+    _tanksHandleList.removeAt(index);
+    _tanksId.removeAt(index);
 }
 
-bool TanksConfig::isExist(const TankID &id) const
+TankHandle TanksConfig::tankHandle(const TankID& id) const
 {
-    return _tanksConfig.contains(id);
+    return _tanksHandle.value(id, INVALID_TANK_HANDLE);
 }
 
-quint64 TanksConfig::tanksCount() const
+TankHandle TanksConfig::handlesCount() const
 {
-    return _tanksConfig.size();
+    return static_cast<TankHandle>(_tanksConfig.size());
 }
 
-void TanksConfig::lastUpdate(const QString& fieldName, const TankID &id, const QDateTime& lastTime)
+TankConfig* TanksConfig::findTankConfig(const TankID& id) const
 {
-    Q_ASSERT(_db.isOpen());
+    return findTankConfig(tankHandle(id));
+}
 
-    const auto queryText =
-            QString("UPDATE [dbo].[TanksInfo] "
-                    "SET [%1] = CAST('%2' AS DATETIME2) "
-                    "WHERE [AZSCode] = %3 AND [TankNumber] = %4 ")
-            .arg(fieldName)
-            .arg(lastTime.toString(Common::DATETIME_FORMAT))
-            .arg(id.levelGaugeCode())
-            .arg(id.tankNumber());
+TankConfig* TanksConfig::findTankConfig(TankHandle handle) const
+{
+    return handle < _tanksConfig.size() ? _tanksConfig[handle].get() : nullptr;
+}
 
-    try
-    {
-        DBQueryExecute(_db, queryText);
-    }
-    catch (const SQLException& err)
-    {      
-        emit errorOccurred(EXIT_CODE::SQL_EXECUTE_QUERY_ERR, QString("Cannot update %1. AZSCode: %2. Tank: %3. Error: %4")
-                           .arg(fieldName)
-                           .arg(id.levelGaugeCode())
-                           .arg(id.tankNumber())
-                           .arg(err.what()));
+bool TanksConfig::checkID(const TankID &id) const
+{
+    return findTankConfig(id) != nullptr;
+}
 
-        return;
-    }
+TankConfig* TanksConfig::getTankConfig(const TankID &id)
+{
+    const auto tankConfig = findTankConfig(id);
+
+    Q_CHECK_PTR(tankConfig);
+
+    return tankConfig;
+}
+
+TankConfig* TanksConfig::getTankConfig(TankHandle handle)
+{
+    Q_ASSERT(handle < _tanksConfig.size());
+    Q_CHECK_PTR(_tanksConfig[handle]);
+
+    return _tanksConfig[handle].get();
 }
 
-void TanksConfig::lastMeasuments(const TankID &id, const QDateTime &lastTime)
+TankIDList TanksConfig::getTanksID() const
 {
-    lastUpdate("LastMeasumentDateTime", id, lastTime);
+    return _tanksId;
 }
 
-void TanksConfig::lastSave(const TankID &id, const QDateTime &lastTime)
+TankHandleList TanksConfig::getTanksHandle() const
 {
-    lastUpdate("LastSaveDateTime", id, lastTime);
+    return _tanksHandleList;
 }
 
-void TanksConfig::lastIntake(const TankID &id, const QDateTime &lastTime)
+bool TanksConfig::isExist(const TankID &id) const
 {
-    lastUpdate("LastIntakeDateTime", id, lastTime);
+    return findTankConfig(id) != nullptr;
 }
 
-void TanksConfig::lastSend(const TankID &id, const QDateTime &lastTime)
+quint64 TanksConfig::tanksCount() const
 {
-    lastUpdate("LastSendDateTime", id, lastTime);
+    return _tanksId.size();
 }
 
-void TanksConfig::lastSendIntake(const TankID &id, const QDateTime &lastTime)
+void TanksConfig::saveLastTimes()
 {
-    lastUpdate("LastSendIntakeDateTime", id, lastTime);
+    Q_ASSERT(_db.isOpen());
+
+    std::vector<std::pair<TankConfig*, quint8>> changedTanks;
+    for (const auto& tankConfig: _tanksConfig)
+    {
+        if (!tankConfig)
+        {
+            continue;
+        }
+
+        const auto changedLastTimes = tankConfig->takeChangedLastTimes();
+        if (changedLastTimes != 0)
+        {
+            changedTanks.emplace_back(tankConfig.get(), changedLastTimes);
+        }
+    }
+
+    if (changedTanks.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        transactionDB(_db);
+
+        for (const auto& [tankConfig, changedLastTimes]: changedTanks)
+        {
+            QStringList fields;
+            for (quint8 i = 0; i < TankConfig::LAST_TIMES_COUNT; ++i)
+            {
+                if ((changedLastTimes & (1 << i)) == 0)
+                {
+                    continue;
+                }
+
+                fields.push_back(QString("[%1] = CAST('%2' AS DATETIME2)")
+                                     .arg(LAST_TIME_FIELD_NAMES[i])
+                                     .arg(tankConfig->lastTime(static_cast<TankConfig::LastTime>(i)).toString(Common::DATETIME_FORMAT)));
+            }
+
+            const auto& id = tankConfig->tankId();
+            const auto queryText =
+                QString("UPDATE [dbo].[TanksInfo] "
+                        "SET %1 "
+                        "WHERE [AZSCode] = '%2' AND [TankNumber] = %3 ")
+                    .arg(fields.join(", "))
+                    .arg(id.levelGaugeCode())
+                    .arg(id.tankNumber());
+
+            DBQueryExecute(_db, queryText);
+        }
+
+        commitDB(_db);
+    }
+    catch (const SQLException& err)
+    {
+        _db.rollback();
+
+        for (const auto& [tankConfig, changedLastTimes]: changedTanks)
+        {
+            tankConfig->markChangedLastTimes(changedLastTimes);
+        }
+
+        emit sendLogMsg(TDBLoger::MSG_CODE::WARNING_CODE, QString("Cannot save last processing times to DB [TanksInfo]. Will be retried. Error: %1").arg(err.what()));
+    }
 }
@@ -3,12 +3,17 @@
 //STL
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 //QT
 #include <QObject>
 #include <QDateTime>
 #include <QPair>
+#include <QHash>
+#include <QStringList>
+#include <QTimer>
 #include <QSqlDatabase>
+#include <QSqlQuery>
 
 //My
 #include "Common/common.h"
@@ -25,17 +30,60 @@ class TanksConfig
     Q_OBJECT
 
 public:
-    explicit TanksConfig(const Common::DBConnectionInfo& dbConnectionInfo, QObject* parent = nullptr);
+    /*!
+        Конструктор
+        @param dbConnectionInfo - информация о подключении к БД
+        @param refreshInterval - интервал проверки изменений конфигурации в БД, мсек. 0 - конфигурация загружается только при запуске
+        @param parent - указатель на родительский класс
+    */
+    TanksConfig(const Common::DBConnectionInfo& dbConnectionInfo, qint64 refreshInterval, QObject* parent = nullptr);
     ~TanksConfig();
 
     bool loadFromDB();
 
     bool checkID(const LevelGaugeService::TankID& id) const;
 
+    /*!
+        Возвращает дескриптор резервуара. Дескриптор назначается при первой загрузке резервуара и сохраняется за ним
+            после удаления резервуара из конфигурации, поэтому может использоваться как индекс массивов загрузчиков
+        @param id - ИД резервуара
+        @return дескриптор или INVALID_TANK_HANDLE если резервуар никогда не загружался
+    */
+    LevelGaugeService::TankHandle tankHandle(const LevelGaugeService::TankID& id) const;
+
+    /*!
+        Возвращает количество назначенных дескрипторов. Все дескрипторы меньше этого значения
+    */
+    LevelGaugeService::TankHandle handlesCount() const;
+
+    /*!
+        Возвращает конфигурацию резервуара одним поиском в хеш-таблице
+        @param id - ИД резервуара
+        @return конфигурация или nullptr если резервуара нет в текущей конфигурации
+    */
+    TankConfig* findTankConfig(const LevelGaugeService::TankID& id) const;
+
+    /*!
+        Возвращает конфигурацию резервуара по индексу массива, без поиска
+        @param handle - дескриптор резервуара
+        @return конфигурация или nullptr если резервуара нет в текущей конфигурации
+    */
+    TankConfig* findTankConfig(LevelGaugeService::TankHandle handle) const;
+
     TankConfig* getTankConfig(const LevelGaugeService::TankID& id);
+    TankConfig* getTankConfig(LevelGaugeService::TankHandle handle);
 
+    /*!
+        Возвращает ИД текущих резервуаров. Список разделяет данные с TanksConfig (implicit sharing), поэтому
+            не копируется при вызове, а при обновлении конфигурации (refresh()) у вызывающего остается прежний список
+    */
     TankIDList getTanksID() const;
 
+    /*!
+        Возвращает дескрипторы текущих резервуаров. Как и getTanksID(), возвращает неизменяемый снимок без копирования
+    */
+    TankHandleList getTanksHandle() const;
+
     bool isExist(const LevelGaugeService::TankID& id) const;
 
     quint64 tanksCount() const;
@@ -44,24 +92,68 @@ signals:
     void errorOccurred(Common::EXIT_CODE errorCode, const QString& errorString);
     void sendLogMsg(Common::TDBLoger::MSG_CODE category, const QString &msg);
 
+    /*!
+        Сигнал испускается перед удалением конфигураций резервуаров, удаленных из [TanksInfo] или отключенных, и резервуаров,
+            настройки которых изменились. Во время обработки сигнала конфигурации еще доступны, после - удаляются,
+            поэтому слоты должны подключаться напрямую (Qt::DirectConnection) и освобождать все ссылки на эти конфигурации
+        @param tanksId - ИД резервуаров
+    */
+    void tanksRemoving(const LevelGaugeService::TankIDList& tanksId);
+
+    /*!
+        Сигнал испускается после добавления конфигураций новых резервуаров и новых конфигураций резервуаров, настройки которых изменились
+        @param tanksId - ИД резервуаров
+    */
+    void tanksAdded(const LevelGaugeService::TankIDList& tanksId);
+
 private slots:
-    void lastMeasuments(const TankID& id, const QDateTime& lastTime);
-    void lastSave(const TankID& id, const QDateTime& lastTime);
-    void lastIntake(const TankID& id, const QDateTime& lastTime);
-    void lastSend(const TankID& id, const QDateTime& lastTime);
-    void lastSendIntake(const TankID& id, const QDateTime& lastTime);
+    /*!
+        Сравнивает конфигурацию в БД с загруженной и применяет изменения
+    */
+    void refresh();
+
+    /*!
+        Сохраняет в [TanksInfo] одной транзакцией времена последней обработки данных, измененные с предыдущего сохранения.
+            В случае ошибки времена остаются помеченными как измененные и сохраняются при следующем вызове
+    */
+    void saveLastTimes();
 
 private:
     TanksConfig() = delete;
     Q_DISABLE_COPY_MOVE(TanksConfig)
 
-    void lastUpdate(const QString& fieldName, const TankID &id, const QDateTime &lastTime);
+    /*!
+        Создает конфигурацию резервуара из текущей записи запроса. В случае ошибки генерирует исключение TankConfigLoadException
+        @param query - запрос, спозиционированный на запись [TanksInfo]
+        @return конфигурация резервуара
+    */
+    std::unique_ptr<TankConfig> parseTankConfig(const QSqlQuery& query) const;
+
+    /*!
+        Возвращает имеющиеся в [TanksInfo] необязательные колонки с настройками обработки данных резервуара.
+            В случае ошибки генерирует исключение SQLException
+    */
+    QStringList loadTimingFieldNames();
+
+    TankHandle internTankId(const TankID& id);
+    void setTankConfig(std::unique_ptr<TankConfig> tankConfig);
+    void removeTankConfig(const TankID& id);
 
 private:
     const Common::DBConnectionInfo _dbConnectionInfo;
     QSqlDatabase _db;
 
-    std::unordered_map<TankID, std::unique_ptr<TankConfig>> _tanksConfig;
+    const qint64 _refreshInterval = 0;  ///< Интервал проверки изменений конфигурации в БД, мсек
+    QString _configQuery;               ///< Запрос загрузки конфигурации с учетом имеющихся в [TanksInfo] колонок
+
+    std::vector<std::unique_ptr<TankConfig>> _tanksConfig; ///< Конфигурации резервуаров. Индекс - дескриптор резервуара. nullptr - резервуар удален
+    QHash<TankID, TankHandle> _tanksHandle;                 ///< Дескрипторы всех загружавшихся резервуаров
+    TankIDList _tanksId;                     ///< ИД текущих резервуаров
+    TankHandleList _tanksHandleList;         ///< Дескрипторы текущих резервуаров в порядке _tanksId
+    QHash<TankID, qint64> _configChecksums;  ///< Контрольные суммы настроек резервуаров в [TanksInfo]
+
+    QTimer _refreshTimer;
+    QTimer _saveLastTimesTimer;
 
 };
 
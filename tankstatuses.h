@@ -7,8 +7,11 @@
 
 //QT
 #include <QDateTime>
+#include <QHash>
+#include <QMap>
 
 //My
+#include "tankid.h"
 #include "tankstatus.h"
 
 namespace LevelGaugeService
@@ -67,7 +70,11 @@ auto operator<(LevelGaugeService::TankStatusesList::TankStatusListIterator itera
 }
 */
 
+///< ИД записей [TanksCalculate], добавленных в БД. Ключ - резервуар, значение - ИД записей по времени статуса в БД
+using SavedStatusesIDs = QHash<LevelGaugeService::TankID, QMap<QDateTime, quint64>>;
+
 } //namespace LevelGaugeService
 
 Q_DECLARE_METATYPE(LevelGaugeService::TankStatusesList);
+Q_DECLARE_METATYPE(LevelGaugeService::SavedStatusesIDs);
 
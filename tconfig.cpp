@@ -12,6 +12,70 @@ using namespace Common;
 //static
 static TConfig* configPtr = nullptr;
 
+//Загружает параметры обработки данных резервуаров из текущей группы. Возвращает текст ошибки или пустую строку
+static QString loadTankTiming(QSettings& ini, TankConfig::Timing& timing)
+{
+    const auto groupName = ini.group();
+    bool ok = false;
+
+    timing.minStepCountStartIntake = ini.value("MinStepCountStartIntake", timing.minStepCountStartIntake).toInt(&ok);
+    if (!ok || timing.minStepCountStartIntake < 1 || timing.minStepCountStartIntake > 60)
+    {
+        return QString("Key value [%1]/MinStepCountStartIntake must be a number between 1 and 60").arg(groupName);
+    }
+
+    timing.minStepCountFinishIntake = ini.value("MinStepCountFinishIntake", timing.minStepCountFinishIntake).toInt(&ok);
+    if (!ok || timing.minStepCountFinishIntake < 1 || timing.minStepCountFinishIntake > 60)
+    {
+        return QString("Key value [%1]/MinStepCountFinishIntake must be a number between 1 and 60").arg(groupName);
+    }
+
+    timing.minStepCountStartPumpingOut = ini.value("MinStepCountStartPumpingOut", timing.minStepCountStartPumpingOut).toInt(&ok);
+    if (!ok || timing.minStepCountStartPumpingOut < 1 || timing.minStepCountStartPumpingOut > 60)
+    {
+        return QString("Key value [%1]/MinStepCountStartPumpingOut must be a number between 1 and 60").arg(groupName);
+    }
+
+    timing.minStepCountFinishPumpingOut = ini.value("MinStepCountFinishPumpingOut", timing.minStepCountFinishPumpingOut).toInt(&ok);
+    if (!ok || timing.minStepCountFinishPumpingOut < 1 || timing.minStepCountFinishPumpingOut > 60)
+    {
+        return QString("Key value [%1]/MinStepCountFinishPumpingOut must be a number between 1 and 60").arg(groupName);
+    }
+
+    timing.skipTime = ini.value("SkipTime", timing.skipTime).toLongLong(&ok);
+    if (!ok || timing.skipTime < 0 || timing.skipTime > 3600)
+    {
+        return QString("Key value [%1]/SkipTime must be a number between 0 and 3600").arg(groupName);
+    }
+
+    timing.connectionTimeout = ini.value("ConnectionTimeout", timing.connectionTimeout).toLongLong(&ok);
+    if (!ok || timing.connectionTimeout < 60 || timing.connectionTimeout > 86400)
+    {
+        return QString("Key value [%1]/ConnectionTimeout must be a number between 60 and 86400").arg(groupName);
+    }
+
+    timing.saveInterval = ini.value("SaveInterval", timing.saveInterval).toLongLong(&ok);
+    if (!ok || timing.saveInterval < 1000 || timing.saveInterval > 3600000)
+    {
+        return QString("Key value [%1]/SaveInterval must be a number between 1000 and 3600000").arg(groupName);
+    }
+
+    Q_ASSERT(timing.check());
+
+    return QString();
+}
+
+static void saveTankTiming(QSettings& ini, const TankConfig::Timing& timing)
+{
+    ini.setValue("MinStepCountStartIntake", timing.minStepCountStartIntake);
+    ini.setValue("MinStepCountFinishIntake", timing.minStepCountFinishIntake);
+    ini.setValue("MinStepCountStartPumpingOut", timing.minStepCountStartPumpingOut);
+    ini.setValue("MinStepCountFinishPumpingOut", timing.minStepCountFinishPumpingOut);
+    ini.setValue("SkipTime", timing.skipTime);
+    ini.setValue("ConnectionTimeout", timing.connectionTimeout);
+    ini.setValue("SaveInterval", timing.saveInterval);
+}
+
 TConfig* TConfig::config(const QString& configFileName)
 {
     if (configPtr == nullptr)
@@ -85,6 +149,319 @@ TConfig::TConfig(const QString& configFileName) :
 
     _sys_DebugMode = ini.value("DebugMode", "0").toBool();
 
+    bool ok = false;
+    _sys_TanksConfigRefreshInterval = ini.value("TanksConfigRefreshInterval", _sys_TanksConfigRefreshInterval).toLongLong(&ok);
+    if (!ok || _sys_TanksConfigRefreshInterval < 0)
+    {
+        _errorString = "Key value [SYSTEM]/TanksConfigRefreshInterval must be a non-negative number";
+
+        return;
+    }
+
+    _sys_CheckMeasumentsInterval = ini.value("CheckMeasumentsInterval", _sys_CheckMeasumentsInterval).toLongLong(&ok);
+    if (!ok || _sys_CheckMeasumentsInterval < 1000 || _sys_CheckMeasumentsInterval > 600000)
+    {
+        _errorString = "Key value [SYSTEM]/CheckMeasumentsInterval must be a number between 1000 and 600000";
+
+        return;
+    }
+
+    ini.endGroup();
+
+    //Log
+    ini.beginGroup("LOG");
+
+    _log_FlushInterval = ini.value("FlushInterval", _log_FlushInterval).toLongLong(&ok);
+    if (!ok || _log_FlushInterval < 100 || _log_FlushInterval > 60000)
+    {
+        _errorString = "Key value [LOG]/FlushInterval must be a number between 100 and 60000";
+
+        return;
+    }
+
+    _log_MaxMessagesPerFlush = ini.value("MaxMessagesPerFlush", _log_MaxMessagesPerFlush).toUInt(&ok);
+    if (!ok || _log_MaxMessagesPerFlush < 10 || _log_MaxMessagesPerFlush > 100000)
+    {
+        _errorString = "Key value [LOG]/MaxMessagesPerFlush must be a number between 10 and 100000";
+
+        return;
+    }
+
+    _log_TankHistorySize = ini.value("TankHistorySize", _log_TankHistorySize).toUInt(&ok);
+    if (!ok || _log_TankHistorySize > 10000)
+    {
+        _errorString = "Key value [LOG]/TankHistorySize must be a number between 0 and 10000";
+
+        return;
+    }
+
+    ini.endGroup();
+
+    //Sync DB
+    ini.beginGroup("SYNC_DB");
+
+    _syncDB_SpoolFileName = ini.value("SpoolFileName", QString("%1/LevelGaugeService.spool").arg(QFileInfo(_configFileName).absolutePath())).toString();
+    if (_syncDB_SpoolFileName.isEmpty())
+    {
+        _errorString = "Key value [SYNC_DB]/SpoolFileName cannot be empty";
+
+        return;
+    }
+
+    _syncDB_FlushMaxRows = ini.value("FlushMaxRows", _syncDB_FlushMaxRows).toLongLong(&ok);
+    if (!ok || _syncDB_FlushMaxRows <= 0)
+    {
+        _errorString = "Key value [SYNC_DB]/FlushMaxRows must be a positive number";
+
+        return;
+    }
+
+    _syncDB_FlushMaxBytes = ini.value("FlushMaxBytes", _syncDB_FlushMaxBytes).toLongLong(&ok);
+    if (!ok || _syncDB_FlushMaxBytes <= 0)
+    {
+        _errorString = "Key value [SYNC_DB]/FlushMaxBytes must be a positive number";
+
+        return;
+    }
+
+    _syncDB_FlushMaxAge = ini.value("FlushMaxAge", _syncDB_FlushMaxAge).toLongLong(&ok);
+    if (!ok || _syncDB_FlushMaxAge <= 0)
+    {
+        _errorString = "Key value [SYNC_DB]/FlushMaxAge must be a positive number";
+
+        return;
+    }
+
+    _syncDB_ShardCount = ini.value("ShardCount", _syncDB_ShardCount).toUInt(&ok);
+    if (!ok || _syncDB_ShardCount == 0 || _syncDB_ShardCount > 64)
+    {
+        _errorString = "Key value [SYNC_DB]/ShardCount must be a number between 1 and 64";
+
+        return;
+    }
+
+    _syncDB_WriteMode = stringToDBWriteMode(ini.value("WriteMode", dbWriteModeToString(_syncDB_WriteMode)).toString());
+    if (_syncDB_WriteMode == DBWriteMode::UNDEFINE)
+    {
+        _errorString = "Key value [SYNC_DB]/WriteMode must be INSERT or MERGE";
+
+        return;
+    }
+
+    ini.endGroup();
+
+    //Sync HTTP
+    ini.beginGroup("SYNC_HTTP");
+
+    _syncHTTP_CheckPackageWindow = ini.value("CheckPackageWindow", _syncHTTP_CheckPackageWindow).toUInt(&ok);
+    if (!ok || _syncHTTP_CheckPackageWindow == 0 || _syncHTTP_CheckPackageWindow > 100)
+    {
+        _errorString = "Key value [SYNC_HTTP]/CheckPackageWindow must be a number between 1 and 100";
+
+        return;
+    }
+
+    _syncHTTP_SendPackageWindow = ini.value("SendPackageWindow", _syncHTTP_SendPackageWindow).toUInt(&ok);
+    if (!ok || _syncHTTP_SendPackageWindow == 0 || _syncHTTP_SendPackageWindow > 100)
+    {
+        _errorString = "Key value [SYNC_HTTP]/SendPackageWindow must be a number between 1 and 100";
+
+        return;
+    }
+
+    _syncHTTP_StreamMode = ini.value("StreamMode", _syncHTTP_StreamMode).toBool();
+
+    _syncHTTP_RealtimeWindow = ini.value("RealtimeWindow", _syncHTTP_RealtimeWindow).toLongLong(&ok);
+    if (!ok || _syncHTTP_RealtimeWindow < 0)
+    {
+        _errorString = "Key value [SYNC_HTTP]/RealtimeWindow must be a non-negative number";
+
+        return;
+    }
+
+    _syncHTTP_BacklogShare = ini.value("BacklogShare", _syncHTTP_BacklogShare).toUInt(&ok);
+    if (!ok || _syncHTTP_BacklogShare == 0 || _syncHTTP_BacklogShare > 99)
+    {
+        _errorString = "Key value [SYNC_HTTP]/BacklogShare must be a number between 1 and 99";
+
+        return;
+    }
+
+    _syncHTTP_CompressionLevels.defaultLevel = ini.value("CompressionLevel", _syncHTTP_CompressionLevels.defaultLevel).toInt(&ok);
+    if (!ok || _syncHTTP_CompressionLevels.defaultLevel < 0 || _syncHTTP_CompressionLevels.defaultLevel > 9)
+    {
+        _errorString = "Key value [SYNC_HTTP]/CompressionLevel must be a number between 0 and 9";
+
+        return;
+    }
+
+    //формат: ApplicantID:Level, ApplicantID:Level, ...
+    for (const auto& applicantLevel: ini.value("ApplicantCompressionLevels").toStringList())
+    {
+        if (applicantLevel.trimmed().isEmpty())
+        {
+            continue;
+        }
+
+        const auto values = applicantLevel.split(':');
+        bool okId = false;
+        bool okLevel = false;
+        const auto applicantId = values.size() == 2 ? values.at(0).trimmed().toLongLong(&okId) : 0;
+        const auto level = values.size() == 2 ? values.at(1).trimmed().toInt(&okLevel) : 0;
+        if (!okId || !okLevel || level < 0 || level > 9)
+        {
+            _errorString = QString("Key value [SYNC_HTTP]/ApplicantCompressionLevels must be a list of ApplicantID:Level pairs with level between 0 and 9. Value: %1").arg(applicantLevel);
+
+            return;
+        }
+
+        _syncHTTP_CompressionLevels.applicantLevels.insert(applicantId, level);
+    }
+
+    _syncHTTP_PackageMinSize = ini.value("PackageMinSize", _syncHTTP_PackageMinSize).toUInt(&ok);
+    if (!ok || _syncHTTP_PackageMinSize == 0)
+    {
+        _errorString = "Key value [SYNC_HTTP]/PackageMinSize must be a positive number";
+
+        return;
+    }
+
+    _syncHTTP_PackageMaxSize = ini.value("PackageMaxSize", _syncHTTP_PackageMaxSize).toUInt(&ok);
+    if (!ok || _syncHTTP_PackageMaxSize < _syncHTTP_PackageMinSize)
+    {
+        _errorString = "Key value [SYNC_HTTP]/PackageMaxSize must be a number not less than [SYNC_HTTP]/PackageMinSize";
+
+        return;
+    }
+
+    _syncHTTP_PackageSizeStep = ini.value("PackageSizeStep", _syncHTTP_PackageSizeStep).toUInt(&ok);
+    if (!ok || _syncHTTP_PackageSizeStep == 0)
+    {
+        _errorString = "Key value [SYNC_HTTP]/PackageSizeStep must be a positive number";
+
+        return;
+    }
+
+    _syncHTTP_SendMinInterval = ini.value("SendMinInterval", _syncHTTP_SendMinInterval).toLongLong(&ok);
+    if (!ok || _syncHTTP_SendMinInterval < 1000)
+    {
+        _errorString = "Key value [SYNC_HTTP]/SendMinInterval must be a number not less than 1000";
+
+        return;
+    }
+
+    _syncHTTP_SendMaxInterval = ini.value("SendMaxInterval", _syncHTTP_SendMaxInterval).toLongLong(&ok);
+    if (!ok || _syncHTTP_SendMaxInterval < _syncHTTP_SendMinInterval)
+    {
+        _errorString = "Key value [SYNC_HTTP]/SendMaxInterval must be a number not less than [SYNC_HTTP]/SendMinInterval";
+
+        return;
+    }
+
+    _syncHTTP_SendIntervalStep = ini.value("SendIntervalStep", _syncHTTP_SendIntervalStep).toLongLong(&ok);
+    if (!ok || _syncHTTP_SendIntervalStep <= 0)
+    {
+        _errorString = "Key value [SYNC_HTTP]/SendIntervalStep must be a positive number";
+
+        return;
+    }
+
+    _syncHTTP_FastAnswerTime = ini.value("FastAnswerTime", _syncHTTP_FastAnswerTime).toLongLong(&ok);
+    if (!ok || _syncHTTP_FastAnswerTime <= 0)
+    {
+        _errorString = "Key value [SYNC_HTTP]/FastAnswerTime must be a positive number";
+
+        return;
+    }
+
+    _syncHTTP_FlowmeterEnabled = ini.value("FlowmeterEnabled", _syncHTTP_FlowmeterEnabled).toBool();
+
+    //формат: ApplicantID:BIN, ApplicantID:BIN, ...
+    for (const auto& applicantBIN: ini.value("ApplicantBINs").toStringList())
+    {
+        if (applicantBIN.trimmed().isEmpty())
+        {
+            continue;
+        }
+
+        const auto values = applicantBIN.split(':');
+        bool okId = false;
+        const auto applicantId = values.size() == 2 ? values.at(0).trimmed().toLongLong(&okId) : 0;
+        const auto BIN = values.size() == 2 ? values.at(1).trimmed() : QString();
+        if (!okId || BIN.isEmpty())
+        {
+            _errorString = QString("Key value [SYNC_HTTP]/ApplicantBINs must be a list of ApplicantID:BIN pairs. Value: %1").arg(applicantBIN);
+
+            return;
+        }
+
+        _syncHTTP_ApplicantBINs.insert(applicantId, BIN);
+    }
+
+    _syncHTTP_TopologyRefreshInterval = ini.value("TopologyRefreshInterval", _syncHTTP_TopologyRefreshInterval).toLongLong(&ok);
+    if (!ok || _syncHTTP_TopologyRefreshInterval < 60000)
+    {
+        _errorString = "Key value [SYNC_HTTP]/TopologyRefreshInterval must be a number not less than 60000";
+
+        return;
+    }
+
+    _syncHTTP_RequestTimeout = ini.value("RequestTimeout", _syncHTTP_RequestTimeout).toLongLong(&ok);
+    if (!ok || _syncHTTP_RequestTimeout < 1000)
+    {
+        _errorString = "Key value [SYNC_HTTP]/RequestTimeout must be a number not less than 1000";
+
+        return;
+    }
+
+    //формат: Path:Timeout, Path:Timeout, ... Например: /Provider/GetPackageStatus:30000
+    for (const auto& pathTimeout: ini.value("PathRequestTimeouts").toStringList())
+    {
+        if (pathTimeout.trimmed().isEmpty())
+        {
+            continue;
+        }
+
+        const auto values = pathTimeout.split(':');
+        bool okTimeout = false;
+        const auto path = values.size() == 2 ? values.at(0).trimmed() : QString();
+        const auto timeout = values.size() == 2 ? values.at(1).trimmed().toLongLong(&okTimeout) : 0;
+        if (!path.startsWith('/') || !okTimeout || timeout < 1000)
+        {
+            _errorString = QString("Key value [SYNC_HTTP]/PathRequestTimeouts must be a list of Path:Timeout pairs with timeout not less than 1000. Value: %1").arg(pathTimeout);
+
+            return;
+        }
+
+        _syncHTTP_PathRequestTimeouts.insert(path, timeout);
+    }
+
+    _syncHTTP_SendIntakeInterval = ini.value("SendIntakeInterval", _syncHTTP_SendIntakeInterval).toLongLong(&ok);
+    if (!ok || _syncHTTP_SendIntakeInterval < 1000 || _syncHTTP_SendIntakeInterval > 3600000)
+    {
+        _errorString = "Key value [SYNC_HTTP]/SendIntakeInterval must be a number between 1000 and 3600000";
+
+        return;
+    }
+
+    ini.endGroup();
+
+    //Tanks. Значения по умолчанию для резервуаров. Могут быть переопределены для отдельного резервуара в [TanksInfo]
+    ini.beginGroup("TANK_AZS");
+
+    _errorString = loadTankTiming(ini, _tank_AZSTiming);
+
+    ini.endGroup();
+
+    if (isError())
+    {
+        return;
+    }
+
+    ini.beginGroup("TANK_OIL_DEPOT");
+
+    _errorString = loadTankTiming(ini, _tank_OilDepotTiming);
+
     ini.endGroup();
 }
 
@@ -129,6 +506,96 @@ bool TConfig::save()
     ini.remove("");
 
     ini.setValue("DebugMode", _sys_DebugMode);
+    ini.setValue("TanksConfigRefreshInterval", _sys_TanksConfigRefreshInterval);
+    ini.setValue("CheckMeasumentsInterval", _sys_CheckMeasumentsInterval);
+
+    ini.endGroup();
+
+    //Log
+    ini.beginGroup("LOG");
+
+    ini.remove("");
+
+    ini.setValue("FlushInterval", _log_FlushInterval);
+    ini.setValue("MaxMessagesPerFlush", _log_MaxMessagesPerFlush);
+    ini.setValue("TankHistorySize", _log_TankHistorySize);
+
+    ini.endGroup();
+
+    //Sync DB
+    ini.beginGroup("SYNC_DB");
+
+    ini.remove("");
+
+    ini.setValue("SpoolFileName", _syncDB_SpoolFileName);
+    ini.setValue("FlushMaxRows", _syncDB_FlushMaxRows);
+    ini.setValue("FlushMaxBytes", _syncDB_FlushMaxBytes);
+    ini.setValue("FlushMaxAge", _syncDB_FlushMaxAge);
+    ini.setValue("ShardCount", _syncDB_ShardCount);
+    ini.setValue("WriteMode", dbWriteModeToString(_syncDB_WriteMode));
+
+    ini.endGroup();
+
+    //Sync HTTP
+    ini.beginGroup("SYNC_HTTP");
+
+    ini.remove("");
+
+    ini.setValue("CheckPackageWindow", _syncHTTP_CheckPackageWindow);
+    ini.setValue("SendPackageWindow", _syncHTTP_SendPackageWindow);
+    ini.setValue("StreamMode", _syncHTTP_StreamMode);
+    ini.setValue("RealtimeWindow", _syncHTTP_RealtimeWindow);
+    ini.setValue("BacklogShare", _syncHTTP_BacklogShare);
+    ini.setValue("CompressionLevel", _syncHTTP_CompressionLevels.defaultLevel);
+
+    QStringList applicantCompressionLevels;
+    for (auto applicantLevels_it = _syncHTTP_CompressionLevels.applicantLevels.begin(); applicantLevels_it != _syncHTTP_CompressionLevels.applicantLevels.end(); ++applicantLevels_it)
+    {
+        applicantCompressionLevels.push_back(QString("%1:%2").arg(applicantLevels_it.key()).arg(applicantLevels_it.value()));
+    }
+    ini.setValue("ApplicantCompressionLevels", applicantCompressionLevels);
+    ini.setValue("PackageMinSize", _syncHTTP_PackageMinSize);
+    ini.setValue("PackageMaxSize", _syncHTTP_PackageMaxSize);
+    ini.setValue("PackageSizeStep", _syncHTTP_PackageSizeStep);
+    ini.setValue("SendMinInterval", _syncHTTP_SendMinInterval);
+    ini.setValue("SendMaxInterval", _syncHTTP_SendMaxInterval);
+    ini.setValue("SendIntervalStep", _syncHTTP_SendIntervalStep);
+    ini.setValue("FastAnswerTime", _syncHTTP_FastAnswerTime);
+    ini.setValue("FlowmeterEnabled", _syncHTTP_FlowmeterEnabled);
+
+    QStringList applicantBINs;
+    for (auto applicantBINs_it = _syncHTTP_ApplicantBINs.begin(); applicantBINs_it != _syncHTTP_ApplicantBINs.end(); ++applicantBINs_it)
+    {
+        applicantBINs.push_back(QString("%1:%2").arg(applicantBINs_it.key()).arg(applicantBINs_it.value()));
+    }
+    ini.setValue("ApplicantBINs", applicantBINs);
+    ini.setValue("TopologyRefreshInterval", _syncHTTP_TopologyRefreshInterval);
+    ini.setValue("RequestTimeout", _syncHTTP_RequestTimeout);
+
+    QStringList pathRequestTimeouts;
+    for (auto pathRequestTimeouts_it = _syncHTTP_PathRequestTimeouts.begin(); pathRequestTimeouts_it != _syncHTTP_PathRequestTimeouts.end(); ++pathRequestTimeouts_it)
+    {
+        pathRequestTimeouts.push_back(QString("%1:%2").arg(pathRequestTimeouts_it.key()).arg(pathRequestTimeouts_it.value()));
+    }
+    ini.setValue("PathRequestTimeouts", pathRequestTimeouts);
+    ini.setValue("SendIntakeInterval", _syncHTTP_SendIntakeInterval);
+
+    ini.endGroup();
+
+    //Tanks
+    ini.beginGroup("TANK_AZS");
+
+    ini.remove("");
+
+    saveTankTiming(ini, _tank_AZSTiming);
+
+    ini.endGroup();
+
+    ini.beginGroup("TANK_OIL_DEPOT");
+
+    ini.remove("");
+
+    saveTankTiming(ini, _tank_OilDepotTiming);
 
     ini.endGroup();
 
@@ -2,9 +2,15 @@
 
 //QT
 #include <QString>
+#include <QHash>
 
 #include "Common/common.h"
 
+//My
+#include "dbwritemode.h"
+#include "compression.h"
+#include "tankconfig.h"
+
 namespace LevelGaugeService
 {
 
@@ -29,6 +35,45 @@ public:
 
     //[SYSTEM]
     bool sys_DebugMode() const { return _sys_DebugMode; }
+    qint64 sys_TanksConfigRefreshInterval() const { return _sys_TanksConfigRefreshInterval; }
+    qint64 sys_CheckMeasumentsInterval() const { return _sys_CheckMeasumentsInterval; }
+
+    //[LOG]
+    qint64 log_FlushInterval() const { return _log_FlushInterval; }
+    quint32 log_MaxMessagesPerFlush() const { return _log_MaxMessagesPerFlush; }
+    quint32 log_TankHistorySize() const { return _log_TankHistorySize; }
+
+    //[SYNC_DB]
+    const QString& syncDB_SpoolFileName() const { return _syncDB_SpoolFileName; }
+    qsizetype syncDB_FlushMaxRows() const { return _syncDB_FlushMaxRows; }
+    qsizetype syncDB_FlushMaxBytes() const { return _syncDB_FlushMaxBytes; }
+    qint64 syncDB_FlushMaxAge() const { return _syncDB_FlushMaxAge; }
+    quint32 syncDB_ShardCount() const { return _syncDB_ShardCount; }
+    DBWriteMode syncDB_WriteMode() const { return _syncDB_WriteMode; }
+
+    //[SYNC_HTTP]
+    quint32 syncHTTP_CheckPackageWindow() const { return _syncHTTP_CheckPackageWindow; }
+    quint32 syncHTTP_SendPackageWindow() const { return _syncHTTP_SendPackageWindow; }
+    bool syncHTTP_StreamMode() const { return _syncHTTP_StreamMode; }
+    qint64 syncHTTP_RealtimeWindow() const { return _syncHTTP_RealtimeWindow; }
+    quint32 syncHTTP_BacklogShare() const { return _syncHTTP_BacklogShare; }
+    const CompressionLevels& syncHTTP_CompressionLevels() const { return _syncHTTP_CompressionLevels; }
+    quint32 syncHTTP_PackageMinSize() const { return _syncHTTP_PackageMinSize; }
+    quint32 syncHTTP_PackageMaxSize() const { return _syncHTTP_PackageMaxSize; }
+    quint32 syncHTTP_PackageSizeStep() const { return _syncHTTP_PackageSizeStep; }
+    qint64 syncHTTP_SendMinInterval() const { return _syncHTTP_SendMinInterval; }
+    qint64 syncHTTP_SendMaxInterval() const { return _syncHTTP_SendMaxInterval; }
+    qint64 syncHTTP_SendIntervalStep() const { return _syncHTTP_SendIntervalStep; }
+    qint64 syncHTTP_FastAnswerTime() const { return _syncHTTP_FastAnswerTime; }
+    bool syncHTTP_FlowmeterEnabled() const { return _syncHTTP_FlowmeterEnabled; }
+    const QHash<qint64, QString>& syncHTTP_ApplicantBINs() const { return _syncHTTP_ApplicantBINs; }
+    qint64 syncHTTP_TopologyRefreshInterval() const { return _syncHTTP_TopologyRefreshInterval; }
+    qint64 syncHTTP_RequestTimeout() const { return _syncHTTP_RequestTimeout; }
+    const QHash<QString, qint64>& syncHTTP_PathRequestTimeouts() const { return _syncHTTP_PathRequestTimeouts; }
+    qint64 syncHTTP_SendIntakeInterval() const { return _syncHTTP_SendIntakeInterval; }
+
+    //[TANK_AZS], [TANK_OIL_DEPOT]
+    const TankConfig::Timing& tank_Timing(TankConfig::Mode mode) const { return mode == TankConfig::Mode::OIL_DEPOT ? _tank_OilDepotTiming : _tank_AZSTiming; }
 
     //errors
     QString errorString();
@@ -44,6 +89,46 @@ private:
 
     //[SYSTEM]
     bool _sys_DebugMode = false;
+    qint64 _sys_TanksConfigRefreshInterval = 60000; ///< Интервал проверки изменений конфигурации резервуаров, мсек. 0 - не проверять
+    qint64 _sys_CheckMeasumentsInterval = 60000;    ///< Интервал загрузки новых измерений из [TanksMeasument], мсек
+
+    //[LOG]
+    qint64 _log_FlushInterval = 1000;           ///< Интервал передачи накопленных сообщений в лог, мсек
+    quint32 _log_MaxMessagesPerFlush = 1000;    ///< Максимальное количество сообщений, передаваемых в лог за один интервал
+    quint32 _log_TankHistorySize = 100;         ///< Количество последних сообщений резервуара, хранимых в памяти. 0 - не хранить
+
+    //[SYNC_DB]
+    QString _syncDB_SpoolFileName; ///< Файл спула статусов на время недоступности БД
+    qsizetype _syncDB_FlushMaxRows = 5000;              ///< Максимальное количество записей в буфере до сохранения в БД
+    qsizetype _syncDB_FlushMaxBytes = 4 * 1024 * 1024;  ///< Максимальный объем буфера до сохранения в БД, байт
+    qint64 _syncDB_FlushMaxAge = 30000;                 ///< Максимальное время хранения записи в буфере, мсек
+    quint32 _syncDB_ShardCount = 1;                     ///< Количество параллельных писателей статусов в БД
+    DBWriteMode _syncDB_WriteMode = DBWriteMode::INSERT; ///< Режим записи вычисленных данных в БД
+
+    //[SYNC_HTTP]
+    quint32 _syncHTTP_CheckPackageWindow = 4; ///< Максимальное количество одновременных запросов проверки статуса пакета для одной организации
+    quint32 _syncHTTP_SendPackageWindow = 4;  ///< Максимальное количество одновременно отправляемых пакетов статусов для одной организации
+    bool _syncHTTP_StreamMode = false;        ///< Формировать пакеты статусов из вычисленных статусов и ИД добавленных в БД записей без повторного чтения из БД
+    qint64 _syncHTTP_RealtimeWindow = 600000; ///< Статусы моложе этого времени отправляются в первую очередь, мсек. 0 - статусы отправляются в порядке времени
+    quint32 _syncHTTP_BacklogShare = 30;      ///< Минимальная доля пакета статусов для накопленных статусов, %
+    CompressionLevels _syncHTTP_CompressionLevels; ///< Уровни сжатия gzip запросов отправки данных на сервер
+    quint32 _syncHTTP_PackageMinSize = 100;     ///< Минимальный размер пакета статусов, записей
+    quint32 _syncHTTP_PackageMaxSize = 5000;    ///< Максимальный размер пакета статусов, записей
+    quint32 _syncHTTP_PackageSizeStep = 100;    ///< Шаг увеличения размера пакета статусов, записей
+    qint64 _syncHTTP_SendMinInterval = 5000;    ///< Минимальный интервал отправки пакетов статусов, мсек
+    qint64 _syncHTTP_SendMaxInterval = 60000;   ///< Максимальный интервал отправки пакетов статусов, мсек
+    qint64 _syncHTTP_SendIntervalStep = 5000;   ///< Шаг увеличения интервала отправки пакетов статусов, мсек
+    qint64 _syncHTTP_FastAnswerTime = 5000;     ///< Время ответа сервера, при котором размер пакета может быть увеличен, мсек
+    bool _syncHTTP_FlowmeterEnabled = false;    ///< Отправлять показания расходомеров из таблицы [FlowmetersMeasurements]
+    QHash<qint64, QString> _syncHTTP_ApplicantBINs;     ///< БИН организаций для запроса их данных с сервера. Ключ - ИД организации
+    qint64 _syncHTTP_TopologyRefreshInterval = 3600000; ///< Интервал обновления данных организаций с сервера, мсек
+    qint64 _syncHTTP_RequestTimeout = 120000;           ///< Срок выполнения запроса к серверу, мсек
+    QHash<QString, qint64> _syncHTTP_PathRequestTimeouts; ///< Сроки выполнения запросов к отдельным методам API сервера, мсек. Ключ - путь метода
+    qint64 _syncHTTP_SendIntakeInterval = 60000;        ///< Интервал отправки приходов топлива на сервер, мсек
+
+    //[TANK_AZS], [TANK_OIL_DEPOT]
+    TankConfig::Timing _tank_AZSTiming;      ///< Параметры обработки данных резервуаров АЗС по умолчанию
+    TankConfig::Timing _tank_OilDepotTiming; ///< Параметры обработки данных резервуаров нефтебаз по умолчанию
 
 };
 
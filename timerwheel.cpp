@@ -0,0 +1,71 @@
+//STL
+#include <algorithm>
+
+//My
+#include "timerwheel.h"
+
+using namespace LevelGaugeService;
+
+TimerWheel::TimerWheel(qint64 tickInterval, quint32 slotsCount)
+    : _tickInterval(tickInterval)
+    , _slots(slotsCount)
+{
+    Q_ASSERT(_tickInterval > 0);
+    Q_ASSERT(slotsCount > 0);
+}
+
+TimerWheel::~TimerWheel()
+{
+}
+
+void TimerWheel::add(quint64 id, qint64 timeout)
+{
+    remove(id);
+
+    //элемент должен пробыть в колесе не меньше срока, поэтому количество шагов округляем вверх
+    const auto ticks = static_cast<quint64>(std::max<qint64>(1, (timeout + _tickInterval - 1) / _tickInterval));
+    const auto slotsCount = static_cast<quint64>(_slots.size());
+    const auto slot = static_cast<quint32>((_current + ticks) % slotsCount);
+
+    _slots[slot].insert(id, (ticks - 1) / slotsCount);
+    _index.insert(id, slot);
+}
+
+bool TimerWheel::remove(quint64 id)
+{
+    const auto index_it = _index.constFind(id);
+    if (index_it == _index.end())
+    {
+        return false;
+    }
+
+    _slots[index_it.value()].remove(id);
+    _index.erase(index_it);
+
+    return true;
+}
+
+QList<quint64> TimerWheel::advance()
+{
+    _current = (_current + 1) % static_cast<quint32>(_slots.size());
+
+    QList<quint64> result;
+
+    auto& slot = _slots[_current];
+    for (auto slot_it = slot.begin(); slot_it != slot.end(); )
+    {
+        if (slot_it.value() > 0)
+        {
+            --slot_it.value();
+            ++slot_it;
+
+            continue;
+        }
+
+        result.push_back(slot_it.key());
+        _index.remove(slot_it.key());
+        slot_it = slot.erase(slot_it);
+    }
+
+    return result;
+}
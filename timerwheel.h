@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Колесо таймеров для отслеживания сроков выполнения запросов
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//STL
+#include <vector>
+
+//Qt
+#include <QHash>
+#include <QList>
+
+namespace LevelGaugeService
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// Колесо состоит из slotsCount ячеек длительностью tickInterval. Элемент
+///     помещается в ячейку, на которую укажет колесо по истечении его срока,
+///     вместе с количеством полных оборотов до этого момента. Добавление,
+///     удаление и обработка очередного шага не зависят от общего количества
+///     элементов, т.к. на каждом шаге просматривается только одна ячейка.
+///     Срок отсчитывается от текущего шага, поэтому точность срока - один шаг.
+///     Колесо не имеет своего таймера - шаги выполняет владелец вызовом advance()
+///
+class TimerWheel final
+{
+public:
+    /*!
+        Конструктор
+        @param tickInterval - длительность одного шага колеса, мсек
+        @param slotsCount - количество ячеек колеса
+    */
+    TimerWheel(qint64 tickInterval, quint32 slotsCount);
+
+    /*!
+        Деструктор
+    */
+    ~TimerWheel();
+
+    /*!
+        Добавляет элемент. Если элемент уже существует - его срок заменяется
+        @param id - ИД элемента
+        @param timeout - срок от текущего шага, мсек
+    */
+    void add(quint64 id, qint64 timeout);
+
+    /*!
+        Удаляет элемент
+        @param id - ИД элемента
+        @return true если элемент был в колесе
+    */
+    bool remove(quint64 id);
+
+    /*!
+        Выполняет один шаг колеса
+        @return список ИД элементов, срок которых истек. Эти элементы удаляются из колеса
+    */
+    QList<quint64> advance();
+
+    qint64 tickInterval() const { return _tickInterval; }
+    qsizetype size() const { return _index.size(); }
+    bool isEmpty() const { return _index.isEmpty(); }
+
+private:
+    TimerWheel() = delete;
+    Q_DISABLE_COPY_MOVE(TimerWheel)
+
+private:
+    const qint64 _tickInterval = 0;
+
+    std::vector<QHash<quint64, quint64>> _slots; ///< Ячейки колеса. Ключ - ИД элемента, значение - количество оставшихся полных оборотов
+    QHash<quint64, quint32> _index;              ///< Ячейки элементов. Ключ - ИД элемента, значение - номер ячейки
+    quint32 _current = 0;                        ///< Номер текущей ячейки
+
+}; //class TimerWheel
+
+} //namespace LevelGaugeService
@@ -0,0 +1,12 @@
+QT -= gui
+QT += sql
+
+CONFIG += c++20 console
+CONFIG -= app_bundle
+
+SOURCES += \
+    fleetloadgenerator.cpp \
+    main.cpp
+
+HEADERS += \
+    fleetloadgenerator.h
@@ -0,0 +1,315 @@
+//STL
+#include <algorithm>
+
+//Qt
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDateTime>
+#include <QDebug>
+
+//My
+#include "fleetloadgenerator.h"
+
+using namespace FleetLoad;
+
+static const QString CONNECTION_NAME = "FleetLoadGenerator";
+static const QString DATETIME_FORMAT = "yyyy-MM-dd hh:mm:ss.zzz";
+static const qsizetype MAX_ROWS_PER_INSERT = 1000;
+
+static const double START_HEIGHT = 1500.0;      ///< Начальный уровень, мм
+static const double MIN_HEIGHT = 500.0;         ///< Минимальный уровень, мм. Ниже уровень не снижается
+static const double MAX_HEIGHT = 2500.0;        ///< Максимальный уровень, мм. Выше уровень не растет
+static const double SALE_HEIGHT_STEP = 0.5;     ///< Снижение уровня за одно измерение при отпуске, мм
+static const double INTAKE_HEIGHT_STEP = 50.0;  ///< Рост уровня за одно измерение при приходе, мм
+static const double VOLUME_PER_MM = 10.0;       ///< Объем резервуара на 1 мм уровня, л
+static const double DENSITY = 750.0;            ///< Плотность, кг/м3
+static const double TEMP = 15.0;                ///< Температура, С
+
+FleetLoadGenerator::FleetLoadGenerator(const Settings& settings, QObject* parent /* = nullptr */)
+    : QObject{parent}
+    , _settings(settings)
+{
+    Q_ASSERT(!_settings.AZSPrefix.isEmpty());
+    Q_ASSERT(_settings.AZSCount > 0);
+    Q_ASSERT(_settings.tanksPerAZS > 0);
+    Q_ASSERT(_settings.interval > 0);
+    Q_ASSERT(_settings.intakeDuration > 0 && _settings.intakeDuration < _settings.intakePeriod);
+    Q_ASSERT(_settings.statsInterval > 0);
+
+    QObject::connect(&_addTimer, SIGNAL(timeout()), SLOT(addMeasuments()));
+    QObject::connect(&_statsTimer, SIGNAL(timeout()), SLOT(printStats()));
+}
+
+FleetLoadGenerator::~FleetLoadGenerator()
+{
+    _addTimer.stop();
+    _statsTimer.stop();
+
+    if (_db.isOpen())
+    {
+        _db.close();
+    }
+}
+
+bool FleetLoadGenerator::connectToDB()
+{
+    if (_db.isOpen())
+    {
+        return true;
+    }
+
+    _db = QSqlDatabase::addDatabase("QODBC", CONNECTION_NAME);
+    _db.setDatabaseName(_settings.connectionString);
+
+    if (!_db.open())
+    {
+        qCritical().noquote() << QString("Cannot connect to DB. Error: %1").arg(_db.lastError().text());
+
+        return false;
+    }
+
+    return true;
+}
+
+QStringList FleetLoadGenerator::AZSCodes() const
+{
+    QStringList result;
+    for (quint32 AZSNumber = 1; AZSNumber <= _settings.AZSCount; ++AZSNumber)
+    {
+        result.push_back(QString("%1%2").arg(_settings.AZSPrefix).arg(AZSNumber, 4, 10, QChar('0')));
+    }
+
+    return result;
+}
+
+bool FleetLoadGenerator::start()
+{
+    if (!connectToDB() || !createFleet())
+    {
+        return false;
+    }
+
+    //приходы резервуаров равномерно распределены по периоду
+    const auto tanksCount = static_cast<quint32>(_settings.AZSCount * _settings.tanksPerAZS);
+    for (const auto& AZSCode: AZSCodes())
+    {
+        for (quint8 tankNumber = 1; tankNumber <= _settings.tanksPerAZS; ++tankNumber)
+        {
+            TankModel tank;
+            tank.AZSCode = AZSCode;
+            tank.tankNumber = tankNumber;
+            tank.height = START_HEIGHT;
+            tank.phase = static_cast<quint32>(static_cast<quint64>(_fleet.size()) * _settings.intakePeriod / tanksCount);
+
+            _fleet.push_back(std::move(tank));
+        }
+    }
+
+    _statsPeriodTimer.start();
+    _addTimer.start(_settings.interval);
+    _statsTimer.start(_settings.statsInterval);
+
+    qInfo().noquote() << QString("Fleet load generator started. AZS: %1. Tanks per AZS: %2. Interval: %3 ms. Intake period: %4 measuments. Server: %5")
+                         .arg(_settings.AZSCount)
+                         .arg(_settings.tanksPerAZS)
+                         .arg(_settings.interval)
+                         .arg(_settings.intakePeriod)
+                         .arg(_settings.serverUrl);
+
+    return true;
+}
+
+bool FleetLoadGenerator::createFleet()
+{
+    Q_ASSERT(_db.isOpen());
+
+    const auto currentDateTime = QDateTime::currentDateTime().toString(DATETIME_FORMAT);
+
+    QStringList AZSCodesList;
+    for (const auto& AZSCode: AZSCodes())
+    {
+        AZSCodesList.push_back(QString("'%1'").arg(AZSCode));
+    }
+
+    //конфигурация шаблона копируется целиком, поэтому генератор не зависит от набора колонок [TanksInfo].
+    //Колонка [ID] удаляется из копии - значения для нее формирует сервер
+    QStringList queries;
+    queries.push_back(QString("DELETE FROM [dbo].[TanksInfo] WHERE [AZSCode] IN (%1)").arg(AZSCodesList.join(',')));
+    queries.push_back("IF OBJECT_ID('tempdb..#FleetTemplate') IS NOT NULL DROP TABLE #FleetTemplate");
+    queries.push_back(QString("SELECT * INTO #FleetTemplate FROM [dbo].[TanksInfo] WHERE [AZSCode] = '%1' AND [TankNumber] = %2")
+                          .arg(_settings.templateAZSCode)
+                          .arg(_settings.templateTankNumber));
+    queries.push_back("ALTER TABLE #FleetTemplate DROP COLUMN [ID]");
+
+    qint64 remoteTankId = _settings.remoteTankIdBase;
+    for (const auto& AZSCode: AZSCodes())
+    {
+        for (quint8 tankNumber = 1; tankNumber <= _settings.tanksPerAZS; ++tankNumber)
+        {
+            //время последней обработки - текущее, чтобы сервис не загружал архив измерений
+            queries.push_back(QString("UPDATE #FleetTemplate "
+                                      "SET [AZSCode] = '%1', [TankNumber] = %2, [TankName] = 'Load test %1-%2', [RemoteTankID] = %3, [RemoteBaseURL] = '%4', [Enabled] = 1, "
+                                          "[LastMeasumentDateTime] = CAST('%5' AS DATETIME2), [LastSaveDateTime] = CAST('%5' AS DATETIME2), "
+                                          "[LastSendDateTime] = CAST('%5' AS DATETIME2), [LastIntakeDateTime] = CAST('%5' AS DATETIME2), "
+                                          "[LastSendIntakeDateTime] = CAST('%5' AS DATETIME2)")
+                                  .arg(AZSCode)
+                                  .arg(tankNumber)
+                                  .arg(remoteTankId)
+                                  .arg(_settings.serverUrl)
+                                  .arg(currentDateTime));
+            queries.push_back("INSERT INTO [dbo].[TanksInfo] SELECT * FROM #FleetTemplate");
+
+            ++remoteTankId;
+        }
+    }
+
+    queries.push_back("DROP TABLE #FleetTemplate");
+
+    _db.transaction();
+
+    QSqlQuery query(_db);
+    for (const auto& queryText: queries)
+    {
+        if (!query.exec(queryText))
+        {
+            qCritical().noquote() << QString("Cannot create fleet. Query: %1. Error: %2").arg(queryText).arg(query.lastError().text());
+
+            _db.rollback();
+
+            return false;
+        }
+
+        //шаблон должен существовать - иначе парк будет пустым
+        if (queryText.startsWith("SELECT * INTO") && query.numRowsAffected() != 1)
+        {
+            qCritical().noquote() << QString("Template tank not found in [TanksInfo]. AZSCode: %1. Tank number: %2")
+                                         .arg(_settings.templateAZSCode)
+                                         .arg(_settings.templateTankNumber);
+
+            _db.rollback();
+
+            return false;
+        }
+    }
+
+    _db.commit();
+
+    qInfo().noquote() << QString("Fleet created in [TanksInfo]. AZS: %1. Tanks: %2. Remote tank ID: %3-%4")
+                         .arg(AZSCodes().join(','))
+                         .arg(_settings.AZSCount * _settings.tanksPerAZS)
+                         .arg(_settings.remoteTankIdBase)
+                         .arg(remoteTankId - 1);
+
+    return true;
+}
+
+bool FleetLoadGenerator::removeFleet()
+{
+    if (!connectToDB())
+    {
+        return false;
+    }
+
+    QStringList AZSCodesList;
+    for (const auto& AZSCode: AZSCodes())
+    {
+        AZSCodesList.push_back(QString("'%1'").arg(AZSCode));
+    }
+
+    QSqlQuery query(_db);
+    if (!query.exec(QString("DELETE FROM [dbo].[TanksInfo] WHERE [AZSCode] IN (%1)").arg(AZSCodesList.join(','))))
+    {
+        qCritical().noquote() << QString("Cannot remove fleet. Error: %1").arg(query.lastError().text());
+
+        return false;
+    }
+
+    qInfo().noquote() << QString("Fleet removed from [TanksInfo]. Tanks: %1").arg(query.numRowsAffected());
+
+    return true;
+}
+
+void FleetLoadGenerator::addMeasuments()
+{
+    QElapsedTimer insertTimer;
+    insertTimer.start();
+
+    const auto currentDateTime = QDateTime::currentDateTime().toString(DATETIME_FORMAT);
+
+    QStringList rows;
+    rows.reserve(_fleet.size());
+    for (auto& tank: _fleet)
+    {
+        const auto intakeStep = (_tick + tank.phase) % _settings.intakePeriod;
+        if (intakeStep < _settings.intakeDuration)
+        {
+            if (intakeStep == 0)
+            {
+                ++_intakesCount;
+            }
+
+            tank.height = std::min(MAX_HEIGHT, tank.height + INTAKE_HEIGHT_STEP);
+        }
+        else
+        {
+            tank.height = std::max(MIN_HEIGHT, tank.height - SALE_HEIGHT_STEP);
+        }
+
+        const auto volume = tank.height * VOLUME_PER_MM;
+
+        rows.push_back(QString("('%1', %2, CAST('%3' AS DATETIME2), %4, %5, %6, %7, %8)")
+                           .arg(tank.AZSCode)
+                           .arg(tank.tankNumber)
+                           .arg(currentDateTime)
+                           .arg(DENSITY, 0, 'f', 1)
+                           .arg(tank.height, 0, 'f', 1)
+                           .arg(volume, 0, 'f', 1)
+                           .arg(volume * DENSITY / 1000.0, 0, 'f', 1)
+                           .arg(TEMP, 0, 'f', 1));
+    }
+
+    ++_tick;
+
+    //SQL Server принимает не более 1000 строк в одном INSERT ... VALUES
+    for (qsizetype first = 0; first < rows.size(); first += MAX_ROWS_PER_INSERT)
+    {
+        const auto chunk = rows.mid(first, MAX_ROWS_PER_INSERT);
+
+        const auto queryText =
+            QString("INSERT INTO [TanksMeasument] ([AZSCode], [TankNumber], [DateTime], [Density], [Height], [Volume], [Mass], [Temp]) "
+                    "VALUES %1")
+                .arg(chunk.join(','));
+
+        QSqlQuery query(_db);
+        if (!query.exec(queryText))
+        {
+            ++_errorsCount;
+
+            qWarning().noquote() << QString("Cannot add tank measuments. Error: %1").arg(query.lastError().text());
+
+            continue;
+        }
+
+        _recordsCount += chunk.size();
+    }
+
+    _insertTime += insertTimer.elapsed();
+}
+
+void FleetLoadGenerator::printStats()
+{
+    const auto period = std::max<qint64>(1, _statsPeriodTimer.restart());
+
+    qInfo().noquote() << QString("Fleet: %1 tanks. Added measuments: %2 (%3 rec/s). Intakes started: %4. Errors: %5. Insert time: %6 ms")
+                         .arg(_fleet.size())
+                         .arg(_recordsCount)
+                         .arg(static_cast<double>(_recordsCount) * 1000.0 / period, 0, 'f', 1)
+                         .arg(_intakesCount)
+                         .arg(_errorsCount)
+                         .arg(_insertTime);
+
+    _recordsCount = 0;
+    _intakesCount = 0;
+    _errorsCount = 0;
+    _insertTime = 0;
+}
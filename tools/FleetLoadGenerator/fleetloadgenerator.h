@@ -0,0 +1,114 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Синтетический парк резервуаров для измерения пропускной способности
+///     сервиса от загрузки измерений до подтверждения пакетов сервером
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//STL
+#include <vector>
+
+//Qt
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+
+namespace FleetLoad
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// При запуске создает в [TanksInfo] AZSCount АЗС по tanksPerAZS резервуаров,
+///     копируя конфигурацию резервуара-шаблона. Адрес сервера организации
+///     заменяется на serverUrl (MockSUNCServer), ИД резервуаров на сервере -
+///     на последовательные значения начиная с remoteTankIdBase. Сервис
+///     подхватывает новые резервуары при обновлении конфигурации.
+///     Далее каждые interval в [TanksMeasument] добавляется по одному измерению
+///     каждого резервуара. Уровень медленно снижается (отпуск топлива), каждые
+///     intakePeriod измерений резервуар в течение intakeDuration измерений
+///     заполняется (приход). Время приходов разных резервуаров смещено, поэтому
+///     нагрузка на отправку приходов равномерная. Каждые statsInterval в консоль
+///     выводится количество добавленных измерений. Количество отправленных
+///     сервисом статусов и приходов и задержку их подтверждения выводит MockSUNCServer
+///
+class FleetLoadGenerator final
+    : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Settings
+    {
+        QString connectionString;       ///< Строка подключения ODBC к БД сервиса
+        QString templateAZSCode;        ///< Код АЗС резервуара-шаблона в [TanksInfo]
+        quint8 templateTankNumber = 1;  ///< Номер резервуара-шаблона
+        QString AZSPrefix = "LOAD";     ///< Префикс кодов АЗС парка
+        quint32 AZSCount = 10;          ///< Количество АЗС
+        quint8 tanksPerAZS = 4;         ///< Количество резервуаров на АЗС
+        QString serverUrl = "http://localhost:8080"; ///< Адрес сервера организации для резервуаров парка
+        qint64 remoteTankIdBase = 900000; ///< ИД первого резервуара парка на сервере
+        qint64 interval = 1000;         ///< Интервал добавления измерений, мсек
+        quint32 intakePeriod = 300;     ///< Период приходов, измерений
+        quint32 intakeDuration = 10;    ///< Длительность прихода, измерений
+        qint64 statsInterval = 10000;   ///< Интервал вывода статистики, мсек
+    };
+
+public:
+    explicit FleetLoadGenerator(const Settings& settings, QObject* parent = nullptr);
+    ~FleetLoadGenerator();
+
+    /*!
+        Подключается к БД, создает парк резервуаров и запускает генерацию измерений
+        @return true если парк создан
+    */
+    bool start();
+
+    /*!
+        Удаляет парк резервуаров из [TanksInfo]. Измерения парка в [TanksMeasument] не удаляются
+        @return true если парк удален
+    */
+    bool removeFleet();
+
+private slots:
+    void addMeasuments();
+    void printStats();
+
+private:
+    struct TankModel
+    {
+        QString AZSCode;
+        quint8 tankNumber = 0;
+        double height = 0.0;        ///< Текущий уровень, мм
+        quint32 phase = 0;          ///< Смещение периода приходов, измерений
+    };
+
+private:
+    FleetLoadGenerator() = delete;
+    Q_DISABLE_COPY_MOVE(FleetLoadGenerator)
+
+    bool connectToDB();
+    bool createFleet();
+    QStringList AZSCodes() const;
+
+private:
+    const Settings _settings;
+
+    QSqlDatabase _db;
+
+    std::vector<TankModel> _fleet;
+    quint64 _tick = 0;              ///< Номер текущего измерения
+
+    QTimer _addTimer;
+    QTimer _statsTimer;
+    QElapsedTimer _statsPeriodTimer;
+
+    quint64 _recordsCount = 0;      ///< Количество добавленных измерений за период
+    quint64 _intakesCount = 0;      ///< Количество начатых приходов за период
+    quint64 _errorsCount = 0;       ///< Количество ошибок добавления за период
+    qint64 _insertTime = 0;         ///< Суммарное время добавления измерений за период, мсек
+
+}; //class FleetLoadGenerator
+
+} //namespace FleetLoad
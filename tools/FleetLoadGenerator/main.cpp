@@ -0,0 +1,98 @@
+//Qt
+#include <QCoreApplication>
+#include <QCommandLineParser>
+
+//My
+#include "fleetloadgenerator.h"
+
+//Генератор нагрузки для измерения пропускной способности сервиса. Запускается вместе с MockSUNCServer:
+//генератор создает в БД сервиса синтетический парк резервуаров с адресом сервера организации, указывающим на
+//MockSUNCServer, и добавляет измерения резервуаров. Сервис вычисляет статусы и приходы и отправляет их через
+//SyncHTTPStatus/SyncHTTPIntake. Количество принятых записей в секунду по типам и задержку подтверждения пакетов
+//выводит MockSUNCServer, количество добавленных измерений - генератор.
+//Пример: FleetLoadGenerator --db "<ODBC>" --template-azs 001 --template-tank 1 --azs-count 50 --tanks 4
+//После измерения парк удаляется: FleetLoadGenerator --db "<ODBC>" --azs-count 50 --remove
+
+using namespace FleetLoad;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCoreApplication::setApplicationName("FleetLoadGenerator");
+    QCoreApplication::setApplicationVersion("0.1");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Synthetic tank fleet load generator for end-to-end throughput measurements");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    const QCommandLineOption DBOption("db", "ODBC connection string of the service DB", "connection");
+    const QCommandLineOption templateAZSOption("template-azs", "AZS code of the template tank in [TanksInfo]", "code");
+    const QCommandLineOption templateTankOption("template-tank", "Number of the template tank in [TanksInfo]", "number", "1");
+    const QCommandLineOption AZSPrefixOption("azs-prefix", "AZS code prefix of the fleet", "prefix", "LOAD");
+    const QCommandLineOption AZSCountOption("azs-count", "AZS count of the fleet", "count", "10");
+    const QCommandLineOption tanksOption("tanks", "Tanks per AZS", "count", "4");
+    const QCommandLineOption serverUrlOption("server-url", "Applicant server URL of the fleet tanks", "url", "http://localhost:8080");
+    const QCommandLineOption remoteTankIdOption("remote-tank-id", "Remote ID of the first fleet tank", "id", "900000");
+    const QCommandLineOption intervalOption("interval", "Measuments interval, ms", "ms", "1000");
+    const QCommandLineOption intakePeriodOption("intake-period", "Intake period of every tank, measuments", "count", "300");
+    const QCommandLineOption intakeDurationOption("intake-duration", "Intake duration, measuments", "count", "10");
+    const QCommandLineOption statsIntervalOption("stats-interval", "Statistics output interval, ms", "ms", "10000");
+    const QCommandLineOption removeOption("remove", "Remove the fleet from [TanksInfo] and exit");
+
+    parser.addOptions({DBOption, templateAZSOption, templateTankOption, AZSPrefixOption, AZSCountOption, tanksOption, serverUrlOption,
+                       remoteTankIdOption, intervalOption, intakePeriodOption, intakeDurationOption, statsIntervalOption, removeOption});
+    parser.process(app);
+
+    FleetLoadGenerator::Settings settings;
+    bool ok = true;
+    bool isValid = true;
+
+    const auto isRemoveMode = parser.isSet(removeOption);
+
+    settings.connectionString = parser.value(DBOption);
+    isValid = isValid && !settings.connectionString.isEmpty();
+    settings.templateAZSCode = parser.value(templateAZSOption);
+    isValid = isValid && (isRemoveMode || !settings.templateAZSCode.isEmpty());
+    settings.templateTankNumber = static_cast<quint8>(parser.value(templateTankOption).toUShort(&ok));
+    isValid = isValid && ok && settings.templateTankNumber > 0;
+    settings.AZSPrefix = parser.value(AZSPrefixOption);
+    isValid = isValid && !settings.AZSPrefix.isEmpty();
+    settings.AZSCount = parser.value(AZSCountOption).toUInt(&ok);
+    isValid = isValid && ok && settings.AZSCount > 0 && settings.AZSCount <= 9999;
+    settings.tanksPerAZS = static_cast<quint8>(parser.value(tanksOption).toUShort(&ok));
+    isValid = isValid && ok && settings.tanksPerAZS > 0;
+    settings.serverUrl = parser.value(serverUrlOption);
+    isValid = isValid && !settings.serverUrl.isEmpty();
+    settings.remoteTankIdBase = parser.value(remoteTankIdOption).toLongLong(&ok);
+    isValid = isValid && ok && settings.remoteTankIdBase > 0;
+    settings.interval = parser.value(intervalOption).toLongLong(&ok);
+    isValid = isValid && ok && settings.interval > 0;
+    settings.intakePeriod = parser.value(intakePeriodOption).toUInt(&ok);
+    isValid = isValid && ok;
+    settings.intakeDuration = parser.value(intakeDurationOption).toUInt(&ok);
+    isValid = isValid && ok && settings.intakeDuration > 0 && settings.intakeDuration < settings.intakePeriod;
+    settings.statsInterval = parser.value(statsIntervalOption).toLongLong(&ok);
+    isValid = isValid && ok && settings.statsInterval > 0;
+
+    if (!isValid)
+    {
+        qCritical() << "Invalid command line options";
+        parser.showHelp(1);
+    }
+
+    FleetLoadGenerator generator(settings);
+
+    if (isRemoveMode)
+    {
+        return generator.removeFleet() ? 0 : 1;
+    }
+
+    if (!generator.start())
+    {
+        return 1;
+    }
+
+    return app.exec();
+}
@@ -0,0 +1,19 @@
+QT -= gui
+QT += network
+
+CONFIG += c++20 console
+CONFIG -= app_bundle
+
+#сжатие и формирование пакета берутся из исходников сервиса, чтобы проверялся тот же код, что отправляет пакеты
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../checksum.cpp \
+    ../../compression.cpp \
+    ../../jsonwriter.cpp \
+    main.cpp
+
+HEADERS += \
+    ../../checksum.h \
+    ../../compression.h \
+    ../../jsonwriter.h
@@ -0,0 +1,217 @@
+//Qt
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QRandomGenerator>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUuid>
+#include <QDateTime>
+#include <QUrl>
+#include <QDebug>
+
+//My
+#include "compression.h"
+#include "jsonwriter.h"
+
+//Проверка сжатия пакетов SUNCSync на MockSUNCServer. Синтетический пакет SendTankIndicators сжимается
+//gzipCompress каждым уровнем из --levels и отправляется на MockSUNCServer с Content-Encoding: gzip. Сервер
+//распаковывает тело и отвечает успехом только если распакованный документ корректен, поэтому успешный ответ
+//подтверждает совместимость формата с zlib. Для каждого уровня выводится коэффициент сжатия, время сжатия и время
+//обработки запроса. Время распаковки на стороне сервера выводит MockSUNCServer.
+//Пример: MockSUNCServer --latency 0 --latency-jitter 0; GzipRoundTrip --url http://localhost:8080 --levels 0,1,6,9
+
+using namespace LevelGaugeService;
+
+static QByteArray makeBody(quint32 tanksCount, quint32 measurementsCount)
+{
+    //фиксированное зерно - одинаковые данные при каждом запуске
+    QRandomGenerator random(1);
+
+    const auto startDateTime = QDateTime::currentDateTimeUtc();
+
+    JSONWriter writer(256 + 384 * static_cast<qsizetype>(tanksCount) * measurementsCount);
+    writer.beginObject();
+    writer.writeUuid("requestGuid", QUuid::createUuid());
+    writer.writeUuid("packageId", QUuid::createUuid());
+
+    writer.beginArray("tanksMeasurements");
+    for (quint32 tankNumber = 0; tankNumber < tanksCount; ++tankNumber)
+    {
+        writer.beginObject();
+        writer.writeNumber("tankId", static_cast<qint64>(900000 + tankNumber));
+
+        writer.beginArray("measurements");
+        for (quint32 measurementNumber = 0; measurementNumber < measurementsCount; ++measurementNumber)
+        {
+            const auto level = static_cast<float>(500.0 + random.bounded(2000.0));
+            const auto volume = level * 10.0f / 1000.0f;
+            const auto density = static_cast<float>(720.0 + random.bounded(60.0));
+
+            writer.beginObject();
+            writer.writeDateTime("measurementDate", startDateTime.addMSecs(static_cast<qint64>(measurementNumber) * 60000 + random.bounded(1000)));
+            writer.writeNumber("mass", volume * density / 1000.0f);
+            writer.writeString("massUnitType", "Kilogram");
+            writer.writeNumber("volume", volume);
+            writer.writeString("volumeUnitType", "CubicMeter");
+            writer.writeNumber("level", level);
+            writer.writeString("levelUnitType", "Millimeter");
+            writer.writeNumber("density", density);
+            writer.writeNumber("temperature", static_cast<float>(-20.0 + random.bounded(50.0)));
+            writer.writeString("oilProductType", "AI92");
+            writer.endObject();
+        }
+        writer.endArray();
+
+        writer.endObject();
+    }
+    writer.endArray();
+
+    writer.endObject();
+
+    return writer.take();
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCoreApplication::setApplicationName("GzipRoundTrip");
+    QCoreApplication::setApplicationVersion("0.1");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Gzip round trip of SendTankIndicators payloads through MockSUNCServer");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    const QCommandLineOption urlOption("url", "MockSUNCServer URL", "url", "http://localhost:8080");
+    const QCommandLineOption levelsOption("levels", "Comma separated compression levels. 0 - without compression", "levels", "0,1,6,9");
+    const QCommandLineOption tanksOption("tanks", "Tanks per package", "count", "50");
+    const QCommandLineOption measurementsOption("measurements", "Measurements per tank", "count", "60");
+    const QCommandLineOption iterationsOption("iterations", "Packages sent with every level", "count", "20");
+
+    parser.addOptions({urlOption, levelsOption, tanksOption, measurementsOption, iterationsOption});
+    parser.process(app);
+
+    bool ok = true;
+    bool isValid = true;
+
+    const QUrl baseUrl(parser.value(urlOption));
+    isValid = isValid && baseUrl.isValid();
+
+    QList<int> levels;
+    for (const auto& levelStr: parser.value(levelsOption).split(',', Qt::SkipEmptyParts))
+    {
+        const auto level = levelStr.trimmed().toInt(&ok);
+        isValid = isValid && ok && level >= 0 && level <= 9;
+        levels.push_back(level);
+    }
+    isValid = isValid && !levels.isEmpty();
+
+    const auto tanksCount = parser.value(tanksOption).toUInt(&ok);
+    isValid = isValid && ok && tanksCount > 0;
+    const auto measurementsCount = parser.value(measurementsOption).toUInt(&ok);
+    isValid = isValid && ok && measurementsCount > 0;
+    const auto iterations = parser.value(iterationsOption).toUInt(&ok);
+    isValid = isValid && ok && iterations > 0;
+
+    if (!isValid)
+    {
+        qCritical() << "Invalid command line options";
+        parser.showHelp(1);
+    }
+
+    auto url = baseUrl;
+    url.setPath("/Tank/SendTankIndicators");
+
+    QNetworkAccessManager manager;
+
+    qInfo().noquote() << QString("Package: %1 tanks x %2 measurements. Iterations: %3. URL: %4")
+                         .arg(tanksCount)
+                         .arg(measurementsCount)
+                         .arg(iterations)
+                         .arg(url.toString());
+
+    bool isAllSuccess = true;
+    for (const auto level: levels)
+    {
+        qint64 sourceSize = 0;
+        qint64 bodySize = 0;
+        qint64 compressTime = 0;
+        qint64 requestTime = 0;
+        quint32 successCount = 0;
+        QString lastError;
+
+        for (quint32 i = 0; i < iterations; ++i)
+        {
+            //ИД пакета должен быть уникальным - формируем тело для каждого запроса
+            auto body = makeBody(tanksCount, measurementsCount);
+            sourceSize += body.size();
+
+            QNetworkRequest request(url);
+            request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+
+            if (level > 0)
+            {
+                QElapsedTimer compressTimer;
+                compressTimer.start();
+
+                body = gzipCompress(body, level);
+
+                compressTime += compressTimer.nsecsElapsed();
+
+                if (body.isEmpty())
+                {
+                    qCritical().noquote() << QString("Compression failed. Level: %1").arg(level);
+
+                    return 1;
+                }
+
+                request.setRawHeader("Content-Encoding", "gzip");
+            }
+            bodySize += body.size();
+
+            QElapsedTimer requestTimer;
+            requestTimer.start();
+
+            auto reply = manager.post(request, body);
+            QEventLoop loop;
+            QObject::connect(reply, SIGNAL(finished()), &loop, SLOT(quit()));
+            loop.exec();
+
+            requestTime += requestTimer.nsecsElapsed();
+
+            const auto answer = QJsonDocument::fromJson(reply->readAll()).object();
+            if (reply->error() == QNetworkReply::NoError && answer.value("success").toBool())
+            {
+                ++successCount;
+            }
+            else
+            {
+                lastError = reply->error() != QNetworkReply::NoError ? reply->errorString() : answer.value("error").toString();
+            }
+
+            reply->deleteLater();
+        }
+
+        qInfo().noquote() << QString("Level %1: %2 -> %3 bytes (%4%). Compress: %5 ms/package, %6 MB/s. Request: %7 ms/package. Success: %8/%9%10")
+                             .arg(level)
+                             .arg(sourceSize / iterations)
+                             .arg(bodySize / iterations)
+                             .arg(100.0 * bodySize / sourceSize, 0, 'f', 1)
+                             .arg(static_cast<double>(compressTime) / iterations / 1000000.0, 0, 'f', 3)
+                             .arg(compressTime > 0 ? QString::number(static_cast<double>(sourceSize) * 1000.0 / compressTime, 'f', 1) : QString("-"))
+                             .arg(static_cast<double>(requestTime) / iterations / 1000000.0, 0, 'f', 3)
+                             .arg(successCount)
+                             .arg(iterations)
+                             .arg(lastError.isEmpty() ? QString() : QString(". Last error: %1").arg(lastError));
+
+        isAllSuccess = isAllSuccess && (successCount == iterations);
+    }
+
+    return isAllSuccess ? 0 : 1;
+}
@@ -0,0 +1,14 @@
+QT -= gui
+
+CONFIG += c++20 console
+CONFIG -= app_bundle
+
+#ИД резервуара берется из исходников сервиса, чтобы измерялся тот же код, что используется в таблицах сервиса
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../tankid.cpp \
+    main.cpp
+
+HEADERS += \
+    ../../tankid.h
@@ -0,0 +1,217 @@
+//STL
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+//Qt
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QUuid>
+#include <QDebug>
+
+//My
+#include "tankid.h"
+
+//Сравнение хеширования ключей таблиц сервиса до и после перехода на хеширование без форматирования строк:
+// - QUuid (ИД пакетов): std::hash от строкового представления против qHash(QUuid);
+// - TankID: qHashMulti от кода и номера при каждом обращении против хеша, вычисленного при создании ИД.
+//Для каждого ключа измеряется время вычисления хеша и время поиска в таблице (std::unordered_map для QUuid,
+//QHash для TankID - как в коде сервиса). Сравнение ключей в обоих вариантах поиска TankID - текущее.
+//Пример: HashBench --keys 1000 --iterations 1000
+
+using namespace LevelGaugeService;
+
+//std::hash<QUuid> до изменения
+struct StringUuidHash
+{
+    std::size_t operator()(const QUuid& id) const noexcept
+    {
+        return std::hash<std::string>{}(id.toString().toStdString());
+    }
+};
+
+struct UuidHash
+{
+    std::size_t operator()(const QUuid& id) const noexcept
+    {
+        return qHash(id, 0);
+    }
+};
+
+//qHash(TankID) до изменения. Обертка нужна, чтобы QHash вызывал старую функцию хеширования
+struct UncachedTankID
+{
+    TankID id;
+
+    bool operator==(const UncachedTankID& other) const { return id == other.id; }
+};
+
+inline size_t qHash(const UncachedTankID& key, size_t seed) noexcept
+{
+    return qHashMulti(seed, key.id.levelGaugeCode(), key.id.tankNumber());
+}
+
+//результат накапливается, чтобы компилятор не удалил измеряемый код
+static volatile std::size_t sink = 0;
+
+template <typename Function>
+static double measure(quint64 operationsCount, Function function)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    sink = sink + function();
+
+    return static_cast<double>(timer.nsecsElapsed()) / operationsCount;
+}
+
+template <typename Hash>
+static std::size_t hashUuids(const std::vector<QUuid>& keys, quint32 iterations)
+{
+    std::size_t result = 0;
+    for (quint32 i = 0; i < iterations; ++i)
+    {
+        for (const auto& key: keys)
+        {
+            result += Hash{}(key);
+        }
+    }
+
+    return result;
+}
+
+template <typename Hash>
+static std::size_t findUuids(const std::vector<QUuid>& keys, quint32 iterations)
+{
+    std::unordered_map<QUuid, std::size_t, Hash> map;
+    for (std::size_t i = 0; i < keys.size(); ++i)
+    {
+        map.emplace(keys[i], i);
+    }
+
+    std::size_t result = 0;
+    for (quint32 i = 0; i < iterations; ++i)
+    {
+        for (const auto& key: keys)
+        {
+            result += map.find(key)->second;
+        }
+    }
+
+    return result;
+}
+
+template <typename Key>
+static std::size_t hashKeys(const std::vector<Key>& keys, quint32 iterations)
+{
+    std::size_t result = 0;
+    for (quint32 i = 0; i < iterations; ++i)
+    {
+        for (const auto& key: keys)
+        {
+            result += qHash(key, 0);
+        }
+    }
+
+    return result;
+}
+
+template <typename Key>
+static std::size_t findKeys(const std::vector<Key>& keys, quint32 iterations)
+{
+    QHash<Key, std::size_t> map;
+    for (std::size_t i = 0; i < keys.size(); ++i)
+    {
+        map.insert(keys[i], i);
+    }
+
+    std::size_t result = 0;
+    for (quint32 i = 0; i < iterations; ++i)
+    {
+        for (const auto& key: keys)
+        {
+            result += map.find(key).value();
+        }
+    }
+
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCoreApplication::setApplicationName("HashBench");
+    QCoreApplication::setApplicationVersion("0.1");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("QUuid and TankID hashing microbenchmark");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    const QCommandLineOption keysOption("keys", "Keys in every table", "count", "1000");
+    const QCommandLineOption iterationsOption("iterations", "Passes over all keys", "count", "1000");
+
+    parser.addOptions({keysOption, iterationsOption});
+    parser.process(app);
+
+    bool ok = true;
+    bool isValid = true;
+
+    const auto keysCount = parser.value(keysOption).toUInt(&ok);
+    isValid = isValid && ok && keysCount > 0;
+    const auto iterations = parser.value(iterationsOption).toUInt(&ok);
+    isValid = isValid && ok && iterations > 0;
+
+    if (!isValid)
+    {
+        qCritical() << "Invalid command line options";
+        parser.showHelp(1);
+    }
+
+    std::vector<QUuid> packageIds;
+    std::vector<TankID> tankIds;
+    std::vector<UncachedTankID> uncachedTankIds;
+    packageIds.reserve(keysCount);
+    tankIds.reserve(keysCount);
+    uncachedTankIds.reserve(keysCount);
+    for (quint32 i = 0; i < keysCount; ++i)
+    {
+        packageIds.push_back(QUuid::createUuid());
+
+        //как в конфигурации: несколько резервуаров на АЗС
+        const TankID tankId(QString("AZS%1").arg(i / 4 + 1, 4, 10, QChar('0')), static_cast<quint8>(i % 4 + 1));
+        tankIds.push_back(tankId);
+        uncachedTankIds.push_back(UncachedTankID{tankId});
+    }
+
+    const auto operationsCount = static_cast<quint64>(keysCount) * iterations;
+
+    const auto print = [](const QString& name, double oldTime, double newTime)
+    {
+        qInfo().noquote() << QString("%1: before %2 ns/op, after %3 ns/op, speedup %4x")
+                             .arg(name, -22)
+                             .arg(oldTime, 0, 'f', 2)
+                             .arg(newTime, 0, 'f', 2)
+                             .arg(oldTime / newTime, 0, 'f', 2);
+    };
+
+    qInfo().noquote() << QString("Keys: %1. Iterations: %2").arg(keysCount).arg(iterations);
+
+    print("QUuid hash",
+          measure(operationsCount, [&](){ return hashUuids<StringUuidHash>(packageIds, iterations); }),
+          measure(operationsCount, [&](){ return hashUuids<UuidHash>(packageIds, iterations); }));
+    print("QUuid unordered_map find",
+          measure(operationsCount, [&](){ return findUuids<StringUuidHash>(packageIds, iterations); }),
+          measure(operationsCount, [&](){ return findUuids<UuidHash>(packageIds, iterations); }));
+    print("TankID hash",
+          measure(operationsCount, [&](){ return hashKeys(uncachedTankIds, iterations); }),
+          measure(operationsCount, [&](){ return hashKeys(tankIds, iterations); }));
+    print("TankID QHash find",
+          measure(operationsCount, [&](){ return findKeys(uncachedTankIds, iterations); }),
+          measure(operationsCount, [&](){ return findKeys(tankIds, iterations); }));
+
+    return 0;
+}
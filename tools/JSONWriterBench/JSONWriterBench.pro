@@ -0,0 +1,14 @@
+QT -= gui
+
+CONFIG += c++20 console
+CONFIG -= app_bundle
+
+#писатель берется из исходников сервиса, чтобы измерялся тот же код, что отправляет пакеты
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../jsonwriter.cpp \
+    main.cpp
+
+HEADERS += \
+    ../../jsonwriter.h
@@ -0,0 +1,312 @@
+//STL
+#include <vector>
+#include <algorithm>
+
+//Qt
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QUuid>
+#include <QDateTime>
+#include <QDebug>
+
+//My
+#include "jsonwriter.h"
+
+//Сравнение скорости формирования тела запроса SendTankIndicators через JSONWriter (текущий код SUNCSync)
+//и через дерево QJsonObject/QJsonArray + QJsonDocument::toJson (код до перехода на JSONWriter).
+//Оба способа формируют один и тот же синтетический пакет. Перед измерением проверяется, что документы
+//совпадают (числа сравниваются с точностью float). Выводится размер документа, время формирования
+//одного документа и скорость записи в байтах в секунду.
+//Пример: JSONWriterBench --tanks 50 --measurements 60 --iterations 200
+
+using namespace LevelGaugeService;
+
+static const QString MEASUMENT_DATETIME_FORMAT = "yyyy-MM-ddThh:mm:ss.zzzZ";
+
+struct Measurement
+{
+    QDateTime measurementDate;
+    float mass = 0.0f;
+    float volume = 0.0f;
+    float level = 0.0f;
+    float density = 0.0f;
+    float temperature = 0.0f;
+};
+
+struct TankMeasurements
+{
+    qint64 tankId = 0;
+    std::vector<Measurement> measuments;
+};
+
+struct Package
+{
+    QUuid packageId;
+    std::vector<TankMeasurements> tankMeasurements;
+};
+
+static Package makePackage(quint32 tanksCount, quint32 measurementsCount)
+{
+    //фиксированное зерно - одинаковый пакет при каждом запуске
+    QRandomGenerator random(1);
+
+    Package package;
+    package.packageId = QUuid::createUuid();
+
+    const auto startDateTime = QDateTime::currentDateTimeUtc();
+    for (quint32 tankNumber = 0; tankNumber < tanksCount; ++tankNumber)
+    {
+        TankMeasurements tank;
+        tank.tankId = 900000 + tankNumber;
+        for (quint32 measurementNumber = 0; measurementNumber < measurementsCount; ++measurementNumber)
+        {
+            Measurement measurement;
+            measurement.measurementDate = startDateTime.addMSecs(static_cast<qint64>(measurementNumber) * 60000 + random.bounded(1000));
+            measurement.level = static_cast<float>(500.0 + random.bounded(2000.0));
+            measurement.volume = measurement.level * 10.0f / 1000.0f;
+            measurement.density = static_cast<float>(720.0 + random.bounded(60.0));
+            measurement.mass = measurement.volume * measurement.density / 1000.0f;
+            measurement.temperature = static_cast<float>(-20.0 + random.bounded(50.0));
+
+            tank.measuments.push_back(std::move(measurement));
+        }
+
+        package.tankMeasurements.push_back(std::move(tank));
+    }
+
+    return package;
+}
+
+//Код SUNCSync::sendSendTankIndicators до перехода на JSONWriter. Строки перечислений формировались при каждом вызове
+static QByteArray writeDOM(const Package& package, const QString& requestGuid)
+{
+    QJsonObject data;
+    data.insert("requestGuid", requestGuid);
+    data.insert("packageId", package.packageId.toString(QUuid::WithoutBraces));
+
+    QJsonArray JSONTanksMeasurements;
+    for (const auto& tanksMeasurement: package.tankMeasurements)
+    {
+        QJsonObject JSONTanksMeasurement;
+        JSONTanksMeasurement.insert("tankId", tanksMeasurement.tankId);
+
+        QJsonArray JSONMeasurements;
+        for (const auto& measurement: tanksMeasurement.measuments)
+        {
+            QJsonObject JSONMeasument;
+
+            JSONMeasument.insert("measurementDate", measurement.measurementDate.toString(MEASUMENT_DATETIME_FORMAT));
+            JSONMeasument.insert("mass", measurement.mass);
+            JSONMeasument.insert("massUnitType", QString("Kilogram"));
+            JSONMeasument.insert("volume", measurement.volume);
+            JSONMeasument.insert("volumeUnitType", QString("CubicMeter"));
+            JSONMeasument.insert("level", measurement.level);
+            JSONMeasument.insert("levelUnitType", QString("Millimeter"));
+            JSONMeasument.insert("density", measurement.density);
+            JSONMeasument.insert("temperature", measurement.temperature);
+            JSONMeasument.insert("oilProductType", QString("AI92"));
+
+            JSONMeasurements.push_back(JSONMeasument);
+        }
+
+        JSONTanksMeasurement.insert("measurements", JSONMeasurements);
+
+        JSONTanksMeasurements.push_back(JSONTanksMeasurement);
+    }
+
+    data.insert("tanksMeasurements", JSONTanksMeasurements);
+
+    return QJsonDocument(data).toJson(QJsonDocument::Compact);
+}
+
+//Код SUNCSync::sendSendTankIndicators с JSONWriter. Строки перечислений в SUNCSync кешируются, здесь - литералы
+static QByteArray writeStreaming(const Package& package, const QByteArray& requestGuid)
+{
+    qsizetype measurementsCount = 0;
+    for (const auto& tanksMeasurement: package.tankMeasurements)
+    {
+        measurementsCount += static_cast<qsizetype>(tanksMeasurement.measuments.size());
+    }
+
+    JSONWriter writer(256 + 384 * measurementsCount);
+    writer.beginObject();
+    writer.writeString("requestGuid", requestGuid);
+    writer.writeUuid("packageId", package.packageId);
+
+    writer.beginArray("tanksMeasurements");
+    for (const auto& tanksMeasurement: package.tankMeasurements)
+    {
+        writer.beginObject();
+        writer.writeNumber("tankId", tanksMeasurement.tankId);
+
+        writer.beginArray("measurements");
+        for (const auto& measurement: tanksMeasurement.measuments)
+        {
+            writer.beginObject();
+            writer.writeDateTime("measurementDate", measurement.measurementDate);
+            writer.writeNumber("mass", measurement.mass);
+            writer.writeString("massUnitType", "Kilogram");
+            writer.writeNumber("volume", measurement.volume);
+            writer.writeString("volumeUnitType", "CubicMeter");
+            writer.writeNumber("level", measurement.level);
+            writer.writeString("levelUnitType", "Millimeter");
+            writer.writeNumber("density", measurement.density);
+            writer.writeNumber("temperature", measurement.temperature);
+            writer.writeString("oilProductType", "AI92");
+            writer.endObject();
+        }
+        writer.endArray();
+
+        writer.endObject();
+    }
+    writer.endArray();
+
+    writer.endObject();
+
+    return writer.take();
+}
+
+//QJsonDocument записывает float как double (0.1f -> 0.10000000149011612), JSONWriter - кратчайшим представлением float,
+//поэтому числа сравниваются после приведения к float
+static bool isEqual(const QJsonValue& first, const QJsonValue& second)
+{
+    if (first.type() != second.type())
+    {
+        return false;
+    }
+
+    switch (first.type())
+    {
+    case QJsonValue::Double:
+        return static_cast<float>(first.toDouble()) == static_cast<float>(second.toDouble());
+    case QJsonValue::Array:
+    {
+        const auto firstArray = first.toArray();
+        const auto secondArray = second.toArray();
+        if (firstArray.size() != secondArray.size())
+        {
+            return false;
+        }
+        for (qsizetype i = 0; i < firstArray.size(); ++i)
+        {
+            if (!isEqual(firstArray.at(i), secondArray.at(i)))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+    case QJsonValue::Object:
+    {
+        const auto firstObject = first.toObject();
+        const auto secondObject = second.toObject();
+        if (firstObject.keys() != secondObject.keys())
+        {
+            return false;
+        }
+        for (auto it = firstObject.begin(); it != firstObject.end(); ++it)
+        {
+            if (!isEqual(it.value(), secondObject.value(it.key())))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+    default:
+        return first == second;
+    }
+}
+
+template <typename Function>
+static qint64 measure(quint32 iterations, qsizetype& size, Function function)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    for (quint32 i = 0; i < iterations; ++i)
+    {
+        size = function().size();
+    }
+
+    return std::max<qint64>(1, timer.nsecsElapsed());
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCoreApplication::setApplicationName("JSONWriterBench");
+    QCoreApplication::setApplicationVersion("0.1");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("JSONWriter vs QJsonDocument serialization benchmark of SendTankIndicators payloads");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    const QCommandLineOption tanksOption("tanks", "Tanks per package", "count", "50");
+    const QCommandLineOption measurementsOption("measurements", "Measurements per tank", "count", "60");
+    const QCommandLineOption iterationsOption("iterations", "Serializations of every method", "count", "200");
+
+    parser.addOptions({tanksOption, measurementsOption, iterationsOption});
+    parser.process(app);
+
+    bool ok = true;
+    bool isValid = true;
+
+    const auto tanksCount = parser.value(tanksOption).toUInt(&ok);
+    isValid = isValid && ok && tanksCount > 0;
+    const auto measurementsCount = parser.value(measurementsOption).toUInt(&ok);
+    isValid = isValid && ok && measurementsCount > 0;
+    const auto iterations = parser.value(iterationsOption).toUInt(&ok);
+    isValid = isValid && ok && iterations > 0;
+
+    if (!isValid)
+    {
+        qCritical() << "Invalid command line options";
+        parser.showHelp(1);
+    }
+
+    const auto package = makePackage(tanksCount, measurementsCount);
+    const auto requestGuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    const auto requestGuidUtf8 = requestGuid.toUtf8();
+
+    //проверка идентичности документов. Заодно прогревает оба пути
+    const auto DOMDoc = QJsonDocument::fromJson(writeDOM(package, requestGuid));
+    const auto streamingDoc = QJsonDocument::fromJson(writeStreaming(package, requestGuidUtf8));
+    if (!streamingDoc.isObject() || !isEqual(DOMDoc.object(), streamingDoc.object()))
+    {
+        qCritical() << "JSONWriter document differs from QJsonDocument document";
+
+        return 1;
+    }
+
+    qsizetype DOMSize = 0;
+    const auto DOMTime = measure(iterations, DOMSize, [&package, &requestGuid](){ return writeDOM(package, requestGuid); });
+
+    qsizetype streamingSize = 0;
+    const auto streamingTime = measure(iterations, streamingSize, [&package, &requestGuidUtf8](){ return writeStreaming(package, requestGuidUtf8); });
+
+    const auto print = [iterations](const QString& name, qsizetype size, qint64 time)
+    {
+        qInfo().noquote() << QString("%1: document %2 bytes, %3 us/doc, %4 MB/s")
+                             .arg(name)
+                             .arg(size)
+                             .arg(static_cast<double>(time) / iterations / 1000.0, 0, 'f', 1)
+                             .arg(static_cast<double>(size) * iterations * 1000.0 / time, 0, 'f', 1);
+    };
+
+    qInfo().noquote() << QString("Package: %1 tanks x %2 measurements. Iterations: %3").arg(tanksCount).arg(measurementsCount).arg(iterations);
+    print("QJsonDocument", DOMSize, DOMTime);
+    print("JSONWriter", streamingSize, streamingTime);
+    qInfo().noquote() << QString("Speedup: %1x").arg(static_cast<double>(DOMTime) / streamingTime, 0, 'f', 2);
+
+    return 0;
+}
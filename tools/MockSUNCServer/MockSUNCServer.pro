@@ -0,0 +1,23 @@
+QT -= gui
+QT += network
+QT += sql
+QT += httpserver
+
+CONFIG += c++20 console
+CONFIG -= app_bundle
+
+#сжатые тела запросов распаковываются zlib. Если Qt собран без системной zlib - используется встроенная в QtCore
+qtConfig(system-zlib) {
+    QMAKE_USE += zlib
+} else {
+    QT += zlib-private
+}
+
+SOURCES += \
+    flowmeterdriver.cpp \
+    main.cpp \
+    mocksuncserver.cpp
+
+HEADERS += \
+    flowmeterdriver.h \
+    mocksuncserver.h
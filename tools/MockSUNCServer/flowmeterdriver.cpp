@@ -0,0 +1,136 @@
+//STL
+#include <algorithm>
+
+//Qt
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDateTime>
+#include <QDebug>
+
+//My
+#include "flowmeterdriver.h"
+
+using namespace MockSUNC;
+
+static const QString CONNECTION_NAME = "FlowmeterDriver";
+static const QString DATETIME_FORMAT = "yyyy-MM-dd hh:mm:ss.zzz";
+static const qsizetype MAX_ROWS_PER_INSERT = 1000;
+
+static const quint8 DIRECTION_OUTPUT = 1;   ///< Отпуск. Значения совпадают с SyncHTTPFlowmeter::Direction
+static const quint8 DIRECTION_INPUT = 2;    ///< Прием
+
+FlowmeterDriver::FlowmeterDriver(const Settings& settings, QObject* parent /* = nullptr */)
+    : QObject{parent}
+    , _settings(settings)
+{
+    Q_ASSERT(!_settings.AZSCodes.isEmpty());
+    Q_ASSERT(_settings.devicesPerAZS > 0);
+    Q_ASSERT(_settings.interval > 0);
+    Q_ASSERT(_settings.statsInterval > 0);
+
+    QObject::connect(&_addTimer, SIGNAL(timeout()), SLOT(addMeasurements()));
+    QObject::connect(&_statsTimer, SIGNAL(timeout()), SLOT(printStats()));
+}
+
+FlowmeterDriver::~FlowmeterDriver()
+{
+    _addTimer.stop();
+    _statsTimer.stop();
+
+    if (_db.isOpen())
+    {
+        _db.close();
+    }
+}
+
+bool FlowmeterDriver::start()
+{
+    _db = QSqlDatabase::addDatabase("QODBC", CONNECTION_NAME);
+    _db.setDatabaseName(_settings.connectionString);
+
+    if (!_db.open())
+    {
+        qCritical().noquote() << QString("Cannot connect to DB. Error: %1").arg(_db.lastError().text());
+
+        return false;
+    }
+
+    _statsPeriodTimer.start();
+    _addTimer.start(_settings.interval);
+    _statsTimer.start(_settings.statsInterval);
+
+    qInfo().noquote() << QString("Flowmeter driver started. AZS: %1. Devices per AZS: %2. Interval: %3 ms")
+                         .arg(_settings.AZSCodes.join(','))
+                         .arg(_settings.devicesPerAZS)
+                         .arg(_settings.interval);
+
+    return true;
+}
+
+void FlowmeterDriver::addMeasurements()
+{
+    const auto currentDateTime = QDateTime::currentDateTime().toString(DATETIME_FORMAT);
+    const auto flowVolume = _settings.interval / 100.0;
+    _totalVolume += flowVolume;
+
+    //показания всех расходомеров добавляются одним запросом. ИД расходомера уникален в пределах всех АЗС
+    QStringList rows;
+    rows.reserve(_settings.AZSCodes.size() * _settings.devicesPerAZS * 2);
+    for (qsizetype AZSIndex = 0; AZSIndex < _settings.AZSCodes.size(); ++AZSIndex)
+    {
+        for (quint32 deviceNumber = 0; deviceNumber < _settings.devicesPerAZS; ++deviceNumber)
+        {
+            const auto deviceId = static_cast<qint64>(AZSIndex) * 1000 + deviceNumber + 1;
+
+            for (const auto direction: {DIRECTION_OUTPUT, DIRECTION_INPUT})
+            {
+                rows.push_back(QString("('%1', %2, CAST('%3' AS DATETIME2), %4, %5, %6, %7, %8, %9, '92')")
+                               .arg(_settings.AZSCodes.at(AZSIndex))
+                               .arg(deviceId)
+                               .arg(currentDateTime)
+                               .arg(direction)
+                               .arg(_totalVolume * 0.75, 0, 'f', 3)
+                               .arg(flowVolume * 0.75, 0, 'f', 3)
+                               .arg(_totalVolume, 0, 'f', 3)
+                               .arg(750.0, 0, 'f', 1)
+                               .arg(15.0, 0, 'f', 1));
+            }
+        }
+    }
+
+    //SQL Server принимает не более 1000 строк в одном INSERT ... VALUES
+    for (qsizetype first = 0; first < rows.size(); first += MAX_ROWS_PER_INSERT)
+    {
+        const auto chunk = rows.mid(first, MAX_ROWS_PER_INSERT);
+
+        const auto queryText =
+            QString("INSERT INTO [FlowmetersMeasurements] ([AZSCode], [DeviceID], [DateTime], [Direction], [TotalMass], [FlowMass], [TotalVolume], [Density], [Temp], [Product]) "
+                    "VALUES %1")
+                .arg(chunk.join(','));
+
+        QSqlQuery query(_db);
+        if (!query.exec(queryText))
+        {
+            ++_errorsCount;
+
+            qWarning().noquote() << QString("Cannot add flowmeter measurements. Error: %1").arg(query.lastError().text());
+
+            continue;
+        }
+
+        _recordsCount += chunk.size();
+    }
+}
+
+void FlowmeterDriver::printStats()
+{
+    const auto period = std::max<qint64>(1, _statsPeriodTimer.restart());
+
+    qInfo().noquote() << QString("Flowmeter driver. Added records: %1 (%2 rec/s). Errors: %3")
+                         .arg(_recordsCount)
+                         .arg(static_cast<double>(_recordsCount) * 1000.0 / period, 0, 'f', 1)
+                         .arg(_errorsCount);
+
+    _recordsCount = 0;
+    _errorsCount = 0;
+}
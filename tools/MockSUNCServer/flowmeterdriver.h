@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Генератор показаний расходомеров для проверки отправки показаний на
+///     локальную замену сервера СУНЦ
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//Qt
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+
+namespace MockSUNC
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// Каждые interval добавляет в таблицу [FlowmetersMeasurements] по одному
+///     показанию отпуска и приема для devicesPerAZS расходомеров каждой АЗС.
+///     Показания забирает и отправляет на сервер SyncHTTPFlowmeter сервиса,
+///     поэтому АЗС должны присутствовать в конфигурации резервуаров, а адрес
+///     сервера организации должен указывать на MockSUNCServer. Каждые
+///     statsInterval в консоль выводится количество добавленных показаний
+///
+class FlowmeterDriver final
+    : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Settings
+    {
+        QString connectionString;       ///< Строка подключения ODBC к БД сервиса
+        QStringList AZSCodes;           ///< Коды АЗС
+        quint32 devicesPerAZS = 2;      ///< Количество расходомеров на АЗС
+        qint64 interval = 1000;         ///< Интервал добавления показаний, мсек
+        qint64 statsInterval = 10000;   ///< Интервал вывода статистики, мсек
+    };
+
+public:
+    explicit FlowmeterDriver(const Settings& settings, QObject* parent = nullptr);
+    ~FlowmeterDriver();
+
+    /*!
+        Подключается к БД и запускает генерацию показаний
+        @return true если подключение выполнено
+    */
+    bool start();
+
+private slots:
+    void addMeasurements();
+    void printStats();
+
+private:
+    FlowmeterDriver() = delete;
+    Q_DISABLE_COPY_MOVE(FlowmeterDriver)
+
+private:
+    const Settings _settings;
+
+    QSqlDatabase _db;
+
+    QTimer _addTimer;
+    QTimer _statsTimer;
+    QElapsedTimer _statsPeriodTimer;
+
+    double _totalVolume = 0.0;      ///< Счетчик объема расходомеров, л
+    quint64 _recordsCount = 0;      ///< Количество добавленных показаний за период
+    quint64 _errorsCount = 0;       ///< Количество ошибок добавления за период
+
+}; //class FlowmeterDriver
+
+} //namespace MockSUNC
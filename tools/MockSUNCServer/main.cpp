@@ -0,0 +1,98 @@
+//STL
+#include <memory>
+
+//Qt
+#include <QCoreApplication>
+#include <QCommandLineParser>
+
+//My
+#include "mocksuncserver.h"
+#include "flowmeterdriver.h"
+
+//Локальная замена API сервера СУНЦ. Для измерения пропускной способности в конфигурации сервиса
+//адрес сервера организаций (RemoteBaseUrl) указывается как http://localhost:<port>. Сжатые пакеты ([SYNC_HTTP]/CompressionLevel > 0) распаковываются.
+//С параметром --driver-db сервер дополнительно добавляет показания расходомеров в БД сервиса, чтобы проверить
+//отправку показаний расходомеров без внешних систем
+
+using namespace MockSUNC;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCoreApplication::setApplicationName("MockSUNCServer");
+    QCoreApplication::setApplicationVersion("0.1");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Local mock of the SUNC API server for throughput measurements");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    const QCommandLineOption portOption("port", "Listen port", "port", "8080");
+    const QCommandLineOption latencyOption("latency", "Answer latency, ms", "ms", "50");
+    const QCommandLineOption latencyJitterOption("latency-jitter", "Answer latency jitter, ms", "ms", "20");
+    const QCommandLineOption errorRateOption("error-rate", "Part of requests answered with HTTP 500 (0..1)", "rate", "0");
+    const QCommandLineOption confirmDelayOption("confirm-delay", "Time of package transition from Pending to Success, ms", "ms", "5000");
+    const QCommandLineOption statsIntervalOption("stats-interval", "Statistics output interval, ms", "ms", "10000");
+    const QCommandLineOption driverDBOption("driver-db", "ODBC connection string of the service DB. Enables flowmeter driver mode", "connection");
+    const QCommandLineOption driverAZSOption("driver-azs", "Comma separated AZS codes of the flowmeter driver", "codes");
+    const QCommandLineOption driverDevicesOption("driver-devices", "Flowmeters per AZS of the flowmeter driver", "count", "2");
+    const QCommandLineOption driverIntervalOption("driver-interval", "Flowmeter measurements interval, ms", "ms", "1000");
+
+    parser.addOptions({portOption, latencyOption, latencyJitterOption, errorRateOption, confirmDelayOption, statsIntervalOption,
+                       driverDBOption, driverAZSOption, driverDevicesOption, driverIntervalOption});
+    parser.process(app);
+
+    MockSUNCServer::Settings settings;
+    bool ok = true;
+    bool isValid = true;
+
+    settings.port = parser.value(portOption).toUShort(&ok);
+    isValid = isValid && ok && settings.port != 0;
+    settings.latency = parser.value(latencyOption).toLongLong(&ok);
+    isValid = isValid && ok && settings.latency >= 0;
+    settings.latencyJitter = parser.value(latencyJitterOption).toLongLong(&ok);
+    isValid = isValid && ok && settings.latencyJitter >= 0;
+    settings.errorRate = parser.value(errorRateOption).toDouble(&ok);
+    isValid = isValid && ok && settings.errorRate >= 0.0 && settings.errorRate <= 1.0;
+    settings.confirmDelay = parser.value(confirmDelayOption).toLongLong(&ok);
+    isValid = isValid && ok && settings.confirmDelay >= 0;
+    settings.statsInterval = parser.value(statsIntervalOption).toLongLong(&ok);
+    isValid = isValid && ok && settings.statsInterval > 0;
+
+    const auto isDriverMode = parser.isSet(driverDBOption);
+
+    FlowmeterDriver::Settings driverSettings;
+    driverSettings.connectionString = parser.value(driverDBOption);
+    driverSettings.AZSCodes = parser.value(driverAZSOption).split(',', Qt::SkipEmptyParts);
+    driverSettings.devicesPerAZS = parser.value(driverDevicesOption).toUInt(&ok);
+    isValid = isValid && ok && driverSettings.devicesPerAZS > 0;
+    driverSettings.interval = parser.value(driverIntervalOption).toLongLong(&ok);
+    isValid = isValid && ok && driverSettings.interval > 0;
+    driverSettings.statsInterval = settings.statsInterval;
+    isValid = isValid && (!isDriverMode || !driverSettings.AZSCodes.isEmpty());
+
+    if (!isValid)
+    {
+        qCritical() << "Invalid command line options";
+        parser.showHelp(1);
+    }
+
+    MockSUNCServer server(settings);
+    if (!server.start())
+    {
+        return 1;
+    }
+
+    std::unique_ptr<FlowmeterDriver> driver;
+    if (isDriverMode)
+    {
+        driver = std::make_unique<FlowmeterDriver>(driverSettings);
+        if (!driver->start())
+        {
+            return 1;
+        }
+    }
+
+    return app.exec();
+}
@@ -0,0 +1,352 @@
+//STL
+#include <algorithm>
+
+//Qt
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QRandomGenerator>
+#include <QHostAddress>
+
+//zlib
+#include <zlib.h>
+
+//My
+#include "mocksuncserver.h"
+
+using namespace MockSUNC;
+
+static const int GZIP_WINDOW_BITS = 16 + MAX_WBITS;    ///< Формат gzip (RFC 1952) вместо zlib
+static const qsizetype GUNZIP_CHUNK_SIZE = 64 * 1024;
+
+//Распаковывает тело запроса в формате gzip. Возвращает пустой массив в случае ошибки
+static QByteArray gunzip(const QByteArray& data)
+{
+    z_stream stream = {};
+    if (inflateInit2(&stream, GZIP_WINDOW_BITS) != Z_OK)
+    {
+        return {};
+    }
+
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+
+    QByteArray result;
+    int status = Z_OK;
+    while (status == Z_OK)
+    {
+        const auto offset = result.size();
+        result.resize(offset + GUNZIP_CHUNK_SIZE);
+
+        stream.next_out = reinterpret_cast<Bytef*>(result.data() + offset);
+        stream.avail_out = static_cast<uInt>(GUNZIP_CHUNK_SIZE);
+
+        status = inflate(&stream, Z_NO_FLUSH);
+
+        result.resize(offset + GUNZIP_CHUNK_SIZE - stream.avail_out);
+    }
+
+    inflateEnd(&stream);
+
+    if (status != Z_STREAM_END)
+    {
+        return {};
+    }
+
+    return result;
+}
+
+MockSUNCServer::MockSUNCServer(const Settings& settings, QObject* parent /* = nullptr */)
+    : QObject{parent}
+    , _settings(settings)
+{
+    Q_ASSERT(_settings.latency >= 0 && _settings.latencyJitter >= 0);
+    Q_ASSERT(_settings.errorRate >= 0.0 && _settings.errorRate <= 1.0);
+    Q_ASSERT(_settings.confirmDelay >= 0);
+    Q_ASSERT(_settings.statsInterval > 0);
+
+    _server.route("/Tank/SendTankIndicators", QHttpServerRequest::Method::Post,
+        [this](const QHttpServerRequest& request, QHttpServerResponder&& responder)
+        {
+            sendData(request, std::move(responder), "tanksMeasurements", "measurements");
+        });
+
+    _server.route("/Tank/SendTankTransfers", QHttpServerRequest::Method::Post,
+        [this](const QHttpServerRequest& request, QHttpServerResponder&& responder)
+        {
+            sendData(request, std::move(responder), "tanksTransfers", "transfers");
+        });
+
+    _server.route("/Device/SendFlowmeterOutputIndicators", QHttpServerRequest::Method::Post,
+        [this](const QHttpServerRequest& request, QHttpServerResponder&& responder)
+        {
+            sendData(request, std::move(responder), "flowmetersOutputMeasurements", "measurements");
+        });
+
+    _server.route("/Device/SendFlowmeterInputIndicators", QHttpServerRequest::Method::Post,
+        [this](const QHttpServerRequest& request, QHttpServerResponder&& responder)
+        {
+            sendData(request, std::move(responder), "flowmetersInputMeasurements", "measurements");
+        });
+
+    _server.route("/Provider/GetPackageStatus", QHttpServerRequest::Method::Post,
+        [this](const QHttpServerRequest& request, QHttpServerResponder&& responder)
+        {
+            getPackageStatus(request, std::move(responder));
+        });
+
+    QObject::connect(&_statsTimer, SIGNAL(timeout()), SLOT(printStats()));
+}
+
+MockSUNCServer::~MockSUNCServer()
+{
+    _statsTimer.stop();
+}
+
+bool MockSUNCServer::start()
+{
+    if (_server.listen(QHostAddress::Any, _settings.port) == 0)
+    {
+        qCritical() << "Cannot listen port" << _settings.port;
+
+        return false;
+    }
+
+    _statsPeriodTimer.start();
+    _statsTimer.start(_settings.statsInterval);
+
+    qInfo().noquote() << QString("Mock SUNC server started. Port: %1. Latency: %2+-%3 ms. Error rate: %4. Confirm delay: %5 ms")
+                         .arg(_settings.port)
+                         .arg(_settings.latency)
+                         .arg(_settings.latencyJitter)
+                         .arg(_settings.errorRate)
+                         .arg(_settings.confirmDelay);
+
+    return true;
+}
+
+QJsonObject MockSUNCServer::errorAnswer(const QString& error)
+{
+    QJsonObject answer;
+    answer.insert("success", false);
+    answer.insert("error", error);
+
+    return answer;
+}
+
+void MockSUNCServer::sendData(const QHttpServerRequest& request, QHttpServerResponder&& responder, const QString& arrayKey, const QString& itemsKey)
+{
+    //сервис сжимает пакеты при CompressionLevel > 0. Время распаковки учитывается в статистике отдельно
+    auto body = request.body();
+    if (request.value("Content-Encoding").contains("gzip"))
+    {
+        QElapsedTimer unzipTimer;
+        unzipTimer.start();
+
+        const auto compressedSize = body.size();
+        body = gunzip(body);
+
+        _unzipTime += unzipTimer.nsecsElapsed();
+
+        if (body.isEmpty())
+        {
+            replyError(std::move(responder), QHttpServerResponder::StatusCode::BadRequest);
+
+            return;
+        }
+
+        ++_compressedCount;
+        _compressedBytes += compressedSize;
+        _uncompressedBytes += body.size();
+    }
+
+    QJsonParseError error;
+    const auto doc = QJsonDocument::fromJson(body, &error);
+    if (!doc.isObject())
+    {
+        reply(std::move(responder), errorAnswer(QString("Request is not JSON object. Error: %1").arg(error.errorString())));
+
+        return;
+    }
+
+    const auto data = doc.object();
+    const auto packageId = QUuid::fromString(data.value("packageId").toString());
+    if (packageId.isNull())
+    {
+        reply(std::move(responder), errorAnswer("PackageId cannot be null"));
+
+        return;
+    }
+
+    quint64 recordsCount = 0;
+    for (const auto& item: data.value(arrayKey).toArray())
+    {
+        recordsCount += item.toObject().value(itemsKey).toArray().size();
+    }
+
+    QJsonObject answer;
+    answer.insert("success", true);
+    answer.insert("error", QJsonValue::Null);
+
+    //пакет считается принятым только если клиент получит успешный ответ
+    if (!reply(std::move(responder), answer))
+    {
+        return;
+    }
+
+    Package package;
+    package.receiveTimer.start();
+    _packages.insert(packageId, std::move(package));
+
+    ++_packagesCount;
+    _recordsCount += recordsCount;
+    _recordsByType[arrayKey] += recordsCount;
+}
+
+void MockSUNCServer::getPackageStatus(const QHttpServerRequest& request, QHttpServerResponder&& responder)
+{
+    ++_statusRequestsCount;
+
+    const auto doc = QJsonDocument::fromJson(request.body());
+    const auto packageId = QUuid::fromString(doc.object().value("packageId").toString());
+
+    const auto packages_it = _packages.find(packageId);
+    if (packages_it == _packages.end())
+    {
+        reply(std::move(responder), errorAnswer(QString("PackageId %1 wasn`t found.").arg(packageId.toString(QUuid::WithoutBraces))));
+
+        return;
+    }
+
+    const auto elapsed = packages_it->receiveTimer.elapsed();
+    const auto isSuccess = elapsed >= _settings.confirmDelay;
+
+    QJsonObject answer;
+    answer.insert("success", true);
+    answer.insert("error", QJsonValue::Null);
+    answer.insert("packageProcessingStatus", isSuccess ? "Success" : "Pending");
+
+    if (!reply(std::move(responder), answer) || !isSuccess || packages_it->isConfirmed)
+    {
+        return;
+    }
+
+    packages_it->isConfirmed = true;
+
+    ++_confirmedCount;
+    _confirmLagSum += elapsed;
+    _confirmLagMax = std::max(_confirmLagMax, elapsed);
+}
+
+qint64 MockSUNCServer::replyDelay() const
+{
+    if (_settings.latencyJitter == 0)
+    {
+        return _settings.latency;
+    }
+
+    const auto jitter = static_cast<qint64>(QRandomGenerator::global()->bounded(static_cast<int>(2 * _settings.latencyJitter + 1))) - _settings.latencyJitter;
+
+    return std::max<qint64>(0, _settings.latency + jitter);
+}
+
+bool MockSUNCServer::reply(QHttpServerResponder&& responder, const QJsonObject& answer)
+{
+    if (_settings.errorRate > 0.0 && QRandomGenerator::global()->generateDouble() < _settings.errorRate)
+    {
+        replyError(std::move(responder), QHttpServerResponder::StatusCode::InternalServerError);
+
+        return false;
+    }
+
+    const auto responderId = ++_lastResponderId;
+    _responders.emplace(responderId, std::move(responder));
+
+    QTimer::singleShot(replyDelay(), this,
+        [this, responderId, answer]()
+        {
+            const auto responders_it = _responders.find(responderId);
+            if (responders_it == _responders.end())
+            {
+                return;
+            }
+
+            responders_it->second.write(QJsonDocument(answer));
+
+            _responders.erase(responders_it);
+        });
+
+    return true;
+}
+
+void MockSUNCServer::replyError(QHttpServerResponder&& responder, QHttpServerResponder::StatusCode code)
+{
+    ++_errorsCount;
+
+    const auto responderId = ++_lastResponderId;
+    _responders.emplace(responderId, std::move(responder));
+
+    QTimer::singleShot(replyDelay(), this,
+        [this, responderId, code]()
+        {
+            const auto responders_it = _responders.find(responderId);
+            if (responders_it == _responders.end())
+            {
+                return;
+            }
+
+            responders_it->second.write(code);
+
+            _responders.erase(responders_it);
+        });
+}
+
+void MockSUNCServer::printStats()
+{
+    const auto period = std::max<qint64>(1, _statsPeriodTimer.restart());
+
+    qInfo().noquote() << QString("Packages: %1. Records: %2 (%3 rec/s). Status requests: %4. Errors: %5. Confirmed: %6. Confirm lag avg: %7 ms max: %8 ms. Pending packages: %9")
+                         .arg(_packagesCount)
+                         .arg(_recordsCount)
+                         .arg(static_cast<double>(_recordsCount) * 1000.0 / period, 0, 'f', 1)
+                         .arg(_statusRequestsCount)
+                         .arg(_errorsCount)
+                         .arg(_confirmedCount)
+                         .arg(_confirmedCount != 0 ? _confirmLagSum / static_cast<qint64>(_confirmedCount) : 0)
+                         .arg(_confirmLagMax)
+                         .arg(std::count_if(_packages.begin(), _packages.end(), [](const Package& package){ return !package.isConfirmed; }));
+
+    if (!_recordsByType.isEmpty())
+    {
+        QStringList recordsByType;
+        for (auto recordsByType_it = _recordsByType.cbegin(); recordsByType_it != _recordsByType.cend(); ++recordsByType_it)
+        {
+            recordsByType.push_back(QString("%1: %2").arg(recordsByType_it.key()).arg(recordsByType_it.value()));
+        }
+        recordsByType.sort();
+
+        qInfo().noquote() << QString("Records by type: %1").arg(recordsByType.join(". "));
+    }
+
+    if (_compressedCount != 0)
+    {
+        qInfo().noquote() << QString("Compressed packages: %1. Compressed: %2 bytes. Uncompressed: %3 bytes. Ratio: %4. Decompress time avg: %5 us")
+                             .arg(_compressedCount)
+                             .arg(_compressedBytes)
+                             .arg(_uncompressedBytes)
+                             .arg(_compressedBytes != 0 ? static_cast<double>(_uncompressedBytes) / _compressedBytes : 0.0, 0, 'f', 2)
+                             .arg(_unzipTime / static_cast<qint64>(_compressedCount) / 1000);
+    }
+
+    _packagesCount = 0;
+    _recordsCount = 0;
+    _recordsByType.clear();
+    _compressedBytes = 0;
+    _uncompressedBytes = 0;
+    _compressedCount = 0;
+    _unzipTime = 0;
+    _statusRequestsCount = 0;
+    _errorsCount = 0;
+    _confirmedCount = 0;
+    _confirmLagSum = 0;
+    _confirmLagMax = 0;
+}
@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Локальная замена API сервера СУНЦ для измерения пропускной способности
+///
+/// (с) Dmitriy Kotov, 2024
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//STL
+#include <unordered_map>
+
+//Qt
+#include <QObject>
+#include <QHash>
+#include <QUuid>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QHttpServer>
+#include <QHttpServerRequest>
+#include <QHttpServerResponder>
+
+namespace MockSUNC
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// Принимает пакеты отправки данных и запросы статуса пакета. Ответ
+///     отправляется с задержкой latency +- latencyJitter, с вероятностью
+///     errorRate вместо ответа возвращается HTTP 500. Принятый пакет имеет
+///     статус Pending до истечения confirmDelay, далее - Success.
+///     Каждые statsInterval в консоль выводится количество принятых записей
+///     в секунду (всего и по типам данных) и задержка подтверждения пакетов (время от приема пакета
+///     до первого запроса статуса, вернувшего Success). Тела со сжатием gzip
+///     распаковываются, для них выводится степень сжатия и время распаковки
+///
+class MockSUNCServer final
+    : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Settings
+    {
+        quint16 port = 8080;
+        qint64 latency = 50;            ///< Задержка ответа, мсек
+        qint64 latencyJitter = 20;      ///< Случайное отклонение задержки ответа, мсек
+        double errorRate = 0.0;         ///< Доля запросов, завершаемых ошибкой HTTP 500 (0..1)
+        qint64 confirmDelay = 5000;     ///< Время перехода пакета из Pending в Success, мсек
+        qint64 statsInterval = 10000;   ///< Интервал вывода статистики, мсек
+    };
+
+public:
+    explicit MockSUNCServer(const Settings& settings, QObject* parent = nullptr);
+    ~MockSUNCServer();
+
+    /*!
+        Запускает сервер
+        @return true если порт открыт
+    */
+    bool start();
+
+private slots:
+    void printStats();
+
+private:
+    struct Package
+    {
+        QElapsedTimer receiveTimer;     ///< Время с момента приема пакета
+        bool isConfirmed = false;       ///< Клиент уже получил статус Success
+    };
+
+private:
+    MockSUNCServer() = delete;
+    Q_DISABLE_COPY_MOVE(MockSUNCServer)
+
+    /*!
+        Обрабатывает пакет отправки данных
+        @param arrayKey - ключ массива объектов с данными
+        @param itemsKey - ключ массива записей в объекте
+    */
+    void sendData(const QHttpServerRequest& request, QHttpServerResponder&& responder, const QString& arrayKey, const QString& itemsKey);
+    void getPackageStatus(const QHttpServerRequest& request, QHttpServerResponder&& responder);
+
+    /*!
+        Отправляет ответ после задержки. С вероятностью errorRate вместо ответа отправляется HTTP 500
+        @return false если вместо ответа будет отправлена ошибка
+    */
+    bool reply(QHttpServerResponder&& responder, const QJsonObject& answer);
+    void replyError(QHttpServerResponder&& responder, QHttpServerResponder::StatusCode code);
+    qint64 replyDelay() const;
+
+    static QJsonObject errorAnswer(const QString& error);
+
+private:
+    const Settings _settings;
+
+    QHttpServer _server;
+
+    QHash<QUuid, Package> _packages;
+
+    std::unordered_map<quint64, QHttpServerResponder> _responders;   ///< Ответы ожидающие отправки. Ключ - порядковый номер ответа
+    quint64 _lastResponderId = 0;
+
+    QTimer _statsTimer;
+    QElapsedTimer _statsPeriodTimer;
+
+    quint64 _packagesCount = 0;     ///< Количество принятых пакетов за период
+    quint64 _recordsCount = 0;      ///< Количество принятых записей за период
+    QHash<QString, quint64> _recordsByType; ///< Количество принятых записей за период по типу данных. Ключ - ключ массива данных пакета
+    quint64 _compressedBytes = 0;   ///< Размер сжатых тел пакетов за период, байт
+    quint64 _uncompressedBytes = 0; ///< Размер сжатых тел пакетов после распаковки за период, байт
+    quint64 _compressedCount = 0;   ///< Количество сжатых пакетов за период
+    qint64 _unzipTime = 0;          ///< Суммарное время распаковки за период, нсек
+    quint64 _statusRequestsCount = 0;
+    quint64 _errorsCount = 0;       ///< Количество ответов с ошибкой за период
+    quint64 _confirmedCount = 0;    ///< Количество подтвержденных пакетов за период
+    qint64 _confirmLagSum = 0;      ///< Суммарная задержка подтверждения за период, мсек
+    qint64 _confirmLagMax = 0;      ///< Максимальная задержка подтверждения за период, мсек
+
+}; //class MockSUNCServer
+
+} //namespace MockSUNC
@@ -0,0 +1,15 @@
+QT -= gui
+
+CONFIG += c++20 console
+CONFIG -= app_bundle
+
+#формирование запроса берется из исходников сервиса, чтобы измерялся тот же код, что используется в SyncDBStatus
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../tankscalculatequery.cpp \
+    main.cpp
+
+HEADERS += \
+    ../../dbwritemode.h \
+    ../../tankscalculatequery.h
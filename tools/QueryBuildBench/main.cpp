@@ -0,0 +1,259 @@
+//STL
+#include <algorithm>
+#include <vector>
+
+//Qt
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QHash>
+#include <QDateTime>
+#include <QDebug>
+
+//My
+#include "tankscalculatequery.h"
+
+//Сравнение времени формирования запроса INSERT в [TanksCalculate] для одного статуса в SyncDBStatus:
+// - до кеширования: вся строка запроса формируется цепочкой QString::arg из 17 значений, включая постоянные
+//   значения резервуара и текущее время сохранения;
+// - после кеширования: код сервиса из tankscalculatequery.cpp. Постоянные значения резервуара берутся из фрагмента,
+//   сформированного один раз на резервуар (tanksCalculateFragment), значения статуса дописываются tanksCalculateRow,
+//   время сохранения формируется один раз на сохранение (tanksCalculateSaveDateTimeSuffix), запросы собирает
+//   tanksCalculateQueries в режиме INSERT.
+//Вариант до кеширования в сервисе больше не существует, поэтому повторен здесь.
+//Пример: QueryBuildBench --tanks 100 --rows 60 --iterations 20
+
+using namespace LevelGaugeService;
+
+static const QString DATETIME_FORMAT = "yyyy-MM-dd hh:mm:ss.zzz";
+
+struct TankConfig
+{
+    QString levelGaugeCode;
+    quint8 tankNumber = 0;
+    qint64 timeShift = 0;
+    double totalVolume = 0.0;
+    QString product;
+    quint8 productStatus = 0;
+    QString name;
+    quint8 type = 0;
+    quint8 mode = 0;
+};
+
+struct TankStatus
+{
+    QDateTime dateTime;
+    double volume = 0.0;
+    double mass = 0.0;
+    double density = 0.0;
+    double height = 0.0;
+    double temp = 0.0;
+    quint8 additionFlag = 0;
+    quint8 status = 0;
+};
+
+struct Tank
+{
+    TankConfig config;
+    std::vector<TankStatus> statuses;
+};
+
+static std::vector<Tank> makeTanks(quint32 tanksCount, quint32 rowsCount)
+{
+    //фиксированное зерно - одинаковые данные при каждом запуске
+    QRandomGenerator random(1);
+
+    const auto startDateTime = QDateTime::currentDateTime();
+
+    std::vector<Tank> tanks;
+    tanks.reserve(tanksCount);
+    for (quint32 tankNumber = 0; tankNumber < tanksCount; ++tankNumber)
+    {
+        Tank tank;
+        tank.config.levelGaugeCode = QString("AZS%1").arg(tankNumber / 4 + 1, 4, 10, QChar('0'));
+        tank.config.tankNumber = static_cast<quint8>(tankNumber % 4 + 1);
+        tank.config.timeShift = 3 * 3600;
+        tank.config.totalVolume = 50000.0;
+        tank.config.product = "AI92";
+        tank.config.productStatus = 1;
+        tank.config.name = QString("Tank %1").arg(tank.config.tankNumber);
+        tank.config.type = 1;
+        tank.config.mode = 1;
+
+        for (quint32 rowNumber = 0; rowNumber < rowsCount; ++rowNumber)
+        {
+            TankStatus status;
+            status.dateTime = startDateTime.addMSecs(static_cast<qint64>(rowNumber) * 60000 + random.bounded(1000));
+            status.height = 500.0 + random.bounded(2000.0);
+            status.volume = status.height * 10.0;
+            status.density = 720.0 + random.bounded(60.0);
+            status.mass = status.volume * status.density / 1000.0;
+            status.temp = -20.0 + random.bounded(50.0);
+            status.additionFlag = 0;
+            status.status = 1;
+
+            tank.statuses.push_back(std::move(status));
+        }
+
+        tanks.push_back(std::move(tank));
+    }
+
+    return tanks;
+}
+
+//Код SyncDBStatus::insertStatuses до кеширования фрагмента
+static qsizetype buildUncached(const std::vector<Tank>& tanks)
+{
+    qsizetype bytes = 0;
+    for (const auto& tank: tanks)
+    {
+        const auto& tankConfig = tank.config;
+        for (const auto& status: tank.statuses)
+        {
+            const auto queryText =
+                QString("INSERT INTO [dbo].[TanksCalculate] "
+                        "([AZSCode], [TankNumber], [DateTime], "
+                        "[Volume], [TotalVolume], [Mass], [Density], [Height], [Temp], [Product], [ProductStatus], "
+                        "[TankName], [Type], [AdditionFlag], [Status], [Mode], [SaveDateTime]) "
+                    "VALUES ("
+                        "'%1', %2, CAST('%3' AS DATETIME2), "
+                        "%4, %5, %6, %7, %8, %9, '%10', %11, "
+                        "'%12', %13, %14, %15, %16, CAST('%17' AS DATETIME2))")
+            .arg(tankConfig.levelGaugeCode)                                                 //1
+            .arg(tankConfig.tankNumber)                                                     //2
+            .arg(status.dateTime.addSecs(tankConfig.timeShift).toString(DATETIME_FORMAT))   //3
+            .arg(status.volume, 0, 'f', 0)                                                  //4
+            .arg(tankConfig.totalVolume, 0, 'f', 0)                                         //5
+            .arg(status.mass, 0, 'f', 0)                                                    //6
+            .arg(status.density, 0, 'f', 1)                                                 //7
+            .arg(status.height, 0, 'f', 1)                                                  //8
+            .arg(status.temp, 0, 'f', 1)                                                    //9
+            .arg(tankConfig.product)                                                        //10
+            .arg(tankConfig.productStatus)                                                  //11
+            .arg(tankConfig.name)                                                           //12
+            .arg(tankConfig.type)                                                           //13
+            .arg(status.additionFlag)                                                       //14
+            .arg(status.status)                                                             //15
+            .arg(tankConfig.mode)                                                           //16
+            .arg((QDateTime::currentDateTime().toString(DATETIME_FORMAT)));                 //17
+
+            bytes += queryText.size();
+        }
+    }
+
+    return bytes;
+}
+
+//Код SyncDBStatus::renderStatuses и SyncDBStatus::saveToDB в режиме INSERT: фрагмент, строка и запрос формируются теми же
+//функциями, что и в сервисе. Кеш фрагментов живет между сохранениями, как и в SyncDBStatus, поэтому передается снаружи
+static qsizetype buildCached(const std::vector<Tank>& tanks, QHash<QString, QString>* staticFragments)
+{
+    const auto rowSuffix = tanksCalculateSaveDateTimeSuffix();
+
+    QStringList rows;
+    for (const auto& tank: tanks)
+    {
+        const auto& tankConfig = tank.config;
+
+        const auto key = QString("%1/%2").arg(tankConfig.levelGaugeCode).arg(tankConfig.tankNumber);
+        auto staticFragments_it = staticFragments->find(key);
+        if (staticFragments_it == staticFragments->end())
+        {
+            staticFragments_it = staticFragments->insert(key, tanksCalculateFragment(tankConfig.levelGaugeCode, tankConfig.tankNumber, tankConfig.totalVolume,
+                                                                                     tankConfig.product, tankConfig.productStatus, tankConfig.name,
+                                                                                     tankConfig.type, tankConfig.mode));
+        }
+        const auto& fragment = staticFragments_it.value();
+
+        for (const auto& status: tank.statuses)
+        {
+            rows.push_back(tanksCalculateRow(fragment, status.dateTime, tankConfig.timeShift, status.volume, status.mass, status.density,
+                                             status.height, status.temp, status.additionFlag, status.status));
+        }
+    }
+
+    QStringList queries;
+    tanksCalculateQueries(rows, DBWriteMode::INSERT, false, rowSuffix, &queries);
+
+    qsizetype bytes = 0;
+    for (const auto& queryText: queries)
+    {
+        bytes += queryText.size();
+    }
+
+    return bytes;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCoreApplication::setApplicationName("QueryBuildBench");
+    QCoreApplication::setApplicationVersion("0.1");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("[TanksCalculate] INSERT query build benchmark: QString::arg per row vs cached static fragment");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    const QCommandLineOption tanksOption("tanks", "Tanks", "count", "100");
+    const QCommandLineOption rowsOption("rows", "Statuses per tank in one save", "count", "60");
+    const QCommandLineOption iterationsOption("iterations", "Saves", "count", "20");
+
+    parser.addOptions({tanksOption, rowsOption, iterationsOption});
+    parser.process(app);
+
+    bool ok = true;
+    bool isValid = true;
+
+    const auto tanksCount = parser.value(tanksOption).toUInt(&ok);
+    isValid = isValid && ok && tanksCount > 0;
+    const auto rowsCount = parser.value(rowsOption).toUInt(&ok);
+    isValid = isValid && ok && rowsCount > 0;
+    const auto iterations = parser.value(iterationsOption).toUInt(&ok);
+    isValid = isValid && ok && iterations > 0;
+
+    if (!isValid)
+    {
+        qCritical() << "Invalid command line options";
+        parser.showHelp(1);
+    }
+
+    const auto tanks = makeTanks(tanksCount, rowsCount);
+    const auto totalRows = static_cast<qint64>(tanksCount) * rowsCount * iterations;
+
+    QHash<QString, QString> staticFragments;
+
+    //прогрев. Заодно заполняет кеш фрагментов - в работе сервиса фрагмент формируется только для первого статуса резервуара
+    qsizetype uncachedBytes = buildUncached(tanks);
+    qsizetype cachedBytes = buildCached(tanks, &staticFragments);
+
+    QElapsedTimer timer;
+    timer.start();
+    for (quint32 i = 0; i < iterations; ++i)
+    {
+        uncachedBytes = buildUncached(tanks);
+    }
+    const auto uncachedTime = std::max<qint64>(1, timer.nsecsElapsed());
+
+    timer.restart();
+    for (quint32 i = 0; i < iterations; ++i)
+    {
+        cachedBytes = buildCached(tanks, &staticFragments);
+    }
+    const auto cachedTime = std::max<qint64>(1, timer.nsecsElapsed());
+
+    const auto rowsPerSave = static_cast<qint64>(tanksCount) * rowsCount;
+
+    qInfo().noquote() << QString("Tanks: %1. Statuses per tank: %2. Saves: %3").arg(tanksCount).arg(rowsCount).arg(iterations);
+    qInfo().noquote() << QString("QString::arg per row: %1 ns/row, %2 chars/row")
+                         .arg(uncachedTime / totalRows)
+                         .arg(uncachedBytes / rowsPerSave);
+    qInfo().noquote() << QString("Cached fragment:      %1 ns/row, %2 chars/row")
+                         .arg(cachedTime / totalRows)
+                         .arg(cachedBytes / rowsPerSave);
+    qInfo().noquote() << QString("Speedup: %1x").arg(static_cast<double>(uncachedTime) / cachedTime, 0, 'f', 2);
+
+    return 0;
+}